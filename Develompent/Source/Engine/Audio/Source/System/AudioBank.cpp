@@ -4,6 +4,7 @@
 
 #include "Misc/AudioGlobals.h"
 #include "Misc/CoreGlobals.h"
+#include "System/MemoryTracker.h"
 #include "System/BaseFileSystem.h"
 #include "System/AudioBufferManager.h"
 #include "Logger/LoggerMacros.h"
@@ -136,6 +137,8 @@ CAudioBank::~CAudioBank()
 
 void CAudioBank::Serialize( class CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Audio );
+
 	CAsset::Serialize( InArchive );
 	InArchive << rawDataSize;
 
@@ -158,7 +161,7 @@ void CAudioBank::Serialize( class CArchive& InArchive )
 		std::vector<byte>		rawData;
 		rawData.resize( rawDataSize );
 
-		CArchive*				archive = GFileSystem->CreateFileReader( pathToArchive, AR_NoFail );	
+		CArchive*				archive = GPackageManager->GetFileHandleCache().CreateReader( pathToArchive, AR_NoFail );	
 		archive->Seek( offsetToRawData );
 		archive->Serialize( rawData.data(), rawDataSize );
 		delete archive;
@@ -185,7 +188,7 @@ AudioBankHandle_t CAudioBank::OpenBank( SAudioBankInfo& OutBankInfo )
 
 	// Init descriptor for read OGG/Vorbis from memory
 	SArchiveOGGRawData*			oggRawDataDesc = new SArchiveOGGRawData();
-	oggRawDataDesc->archive		= GFileSystem->CreateFileReader( pathToArchive );
+	oggRawDataDesc->archive		= GPackageManager->GetFileHandleCache().CreateReader( pathToArchive );
 	oggRawDataDesc->beginOffset	= offsetToRawData;
 	oggRawDataDesc->endOffset	= offsetToRawData + rawDataSize;
 
@@ -1,7 +1,11 @@
+#include "System/Malloc.h"
+#include "System/MemoryTracker.h"
 #include "System/AudioBufferManager.h"
 
 AudioBufferRef_t CAudioBufferManager::Find( const TAssetHandle<CAudioBank>& InAudioBank )
 {
+	SCOPED_MEMORY_TAG( MT_Audio );
+
 	// If already loaded buffer - return it
 	{
 		auto	it = buffers.find( InAudioBank );
@@ -19,14 +23,14 @@ AudioBufferRef_t CAudioBufferManager::Find( const TAssetHandle<CAudioBank>& InAu
 	AudioBankHandle_t			audioBankHandle = audioBankRef->OpenBank( audioBankInfo );
 	if ( audioBankHandle )
 	{
-		byte* sampleData = ( byte* ) malloc( audioBankInfo.numSamples );
+		byte* sampleData = ( byte* ) appMalloc( audioBankInfo.numSamples );
 		audioBankRef->ReadBankPCM( audioBankHandle, sampleData, audioBankInfo.numSamples );
 
 		AudioBufferRef_t		audioBuffer = new CAudioBuffer();
 		audioBuffer->Append( audioBankInfo.format, sampleData, audioBankInfo.numSamples, audioBankInfo.rate );
 
 		// Free all allocated temporary data and return audio buffer
-		free( sampleData );
+		appFree( sampleData );
 		audioBankRef->CloseBank( audioBankHandle );
 
 		buffers.insert( std::make_pair( InAudioBank, audioBuffer ) );
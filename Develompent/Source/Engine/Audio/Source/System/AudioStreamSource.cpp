@@ -1,6 +1,9 @@
 #include "System/AudioStreamSource.h"
+#include "System/Stats.h"
 #include "Logger/LoggerMacros.h"
 
+DECLARE_CYCLE_STAT( TEXT( "Fill stream buffer" ), STAT_FillStreamBuffer, SG_Audio );
+
 CAudioStreamRunnable::CAudioStreamRunnable( CAudioStreamSource* InStreamSource )
 	: streamSource( InStreamSource )
 {}
@@ -159,6 +162,7 @@ void CAudioStreamRunnable::ClearQueue()
 
 bool CAudioStreamRunnable::FillAndPushBuffer( uint32 InBufferIndex )
 {
+	SCOPE_CYCLE_COUNTER( STAT_FillStreamBuffer );
 	bool		requestStop = false;
 
 	// Acquire audio data, also address EOF and error cases if they occur
@@ -402,7 +406,7 @@ void CAudioStreamSource::SetAudioBank( const TAssetHandle<CAudioBank>& InAudioBa
 		}
 		else
 		{
-			audioBankUpdatedHandle = nullptr;
+			audioBankUpdatedHandle.Reset();
 		}
 
 		// Subscribe to new event delegate
@@ -228,6 +228,26 @@ extern void appShowMessageBox( const tchar* InTitle, const tchar* InMessage, EMe
  */
 extern void appDumpCallStack( std::wstring& OutCallStack );
 
+/**
+ * @ingroup Core
+ * @brief Capture return addresses of current call stack
+ *
+ * @param InNumFramesToSkip		Number of frames to skip, frame of this function is skipped always
+ * @param OutFrames				Output array of return addresses
+ * @param InMaxFrames			Maximum number of frames
+ * @return Return number of captured frames
+ */
+extern uint32 appCaptureCallStack( uint32 InNumFramesToSkip, void** OutFrames, uint32 InMaxFrames );
+
+/**
+ * @ingroup Core
+ * @brief Convert address of code to readable string
+ *
+ * @param InAddress		Address of code
+ * @return Return string in format 'Module+Offset', it can be resolved to source line by debug symbols of module
+ */
+extern std::wstring appCodeAddressToString( void* InAddress );
+
 /**
  * @ingroup Core
  * @brief Request shutdown application
@@ -26,13 +26,19 @@
 	#define SHIPPING_BUILD			SHIPPING
 #endif // !SHIPPING_BUILD
 
-// If current build not shipping - use  ImGui for debug
+// Scoped cycle counters and counters for 'stat' console commands. Data is collected only while stats are shown,
+// so it's cheap enough to keep enabled in shipping builds
+#ifndef STATS
+	#define STATS					1
+#endif // !STATS
+
+// If current build not shipping - use  ImGui for debug. With stats ImGui is needed for on-screen stats overlay
 #ifndef WITH_IMGUI
-	#if !SHIPPING_BUILD
+	#if !SHIPPING_BUILD || STATS
 		#define WITH_IMGUI 1
 	#else
 		#define WITH_IMGUI 0
-	#endif // !SHIPPING_BUILD
+	#endif // !SHIPPING_BUILD || STATS
 #endif // !WITH_IMGUI
 
 // Enable or disable checks in build
@@ -85,6 +91,27 @@
 	#define CHECK_PUREVIRTUALS		0
 #endif
 
+// Route global operators new and delete to engine allocator (CMallocBinned)
+#ifndef USE_MALLOC_BINNED
+	#define USE_MALLOC_BINNED		0
+#endif // !USE_MALLOC_BINNED
+
+// Track memory of engine allocator by tags (see SCOPED_MEMORY_TAG). Useful only with USE_MALLOC_BINNED,
+// because without it containers and operator new don't go through engine allocator
+#ifndef USE_MALLOC_TRACKING
+	#define USE_MALLOC_TRACKING		0
+#endif // !USE_MALLOC_TRACKING
+
+// Capture call stacks of tracked allocations for leak reports, it's slow so enabled only in debug builds
+#ifndef MALLOC_TRACKING_CALLSTACKS
+	#define MALLOC_TRACKING_CALLSTACKS	( USE_MALLOC_TRACKING && DEBUG )
+#endif // !MALLOC_TRACKING_CALLSTACKS
+
+// Back memory of engine allocator by large pages, works only if user has privilege 'Lock pages in memory'
+#ifndef USE_LARGE_PAGES
+	#define USE_LARGE_PAGES			1
+#endif // !USE_LARGE_PAGES
+
 // Is enable hit proxy
 #define ENABLE_HITPROXY		WITH_EDITOR
 
@@ -50,6 +50,13 @@ enum ELifeEnginePackageVersion
 	VER_AssetName_V3						= 18,					/**< Moved asset name to CAsset */
 	VER_AssetOnlyEditor						= 19,					/**< Added field 'bOnlyEditor' to asset */
 	VER_CName								= 20,					/**< Added CName for IDs in string view */
+	VER_CompressionCodecs					= 21,					/**< Added codec flags in compressed data */
+	VER_TextureMips							= 22,					/**< Added mip levels in texture 2D */
+	VER_TextureStreaming					= 23,					/**< Every mip of texture 2D stored in own compressed block for streaming */
+	VER_ShaderSourceHash					= 24,					/**< Added hash of compile inputs to items of shader cache */
+	VER_ShaderCacheIndex					= 25,					/**< Byte code of shaders stored uncompressed after index of shader cache for memory mapping */
+	VER_ShaderParameterSlots				= 26,					/**< Shader parameter map stored as table of slots sorted by hash of parameter name */
+	VER_FastHash							= 27,					/**< Changed function of appMemFastHash, hashes saved in older archives are not valid */
 
 	//
 	// New versions can be added here
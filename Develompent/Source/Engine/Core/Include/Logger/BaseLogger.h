@@ -9,8 +9,23 @@
 #ifndef BASELOGGER_H
 #define BASELOGGER_H
 
+#include <string>
+
 #include "Core.h"
 #include "Scripts/ScriptEngine.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Maximum length of message which fits in record of log queue, longer messages are allocated in heap
+ */
+#define LOG_RECORD_MESSAGE_LENGTH       512
+
+/**
+ * @ingroup Core
+ * @brief Number of records in log queue. Must be power of two
+ */
+#define LOG_QUEUE_SIZE                  1024
 
 /**
  * @ingroup Core
@@ -42,11 +57,14 @@ enum ELogCategory
     LC_Movie,               /**< Movie category */
     LC_Render,              /**< Render category */
     LC_RHI,                 /**< RHI category */
+    LC_Memory,              /**< Memory category */
 
 #if WITH_EDITOR
     LC_Editor,              /**< Editor category */
-    LC_Commandlet           /**< Commandlet category */
+    LC_Commandlet,          /**< Commandlet category */
 #endif // WITH_EDITOR
+
+    LC_Num                  /**< Number of categories */
 };
 
 /**
@@ -73,47 +91,55 @@ public:
     /**
      * @brief Constructor
      */
-                        CBaseLogger() {}
+                        CBaseLogger();
 
     /**
      * @brief Destructor
      */
-    virtual             ~CBaseLogger() {}
+    virtual             ~CBaseLogger();
 
     /**
      * @brief Initialize logger
+     * @note Derived loggers must call it after their output devices are ready
+     *
+     * Loads verbosity of categories from config and starts writer thread
      */
-    virtual void        Init() {}
+    virtual void        Init();
 
     /**
      * @ingroup Core
      * @brief Serialize message
+     * @note Called only on writer thread, or on calling thread when writer thread isn't started
      *
      * @param[in] InMessage Message
      * @param[in] InLogType Type of message
      * @param[in] InLogCategory Log category
+     * @param[in] InTime Time of message in seconds since start of engine, taken on calling thread
      */
-    virtual void        Serialize( const tchar* InMessage, ELogType InLogType, ELogCategory InLogCategory ) {};
+    virtual void        Serialize( const tchar* InMessage, ELogType InLogType, ELogCategory InLogCategory, double InTime ) {};
 
     /**
      * @ingroup Core
      * @brief Flush of output device
+     * @note Waits until all messages in queue are written
      */
-    virtual void        Flush() {};
+    virtual void        Flush();
 
     /**
      * @ingroup Core
      * @brief Closes output device and cleans up
+     * @note Derived loggers must call it before closing of their output devices
      *
      * Closes output device and cleans up. This can't happen in the destructor
 	 * as we might have to call "delete" which cannot be done for static/ global
 	 * objects
      */
-    virtual void        TearDown() {};
+    virtual void        TearDown();
 
     /**
      * @ingroup Core
      * @brief Print message to output device
+     * @note Message is formatted on calling thread and written by writer thread. Messages with type LT_Log are dropped when queue is full
      *
      * @param[in] InLogType Type of message
      * @param[in] InLogCategory Log category 
@@ -122,8 +148,45 @@ public:
      */
     void                Logf( ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, ... );
 
+    /**
+     * @ingroup Core
+     * @brief Print message with color to output device
+     *
+     * @param[in] InLogColor Color of message
+     * @param[in] InLogType Type of message
+     * @param[in] InLogCategory Log category 
+     * @param[in] InMessage Message
+     * @param[in] ... Other arguments of message
+     */
+    void                LogColorf( ELogColor InLogColor, ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, ... );
+
+    /**
+     * @brief Is enabled message
+     * @note Checked by LE_LOG before formatting of message
+     *
+     * @param[in] InLogType Type of message
+     * @param[in] InLogCategory Log category
+     * @return Return TRUE if message will be printed, otherwise returns FALSE
+     */
+    FORCEINLINE bool    IsLogEnabled( ELogType InLogType, ELogCategory InLogCategory ) const
+    {
+        return InLogType >= verbosity[ InLogCategory ];
+    }
+
+    /**
+     * @brief Set verbosity of category
+     *
+     * @param[in] InLogCategory Log category
+     * @param[in] InMinLogType Minimum type of printed messages
+     */
+    FORCEINLINE void    SetVerbosity( ELogCategory InLogCategory, ELogType InMinLogType )
+    {
+        verbosity[ InLogCategory ] = InMinLogType;
+    }
+
     /**
      * @brief Set color for text in log
+     * @note Called only by writer of messages
      * 
      * @param InLogColor Log color
      */
@@ -131,8 +194,106 @@ public:
 
     /**
      * @brief Reset color text to default
+     * @note Called only by writer of messages
      */
     virtual void        ResetTextColor() {}
+
+private:
+    friend class CLogWriterRunnable;
+
+    /**
+     * @brief Record of message in log queue
+     */
+    struct SLogRecord
+    {
+        volatile int32      sequence;                                   /**< Sequence number of record, used for synchronization of queue */
+        ELogType            logType;                                    /**< Type of message */
+        ELogCategory        logCategory;                                /**< Log category */
+        ELogColor           logColor;                                   /**< Color of message */
+        double              time;                                       /**< Time of message in seconds since start of engine */
+        std::wstring*       longMessage;                                /**< Message which doesn't fit in record */
+        tchar               message[ LOG_RECORD_MESSAGE_LENGTH ];       /**< Message */
+    };
+
+    /**
+     * @brief Print message to output device
+     *
+     * @param[in] InLogColor Color of message
+     * @param[in] InLogType Type of message
+     * @param[in] InLogCategory Log category 
+     * @param[in] InMessage Message
+     * @param[in] InArguments Other arguments of message
+     */
+    void                Logv( ELogColor InLogColor, ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, va_list InArguments );
+
+    /**
+     * @brief Allocate record in log queue
+     *
+     * @param[in] InLogType Type of message
+     * @param[out] OutPosition Position of record in queue
+     * @return Return allocated record, if queue is full and message can be dropped returns NULL
+     */
+    SLogRecord*         AllocateRecord( ELogType InLogType, uint32& OutPosition );
+
+    /**
+     * @brief Write messages from queue to output device
+     * @note Must be called only on one thread at the same time
+     *
+     * @return Return TRUE if any message is written, otherwise returns FALSE
+     */
+    bool                ProcessRecords();
+
+    /**
+     * @brief Write message to output device
+     *
+     * @param[in] InLogColor Color of message
+     * @param[in] InLogType Type of message
+     * @param[in] InLogCategory Log category 
+     * @param[in] InMessage Message
+     * @param[in] InTime Time of message in seconds since start of engine
+     */
+    void                WriteMessage( ELogColor InLogColor, ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, double InTime );
+
+    /**
+     * @brief Wake up writer thread if it waits for new messages
+     */
+    FORCEINLINE void    WakeWriter()
+    {
+        if ( isWriterWaiting && appInterlockedExchange( &isWriterWaiting, 0 ) )
+        {
+            eventNewRecords->Trigger();
+        }
+    }
+
+    ELogType            verbosity[ LC_Num ];        /**< Minimum type of printed messages for every category */
+    SLogRecord*         records;                    /**< Ring buffer of log queue */
+    volatile int32      enqueuePosition;            /**< Position of next allocated record */
+    volatile int32      dequeuePosition;            /**< Position of next written record */
+    volatile int32      numDroppedRecords;          /**< Number of dropped messages since last write */
+    volatile int32      isWriterRunning;            /**< Is writer thread running */
+    volatile int32      isWriterWaiting;            /**< Is writer thread waiting for new messages */
+    uint32              writerThreadId;             /**< ID of writer thread */
+    CRunnableThread*    writerThread;               /**< Writer thread */
+    CEvent*             eventNewRecords;            /**< Event triggered when new messages are in queue */
+    CCriticalSection    csDevice;                   /**< Critical section of output device */
 };
 
+/**
+ * @ingroup Core
+ * @brief Convert log type to text
+ *
+ * @param InLogType     Log type
+ * @return Return name of log type
+ */
+const tchar* appLogTypeToText( ELogType InLogType );
+
+/**
+ * @ingroup Core
+ * @brief Convert log category to text
+ *
+ * @param InLogCategory     Log category
+ * @return Return name of log category
+ */
+const tchar* appLogCategoryToText( ELogCategory InLogCategory );
+
 #endif // !BASELOGGER_H
@@ -19,13 +19,14 @@
 	 * @ingroup Core
 	 * @brief Macro for print message to log
 	 * @warning In shipping this macro is empty and logging disabled
+	 * @note Arguments aren't evaluated and message isn't formatted if category is filtered out by verbosity
 	 * 
 	 * @param[in] InType Type message
 	 * @param[in] InCategory Category of message
 	 * @param[in] InMessage Message
 	 * @param[in] ... Other arguments of message
 	 */
-	#define LE_LOG( InType, InCategory, InMessage, ... )				GLog->Logf( InType, InCategory, InMessage, __VA_ARGS__ )
+	#define LE_LOG( InType, InCategory, InMessage, ... )				( GLog->IsLogEnabled( InType, InCategory ) ? GLog->Logf( InType, InCategory, InMessage, __VA_ARGS__ ) : ( void )0 )
 	 
 	 /**
 	   * @ingroup Core
@@ -40,9 +41,10 @@
 	   */
 	#define LE_LOG_COLOR( InColor, InType, InCategory, InMessage, ...  ) \
 		{ \
-			GLog->SetTextColor( InColor ); \
-			GLog->Logf( InType, InCategory, InMessage, __VA_ARGS__ ); \
-			GLog->ResetTextColor(); \
+			if ( GLog->IsLogEnabled( InType, InCategory ) ) \
+			{ \
+				GLog->LogColorf( InColor, InType, InCategory, InMessage, __VA_ARGS__ ); \
+			} \
 		}
 #else
 	#define LE_LOG( InType, InCategory, InMessage, ... )
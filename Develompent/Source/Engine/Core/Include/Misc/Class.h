@@ -10,10 +10,12 @@
 #define CLASS_H
 
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "Core.h"
 #include "System/Archive.h"
+#include "System/Name.h"
+#include "System/ObjectPool.h"
 #include "Scripts/ScriptEngine.h"
 
 /**
@@ -28,7 +30,10 @@ public:
 	 */
 	FORCEINLINE										CClass() :
 		ClassConstructor( nullptr ),
-		superClass( nullptr )
+		superClass( nullptr ),
+		classIndex( INDEX_NONE ),
+		objectSize( 0 ),
+		objectPool( nullptr )
 	{}
 
 	/**
@@ -37,13 +42,26 @@ public:
 	 * @param[in] InClassName Class name
 	 * @param[in] InClassConstructor Pointer to class constructor
 	 * @param[in] InSuperClass Pointer to super class
+	 * @param[in] InObjectSize Size of class object. If zero objects are allocated in heap without pool
 	 */
-	FORCEINLINE										CClass( const std::wstring& InClassName, class CObject*( *InClassConstructor )(), CClass* InSuperClass = nullptr ) :
+	FORCEINLINE										CClass( const std::wstring& InClassName, class CObject*( *InClassConstructor )(), CClass* InSuperClass = nullptr, uint32 InObjectSize = 0 ) :
 		ClassConstructor( InClassConstructor ),
 		superClass( InSuperClass ),
-		name( InClassName )
+		name( InClassName ),
+		cname( InClassName ),
+		classIndex( INDEX_NONE ),
+		objectSize( InObjectSize ),
+		objectPool( InObjectSize > 0 ? new CObjectPool( InObjectSize ) : nullptr )
 	{}
 
+	/**
+	 * @brief Destructor
+	 */
+	FORCEINLINE										~CClass()
+	{
+		delete objectPool;
+	}
+
 	/**
 	 * @brief Get class name
 	 * @return Return class name
@@ -53,6 +71,69 @@ public:
 		return name;
 	}
 
+	/**
+	 * @brief Get class name
+	 * @return Return class name as CName
+	 */
+	FORCEINLINE const CName&						GetCName() const
+	{
+		return cname;
+	}
+
+	/**
+	 * @brief Get class index
+	 * @return Return dense index of class in registry. If class isn't registered returns INDEX_NONE
+	 */
+	FORCEINLINE uint32								GetClassIndex() const
+	{
+		return classIndex;
+	}
+
+	/**
+	 * @brief Get object pool
+	 * @return Return pool of class objects. If class doesn't use pool returns nullptr
+	 */
+	FORCEINLINE const CObjectPool*					GetObjectPool() const
+	{
+		return objectPool;
+	}
+
+	/**
+	 * @brief Allocate memory for class object
+	 * @note Called from operator new of classes declared by DECLARE_CLASS
+	 *
+	 * @param[in] InSize Size of memory
+	 * @return Return pointer to allocated memory
+	 */
+	FORCEINLINE void*								AllocateObject( size_t InSize ) const
+	{
+		// Child class without own DECLARE_CLASS has other size, it is allocated in heap
+		if ( objectPool && InSize == objectSize )
+		{
+			return objectPool->Allocate();
+		}
+		return ::operator new( InSize );
+	}
+
+	/**
+	 * @brief Free memory of class object
+	 * @note Called from operator delete of classes declared by DECLARE_CLASS
+	 *
+	 * @param[in] InPointer Pointer to memory
+	 * @param[in] InSize Size of memory
+	 */
+	FORCEINLINE void								FreeObject( void* InPointer, size_t InSize ) const
+	{
+		if ( objectPool && InSize == objectSize )
+		{
+			objectPool->Free( InPointer );
+		}
+		else
+		{
+			::operator delete( InPointer );
+		}
+	}
+
 	/**
 	 * @brief Get super class
 	 * @return Return pointer to super class. If it is not, it will return nullptr
@@ -86,11 +167,7 @@ public:
 	 * @brief Register class in table
 	 * @param[in] InClass Class
 	 */
-	static FORCEINLINE void							StaticRegisterClass( const CClass* InClass )
-	{
-		check( InClass );
-		classesTable.insert( std::make_pair( InClass->GetName(), InClass ) );
-	}
+	static void										StaticRegisterClass( CClass* InClass );
 
 	/**
 	 * @brief Find class by name
@@ -98,26 +175,37 @@ public:
 	 * 
 	 * @return Return pointer to class. If not found returning nullptr
 	 */
-	static FORCEINLINE CClass*					StaticFindClass( const tchar* InClassName )
-	{
-		auto		itClass = classesTable.find( InClassName );
-		if ( itClass == classesTable.end() )
-		{
-			return nullptr;
-		}
+	static CClass*									StaticFindClass( const CName& InClassName );
 
-		return ( CClass* )itClass->second;
+	/**
+	 * @brief Find class by name
+	 * @param[in] InClassName Class name
+	 * 
+	 * @return Return pointer to class. If not found returning nullptr
+	 */
+	static FORCEINLINE CClass*						StaticFindClass( const tchar* InClassName )
+	{
+		return StaticFindClass( CName( InClassName ) );
 	}
 
 	/**
-	 * @brief Get array of all registered classes
-	 * @return Return array of all registered classes
+	 * @brief Get class by index
+	 * @param[in] InClassIndex Dense index of class
+	 * 
+	 * @return Return pointer to class. If index isn't valid returning nullptr
 	 */
-	static FORCEINLINE const std::unordered_map<std::wstring, const CClass*>& StaticGetRegisteredClasses()
+	static FORCEINLINE CClass*						StaticGetClass( uint32 InClassIndex )
 	{
-		return classesTable;
+		const std::vector<CClass*>&		classes = StaticGetRegisteredClasses();
+		return InClassIndex < classes.size() ? classes[InClassIndex] : nullptr;
 	}
 
+	/**
+	 * @brief Get array of all registered classes
+	 * @return Return array of all registered classes, index in array is class index
+	 */
+	static const std::vector<CClass*>&				StaticGetRegisteredClasses();
+
 	/**
 	 * @brief Is a class
 	 * 
@@ -151,7 +239,10 @@ private:
 
 	CClass*														superClass;			/**< Pointer to super class */
 	std::wstring												name;				/**< Class name */	
-	static std::unordered_map<std::wstring, const CClass*>		classesTable;		/**< Table of all classes in system */
+	CName														cname;				/**< Class name as CName */
+	uint32														classIndex;			/**< Dense index of class in registry */
+	uint32														objectSize;			/**< Size of class object */
+	CObjectPool*												objectPool;			/**< Pool of class objects */
 };
 
 #endif // !CLASS_H
\ No newline at end of file
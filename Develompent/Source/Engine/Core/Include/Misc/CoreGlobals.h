@@ -114,6 +114,12 @@ extern double						GLastTime;
  */
 extern class CPackageManager*		GPackageManager;
 
+/**
+ * @ingroup Core
+ * Thread pool for background and parallel works
+ */
+extern class CQueuedThreadPool*		GThreadPool;
+
 /**
  * @ingroup Core
  * Table of contents
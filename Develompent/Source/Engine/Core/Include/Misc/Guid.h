@@ -203,6 +203,18 @@ public:
 		return bSuccessful;
 	}
 
+	/**
+	 * Get section of GUID
+	 * 
+	 * @param InIndex Index of section (0 - A, 1 - B, 2 - C, 3 - D)
+	 * @return Return section of GUID
+	 */
+	FORCEINLINE uint32 operator[]( uint32 InIndex ) const
+	{
+		check( InIndex < 4 );
+		return ( &a )[ InIndex ];
+	}
+
 	/**
 	 * Get hash of type
 	 * @return Return hash of this GUID
@@ -24,8 +24,12 @@
  */
 enum ECompressionFlags
 {
-	CF_None = 0,		/**< No compression */
-	CF_ZLIB = 1 << 0,	/**< Compress with ZLIB */
+	CF_None			= 0,								/**< No compression */
+	CF_ZLIB			= 1 << 0,							/**< Compress with ZLIB */
+	CF_BiasSpeed	= 1 << 4,							/**< Prefer compression speed over compression ratio */
+	CF_BiasSize		= 1 << 5,							/**< Prefer compression ratio over compression speed */
+
+	CF_CodecMask	= CF_ZLIB							/**< Mask of codec flags, bits 0-3 are reserved for codecs */
 };
 
 /**
@@ -128,6 +132,13 @@ std::wstring appComputerName();
  */
 std::wstring appUserName();
 
+/**
+ * @ingroup Core
+ * @brief Get number of logical cores
+ * @return Return number of logical cores in system
+ */
+uint32 appNumberOfCores();
+
 /**
  * @ingroup Core
  * Calculate hash from name
@@ -169,6 +180,16 @@ bool appCompressMemory( ECompressionFlags InFlags, void* InCompressedBuffer, uin
  */
 bool appUncompressMemory( ECompressionFlags InFlags, void* InUncompressedBuffer, uint32 InUncompressedSize, const void* InCompressedBuffer, uint32 InCompressedSize );
 
+/**
+ * @ingroup Core
+ * Get maximum size of compressed data
+ *
+ * @param[in] InFlags Flags to control what method to use
+ * @param[in] InUncompressedSize Size of uncompressed data in bytes
+ * @return Return maximum size of compressed data for InUncompressedSize bytes
+ */
+uint32 appCompressMemoryBound( ECompressionFlags InFlags, uint32 InUncompressedSize );
+
 /**
  * @ingroup Core
  * Does per platform initialization of timing information and returns the current time
@@ -16,6 +16,8 @@
  * @ingroup Core
  * @brief Macro for declare class
  * 
+ * Objects of class are allocated from pool of the class (see CClass::AllocateObject)
+ *
  * @param[in] TClass Class
  * @param[in] TSuperClass Super class
  * 
@@ -29,7 +31,11 @@
 	    typedef TSuperClass	        Super; \
         static CObject*             StaticConstructor(); \
         static class CClass*        StaticClass(); \
-        virtual class CClass*       GetClass() const;
+        virtual class CClass*       GetClass() const; \
+        static void*                operator new( size_t InSize ) { return StaticClass()->AllocateObject( InSize ); } \
+        static void*                operator new( size_t InSize, void* InPlace ) { return InPlace; } \
+        static void                 operator delete( void* InPointer, size_t InSize ) { StaticClass()->FreeObject( InPointer, InSize ); } \
+        static void                 operator delete( void* InPointer, void* InPlace ) {}
 
 /**
  * @ingroup Core
@@ -51,7 +57,7 @@
         if ( !staticClass ) \
         { \
             bool        isBaseClass = &ThisClass::StaticClass == &Super::StaticClass; \
-            staticClass = new CClass( TEXT( #TClass ), &ThisClass::StaticConstructor, !isBaseClass ? Super::StaticClass() : nullptr ); \
+            staticClass = new CClass( TEXT( #TClass ), &ThisClass::StaticConstructor, !isBaseClass ? Super::StaticClass() : nullptr, sizeof( ThisClass ) ); \
         } \
         \
         return staticClass; \
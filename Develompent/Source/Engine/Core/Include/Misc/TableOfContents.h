@@ -10,10 +10,13 @@
 #define TABLEOFCONTENTS_H
 
 #include <unordered_map>
+#include <vector>
 
 #include "Misc/Types.h"
 #include "Misc/Guid.h"
 #include "System/Archive.h"
+#include "System/BaseFileSystem.h"
+#include "System/ThreadingBase.h"
 #include "CoreDefines.h"
 
 /**
@@ -23,6 +26,20 @@
 class CTableOfContets
 {
 public:
+	/**
+	 * Constructor
+	 */
+	CTableOfContets();
+
+	/**
+	 * Load table of contents from file
+	 * @note File is mapped to memory and used as is, without parsing
+	 * 
+	 * @param InPath	Path to file
+	 * @return Return TRUE if table is loaded, else return FALSE
+	 */
+	bool Load( const std::wstring& InPath );
+
 	/**
 	 * Serialize archive
 	 * 
@@ -35,8 +52,10 @@ public:
 	 */
 	FORCEINLINE void Clear()
 	{
+		CScopeLock		scopeLock( cs );
 		nameEntries.clear();
 		guidEntries.clear();
+		ResetBinaryTable();
 	}
 
 	/**
@@ -47,16 +66,13 @@ public:
 
 	/**
 	 * Add a package to the TOC at runtime
+	 * @note If binary table is loaded it isn't unpacked, the entry goes to runtime entries which are checked before binary table
 	 *
 	 * @param InGUID GUID of the package
 	 * @param InName Name of the package
 	 * @param InPath Path to the package
 	 */
-	FORCEINLINE void AddEntry( const CGuid& InGUID, const std::wstring& InName, const std::wstring& InPath )
-	{
-		nameEntries.insert( std::make_pair( InName, STOCEntry{ InName, InPath } ) );
-		guidEntries.insert( std::make_pair( InGUID, STOCEntry{ InName, InPath } ) );
-	}
+	void AddEntry( const CGuid& InGUID, const std::wstring& InName, const std::wstring& InPath );
 
 	/**
 	 * Remove a package from the TOC at runtime
@@ -70,6 +86,8 @@ public:
 	 */
 	FORCEINLINE void RemoveEntry( const CGuid& InGUID )
 	{
+		CScopeLock		scopeLock( cs );
+		MakeEditable();
 		auto	it = guidEntries.find( InGUID );
 		if ( it == guidEntries.end() )
 		{
@@ -95,16 +113,7 @@ public:
 	 * @param InGUID GUID of the package
 	 * @return Return path to the package by GUID, if not found returning empty string
 	 */
-	FORCEINLINE std::wstring GetPackagePath( const CGuid& InGUID ) const
-	{
-		auto	itEntry = guidEntries.find( InGUID );
-		if ( itEntry != guidEntries.end() )
-		{
-			return itEntry->second.path;
-		}
-
-		return TEXT( "" );
-	}
+	std::wstring GetPackagePath( const CGuid& InGUID ) const;
 
 	/**
 	 * Get path to the package
@@ -112,16 +121,7 @@ public:
 	 * @param InName Name of the package
 	 * @return Return path to the package by name, if not found returning empty string
 	 */
-	FORCEINLINE std::wstring GetPackagePath( const std::wstring& InName ) const
-	{
-		auto	itEntry = nameEntries.find( InName );
-		if ( itEntry != nameEntries.end() )
-		{
-			return itEntry->second.path;
-		}
-
-		return TEXT( "" );
-	}
+	std::wstring GetPackagePath( const std::wstring& InName ) const;
 
 	/**
 	 * Get number of entries
@@ -129,7 +129,8 @@ public:
 	 */
 	FORCEINLINE uint32 GetNumEntries() const
 	{
-		return guidEntries.size();
+		CScopeLock		scopeLock( cs );
+		return ( binaryHeader ? binaryHeader->numEntries : 0 ) + ( uint32 )guidEntries.size();
 	}
 
 	/**
@@ -138,7 +139,7 @@ public:
 	 */
 	FORCEINLINE static std::wstring GetNameTOC()
 	{
-		return TEXT( "TOC.txt" );
+		return TEXT( "TOC.bin" );
 	}
 
 private:
@@ -151,8 +152,91 @@ private:
 		std::wstring		path;		/**< Path to entry */
 	};
 
-	std::unordered_map< std::wstring, STOCEntry >					nameEntries;			/**< Entries of table content. Key - Name of the package, Item - Path to package */
-	std::unordered_map< CGuid, STOCEntry, CGuid::SGuidKeyFunc >		guidEntries;			/**< Entries of table content. Key - GUID of the package, Item - Path to package */
+	/**
+	 * Header of binary table of contents
+	 * 
+	 * Binary table is position independent and used right from memory (it's mapped from file). After header follow:
+	 *  - STOCBinaryEntry[ numEntries ], sorted by bucket of GUID hash
+	 *  - uint32 guidBuckets[ numBuckets + 1 ], index of first entry in bucket
+	 *  - uint32 nameBuckets[ numBuckets + 1 ], index of first element of nameIndices in bucket
+	 *  - uint32 nameIndices[ numEntries ], indices of entries sorted by bucket of name hash
+	 *  - uint16 strings[ numChars ], names and paths of packages in UTF-16 without null terminators
+	 */
+	struct STOCBinaryHeader
+	{
+		uint32		magic;					/**< Magic number */
+		uint32		version;				/**< Version of format */
+		uint32		numEntries;				/**< Number of entries */
+		uint32		numBuckets;				/**< Number of buckets in hash tables. It's always power of two */
+		uint32		entriesOffset;			/**< Offset to entries */
+		uint32		guidBucketsOffset;		/**< Offset to buckets of GUID table */
+		uint32		nameBucketsOffset;		/**< Offset to buckets of name table */
+		uint32		nameIndicesOffset;		/**< Offset to indices of name table */
+		uint32		stringsOffset;			/**< Offset to strings */
+		uint32		numChars;				/**< Number of chars in strings */
+	};
+
+	/**
+	 * Entry of binary table of contents
+	 */
+	struct STOCBinaryEntry
+	{
+		uint32		guid[4];				/**< GUID of package */
+		uint32		nameHash;				/**< Hash of package name */
+		uint32		nameOffset;				/**< Offset to name in strings (in chars) */
+		uint32		nameLength;				/**< Length of name (in chars) */
+		uint32		pathOffset;				/**< Offset to path in strings (in chars) */
+		uint32		pathLength;				/**< Length of path (in chars) */
+	};
+
+	/**
+	 * Set binary table
+	 * 
+	 * @param InData	Pointer to data of binary table
+	 * @param InSize	Size of data
+	 * @return Return TRUE if binary table is valid, else return FALSE
+	 */
+	bool SetBinaryTable( const byte* InData, uint32 InSize );
+
+	/**
+	 * Reset binary table
+	 */
+	void ResetBinaryTable();
+
+	/**
+	 * Move entries from binary table to editable maps
+	 * @note Used only by editor and cooker, on runtime binary table is never unpacked
+	 */
+	void MakeEditable();
+
+	/**
+	 * Find entry in binary table by GUID
+	 *
+	 * @param InGUID	GUID of the package
+	 * @return Return pointer to entry in binary table, if not found or binary table isn't loaded returning NULL
+	 */
+	const STOCBinaryEntry* FindBinaryEntry( const CGuid& InGUID ) const;
+
+	/**
+	 * Get string from binary table
+	 * 
+	 * @param InOffset	Offset in strings
+	 * @param InLength	Length of string
+	 * @return Return string
+	 */
+	std::wstring GetBinaryString( uint32 InOffset, uint32 InLength ) const;
+
+	mutable CCriticalSection										cs;						/**< Critical section, packages may be loaded (and added to TOC) from any thread */
+	std::unordered_map< std::wstring, STOCEntry >					nameEntries;			/**< Entries of table content (runtime entries if binary table is loaded). Key - Name of the package, Item - Path to package */
+	std::unordered_map< CGuid, STOCEntry, CGuid::SGuidKeyFunc >		guidEntries;			/**< Entries of table content (runtime entries if binary table is loaded). Key - GUID of the package, Item - Path to package */
+	MappedFileRef_t													mappedFile;				/**< Mapped file with binary table */
+	std::vector< byte >												binaryData;				/**< Binary table loaded through archive */
+	const STOCBinaryHeader*											binaryHeader;			/**< Header of binary table. If not NULL lookups go through binary table */
+	const STOCBinaryEntry*											binaryEntries;			/**< Entries of binary table */
+	const uint32*													binaryGuidBuckets;		/**< Buckets of GUID table */
+	const uint32*													binaryNameBuckets;		/**< Buckets of name table */
+	const uint32*													binaryNameIndices;		/**< Indices of name table */
+	const uint16*													binaryStrings;			/**< Strings of binary table */
 };
 
 #endif // !TABLEOFCONTENTS_H
\ No newline at end of file
@@ -154,6 +154,9 @@ protected:
 	uint32					arVer;		/**< Archive version (look ELifeEnginePackageVersion) */
 	EArchiveType			arType;		/**< Archive type */
 	std::wstring			arPath;		/**< Path to archive */
+
+private:
+	std::vector<byte>		compressedScratch;		/**< Scratch buffer for compressed data, reused between calls of SerializeCompressed */
 };
 
 /**
@@ -14,6 +14,8 @@
 
 #include "Core.h"
 #include "Misc/Types.h"
+#include "Misc/RefCounted.h"
+#include "Misc/RefCountPtr.h"
 
 /**
  * @ingroup Core
@@ -118,6 +120,156 @@ private:
     std::wstring        path;       /**< Path to file */
 };
 
+/**
+ * @ingroup Core
+ * @brief Handle of file opened for positional reading
+ * @note Reads through this handle not change any shared file pointer, so one handle can be used from many threads at once
+ */
+class CFileReadHandle : public CRefCounted
+{
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param InPath    Path to file
+     */
+    FORCEINLINE CFileReadHandle( const std::wstring& InPath )
+        : path( InPath )
+    {}
+
+    /**
+     * @brief Read data from file at offset
+     * 
+     * @param InBuffer  Pointer to destination buffer
+     * @param InSize    Number of bytes to read
+     * @param InOffset  Offset in file from which to start reading
+     * @return Return number of readed bytes. If it less then InSize - reached end of file or happened error
+     */
+    virtual uint32 ReadAt( void* InBuffer, uint32 InSize, uint64 InOffset ) = 0;
+
+    /**
+     * @brief Get size of file
+     * @return Return size of file in bytes
+     */
+    virtual uint64 GetSize() const = 0;
+
+    /**
+     * @brief Get path to file
+     * @return Return path to file
+     */
+    FORCEINLINE const std::wstring& GetPath() const
+    {
+        return path;
+    }
+
+private:
+    std::wstring        path;       /**< Path to file */
+};
+
+/**
+ * @ingroup Core
+ * @brief Reference to CFileReadHandle
+ */
+typedef TRefCountPtr<CFileReadHandle>       FileReadHandleRef_t;
+
+/**
+ * @ingroup Core
+ * @brief Handle of file opened for positional writing
+ */
+class CFileWriteHandle : public CRefCounted
+{
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param InPath    Path to file
+     */
+    FORCEINLINE CFileWriteHandle( const std::wstring& InPath )
+        : path( InPath )
+    {}
+
+    /**
+     * @brief Write data to file at offset
+     * 
+     * @param InBuffer  Pointer to source buffer
+     * @param InSize    Number of bytes to write
+     * @param InOffset  Offset in file from which to start writing
+     * @return Return TRUE if all data is written, else return FALSE
+     */
+    virtual bool WriteAt( const void* InBuffer, uint32 InSize, uint64 InOffset ) = 0;
+
+    /**
+     * @brief Get size of file at the moment of opening
+     * @return Return size of file in bytes
+     */
+    virtual uint64 GetSize() const = 0;
+
+    /**
+     * @brief Get path to file
+     * @return Return path to file
+     */
+    FORCEINLINE const std::wstring& GetPath() const
+    {
+        return path;
+    }
+
+private:
+    std::wstring        path;       /**< Path to file */
+};
+
+/**
+ * @ingroup Core
+ * @brief Reference to CFileWriteHandle
+ */
+typedef TRefCountPtr<CFileWriteHandle>      FileWriteHandleRef_t;
+
+/**
+ * @ingroup Core
+ * @brief File mapped to memory for reading
+ */
+class CMappedFile : public CRefCounted
+{
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param InPath    Path to file
+     */
+    FORCEINLINE CMappedFile( const std::wstring& InPath )
+        : path( InPath )
+    {}
+
+    /**
+     * @brief Get pointer to data of file
+     * @return Return pointer to data of file
+     */
+    virtual const byte* GetData() const = 0;
+
+    /**
+     * @brief Get size of file
+     * @return Return size of file in bytes
+     */
+    virtual uint64 GetSize() const = 0;
+
+    /**
+     * @brief Get path to file
+     * @return Return path to file
+     */
+    FORCEINLINE const std::wstring& GetPath() const
+    {
+        return path;
+    }
+
+private:
+    std::wstring        path;       /**< Path to file */
+};
+
+/**
+ * @ingroup Core
+ * @brief Reference to CMappedFile
+ */
+typedef TRefCountPtr<CMappedFile>           MappedFileRef_t;
+
 /**
  * @ingroup Core
  * @brief The base class for work with file system
@@ -125,11 +277,27 @@ private:
 class CBaseFileSystem
 {
 public:
+    /**
+     * @brief Constructor
+     */
+                                                    CBaseFileSystem() : fileHandleCache( nullptr ) {}
+
     /**
      * @brief Destructor
      */
     virtual                                         ~CBaseFileSystem() {}
 
+    /**
+     * @brief Set cache of opened file handles
+     * @note Handles of files in this cache are dropped when files are written, copied over, moved or deleted
+     *
+     * @param InFileHandleCache     Cache of opened file handles. If NULL, nothing is invalidated
+     */
+    FORCEINLINE void                                SetFileHandleCache( class CFileHandleCache* InFileHandleCache )
+    {
+        fileHandleCache = InFileHandleCache;
+    }
+
     /**
      * @brief Create file reader
      * @warning You must manually delete the selected object 
@@ -140,7 +308,7 @@ public:
      * 
      * @warning After use need delete file reader
      */
-    virtual class CArchive*                     CreateFileReader( const std::wstring& InFileName, uint32 InFlags = AR_None )            { return nullptr; }
+    virtual class CArchive*                     CreateFileReader( const std::wstring& InFileName, uint32 InFlags = AR_None );
 
     /**
 	 * @brief Create file writer
@@ -152,7 +320,37 @@ public:
 	 *
 	 * @warning After use need delete file writer
 	 */
-    virtual class CArchive*                     CreateFileWriter( const std::wstring& InFileName, uint32 InFlags = AW_None )            { return nullptr; }
+    virtual class CArchive*                     CreateFileWriter( const std::wstring& InFileName, uint32 InFlags = AW_None );
+
+    /**
+     * @brief Open file for positional reading
+     * @note Usually you don't need call this directly, use CFileHandleCache for share opened files between consumers
+     * 
+     * @param InFileName    Path to file
+     * @param InFlags       Combinations flags of EArchiveRead for open mode
+     * @return Return handle of opened file, if file not opened return NULL
+     */
+    virtual FileReadHandleRef_t                     OpenReadHandle( const std::wstring& InFileName, uint32 InFlags = AR_None )             { return nullptr; }
+
+    /**
+     * @brief Open file for positional writing
+     * @note Directory of file is created if it not exist. Without AW_Append file is truncated
+     * 
+     * @param InFileName    Path to file
+     * @param InFlags       Combinations flags of EArchiveWrite for opening mode
+     * @return Return handle of opened file, if file not opened return NULL
+     */
+    virtual FileWriteHandleRef_t                    OpenWriteHandle( const std::wstring& InFileName, uint32 InFlags = AW_None )            { return nullptr; }
+
+    /**
+     * @brief Map file to memory for reading
+     * @note By default file is fully read to memory, platforms with support of memory mapping override it
+     * 
+     * @param InFileName    Path to file
+     * @param InFlags       Combinations flags of EArchiveRead for open mode
+     * @return Return mapped file, if file not opened return NULL
+     */
+    virtual MappedFileRef_t                         MapFile( const std::wstring& InFileName, uint32 InFlags = AR_None );
 
     /**
      * @brief Find files in directory
@@ -259,6 +457,17 @@ protected:
      * @return Return TRUE in case 'yes'
      */
     virtual bool IsDrive( const std::wstring& InPath ) const;
+
+    /**
+     * @brief Drop cached handles of file or of all files in directory
+     * @note Platform file systems must call it before file is changed on disk
+     *
+     * @param InPath    Path to file or directory
+     */
+    void InvalidateCachedHandles( const std::wstring& InPath );
+
+private:
+    class CFileHandleCache*                         fileHandleCache;        /**< Cache of opened file handles */
 };
 
 #endif
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include <rapidjson/document.h>
 
 #include "Core.h"
+#include "Misc/CoreGlobals.h"
 
 #undef GetObject
 
@@ -119,6 +120,14 @@ public:
 	 */
 	class CConfigValue				GetValue( const tchar* InName ) const;
 
+	/**
+	 * @brief Find value
+	 *
+	 * @param[in] InName Name of value
+	 * @return Return pointer to value in object without copy. If not exist value in object - return NULL
+	 */
+	const class CConfigValue*		FindValue( const tchar* InName ) const;
+
 	/**
 	 * @brief Operator = for copy value
 	 * @param[in] InCopy Copy of value
@@ -520,6 +529,24 @@ public:
 		return itGroup->second.GetValue( InName );
 	}
 
+	/**
+	 * @brief Find value
+	 *
+	 * @param[in] InGroup Name of group in config
+	 * @param[in] InName Name of value in config group
+	 * @return Return pointer to value in config without copy, if not founded return NULL
+	 */
+	FORCEINLINE const CConfigValue*	FindValue( const tchar* InGroup, const tchar* InName ) const
+	{
+		MapGroups_t::const_iterator		itGroup = groups.find( InGroup );
+		if ( itGroup == groups.end() )
+		{
+			return nullptr;
+		}
+
+		return itGroup->second.FindValue( InName );
+	}
+
 private:
 	typedef std::unordered_map< std::wstring, CConfigObject >		MapGroups_t;
 
@@ -533,8 +560,16 @@ private:
 class CConfigManager
 {
 public:
+	/**
+	 * @brief Constructor
+	 */
+	FORCEINLINE CConfigManager()
+		: generation( 0 )
+	{}
+
 	/**
 	 * @brief Initialize configs
+	 * @note Can be called again to reload configs, all TConfigHandle will be resolved again
 	 */
 	void Init();
 
@@ -544,6 +579,16 @@ public:
 	FORCEINLINE void Shutdown()
 	{
 		configs.clear();
+		++generation;
+	}
+
+	/**
+	 * @brief Get generation of configs
+	 * @return Return number which changes every time when configs are reloaded or changed
+	 */
+	FORCEINLINE uint32 GetGeneration() const
+	{
+		return generation;
 	}
 
 	/**
@@ -592,6 +637,7 @@ public:
 	{
 		CConfig&	config = GetConfig( InType );
 		config.SetValue( InGroup, InName, InValue );
+		++generation;
 	}
 
 	/**
@@ -608,8 +654,173 @@ public:
 		return config.GetValue( InGroup, InName );
 	}
 
+	/**
+	 * @brief Find value
+	 * @note Pointer is valid until configs are changed, see GetGeneration
+	 *
+	 * @param InType	Config type
+	 * @param InGroup	Name of group in config
+	 * @param InName	Name of value in config group
+	 * @return Return pointer to value in config without copy, if not founded return NULL
+	 */
+	FORCEINLINE const CConfigValue* FindValue( EConfigType InType, const tchar* InGroup, const tchar* InName ) const
+	{
+		const CConfig&	config = GetConfig( InType );
+		return config.FindValue( InGroup, InName );
+	}
+
 private:
 	std::unordered_map<EConfigType, CConfig>		configs;		/**< Configs */
+	uint32											generation;		/**< Generation of configs, increments on every change */
+};
+
+/**
+ * @ingroup Core
+ * @brief Traits for convert config value to type of TConfigHandle
+ */
+template<typename TType>
+struct TConfigValueTraits
+{};
+
+/**
+ * @ingroup Core
+ * @brief Traits for convert config value to bool
+ */
+template<>
+struct TConfigValueTraits<bool>
+{
+	static FORCEINLINE bool Get( const CConfigValue& InValue )
+	{
+		return InValue.GetBool();
+	}
+};
+
+/**
+ * @ingroup Core
+ * @brief Traits for convert config value to integer
+ */
+template<>
+struct TConfigValueTraits<int32>
+{
+	static FORCEINLINE int32 Get( const CConfigValue& InValue )
+	{
+		return InValue.IsA( CConfigValue::T_Float ) ? ( int32 )InValue.GetFloat() : InValue.GetInt();
+	}
+};
+
+/**
+ * @ingroup Core
+ * @brief Traits for convert config value to float
+ */
+template<>
+struct TConfigValueTraits<float>
+{
+	static FORCEINLINE float Get( const CConfigValue& InValue )
+	{
+		return InValue.GetNumber();
+	}
+};
+
+/**
+ * @ingroup Core
+ * @brief Traits for convert config value to string
+ */
+template<>
+struct TConfigValueTraits<std::wstring>
+{
+	static FORCEINLINE std::wstring Get( const CConfigValue& InValue )
+	{
+		return InValue.GetString();
+	}
+};
+
+/**
+ * @ingroup Core
+ * @brief Typed handle of config value
+ *
+ * Value is found in config and converted to TType only at first access and after reload of configs,
+ * so reading of value costs as reading of variable. Use it for values which are read often, e.g. every frame.
+ * @note Not thread safe, handle must be used from one thread
+ *
+ * Example usage:
+ * @code
+ * static TConfigHandle<float>		configMaxTickRate( CT_Engine, TEXT( "Engine.Engine" ), TEXT( "MaxTickRate" ), 0.f );
+ * float							maxTickRate = configMaxTickRate.Get();
+ * @endcode
+ */
+template<typename TType>
+class TConfigHandle
+{
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param InType			Config type
+	 * @param InGroup			Name of group in config. Must be valid all lifetime of handle
+	 * @param InName			Name of value in config group. Must be valid all lifetime of handle
+	 * @param InDefaultValue	Default value if it isn't exist in config
+	 */
+	FORCEINLINE TConfigHandle( EConfigType InType, const tchar* InGroup, const tchar* InName, const TType& InDefaultValue = TType() )
+		: type( InType )
+		, group( InGroup )
+		, name( InName )
+		, bExist( false )
+		, generation( ( uint32 )INDEX_NONE )
+		, defaultValue( InDefaultValue )
+		, value( InDefaultValue )
+	{}
+
+	/**
+	 * @brief Get value
+	 * @return Return reference to value from config, if it isn't exist returns default value
+	 */
+	FORCEINLINE const TType& Get() const
+	{
+		if ( generation != GConfig.GetGeneration() )
+		{
+			Resolve();
+		}
+		return value;
+	}
+
+	/**
+	 * @brief Is value exist in config
+	 * @return Return TRUE if value exist in config, otherwise returns FALSE
+	 */
+	FORCEINLINE bool IsExist() const
+	{
+		Get();
+		return bExist;
+	}
+
+	/**
+	 * @brief Operator for get value
+	 * @return Return reference to value from config
+	 */
+	FORCEINLINE operator const TType&() const
+	{
+		return Get();
+	}
+
+private:
+	/**
+	 * @brief Find value in config and convert it to TType
+	 */
+	FORCENOINLINE void Resolve() const
+	{
+		const CConfigValue*		configValue = GConfig.FindValue( type, group, name );
+		bExist		= configValue && configValue->IsValid();
+		value		= bExist ? TConfigValueTraits<TType>::Get( *configValue ) : defaultValue;
+		generation	= GConfig.GetGeneration();
+	}
+
+	EConfigType			type;			/**< Config type */
+	const tchar*		group;			/**< Name of group in config */
+	const tchar*		name;			/**< Name of value in config group */
+	mutable bool		bExist;			/**< Is value exist in config */
+	mutable uint32		generation;		/**< Generation of configs at which value is resolved */
+	TType				defaultValue;	/**< Default value */
+	mutable TType		value;			/**< Cached value */
 };
 
 #endif // !CONFIG_H
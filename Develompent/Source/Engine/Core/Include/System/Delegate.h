@@ -10,15 +10,376 @@
 #define DELEGATE_H
 
 #include <functional>
-#include <list>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
 
 #include "Core.h"
 #include "Misc/Object.h"
 #include "ThreadingBase.h"
 
+/**
+ * @ingroup Core
+ * Size of inline buffer in TDelegateFunction. Callables which fit in it are stored without heap allocation
+ */
+#define DELEGATE_INLINE_SIZE		( 6 * sizeof( void* ) )
+
+/**
+ * @ingroup Core
+ * Callable of delegate with small buffer optimization
+ *
+ * Lambdas, function pointers and std::bind of member function with object pointer are stored in inline buffer,
+ * only bigger callables are allocated in heap
+ */
+template< typename... TParamTypes >
+class TDelegateFunction
+{
+public:
+	/**
+	 * Constructor
+	 */
+	FORCEINLINE TDelegateFunction()
+		: invoker( nullptr )
+		, manager( nullptr )
+	{}
+
+	/**
+	 * Constructor of empty function
+	 */
+	FORCEINLINE TDelegateFunction( std::nullptr_t )
+		: invoker( nullptr )
+		, manager( nullptr )
+	{}
+
+	/**
+	 * Constructor from callable
+	 * @param InCallable	Callable object
+	 */
+	template< typename TCallable, typename = typename std::enable_if< !std::is_same< typename std::decay<TCallable>::type, TDelegateFunction >::value >::type >
+	FORCEINLINE TDelegateFunction( TCallable&& InCallable )
+		: invoker( nullptr )
+		, manager( nullptr )
+	{
+		typedef TCallableOps< typename std::decay<TCallable>::type >		CallableOps_t;
+		if ( CallableOps_t::bInline )
+		{
+			new( storage ) typename std::decay<TCallable>::type( std::forward<TCallable>( InCallable ) );
+		}
+		else
+		{
+			*( void** )storage = new typename std::decay<TCallable>::type( std::forward<TCallable>( InCallable ) );
+		}
+
+		invoker = &CallableOps_t::Invoke;
+		manager = &CallableOps_t::Manage;
+	}
+
+	/**
+	 * Copy constructor
+	 * @param InOther	Other function
+	 */
+	FORCEINLINE TDelegateFunction( const TDelegateFunction& InOther )
+		: invoker( nullptr )
+		, manager( nullptr )
+	{
+		CopyFrom( InOther );
+	}
+
+	/**
+	 * Move constructor
+	 * @param InOther	Other function
+	 */
+	FORCEINLINE TDelegateFunction( TDelegateFunction&& InOther )
+		: invoker( nullptr )
+		, manager( nullptr )
+	{
+		MoveFrom( InOther );
+	}
+
+	/**
+	 * Destructor
+	 */
+	FORCEINLINE ~TDelegateFunction()
+	{
+		Reset();
+	}
+
+	/**
+	 * Reset function to empty state
+	 */
+	FORCEINLINE void Reset()
+	{
+		if ( manager )
+		{
+			manager( O_Destroy, storage, nullptr );
+		}
+
+		invoker = nullptr;
+		manager = nullptr;
+	}
+
+	/**
+	 * Is bound callable
+	 * @return Return TRUE if function isn't empty, else return FALSE
+	 */
+	FORCEINLINE bool IsBound() const
+	{
+		return invoker != nullptr;
+	}
+
+	/**
+	 * Call function
+	 * @param InParams	Params for call
+	 */
+	FORCEINLINE void operator()( TParamTypes... InParams ) const
+	{
+		check( invoker );
+		invoker( ( void* )storage, InParams... );
+	}
+
+	/**
+	 * Is bound callable
+	 */
+	FORCEINLINE explicit operator bool() const
+	{
+		return invoker != nullptr;
+	}
+
+	/**
+	 * Copy operator
+	 */
+	FORCEINLINE TDelegateFunction& operator=( const TDelegateFunction& InOther )
+	{
+		if ( this != &InOther )
+		{
+			Reset();
+			CopyFrom( InOther );
+		}
+		return *this;
+	}
+
+	/**
+	 * Move operator
+	 */
+	FORCEINLINE TDelegateFunction& operator=( TDelegateFunction&& InOther )
+	{
+		if ( this != &InOther )
+		{
+			Reset();
+			MoveFrom( InOther );
+		}
+		return *this;
+	}
+
+	/**
+	 * Reset function
+	 */
+	FORCEINLINE TDelegateFunction& operator=( std::nullptr_t )
+	{
+		Reset();
+		return *this;
+	}
+
+private:
+	/**
+	 * Operation of manager
+	 */
+	enum EOperation
+	{
+		O_Copy,			/**< Copy callable from source to destination storage */
+		O_Move,			/**< Move callable from source to destination storage, source is left destroyed */
+		O_Destroy		/**< Destroy callable in destination storage */
+	};
+
+	/**
+	 * Typedef of function for call callable
+	 */
+	typedef void ( *Invoker_t )( void* InStorage, TParamTypes... InParams );
+
+	/**
+	 * Typedef of function for copy, move and destroy callable
+	 */
+	typedef void ( *Manager_t )( EOperation InOperation, void* InDest, void* InSource );
+
+	/**
+	 * Operations with stored callable
+	 */
+	template< typename TCallable >
+	struct TCallableOps
+	{
+		static const bool	bInline = sizeof( TCallable ) <= DELEGATE_INLINE_SIZE && alignof( TCallable ) <= alignof( std::max_align_t ) && std::is_nothrow_move_constructible<TCallable>::value;
+
+		/**
+		 * Get callable from storage
+		 */
+		static FORCEINLINE TCallable* Get( void* InStorage )
+		{
+			return bInline ? ( TCallable* )InStorage : *( TCallable** )InStorage;
+		}
+
+		/**
+		 * Call callable
+		 */
+		static void Invoke( void* InStorage, TParamTypes... InParams )
+		{
+			( *Get( InStorage ) )( InParams... );
+		}
+
+		/**
+		 * Copy, move or destroy callable
+		 */
+		static void Manage( EOperation InOperation, void* InDest, void* InSource )
+		{
+			switch ( InOperation )
+			{
+			case O_Copy:
+				if ( bInline )
+				{
+					new( InDest ) TCallable( *Get( InSource ) );
+				}
+				else
+				{
+					*( TCallable** )InDest = new TCallable( *Get( InSource ) );
+				}
+				break;
+
+			case O_Move:
+				if ( bInline )
+				{
+					new( InDest ) TCallable( std::move( *Get( InSource ) ) );
+					Get( InSource )->~TCallable();
+				}
+				else
+				{
+					*( TCallable** )InDest = *( TCallable** )InSource;
+				}
+				break;
+
+			case O_Destroy:
+				if ( bInline )
+				{
+					Get( InDest )->~TCallable();
+				}
+				else
+				{
+					delete Get( InDest );
+				}
+				break;
+			}
+		}
+	};
+
+	/**
+	 * Copy callable from other function
+	 */
+	FORCEINLINE void CopyFrom( const TDelegateFunction& InOther )
+	{
+		if ( InOther.manager )
+		{
+			InOther.manager( O_Copy, storage, ( void* )InOther.storage );
+			invoker = InOther.invoker;
+			manager = InOther.manager;
+		}
+	}
+
+	/**
+	 * Move callable from other function
+	 */
+	FORCEINLINE void MoveFrom( TDelegateFunction& InOther )
+	{
+		if ( InOther.manager )
+		{
+			InOther.manager( O_Move, storage, InOther.storage );
+			invoker = InOther.invoker;
+			manager = InOther.manager;
+			InOther.invoker = nullptr;
+			InOther.manager = nullptr;
+		}
+	}
+
+	alignas( std::max_align_t ) byte	storage[DELEGATE_INLINE_SIZE];		/**< Inline buffer for callable or pointer to heap allocated callable */
+	Invoker_t							invoker;							/**< Function for call callable */
+	Manager_t							manager;							/**< Function for copy, move and destroy callable */
+};
+
+/**
+ * @ingroup Core
+ * Handle of delegate added to multicast delegate
+ */
+class CDelegateHandle
+{
+public:
+	/**
+	 * Constructor
+	 */
+	FORCEINLINE CDelegateHandle()
+		: id( 0 )
+	{}
+
+	/**
+	 * Constructor
+	 * @param InID	ID of delegate
+	 */
+	FORCEINLINE explicit CDelegateHandle( uint32 InID )
+		: id( InID )
+	{}
+
+	/**
+	 * Is valid handle
+	 * @return Return TRUE if handle is valid, else return FALSE
+	 */
+	FORCEINLINE bool IsValid() const
+	{
+		return id != 0;
+	}
+
+	/**
+	 * Reset handle
+	 */
+	FORCEINLINE void Reset()
+	{
+		id = 0;
+	}
+
+	/**
+	 * Get ID of delegate
+	 * @return Return ID of delegate, zero if handle isn't valid
+	 */
+	FORCEINLINE uint32 GetID() const
+	{
+		return id;
+	}
+
+	/**
+	 * Compare handles
+	 */
+	FORCEINLINE bool operator==( const CDelegateHandle& InOther ) const
+	{
+		return id == InOther.id;
+	}
+
+	/**
+	 * Compare handles
+	 */
+	FORCEINLINE bool operator!=( const CDelegateHandle& InOther ) const
+	{
+		return id != InOther.id;
+	}
+
+private:
+	uint32		id;		/**< ID of delegate in multicast delegate */
+};
+
 /**
  * @ingroup Core
  * Multicast delegate
+ *
+ * Delegates are stored in contiguous array, broadcast doesn't allocate memory.
+ * Delegates can be added and removed inside of broadcast: removed delegates are only marked and
+ * compacted after broadcast, added delegates are called starting with next broadcast.
+ * Not thread safe, for use from several threads see TThreadSafeMulticastDelegate
  */
 template< typename... TParamTypes >
 class TMulticastDelegate
@@ -27,40 +388,115 @@ public:
 	/**
 	 * Typedef of delegate type
 	 */
-	typedef std::function<void( TParamTypes... )>		DelegateType_t;
+	typedef TDelegateFunction< TParamTypes... >		DelegateType_t;
+
+	/**
+	 * Constructor
+	 */
+	FORCEINLINE TMulticastDelegate()
+		: nextID( 1 )
+		, broadcastDepth( 0 )
+		, bNeedCompact( false )
+	{}
 
 	/**
 	 * Add delegate
+	 * 
 	 * @param InDelegate	Delegate
+	 * @return Return handle of added delegate
 	 */
-	FORCEINLINE DelegateType_t* Add( const DelegateType_t& InDelegate )
+	FORCEINLINE CDelegateHandle Add( DelegateType_t InDelegate )
 	{
-		CScopeLock		scopeLock( criticalSection );
-		delegates.push_back( InDelegate );
-		return &delegates.back();
+		CDelegateHandle		handle( nextID++ );
+		SDelegateEntry		entry;
+		entry.id		= handle.GetID();
+		entry.delegate	= std::move( InDelegate );
+		if ( nextID == 0 )
+		{
+			nextID = 1;
+		}
+
+		// Array of delegates can't be reallocated while broadcast is going
+		if ( broadcastDepth > 0 )
+		{
+			pendingDelegates.push_back( std::move( entry ) );
+			bNeedCompact = true;
+		}
+		else
+		{
+			delegates.push_back( std::move( entry ) );
+		}
+		return handle;
 	}
 
 	/**
 	 * Remove delegate
-	 * @param InDelegate		Delegate
+	 * @param InHandle		Handle of delegate. After removing it is reset
 	 */
-	FORCEINLINE void Remove( DelegateType_t*& InDelegate )
+	void Remove( CDelegateHandle& InHandle )
 	{
-		if ( !InDelegate )
+		if ( !InHandle.IsValid() )
 		{
 			return;
 		}
 
-		CScopeLock		scopeLock( criticalSection );
-		for ( auto itDelegate = delegates.begin(), itDelegateEnd = delegates.end(); itDelegate != itDelegateEnd; ++itDelegate )
+		for ( uint32 index = 0, count = delegates.size(); index < count; ++index )
 		{
-			if ( &( *itDelegate ) == InDelegate )
+			if ( delegates[index].id == InHandle.GetID() )
 			{
-				delegates.erase( itDelegate );
-				InDelegate = nullptr;
+				if ( broadcastDepth > 0 )
+				{
+					delegates[index].id = 0;
+					bNeedCompact		= true;
+				}
+				else
+				{
+					delegates.erase( delegates.begin() + index );
+				}
+
+				InHandle.Reset();
 				return;
 			}
 		}
+
+		for ( uint32 index = 0, count = pendingDelegates.size(); index < count; ++index )
+		{
+			if ( pendingDelegates[index].id == InHandle.GetID() )
+			{
+				pendingDelegates.erase( pendingDelegates.begin() + index );
+				break;
+			}
+		}
+		InHandle.Reset();
+	}
+
+	/**
+	 * Remove all delegates
+	 */
+	void RemoveAll()
+	{
+		pendingDelegates.clear();
+		if ( broadcastDepth > 0 )
+		{
+			for ( uint32 index = 0, count = delegates.size(); index < count; ++index )
+			{
+				delegates[index].id = 0;
+			}
+			bNeedCompact = true;
+		}
+		else
+		{
+			delegates.clear();
+		}
+	}
+
+	/**
+	 * Is bound any delegate
+	 * @return Return TRUE if at least one delegate is bound, else return FALSE
+	 */
+	FORCEINLINE bool IsBound() const
+	{
+		return !delegates.empty() || !pendingDelegates.empty();
 	}
 
 	/**
@@ -69,17 +505,138 @@ public:
 	 */
 	FORCEINLINE void Broadcast( TParamTypes... InParams ) const
 	{
-		// Call delegates
-		CScopeLock		scopeLock( criticalSection );	
-		for ( auto itDelegate = delegates.begin(), itDelegateEnd = delegates.end(); itDelegate != itDelegateEnd; ++itDelegate )
+		if ( delegates.empty() )
+		{
+			return;
+		}
+
+		++broadcastDepth;
+		for ( uint32 index = 0, count = delegates.size(); index < count; ++index )
+		{
+			const SDelegateEntry&		entry = delegates[index];
+			if ( entry.id != 0 )
+			{
+				entry.delegate( InParams... );
+			}
+		}
+
+		if ( --broadcastDepth == 0 && bNeedCompact )
+		{
+			Compact();
+		}
+	}
+
+private:
+	/**
+	 * Entry of delegate
+	 */
+	struct SDelegateEntry
+	{
+		uint32				id;				/**< ID of delegate, zero if delegate is removed inside of broadcast */
+		DelegateType_t		delegate;		/**< Delegate */
+	};
+
+	/**
+	 * Remove marked delegates and append delegates added inside of broadcast
+	 */
+	void Compact() const
+	{
+		uint32		numDelegates = 0;
+		for ( uint32 index = 0, count = delegates.size(); index < count; ++index )
+		{
+			if ( delegates[index].id != 0 )
+			{
+				if ( numDelegates != index )
+				{
+					delegates[numDelegates] = std::move( delegates[index] );
+				}
+				++numDelegates;
+			}
+		}
+		delegates.resize( numDelegates );
+
+		for ( uint32 index = 0, count = pendingDelegates.size(); index < count; ++index )
 		{
-			( *itDelegate )( InParams... );
+			delegates.push_back( std::move( pendingDelegates[index] ) );
 		}
+		pendingDelegates.clear();
+		bNeedCompact = false;
+	}
+
+	mutable std::vector< SDelegateEntry >	delegates;				/**< Array of delegates */
+	mutable std::vector< SDelegateEntry >	pendingDelegates;		/**< Delegates added inside of broadcast */
+	uint32									nextID;					/**< Next ID of delegate */
+	mutable uint32							broadcastDepth;			/**< Depth of nested broadcasts */
+	mutable bool							bNeedCompact;			/**< Is need compact array of delegates after broadcast */
+};
+
+/**
+ * @ingroup Core
+ * Thread safe multicast delegate
+ *
+ * Use it only for events which added, removed or broadcasted from several threads.
+ * Delegates are called with locked critical section
+ */
+template< typename... TParamTypes >
+class TThreadSafeMulticastDelegate : public TMulticastDelegate< TParamTypes... >
+{
+public:
+	typedef TMulticastDelegate< TParamTypes... >		Super;
+	typedef typename Super::DelegateType_t				DelegateType_t;
+
+	/**
+	 * Add delegate
+	 *
+	 * @param InDelegate	Delegate
+	 * @return Return handle of added delegate
+	 */
+	FORCEINLINE CDelegateHandle Add( DelegateType_t InDelegate )
+	{
+		CScopeLock		scopeLock( criticalSection );
+		return Super::Add( std::move( InDelegate ) );
+	}
+
+	/**
+	 * Remove delegate
+	 * @param InHandle		Handle of delegate. After removing it is reset
+	 */
+	FORCEINLINE void Remove( CDelegateHandle& InHandle )
+	{
+		CScopeLock		scopeLock( criticalSection );
+		Super::Remove( InHandle );
+	}
+
+	/**
+	 * Remove all delegates
+	 */
+	FORCEINLINE void RemoveAll()
+	{
+		CScopeLock		scopeLock( criticalSection );
+		Super::RemoveAll();
+	}
+
+	/**
+	 * Is bound any delegate
+	 * @return Return TRUE if at least one delegate is bound, else return FALSE
+	 */
+	FORCEINLINE bool IsBound() const
+	{
+		CScopeLock		scopeLock( criticalSection );
+		return Super::IsBound();
+	}
+
+	/**
+	 * Broadcast all delegates
+	 * @param[in] InParams Params for call delegate
+	 */
+	FORCEINLINE void Broadcast( TParamTypes... InParams ) const
+	{
+		CScopeLock		scopeLock( criticalSection );
+		Super::Broadcast( InParams... );
 	}
 
 private:
-	std::list< DelegateType_t >		delegates;				/**< List of delegates */
-	mutable CCriticalSection		criticalSection;		/**< Critical section for thread safe broadcast */
+	mutable CCriticalSection	criticalSection;		/**< Critical section */
 };
 
 /**
@@ -93,17 +650,16 @@ public:
 	/**
 	 * Typedef of delegate type
 	 */
-	typedef std::function<void( TParamTypes... )>		DelegateType_t;
+	typedef TDelegateFunction< TParamTypes... >		DelegateType_t;
 	
 	/**
 	 * Bind delegate
 	 * 
 	 * @param InDelegate	Delegate
 	 */
-	FORCEINLINE void Bind( const DelegateType_t& InDelegate )
+	FORCEINLINE void Bind( DelegateType_t InDelegate )
 	{
-		CScopeLock		scopeLock( criticalSection );
-		delegate = InDelegate;
+		delegate = std::move( InDelegate );
 	}
 
 	/**
@@ -111,8 +667,16 @@ public:
 	 */
 	FORCEINLINE void Unbind()
 	{
-		CScopeLock		scopeLock( criticalSection );
-		delegate = nullptr;
+		delegate.Reset();
+	}
+
+	/**
+	 * Is bound delegate
+	 * @return Return TRUE if delegate is bound, else return FALSE
+	 */
+	FORCEINLINE bool IsBound() const
+	{
+		return delegate.IsBound();
 	}
 
 	/**
@@ -120,20 +684,16 @@ public:
 	 * 
 	 * @param InParams Params for call delegate
 	 */
-	FORCEINLINE void Execute( TParamTypes... InParams )
+	FORCEINLINE void Execute( TParamTypes... InParams ) const
 	{
-		if ( !delegate )
+		if ( delegate )
 		{
-			return;
+			delegate( InParams... );
 		}
-
-		CScopeLock		scopeLock( criticalSection );
-		delegate( InParams... );
 	}
 
 private:
-	DelegateType_t				delegate;				/**< Delegate */
-	mutable CCriticalSection	criticalSection;		/**< Critical section for thread safe execute */
+	DelegateType_t		delegate;		/**< Delegate */
 };
 
 /**
@@ -146,6 +706,16 @@ private:
 #define DECLARE_MULTICAST_DELEGATE( InDelegateName, ... )	\
 	typedef TMulticastDelegate< __VA_ARGS__ >			InDelegateName;
 
+/**
+ * @ingroup Core
+ * Macro for declare thread safe multi cast delegate
+ *
+ * @param[in] InDelegateName Delegate name
+ * @param[in] ... Other parameters of delegate
+ */
+#define DECLARE_THREADSAFE_MULTICAST_DELEGATE( InDelegateName, ... )	\
+	typedef TThreadSafeMulticastDelegate< __VA_ARGS__ >	InDelegateName;
+
  /**
   * @ingroup Core
   * Macro for declare single cast delegate
@@ -156,4 +726,4 @@ private:
 #define DECLARE_DELEGATE( InDelegateName, ... )	\
 	typedef TDelegate< __VA_ARGS__ >					InDelegateName;
 
-#endif // !DELEGATE_H
\ No newline at end of file
+#endif // !DELEGATE_H
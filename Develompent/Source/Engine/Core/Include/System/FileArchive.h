@@ -0,0 +1,185 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef FILEARCHIVE_H
+#define FILEARCHIVE_H
+
+#include <vector>
+
+#include "Core.h"
+#include "System/Archive.h"
+#include "System/BaseFileSystem.h"
+
+/**
+ * @ingroup Core
+ * @brief Archive for reading file through CFileReadHandle
+ *
+ * Each reader has own position and read-ahead buffer, so many readers can share one file handle
+ * without reopening the file and without synchronization between them
+ */
+class CFileArchiveReader : public CArchive
+{
+public:
+	/**
+	 * @brief Default size of read-ahead buffer
+	 */
+	enum { DEFAULT_BUFFER_SIZE = 64 * 1024 };
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param InHandle		Handle of opened file
+	 * @param InBufferSize	Size of read-ahead buffer
+	 */
+	CFileArchiveReader( const FileReadHandleRef_t& InHandle, uint32 InBufferSize = DEFAULT_BUFFER_SIZE );
+
+	/**
+	 * @brief Serialize data
+	 *
+	 * @param[in] InBuffer Pointer to buffer for serialize
+	 * @param[in] InSize Size of buffer
+	 */
+	virtual void Serialize( void* InBuffer, uint32 InSize ) override;
+
+	/**
+	 * @brief Get current position in archive
+	 * @return Current position in archive
+	 */
+	virtual uint32 Tell() override;
+
+	/**
+	 * @brief Set current position in archive
+	 *
+	 * @param[in] InPosition New position in archive
+	 */
+	virtual void Seek( uint32 InPosition ) override;
+
+	/**
+	 * @breif Is loading archive
+	 * @return True if archive loading, false if archive saving
+	 */
+	virtual bool IsLoading() const override;
+
+	/**
+	 * Is end of file
+	 * @return Return true if end of file, else return false
+	 */
+	virtual bool IsEndOfFile() override;
+
+	/**
+	 * @brief Get size of archive
+	 * @return Size of archive
+	 */
+	virtual uint32 GetSize() override;
+
+	/**
+	 * @brief Get file handle
+	 * @return Return file handle
+	 */
+	FORCEINLINE const FileReadHandleRef_t& GetHandle() const
+	{
+		return handle;
+	}
+
+private:
+	FileReadHandleRef_t		handle;				/**< Handle of file */
+	uint32					size;				/**< Cached size of file */
+	uint32					position;			/**< Current position in file */
+	uint32					bufferOffset;		/**< Offset in file of data in read-ahead buffer */
+	uint32					bufferCount;		/**< Number of valid bytes in read-ahead buffer */
+	std::vector<byte>		buffer;				/**< Read-ahead buffer */
+};
+
+/**
+ * @ingroup Core
+ * @brief Archive for writing file through CFileWriteHandle
+ *
+ * Small writes are coalesced in buffer and go to file only when buffer is full, on Flush or when archive destroyed.
+ * Seek and Tell not flush the buffer
+ */
+class CFileArchiveWriter : public CArchive
+{
+public:
+	/**
+	 * @brief Default size of write buffer
+	 */
+	enum { DEFAULT_BUFFER_SIZE = 64 * 1024 };
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param InHandle		Handle of opened file
+	 * @param InIsAppend	Is need start writing from end of file
+	 * @param InBufferSize	Size of write buffer
+	 */
+	CFileArchiveWriter( const FileWriteHandleRef_t& InHandle, bool InIsAppend = false, uint32 InBufferSize = DEFAULT_BUFFER_SIZE );
+
+	/**
+	 * @brief Destructor
+	 */
+	~CFileArchiveWriter();
+
+	/**
+	 * @brief Serialize data
+	 *
+	 * @param[in] InBuffer Pointer to buffer for serialize
+	 * @param[in] InSize Size of buffer
+	 */
+	virtual void Serialize( void* InBuffer, uint32 InSize ) override;
+
+	/**
+	 * @brief Get current position in archive
+	 * @return Current position in archive
+	 */
+	virtual uint32 Tell() override;
+
+	/**
+	 * @brief Set current position in archive
+	 *
+	 * @param[in] InPosition New position in archive
+	 */
+	virtual void Seek( uint32 InPosition ) override;
+
+	/**
+	 * @brief Flush data
+	 */
+	virtual void Flush() override;
+
+	/**
+	 * @brief Is saving archive
+	 * @return True if archive saving, false if archive loading
+	 */
+	virtual bool IsSaving() const override;
+
+	/**
+	 * Is end of file
+	 * @return Return true if end of file, else return false
+	 */
+	virtual bool IsEndOfFile() override;
+
+	/**
+	 * @brief Get size of archive
+	 * @return Size of archive
+	 */
+	virtual uint32 GetSize() override;
+
+private:
+	/**
+	 * @brief Write buffered data to file
+	 */
+	void FlushBuffer();
+
+	FileWriteHandleRef_t	handle;				/**< Handle of file */
+	uint32					size;				/**< Size of file including buffered data */
+	uint32					position;			/**< Current position in file */
+	uint32					bufferOffset;		/**< Offset in file of data in write buffer */
+	uint32					bufferCount;		/**< Number of bytes in write buffer */
+	std::vector<byte>		buffer;				/**< Write buffer */
+};
+
+#endif // !FILEARCHIVE_H
@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef FILEHANDLECACHE_H
+#define FILEHANDLECACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+
+#include "Core.h"
+#include "System/Archive.h"
+#include "System/BaseFileSystem.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Bounded cache of opened file handles
+ *
+ * Keeps recently used files opened, so repeated loads from one package not pay for open/close file.
+ * Handles evicted in LRU order and only when nobody outside of cache uses them
+ */
+class CFileHandleCache
+{
+public:
+	/**
+	 * @brief Default maximum number of opened handles
+	 */
+	enum { DEFAULT_MAX_HANDLES = 32 };
+
+	/**
+	 * @brief Constructor
+	 */
+	CFileHandleCache();
+
+	/**
+	 * @brief Destructor
+	 */
+	~CFileHandleCache();
+
+	/**
+	 * @brief Get handle of file, open it if need
+	 *
+	 * @param InPath	Path to file
+	 * @param InFlags	Flags (see EArchiveReadFlags)
+	 * @return Return handle of file, if file not opened return NULL
+	 */
+	FileReadHandleRef_t Acquire( const std::wstring& InPath, uint32 InFlags = AR_None );
+
+	/**
+	 * @brief Create archive for reading file through cached handle
+	 *
+	 * @param InPath	Path to file
+	 * @param InFlags	Flags (see EArchiveReadFlags)
+	 * @return Pointer on file reader, if file not opened return null
+	 * @warning After use need delete file reader
+	 */
+	CArchive* CreateReader( const std::wstring& InPath, uint32 InFlags = AR_None );
+
+	/**
+	 * @brief Drop handles of file or of all files in directory from cache
+	 * @note File system calls it before file is written, moved or deleted (see CBaseFileSystem::SetFileHandleCache).
+	 * Readers which already have handle keep it until they destroyed
+	 *
+	 * @param InPath	Path to file or directory
+	 */
+	void Invalidate( const std::wstring& InPath );
+
+	/**
+	 * @brief Close all handles which not used outside of cache
+	 */
+	void Flush();
+
+	/**
+	 * @brief Set maximum number of opened handles
+	 * @param InMaxHandles	Maximum number of opened handles
+	 */
+	void SetMaxHandles( uint32 InMaxHandles );
+
+	/**
+	 * @brief Get maximum number of opened handles
+	 * @return Return maximum number of opened handles
+	 */
+	FORCEINLINE uint32 GetMaxHandles() const
+	{
+		return maxHandles;
+	}
+
+private:
+	/**
+	 * @brief Typedef of list with handles. Most recently used handles are in front
+	 */
+	typedef std::list<FileReadHandleRef_t>											HandleList_t;
+
+	/**
+	 * @brief Get key of path in cache
+	 *
+	 * @param InPath	Path to file
+	 * @return Return normalized path
+	 */
+	static std::wstring GetKey( const std::wstring& InPath );
+
+	/**
+	 * @brief Close unused handles while there are more than maxHandles
+	 * @note Must be called with locked critical section
+	 */
+	void Trim();
+
+	uint32															maxHandles;		/**< Maximum number of opened handles */
+	uint32															generation;		/**< Number of invalidations. Handle opened while it changed is not cached */
+	HandleList_t													handles;		/**< Opened handles in LRU order */
+	std::unordered_map<std::wstring, HandleList_t::iterator>		handlesMap;		/**< Map of path to handle */
+	CCriticalSection												cs;				/**< Critical section */
+};
+
+#endif // !FILEHANDLECACHE_H
@@ -0,0 +1,370 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright BSOD-Games, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef MALLOC_H
+#define MALLOC_H
+
+#include <new>
+
+#include "Core.h"
+#include "Misc/Types.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Default alignment of allocations in bytes
+ */
+#define MALLOC_DEFAULT_ALIGNMENT		16
+
+/**
+ * @ingroup Core
+ * @brief Size of page in bytes. Pages are the units in which memory is given to bins
+ */
+#define MALLOC_PAGE_SIZE				( 64 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Size of arena in bytes. Arenas are requested from OS and split to pages, they are backed by large pages if possible
+ */
+#define MALLOC_ARENA_SIZE				( 2 * 1024 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Maximum size of small block in bytes. Bigger blocks are allocated directly from OS
+ */
+#define MALLOC_MAX_SMALL_SIZE			( 32 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Number of size classes of small blocks
+ */
+#define MALLOC_NUM_BINS					40
+
+/**
+ * @ingroup Core
+ * @brief Maximum size in bytes of blocks of one size class kept in cache of thread
+ */
+#define MALLOC_THREAD_CACHE_SIZE		( 64 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Allocate memory pages from OS
+ * @note Implemented in platform module
+ *
+ * @param InSize			Size in bytes, multiple of MALLOC_PAGE_SIZE
+ * @param InIsLargePages	Try to back memory by large pages, InSize must be multiple of appGetLargePageSize()
+ * @return Return pointer to memory aligned at least to MALLOC_PAGE_SIZE, nullptr if out of memory
+ */
+extern void* appPageAlloc( uint64 InSize, bool InIsLargePages );
+
+/**
+ * @ingroup Core
+ * @brief Free memory pages allocated by appPageAlloc
+ * @note Implemented in platform module
+ *
+ * @param InPointer		Pointer to memory
+ * @param InSize		Size in bytes
+ */
+extern void appPageFree( void* InPointer, uint64 InSize );
+
+/**
+ * @ingroup Core
+ * @brief Get size of large page
+ * @note Implemented in platform module
+ * @return Return size of large page in bytes, zero if large pages aren't available for process
+ */
+extern uint64 appGetLargePageSize();
+
+/**
+ * @ingroup Core
+ * @brief Statistics of engine allocator
+ */
+struct SMallocStats
+{
+	uint64		reservedSize;		/**< Size of memory requested from OS in bytes */
+	uint64		largeSize;			/**< Size of memory of allocated large blocks in bytes */
+	uint32		numArenas;			/**< Number of allocated arenas */
+	uint32		numLargeBlocks;		/**< Number of allocated large blocks */
+	bool		bLargePages;		/**< Are arenas backed by large pages */
+};
+
+/**
+ * @ingroup Core
+ * @brief Engine allocator with size classes and per-thread caches
+ *
+ * Small blocks (up to MALLOC_MAX_SMALL_SIZE) are taken from size class bins. Every thread keeps own cache of
+ * free blocks for every bin, so most of allocations and frees don't take locks at all, bins are locked only
+ * when cache is refilled or flushed by batches. Memory of bins is split from arenas, which are backed by
+ * large pages when process has privilege for it. Big blocks are allocated directly from OS.
+ * Size class of pointer is found by page map, pointers which weren't allocated by this allocator are passed to CRT,
+ * so it's safe to route global operator new/delete to it (see USE_MALLOC_BINNED).
+ * Memory of bins isn't returned to OS.
+ * With USE_MALLOC_TRACKING every allocation gets header for CMemoryTracker right before user memory
+ */
+class CMallocBinned
+{
+public:
+	/**
+	 * @brief Get engine allocator
+	 * @note Allocator is created on first call and never destroyed, so it may be used from static constructors and destructors
+	 * @return Return engine allocator
+	 */
+	static CMallocBinned& Get();
+
+	/**
+	 * @brief Allocate memory
+	 *
+	 * @param InSize		Size in bytes
+	 * @param InAlignment	Alignment, power of two
+	 * @return Return pointer to allocated memory, nullptr if out of memory
+	 */
+	void* Malloc( size_t InSize, uint32 InAlignment = MALLOC_DEFAULT_ALIGNMENT );
+
+	/**
+	 * @brief Reallocate memory
+	 *
+	 * @param InPointer		Pointer to memory, may be nullptr
+	 * @param InNewSize		New size in bytes. If zero memory is freed
+	 * @param InAlignment	Alignment, power of two
+	 * @return Return pointer to reallocated memory
+	 */
+	void* Realloc( void* InPointer, size_t InNewSize, uint32 InAlignment = MALLOC_DEFAULT_ALIGNMENT );
+
+	/**
+	 * @brief Free memory
+	 * @param InPointer		Pointer to memory, may be nullptr
+	 */
+	void Free( void* InPointer );
+
+	/**
+	 * @brief Get usable size of allocation
+	 *
+	 * @param InPointer		Pointer to memory
+	 * @return Return size in bytes which can be used, zero if pointer isn't allocated by this allocator
+	 */
+	size_t GetAllocationSize( void* InPointer ) const;
+
+	/**
+	 * @brief Return blocks cached by current thread to bins
+	 * @note It's called automatically when thread exits
+	 */
+	void FlushThreadCache();
+
+	/**
+	 * @brief Get statistics of allocator
+	 * @return Return statistics
+	 */
+	SMallocStats GetStats() const;
+
+private:
+	friend struct SMallocThreadCache;
+
+	/**
+	 * @brief Free block in list
+	 */
+	struct SFreeBlock
+	{
+		SFreeBlock*		next;		/**< Next free block */
+	};
+
+	/**
+	 * @brief Size class of small blocks
+	 */
+	struct SBin
+	{
+		uint32				blockSize;		/**< Size of block */
+		uint32				numSpanPages;	/**< Number of pages taken at once for new blocks */
+		uint32				batchSize;		/**< Number of blocks moved at once between bin and thread cache */
+		uint32				maxCached;		/**< Maximum number of blocks in thread cache */
+		SFreeBlock*			freeList;		/**< List of free blocks */
+		CCriticalSection	cs;				/**< Critical section */
+	};
+
+	/**
+	 * @brief Header of large block, placed at start of its memory
+	 */
+	struct SLargeHeader
+	{
+		uint64		size;			/**< Size of memory requested from OS */
+		uint64		userSize;		/**< Size of memory available to user */
+	};
+
+	/**
+	 * @brief Constructor
+	 */
+	CMallocBinned();
+
+	/**
+	 * @brief Get bin index for size
+	 *
+	 * @param InSize		Size in bytes
+	 * @param InAlignment	Alignment
+	 * @return Return index of bin, INDEX_NONE if block must be large
+	 */
+	uint32 GetBinIndex( size_t InSize, uint32 InAlignment ) const;
+
+	/**
+	 * @brief Get entry of page map for pointer
+	 *
+	 * @param InPointer		Pointer
+	 * @return Return bin index + 1 for small blocks, PAGEMAP_LARGE for large blocks, zero for foreign memory
+	 */
+	byte GetPageMapEntry( const void* InPointer ) const;
+
+	/**
+	 * @brief Set entry of page map for page
+	 *
+	 * @param InPage		Pointer to page
+	 * @param InEntry		Entry
+	 */
+	void SetPageMapEntry( const void* InPage, byte InEntry );
+
+	/**
+	 * @brief Allocate memory without tracking
+	 *
+	 * @param InSize		Size in bytes
+	 * @param InAlignment	Alignment, power of two
+	 * @return Return pointer to allocated memory, nullptr if out of memory
+	 */
+	void* InternalMalloc( size_t InSize, uint32 InAlignment );
+
+	/**
+	 * @brief Reallocate memory without tracking
+	 *
+	 * @param InPointer		Pointer to memory, may be nullptr
+	 * @param InNewSize		New size in bytes. If zero memory is freed
+	 * @param InAlignment	Alignment, power of two
+	 * @return Return pointer to reallocated memory
+	 */
+	void* InternalRealloc( void* InPointer, size_t InNewSize, uint32 InAlignment );
+
+	/**
+	 * @brief Free memory without tracking
+	 *
+	 * @param InPointer		Pointer to memory, not nullptr
+	 * @param InEntry		Entry of page map for pointer, not zero
+	 */
+	void InternalFree( void* InPointer, byte InEntry );
+
+	/**
+	 * @brief Get usable size of block
+	 *
+	 * @param InPointer		Pointer to block
+	 * @param InEntry		Entry of page map for pointer, not zero
+	 * @return Return size in bytes which can be used
+	 */
+	size_t InternalGetAllocationSize( void* InPointer, byte InEntry ) const;
+
+	/**
+	 * @brief Move blocks from bin to list
+	 *
+	 * @param InBinIndex	Index of bin
+	 * @param InNumBlocks	Maximum number of blocks
+	 * @param OutFirst		Output first block of list, nullptr if out of memory
+	 * @return Return number of blocks in list
+	 */
+	uint32 AllocateBlocks( uint32 InBinIndex, uint32 InNumBlocks, SFreeBlock*& OutFirst );
+
+	/**
+	 * @brief Return list of blocks to bin
+	 *
+	 * @param InBinIndex	Index of bin
+	 * @param InFirst		First block
+	 * @param InLast		Last block
+	 */
+	void FreeBlocks( uint32 InBinIndex, SFreeBlock* InFirst, SFreeBlock* InLast );
+
+	/**
+	 * @brief Allocate pages from arena
+	 * @note Must be called with locked pageCS
+	 *
+	 * @param InNumPages	Number of contiguous pages
+	 * @return Return pointer to first page, nullptr if out of memory
+	 */
+	byte* AllocatePages( uint32 InNumPages );
+
+	/**
+	 * @brief Allocate large block
+	 *
+	 * @param InSize		Size in bytes
+	 * @param InAlignment	Alignment
+	 * @return Return pointer to memory, nullptr if out of memory
+	 */
+	void* MallocLarge( size_t InSize, uint32 InAlignment );
+
+	/**
+	 * @brief Free large block
+	 * @param InPointer		Pointer to memory
+	 */
+	void FreeLarge( void* InPointer );
+
+	SBin					bins[MALLOC_NUM_BINS];			/**< Size class bins */
+	byte					sizeToBin[MALLOC_MAX_SMALL_SIZE / MALLOC_DEFAULT_ALIGNMENT + 1];	/**< Table of bin indices by size / MALLOC_DEFAULT_ALIGNMENT */
+	byte* volatile			pageMap[1 << 16];				/**< Page map of address space, first level indexed by bits 32..47 of address */
+	byte*					arenaCurrent;					/**< Current position in arena */
+	byte*					arenaEnd;						/**< End of current arena */
+	uint64					largePageSize;					/**< Size of large page, zero if large pages are disabled */
+	SMallocStats			stats;							/**< Statistics */
+	mutable CCriticalSection	pageCS;						/**< Critical section of arenas, page map and statistics */
+};
+
+/**
+ * @ingroup Core
+ * @brief Allocate memory by engine allocator
+ *
+ * @param InSize		Size in bytes
+ * @param InAlignment	Alignment, power of two
+ * @return Return pointer to allocated memory
+ */
+FORCEINLINE void* appMalloc( size_t InSize, uint32 InAlignment = MALLOC_DEFAULT_ALIGNMENT )
+{
+	return CMallocBinned::Get().Malloc( InSize, InAlignment );
+}
+
+/**
+ * @ingroup Core
+ * @brief Reallocate memory by engine allocator
+ *
+ * @param InPointer		Pointer to memory
+ * @param InNewSize		New size in bytes
+ * @param InAlignment	Alignment, power of two
+ * @return Return pointer to reallocated memory
+ */
+FORCEINLINE void* appRealloc( void* InPointer, size_t InNewSize, uint32 InAlignment = MALLOC_DEFAULT_ALIGNMENT )
+{
+	return CMallocBinned::Get().Realloc( InPointer, InNewSize, InAlignment );
+}
+
+/**
+ * @ingroup Core
+ * @brief Free memory allocated by engine allocator
+ * @param InPointer		Pointer to memory
+ */
+FORCEINLINE void appFree( void* InPointer )
+{
+	CMallocBinned::Get().Free( InPointer );
+}
+
+/**
+ * @ingroup Core
+ * @brief Macro for replace global operators new and delete by engine allocator
+ * @note Must be used only once in module of executable, see USE_MALLOC_BINNED
+ */
+#define REPLACEMENT_OPERATOR_NEW_AND_DELETE \
+	void* operator new( size_t InSize )													{ void* ptr = appMalloc( InSize ? InSize : 1 ); if ( !ptr ) { throw std::bad_alloc(); } return ptr; } \
+	void* operator new[]( size_t InSize )												{ void* ptr = appMalloc( InSize ? InSize : 1 ); if ( !ptr ) { throw std::bad_alloc(); } return ptr; } \
+	void* operator new( size_t InSize, const std::nothrow_t& ) noexcept					{ return appMalloc( InSize ? InSize : 1 ); } \
+	void* operator new[]( size_t InSize, const std::nothrow_t& ) noexcept				{ return appMalloc( InSize ? InSize : 1 ); } \
+	void operator delete( void* InPointer ) noexcept									{ appFree( InPointer ); } \
+	void operator delete[]( void* InPointer ) noexcept									{ appFree( InPointer ); } \
+	void operator delete( void* InPointer, size_t ) noexcept							{ appFree( InPointer ); } \
+	void operator delete[]( void* InPointer, size_t ) noexcept							{ appFree( InPointer ); } \
+	void operator delete( void* InPointer, const std::nothrow_t& ) noexcept				{ appFree( InPointer ); } \
+	void operator delete[]( void* InPointer, const std::nothrow_t& ) noexcept			{ appFree( InPointer ); }
+
+#endif // !MALLOC_H
@@ -9,8 +9,14 @@
 #ifndef MEMORYBASE_H
 #define MEMORYBASE_H
 
+#include <string.h>
+
 #include "../CoreDefines.h"
 
+#if _MSC_VER
+	#include <intrin.h>
+#endif // _MSC_VER
+
 #ifndef DEFINED_appMemzero
 	/**
 	 * @ingroup Core
@@ -22,9 +28,212 @@
 	#define appMemzero( InDest, InCount )		memset( InDest, 0, InCount )
 #endif
 
+/**
+ * @ingroup Core
+ * @brief Size of block in bytes which is processed at once by CFastHash
+ */
+#define FASTHASH_BLOCK_SIZE		48
+
+/**
+ * @ingroup Core
+ * @brief Fast non-cryptographic 64-bit hash
+ *
+ * Data is read by 8 bytes and mixed by 64x64->128 bit multiplication (wyhash family), long data
+ * is processed by blocks of FASTHASH_BLOCK_SIZE bytes in three independent lanes.
+ * Hash can be calculated at once by CFastHash::Hash or by parts with Update and Finalize,
+ * both ways give the same result
+ *
+ * Example usage:
+ * @code
+ * CFastHash	fastHash( InSeed );
+ * fastHash.Update( header, headerSize );
+ * fastHash.Update( data, dataSize );
+ * uint64		hash = fastHash.Finalize();
+ * @endcode
+ */
+class CFastHash
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param InSeed	Start hash
+	 */
+	FORCEINLINE CFastHash( uint64 InSeed = 0 )
+		: length( 0 )
+		, bufferSize( 0 )
+	{
+		InitLanes( InSeed, lanes );
+	}
+
+	/**
+	 * @brief Add data to hash
+	 *
+	 * @param InData	Pointer to data
+	 * @param InLength	Length of data
+	 */
+	FORCEINLINE void Update( const void* InData, uint64 InLength )
+	{
+		const byte*		data = ( const byte* )InData;
+		length += InLength;
+
+		// Fill buffer with not processed bytes of previous update
+		if ( bufferSize > 0 )
+		{
+			uint32		copySize = InLength < FASTHASH_BLOCK_SIZE - bufferSize ? ( uint32 )InLength : FASTHASH_BLOCK_SIZE - bufferSize;
+			memcpy( buffer + bufferSize, data, copySize );
+			bufferSize	+= copySize;
+			data		+= copySize;
+			InLength	-= copySize;
+			if ( bufferSize < FASTHASH_BLOCK_SIZE )
+			{
+				return;
+			}
+
+			ProcessBlock( buffer, lanes );
+			bufferSize = 0;
+		}
+
+		// Full blocks are processed directly from data, the rest is kept to next update
+		for ( ; InLength >= FASTHASH_BLOCK_SIZE; data += FASTHASH_BLOCK_SIZE, InLength -= FASTHASH_BLOCK_SIZE )
+		{
+			ProcessBlock( data, lanes );
+		}
+
+		memcpy( buffer, data, InLength );
+		bufferSize = ( uint32 )InLength;
+	}
+
+	/**
+	 * @brief Get hash of all added data
+	 * @return Return calculated hash
+	 */
+	FORCEINLINE uint64 Finalize() const
+	{
+		return Finish( lanes, buffer, bufferSize, length );
+	}
+
+	/**
+	 * @brief Calculate hash of data at once
+	 *
+	 * @param InData	Pointer to data
+	 * @param InLength	Length of data
+	 * @param InSeed	Start hash
+	 * @return Return calculated hash
+	 */
+	static FORCEINLINE uint64 Hash( const void* InData, uint64 InLength, uint64 InSeed = 0 )
+	{
+		const byte*		data = ( const byte* )InData;
+		uint64			localLanes[3];
+		InitLanes( InSeed, localLanes );
+
+		uint64			tailLength = InLength;
+		for ( ; tailLength >= FASTHASH_BLOCK_SIZE; data += FASTHASH_BLOCK_SIZE, tailLength -= FASTHASH_BLOCK_SIZE )
+		{
+			ProcessBlock( data, localLanes );
+		}
+		return Finish( localLanes, data, ( uint32 )tailLength, InLength );
+	}
+
+	/**
+	 * @brief Mix two 64-bit values
+	 *
+	 * @param InA	First value
+	 * @param InB	Second value
+	 * @return Return XOR of high and low parts of 128-bit product
+	 */
+	static FORCEINLINE uint64 Mix( uint64 InA, uint64 InB )
+	{
+#if _MSC_VER
+		uint64		high;
+		uint64		low = _umul128( InA, InB, &high );
+		return low ^ high;
+#else
+		unsigned __int128	product = ( unsigned __int128 )InA * InB;
+		return ( uint64 )product ^ ( uint64 )( product >> 64 );
+#endif // _MSC_VER
+	}
+
+private:
+	/**
+	 * @brief Read unaligned 64-bit value
+	 */
+	static FORCEINLINE uint64 Read64( const byte* InData )
+	{
+		uint64		value;
+		memcpy( &value, InData, sizeof( value ) );
+		return value;
+	}
+
+	/**
+	 * @brief Read unaligned 32-bit value
+	 */
+	static FORCEINLINE uint64 Read32( const byte* InData )
+	{
+		uint32		value;
+		memcpy( &value, InData, sizeof( value ) );
+		return value;
+	}
+
+	/**
+	 * @brief Init lanes from seed
+	 */
+	static FORCEINLINE void InitLanes( uint64 InSeed, uint64* OutLanes )
+	{
+		InSeed		^= Mix( InSeed ^ 0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL );
+		OutLanes[0]	= InSeed;
+		OutLanes[1]	= InSeed;
+		OutLanes[2]	= InSeed;
+	}
+
+	/**
+	 * @brief Process one block of FASTHASH_BLOCK_SIZE bytes
+	 */
+	static FORCEINLINE void ProcessBlock( const byte* InData, uint64* InOutLanes )
+	{
+		InOutLanes[0] = Mix( Read64( InData ) ^ 0xe7037ed1a0b428dbULL, Read64( InData + 8 ) ^ InOutLanes[0] );
+		InOutLanes[1] = Mix( Read64( InData + 16 ) ^ 0x8ebc6af09c88c6e3ULL, Read64( InData + 24 ) ^ InOutLanes[1] );
+		InOutLanes[2] = Mix( Read64( InData + 32 ) ^ 0x589965cc75374cc3ULL, Read64( InData + 40 ) ^ InOutLanes[2] );
+	}
+
+	/**
+	 * @brief Process tail of data shorter than block and calculate final hash
+	 */
+	static FORCEINLINE uint64 Finish( const uint64* InLanes, const byte* InTail, uint32 InTailLength, uint64 InLength )
+	{
+		uint64		lane = InLanes[0];
+		for ( ; InTailLength > 16; InTail += 16, InTailLength -= 16 )
+		{
+			lane = Mix( Read64( InTail ) ^ 0xe7037ed1a0b428dbULL, Read64( InTail + 8 ) ^ lane );
+		}
+
+		// Last 1-16 bytes are read by overlapped 4 bytes words
+		uint64		a = 0;
+		uint64		b = 0;
+		if ( InTailLength >= 4 )
+		{
+			uint32		offset = ( InTailLength >> 3 ) << 2;
+			a = ( Read32( InTail ) << 32 ) | Read32( InTail + offset );
+			b = ( Read32( InTail + InTailLength - 4 ) << 32 ) | Read32( InTail + InTailLength - 4 - offset );
+		}
+		else if ( InTailLength > 0 )
+		{
+			a = ( ( uint64 )InTail[0] << 16 ) | ( ( uint64 )InTail[InTailLength >> 1] << 8 ) | InTail[InTailLength - 1];
+		}
+
+		lane = Mix( a ^ 0xe7037ed1a0b428dbULL, b ^ lane );
+		return Mix( lane ^ InLanes[1] ^ InLanes[2] ^ 0x8ebc6af09c88c6e3ULL, InLength ^ 0xe7037ed1a0b428dbULL );
+	}
+
+	uint64		lanes[3];							/**< Lanes of hash state */
+	uint64		length;								/**< Total length of added data */
+	byte		buffer[FASTHASH_BLOCK_SIZE];		/**< Not processed bytes */
+	uint32		bufferSize;							/**< Number of bytes in buffer */
+};
+
 /**
  * @ingroup Core
  * @brief Fast memory hashing function that doesn't require a table lookup for each element
+ * @note Hash is calculated by CFastHash
  *
  * @param[in] InData Pointer to data for which is considered hash
  * @param[in] InLength Length of data
@@ -33,13 +242,7 @@
  */
 FORCEINLINE uint64 appMemFastHash( const void* InData, uint64 InLength, uint64 InHash = 0 )
 {
-	byte*		data = ( byte* )InData;
-	for ( uint64 index = 0; index < InLength; ++index )
-	{
-		InHash = data[ index ] + ( InHash << 6 ) + ( InHash << 16 ) - InHash;
-	}
-
-	return InHash;
+	return CFastHash::Hash( InData, InLength, InHash );
 }
 
 /**
@@ -0,0 +1,224 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright BSOD-Games, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include "Core.h"
+#include "Misc/Types.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Maximum number of frames in call stack of tracked allocation
+ */
+#define MEMTRACKER_MAX_FRAMES		12
+
+/**
+ * @ingroup Core
+ * @brief Maximum number of unique call stacks of tracked allocations
+ */
+#define MEMTRACKER_MAX_CALLSTACKS	( 64 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Tag of memory, shows which subsystem allocated memory
+ */
+enum EMemoryTag
+{
+	MT_Default,			/**< Not tagged memory */
+	MT_Objects,			/**< Actors and components */
+	MT_Package,			/**< Packages and assets without own tag */
+	MT_Texture,			/**< Textures */
+	MT_StaticMesh,		/**< Static meshes */
+	MT_Material,		/**< Materials */
+	MT_Audio,			/**< Audio banks and PCM data */
+	MT_Script,			/**< Scripts */
+	MT_Physics,			/**< Physics */
+	MT_Shader,			/**< Shaders and shader cache */
+	MT_Num				/**< Number of tags */
+};
+
+/**
+ * @ingroup Core
+ * @brief Convert memory tag to text
+ *
+ * @param InTag		Memory tag
+ * @return Return name of memory tag
+ */
+const tchar* appMemoryTagToText( EMemoryTag InTag );
+
+/**
+ * @ingroup Core
+ * @brief Statistics of memory tag
+ */
+struct SMemoryTagStats
+{
+	int64		liveBytes;			/**< Size of live allocations in bytes */
+	int64		peakBytes;			/**< Peak size of live allocations in bytes */
+	int64		numLive;			/**< Number of live allocations */
+	int64		numTotal;			/**< Total number of allocations */
+};
+
+/**
+ * @ingroup Core
+ * @brief Header of tracked allocation, placed right before user memory
+ */
+struct SMemoryTrackingHeader
+{
+	uint64		size;				/**< Requested size */
+	uint32		callstackId;		/**< ID of call stack, zero if call stacks aren't captured */
+	uint16		offset;				/**< Offset of user memory from start of block */
+	uint8		tag;				/**< Memory tag */
+	uint8		magic;				/**< Magic number for check of header */
+};
+
+/**
+ * @ingroup Core
+ * @brief Tracker of memory allocated by engine allocator
+ *
+ * Every allocation is tagged by tag of current thread (see SCOPED_MEMORY_TAG), live and peak bytes are counted
+ * for every tag. In debug builds call stacks of allocations are captured and live bytes are counted for every unique
+ * call stack, so growth of memory between two reports shows where it leaks.
+ * Works only if USE_MALLOC_TRACKING is enabled
+ */
+class CMemoryTracker
+{
+public:
+	/**
+	 * @brief Get memory tracker
+	 * @return Return memory tracker
+	 */
+	static CMemoryTracker& Get();
+
+	/**
+	 * @brief Set memory tag of current thread
+	 *
+	 * @param InTag		Memory tag
+	 * @return Return previous memory tag
+	 */
+	static EMemoryTag SetThreadTag( EMemoryTag InTag );
+
+	/**
+	 * @brief Track new allocation
+	 *
+	 * @param InHeader		Header of allocation
+	 * @param InOffset		Offset of user memory from start of block
+	 * @param InSize		Requested size
+	 */
+	void TrackMalloc( SMemoryTrackingHeader* InHeader, uint32 InOffset, uint64 InSize );
+
+	/**
+	 * @brief Track free of allocation
+	 * @param InHeader		Header of allocation
+	 */
+	void TrackFree( const SMemoryTrackingHeader* InHeader );
+
+	/**
+	 * @brief Get statistics of tags
+	 * @param OutStats		Output array of statistics for every tag
+	 */
+	void GetTagStats( SMemoryTagStats OutStats[MT_Num] ) const;
+
+	/**
+	 * @brief Print to log statistics of tags and difference with previous snapshot, after it takes new snapshot
+	 */
+	void DumpSnapshot();
+
+	/**
+	 * @brief Print to log call stacks which live bytes grew since previous report
+	 * @note Works only if MALLOC_TRACKING_CALLSTACKS is enabled
+	 *
+	 * @param InMaxCallstacks	Maximum number of printed call stacks
+	 */
+	void DumpLeaks( uint32 InMaxCallstacks );
+
+private:
+	/**
+	 * @brief Counters of memory tag
+	 */
+	struct STagCounters
+	{
+		volatile int64		liveBytes;		/**< Size of live allocations in bytes */
+		volatile int64		peakBytes;		/**< Peak size of live allocations in bytes */
+		volatile int64		numLive;		/**< Number of live allocations */
+		volatile int64		numTotal;		/**< Total number of allocations */
+	};
+
+	/**
+	 * @brief Unique call stack of allocations
+	 */
+	struct SCallstack
+	{
+		uint64				hash;							/**< Hash of frames */
+		void*				frames[MEMTRACKER_MAX_FRAMES];	/**< Return addresses */
+		uint32				numFrames;						/**< Number of frames */
+		uint32				tag;							/**< Memory tag of first allocation */
+		volatile int64		liveBytes;						/**< Size of live allocations in bytes */
+		volatile int64		numLive;						/**< Number of live allocations */
+		int64				reportedBytes;					/**< Live bytes at previous report */
+	};
+
+	/**
+	 * @brief Constructor
+	 */
+	CMemoryTracker();
+
+	/**
+	 * @brief Find or add call stack of current allocation
+	 * @return Return ID of call stack, zero if table of call stacks is full
+	 */
+	uint32 FindOrAddCallstack();
+
+	STagCounters			tags[MT_Num];			/**< Counters of tags */
+	SMemoryTagStats			snapshot[MT_Num];		/**< Statistics of tags at previous snapshot */
+	SCallstack*				callstacks;				/**< Hash table of call stacks, index in table is ID of call stack */
+	uint32					numCallstacks;			/**< Number of call stacks in table */
+	CCriticalSection		cs;						/**< Critical section of call stacks and snapshot */
+};
+
+/**
+ * @ingroup Core
+ * @brief Scope which sets memory tag of current thread
+ */
+class CMemoryTagScope
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param InTag		Memory tag
+	 */
+	FORCEINLINE CMemoryTagScope( EMemoryTag InTag )
+		: prevTag( CMemoryTracker::SetThreadTag( InTag ) )
+	{}
+
+	/**
+	 * @brief Destructor
+	 */
+	FORCEINLINE ~CMemoryTagScope()
+	{
+		CMemoryTracker::SetThreadTag( prevTag );
+	}
+
+private:
+	EMemoryTag		prevTag;		/**< Previous memory tag */
+};
+
+#if USE_MALLOC_TRACKING
+	/**
+	 * @ingroup Core
+	 * @brief Macro for tag memory allocated in current scope
+	 *
+	 * Example usage: @code SCOPED_MEMORY_TAG( MT_Texture ); @endcode
+	 */
+	#define SCOPED_MEMORY_TAG( InTag )		CMemoryTagScope		memoryTagScope( InTag )
+#else
+	#define SCOPED_MEMORY_TAG( InTag )
+#endif // USE_MALLOC_TRACKING
+
+#endif // !MEMORYTRACKER_H
@@ -19,7 +19,7 @@
 /**
  * @ingroup Core
  * @brief Class for containing IDs in name view.
- * Names are case-insensitive
+ * Names are case-insensitive. Creating and reading of names is thread safe
  */
 class CName
 {
@@ -34,20 +34,28 @@ public:
 		 */
 		FORCEINLINE SNameEntry()
 			: hash( INVALID_HASH )
+			, index( INDEX_NONE )
+			, next( nullptr )
 		{}
 
 		/**
 		 * @brief Constructor
 		 * @param InName	Name
-		 * @param InHash	Hash
+		 * @param InLength	Length of name
+		 * @param InHash	Case-insensitive hash of name
+		 * @param InIndex	Index of name in global table
 		 */
-		FORCEINLINE SNameEntry( const std::wstring& InName, uint32 InHash = INVALID_HASH )
-			: name( InName )
+		FORCEINLINE SNameEntry( const tchar* InName, uint32 InLength, uint32 InHash, uint32 InIndex )
+			: name( InName, InLength )
 			, hash( InHash )
+			, index( InIndex )
+			, next( nullptr )
 		{}
 
 		std::wstring	name;		/**< Name in string */
-		uint32			hash;		/**< Hash name */
+		uint32			hash;		/**< Case-insensitive hash of name */
+		uint32			index;		/**< Index of name in global table */
+		SNameEntry*		next;		/**< Next entry in hash bucket */
 	};
 
 	/**
@@ -77,7 +85,7 @@ public:
 		: index( INDEX_NONE )
 	{
 		StaticInit();
-		Init( InString );
+		Init( InString, ( uint32 )wcslen( InString ) );
 	}
 
 	/**
@@ -88,7 +96,7 @@ public:
 		: index( INDEX_NONE )
 	{
 		StaticInit();
-		Init( InString );
+		Init( InString.c_str(), ( uint32 )InString.size() );
 	}
 
 	/**
@@ -173,7 +181,7 @@ public:
 	 */
 	FORCEINLINE CName& operator=( const std::wstring& InOther )
 	{
-		Init( InOther );
+		Init( InOther.c_str(), ( uint32 )InOther.size() );
 		return *this;
 	}
 
@@ -226,9 +234,12 @@ public:
 private:
 	/**
 	 * @brief Initialize name
+	 * @note Find name in global table without temporary allocations, allocates new entry only if it isn't exist
+	 *
 	 * @param InString		String
+	 * @param InLength		Length of string
 	 */
-	void Init( const std::wstring& InString );
+	void Init( const tchar* InString, uint32 InLength );
 
 	uint32		index;		/**< Index name */
 };
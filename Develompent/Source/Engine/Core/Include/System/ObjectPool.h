@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright BSOD-Games, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <vector>
+
+#include "Core.h"
+#include "Misc/Types.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Maximum size of one slab of object pool in bytes
+ */
+#define OBJECTPOOL_SLAB_SIZE			( 64 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Alignment of elements in object pool
+ */
+#define OBJECTPOOL_ALIGNMENT			16
+
+/**
+ * @ingroup Core
+ * @brief Pool of fixed size elements
+ *
+ * Elements are allocated from slabs, so objects of one class lie close in memory. Every next slab is twice
+ * bigger up to OBJECTPOOL_SLAB_SIZE, so classes with a few objects don't reserve much memory.
+ * Freed elements are kept in free list and reused at first, slabs are released only when pool is destroyed
+ */
+class CObjectPool
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @note Memory isn't allocated until first call of Allocate
+	 *
+	 * @param InElementSize		Size of element in bytes
+	 */
+	CObjectPool( uint32 InElementSize );
+
+	/**
+	 * @brief Destructor
+	 */
+	~CObjectPool();
+
+	/**
+	 * @brief Allocate element
+	 * @return Return pointer to not initialized element
+	 */
+	void* Allocate();
+
+	/**
+	 * @brief Free element
+	 * @param InPointer		Pointer to element allocated by this pool
+	 */
+	void Free( void* InPointer );
+
+	/**
+	 * @brief Get size of element
+	 * @return Return size of element in bytes with alignment
+	 */
+	FORCEINLINE uint32 GetElementSize() const
+	{
+		return elementSize;
+	}
+
+	/**
+	 * @brief Get number of allocated elements
+	 * @return Return number of allocated elements
+	 */
+	FORCEINLINE uint32 GetNumAllocated() const
+	{
+		return numAllocated;
+	}
+
+	/**
+	 * @brief Get number of allocated slabs
+	 * @return Return number of allocated slabs
+	 */
+	FORCEINLINE uint32 GetNumSlabs() const
+	{
+		return ( uint32 )slabs.size();
+	}
+
+	/**
+	 * @brief Get size of memory reserved by pool
+	 * @return Return size in bytes of all slabs
+	 */
+	FORCEINLINE uint64 GetReservedSize() const
+	{
+		return reservedSize;
+	}
+
+private:
+	/**
+	 * @brief Free element in free list
+	 */
+	struct SFreeElement
+	{
+		SFreeElement*		next;		/**< Next free element */
+	};
+
+	/**
+	 * @brief Allocate new slab and add its elements to free list
+	 */
+	void AllocateSlab();
+
+	uint32					elementSize;		/**< Size of element with alignment */
+	uint32					numSlabElements;	/**< Number of elements in next slab */
+	uint32					maxSlabElements;	/**< Maximum number of elements in one slab */
+	uint32					numAllocated;		/**< Number of allocated elements */
+	uint64					reservedSize;		/**< Size of all slabs in bytes */
+	SFreeElement*			freeList;			/**< List of free elements */
+	std::vector<byte*>		slabs;				/**< Allocated slabs */
+	CCriticalSection		cs;					/**< Critical section */
+};
+
+#endif // !OBJECTPOOL_H
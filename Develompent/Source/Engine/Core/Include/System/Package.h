@@ -12,6 +12,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <vector>
+#include <list>
 
 #include "Misc/Types.h"
 #include "Misc/RefCounted.h"
@@ -24,6 +25,7 @@
 #include "Misc/CoreGlobals.h"
 #include "System/Delegate.h"
 #include "System/Archive.h"
+#include "System/FileHandleCache.h"
 
 /**
  * @ingroup Core
@@ -490,6 +492,17 @@ public:
 		}
 		bOnlyEditor = InIsOnlyEditor;
 	}
+
+	/**
+	 * Set GUID of asset
+	 * @note Need call it before adding asset to package. Used by cooker for keep GUIDs of recooked assets
+	 * @param InGUID	GUID of asset
+	 */
+	FORCEINLINE void SetGUID( const CGuid& InGUID )
+	{
+		check( !package && InGUID.IsValid() );
+		guid = InGUID;
+	}
 #endif // WITH_EDITOR
 
 	/**
@@ -582,6 +595,14 @@ public:
 	 */
 	virtual void ReloadDependentAssets( bool InForce = false );
 
+	/**
+	 * Get memory used by loaded asset
+	 * @note Base implementation return 0, assets with own CPU or GPU data must override it
+	 * 
+	 * @return Return size in bytes of CPU and GPU data of asset
+	 */
+	virtual uint64 GetResidentSize() const;
+
 protected:
 	/**
 	 * Mark dirty asset
@@ -1464,6 +1485,70 @@ public:
 		return itPackage != packages.end();
 	}
 
+	/**
+	 * Get cache of opened file handles
+	 * @return Return cache of opened file handles
+	 */
+	FORCEINLINE CFileHandleCache& GetFileHandleCache()
+	{
+		return fileHandleCache;
+	}
+
+	/**
+	 * Set memory budget for assets
+	 * 
+	 * @param InType	Asset type. If AT_Unknown, budget is set for all assets together
+	 * @param InBudget	Budget in bytes. 0 means no limit
+	 */
+	FORCEINLINE void SetMemoryBudget( EAssetType InType, uint64 InBudget )
+	{
+		check( InType >= AT_Unknown && InType < AT_Count );
+		memoryBudgets[ InType ] = InBudget;
+	}
+
+	/**
+	 * Get memory budget for assets
+	 * 
+	 * @param InType	Asset type. If AT_Unknown, return budget for all assets together
+	 * @return Return budget in bytes. 0 means no limit
+	 */
+	FORCEINLINE uint64 GetMemoryBudget( EAssetType InType ) const
+	{
+		check( InType >= AT_Unknown && InType < AT_Count );
+		return memoryBudgets[ InType ];
+	}
+
+	/**
+	 * Get memory used by loaded assets
+	 * @note Memory of asset is its CPU and GPU data (see CAsset::GetResidentSize)
+	 * 
+	 * @param InType	Asset type. If AT_Unknown, return memory used by all assets
+	 * @return Return memory in bytes
+	 */
+	FORCEINLINE uint64 GetMemoryUsage( EAssetType InType ) const
+	{
+		check( InType >= AT_Unknown && InType < AT_Count );
+		return memoryUsage[ InType ];
+	}
+
+	/**
+	 * Unload not referenced assets in LRU order while memory usage is over budgets
+	 * 
+	 * @param InIgnoreBudgets	If TRUE, unload all not referenced assets
+	 * @return Return number of unloaded assets
+	 */
+	uint32 EvictUnreferencedAssets( bool InIgnoreBudgets = false );
+
+	/**
+	 * Print to log memory usage and budgets of assets
+	 */
+	void DumpMemoryUsage() const;
+
+	/**
+	 * Print to log loaded assets in LRU order
+	 */
+	void DumpResidentAssets() const;
+
 private:	
 	/**
 	 * Struct of normalized path in file system
@@ -1568,12 +1653,70 @@ private:
 		std::wstring		path;			/**< Normalized path */
 	};
 
+	/**
+	 * Loaded asset which can be unloaded under memory pressure
+	 */
+	struct SResidentAsset
+	{
+		CPackage*		package;		/**< Package of asset */
+		CGuid			guid;			/**< GUID of asset */
+		EAssetType		type;			/**< Asset type */
+		uint64			size;			/**< Memory used by asset */
+	};
+
+	/**
+	 * Typedef of list loaded assets. Most recently used assets are in front
+	 */
+	typedef std::list< SResidentAsset >																				ResidentAssetList_t;
+
 	/**
 	 * Typedef of list loaded packages
 	 */
 	typedef std::unordered_map< SNormalizedPath, PackageRef_t, SNormalizedPath::SNormalizedPathKeyFunc >			PackageList_t;
 
-	PackageList_t			packages;				/**< Opened packages */
+	/**
+	 * Add loaded asset to accounting or mark it as most recently used if it already added
+	 * @warning Must called from CPackage
+	 * 
+	 * @param InPackage		Package of asset
+	 * @param InAssetInfo	Asset info
+	 */
+	void AddResidentAsset( CPackage* InPackage, const SAssetInfo& InAssetInfo );
+
+	/**
+	 * Remove asset from accounting
+	 * @warning Must called from CPackage
+	 * 
+	 * @param InAssetInfo	Asset info
+	 */
+	void RemoveResidentAsset( const SAssetInfo& InAssetInfo );
+
+	/**
+	 * Mark asset as most recently used
+	 * @warning Must called from CPackage
+	 * 
+	 * @param InAssetInfo	Asset info
+	 */
+	void TouchResidentAsset( const SAssetInfo& InAssetInfo );
+
+	/**
+	 * Is memory usage over budget
+	 * 
+	 * @param InType	Asset type
+	 * @return Return TRUE if usage of InType or of all assets is over budget
+	 */
+	FORCEINLINE bool IsOverBudget( EAssetType InType ) const
+	{
+		return ( memoryBudgets[ AT_Unknown ] > 0 && memoryUsage[ AT_Unknown ] > memoryBudgets[ AT_Unknown ] ) || ( memoryBudgets[ InType ] > 0 && memoryUsage[ InType ] > memoryBudgets[ InType ] );
+	}
+
+	ResidentAssetList_t													residentAssets;				/**< Loaded assets in LRU order */
+	std::unordered_map< const CAsset*, ResidentAssetList_t::iterator >	residentAssetsMap;			/**< Map of asset to item in residentAssets */
+	uint64																memoryUsage[ AT_Count ];	/**< Memory used by assets of every type. In AT_Unknown is memory of all assets */
+	uint64																memoryBudgets[ AT_Count ];	/**< Memory budgets for every asset type. In AT_Unknown is budget of all assets */
+	PackageList_t														packages;					/**< Opened packages */
+	CFileHandleCache													fileHandleCache;			/**< Cache of opened file handles */
+	mutable CCriticalSection											residentAssetsCS;			/**< Critical section of residentAssets, residentAssetsMap and memoryUsage */
 };
 
 /**
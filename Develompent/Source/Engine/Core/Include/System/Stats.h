@@ -0,0 +1,513 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright BSOD-Games, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Core.h"
+#include "Misc/Types.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Maximum depth of nested cycle counters on one thread
+ */
+#define STATS_MAX_DEPTH				64
+
+/**
+ * @ingroup Core
+ * @brief Maximum number of events recorded by one thread between two frames, the rest are dropped
+ */
+#define STATS_MAX_THREAD_EVENTS		( 64 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Period in seconds of update of shown stats
+ */
+#define STATS_UPDATE_PERIOD			0.5
+
+/**
+ * @ingroup Core
+ * @brief Maximum number of events in trace capture, capture is finished earlier when it's reached
+ */
+#define STATS_MAX_TRACE_EVENTS		( 2 * 1024 * 1024 )
+
+/**
+ * @ingroup Core
+ * @brief Group of stats, stats of one group are shown by one 'stat' command
+ */
+enum EStatGroup
+{
+	SG_Engine,			/**< Game thread, world and thread pool */
+	SG_Scene,			/**< Scene rendering */
+	SG_Audio,			/**< Audio */
+	SG_Physics,			/**< Physics */
+	SG_Loading,			/**< Loading of packages and streaming */
+	SG_Memory,			/**< Memory */
+	SG_Num				/**< Number of groups */
+};
+
+/**
+ * @ingroup Core
+ * @brief Type of stat
+ */
+enum EStatType
+{
+	ST_Cycle,			/**< Scoped cycle counter */
+	ST_Counter,			/**< Counter which is reset every frame, e.g. number of draw calls */
+	ST_Memory			/**< Size of memory in bytes, isn't reset */
+};
+
+/**
+ * @ingroup Core
+ * @brief Convert stat group to text
+ *
+ * @param InGroup	Stat group
+ * @return Return name of stat group
+ */
+const tchar* appStatGroupToText( EStatGroup InGroup );
+
+/**
+ * @ingroup Core
+ * @brief Descriptor of stat
+ * @note Descriptors must have static storage duration, use DECLARE_*_STAT macros
+ */
+class CStatDescriptor
+{
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param InName	Name of stat
+	 * @param InGroup	Group of stat
+	 * @param InType	Type of stat
+	 */
+	CStatDescriptor( const tchar* InName, EStatGroup InGroup, EStatType InType );
+
+	/**
+	 * @brief Add value to counter
+	 * @param InAmount	Amount
+	 */
+	FORCEINLINE void Add( int64 InAmount )
+	{
+		appInterlockedAdd64( &value, InAmount );
+	}
+
+	/**
+	 * @brief Set value of counter
+	 * @param InValue	Value
+	 */
+	FORCEINLINE void Set( int64 InValue )
+	{
+		appInterlockedExchange64( &value, InValue );
+	}
+
+	/**
+	 * @brief Get name
+	 * @return Return name of stat
+	 */
+	FORCEINLINE const tchar* GetName() const
+	{
+		return name;
+	}
+
+	/**
+	 * @brief Get group
+	 * @return Return group of stat
+	 */
+	FORCEINLINE EStatGroup GetGroup() const
+	{
+		return group;
+	}
+
+	/**
+	 * @brief Get type
+	 * @return Return type of stat
+	 */
+	FORCEINLINE EStatType GetType() const
+	{
+		return type;
+	}
+
+	/**
+	 * @brief Get index
+	 * @return Return index of stat in array of registered stats
+	 */
+	FORCEINLINE uint32 GetIndex() const
+	{
+		return index;
+	}
+
+private:
+	friend class CStats;
+
+	const tchar*		name;		/**< Name */
+	EStatGroup			group;		/**< Group */
+	EStatType			type;		/**< Type */
+	uint32				index;		/**< Index in array of registered stats */
+	volatile int64		value;		/**< Value of counter */
+};
+
+/**
+ * @ingroup Core
+ * @brief Event of cycle counter
+ */
+struct SStatEvent
+{
+	uint64		startCycles;		/**< Cycles at begin of scope */
+	uint64		endCycles;			/**< Cycles at end of scope */
+	uint32		statIndex;			/**< Index of stat */
+	uint16		parentStatIndex;	/**< Index of stat of parent scope, 0xFFFF if it's root scope */
+	uint16		depth;				/**< Depth of scope, zero for root scope */
+	uint32		threadId;			/**< ID of thread which recorded event */
+};
+
+/**
+ * @ingroup Core
+ * @brief Buffer of events recorded by one thread
+ */
+struct SStatThreadBuffer
+{
+	std::wstring				name;						/**< Name of thread */
+	uint32						threadId;					/**< ID of thread */
+	uint32						depth;						/**< Current depth of scopes, used only by owner thread */
+	uint16						stack[STATS_MAX_DEPTH];		/**< Stat indices of opened scopes, used only by owner thread */
+	std::vector<SStatEvent>		events;						/**< Events recorded since last frame */
+	bool						bFree;						/**< Is owner thread exited, free buffer is reused by new thread */
+	CCriticalSection			cs;							/**< Critical section of events */
+};
+
+/**
+ * @ingroup Core
+ * @brief Collector of stats
+ *
+ * Every thread records events of scoped cycle counters (see SCOPE_CYCLE_COUNTER) to own buffer.
+ * At the end of every game frame buffers of all threads are collected, events are aggregated by thread and
+ * by pair of stat and parent stat, so shown stats keep hierarchy of scopes. Collection works only while
+ * some stats are shown or trace is captured, otherwise scoped cycle counters cost one check of flag.
+ * Trace capture keeps raw events of all threads for some frames or time and writes them as Chrome Trace Event JSON
+ */
+class CStats
+{
+public:
+	/**
+	 * @brief Constructor
+	 */
+	CStats();
+
+	/**
+	 * @brief Set name of current thread
+	 * @param InName	Name of thread
+	 */
+	void SetThreadName( const std::wstring& InName );
+
+	/**
+	 * @brief Begin scope of cycle counter on current thread
+	 * @param InStat	Stat
+	 */
+	FORCEINLINE void BeginScope( const CStatDescriptor& InStat )
+	{
+		SStatThreadBuffer*		buffer = GetThreadBuffer();
+		if ( buffer->depth < STATS_MAX_DEPTH )
+		{
+			buffer->stack[buffer->depth] = ( uint16 )InStat.GetIndex();
+		}
+		++buffer->depth;
+	}
+
+	/**
+	 * @brief End scope of cycle counter on current thread
+	 *
+	 * @param InStat			Stat
+	 * @param InStartCycles		Cycles at begin of scope
+	 */
+	void EndScope( const CStatDescriptor& InStat, uint64 InStartCycles );
+
+	/**
+	 * @brief Collect stats of the frame
+	 * @note Must be called on game thread at the end of frame
+	 *
+	 * @param InDeltaSeconds	Time of frame in seconds
+	 */
+	void AdvanceFrame( float InDeltaSeconds );
+
+	/**
+	 * @brief Toggle showing of 'stat unit'
+	 */
+	void ToggleUnit();
+
+	/**
+	 * @brief Toggle showing of group
+	 * @param InGroup	Stat group
+	 */
+	void ToggleGroup( EStatGroup InGroup );
+
+	/**
+	 * @brief Hide all stats
+	 */
+	void HideAll();
+
+	/**
+	 * @brief Get lines of shown stats
+	 * @note Thread safe, lines are updated every STATS_UPDATE_PERIOD seconds
+	 *
+	 * @param OutLines	Output array of lines
+	 */
+	void GetDisplayLines( std::vector<std::wstring>& OutLines );
+
+	/**
+	 * @brief Execute 'stat' console command
+	 * @param InArguments	Arguments of command
+	 */
+	void ExecCommand( const std::vector<std::wstring>& InArguments );
+
+	/**
+	 * @brief Begin trace capture
+	 * @note Trace is written to Profiling directory of game, it may be opened in chrome://tracing or Perfetto UI
+	 *
+	 * @param InNumFrames	Number of frames to capture, if zero capture is limited by time
+	 * @param InSeconds		Time of capture in seconds, used only if InNumFrames is zero
+	 */
+	void BeginTraceCapture( uint32 InNumFrames, float InSeconds );
+
+	/**
+	 * @brief End trace capture and write it to file
+	 */
+	void EndTraceCapture();
+
+	/**
+	 * @brief Execute 'tracecapture' console command
+	 * @param InArguments	Arguments of command
+	 */
+	void ExecTraceCommand( const std::vector<std::wstring>& InArguments );
+
+	/**
+	 * @brief Is trace captured
+	 * @return Return TRUE if trace capture is in progress, else return FALSE
+	 */
+	FORCEINLINE bool IsTraceCapturing() const
+	{
+		return bTraceCapture;
+	}
+
+	/**
+	 * @brief Is collection of stats enabled
+	 * @return Return TRUE if stats are collected, else return FALSE
+	 */
+	FORCEINLINE bool IsEnabled() const
+	{
+		return bEnabled;
+	}
+
+	/**
+	 * @brief Get registered stats
+	 * @return Return array of registered stats
+	 */
+	static std::vector<CStatDescriptor*>& GetDescriptors();
+
+	/**
+	 * @brief Get buffer of current thread
+	 * @return Return buffer of current thread, it's created on first call
+	 */
+	static SStatThreadBuffer* GetThreadBuffer();
+
+private:
+	friend struct SStatThreadBufferOwner;
+
+	/**
+	 * @brief Aggregated values of cycle counter on one thread
+	 */
+	struct SStatNode
+	{
+		uint32		threadIndex;		/**< Index of thread buffer */
+		uint32		statIndex;			/**< Index of stat */
+		uint32		parentStatIndex;	/**< Index of stat of parent scope, INDEX_NONE for root scope */
+		uint32		depth;				/**< Depth of scope */
+		uint64		firstCycles;		/**< Cycles of first event in window, used for order */
+		uint64		totalCycles;		/**< Total cycles in window */
+		uint64		frameCycles;		/**< Cycles in current frame */
+		uint64		maxFrameCycles;		/**< Maximum cycles per frame in window */
+		uint64		numCalls;			/**< Number of calls in window */
+	};
+
+	/**
+	 * @brief Aggregated values of counter
+	 */
+	struct SCounterValue
+	{
+		int64		total;				/**< Total value in window */
+		int64		max;				/**< Maximum value per frame in window */
+	};
+
+	/**
+	 * @brief Event of trace capture
+	 */
+	struct STraceEvent
+	{
+		uint64		startCycles;		/**< Cycles at begin of scope */
+		uint64		endCycles;			/**< Cycles at end of scope */
+		uint32		statIndex;			/**< Index of stat, INDEX_NONE for frame */
+		uint32		threadId;			/**< ID of thread */
+	};
+
+	/**
+	 * @brief Update flag of collection
+	 */
+	void UpdateEnabled();
+
+	/**
+	 * @brief Build lines of shown stats from aggregated values and reset window
+	 */
+	void UpdateDisplayLines();
+
+	/**
+	 * @brief Append events of thread to trace, events started before the capture are dropped
+	 *
+	 * @param InEvents		Events collected from buffer of thread
+	 * @param InThreadName	Name of thread
+	 */
+	void AppendTraceEvents( const std::vector<SStatEvent>& InEvents, const std::wstring& InThreadName );
+
+	/**
+	 * @brief Write captured trace to file
+	 *
+	 * @param InPath	Path to file
+	 * @return Return TRUE if trace is written, else return FALSE
+	 */
+	bool WriteTrace( const std::wstring& InPath );
+
+	volatile bool										bEnabled;				/**< Is collection of stats enabled */
+	bool												bShowUnit;				/**< Is shown 'stat unit' */
+	bool												bShowGroups[SG_Num];	/**< Is shown groups */
+	std::vector<SStatThreadBuffer*>						threadBuffers;			/**< Buffers of all threads, they are never deleted but reused after exit of thread */
+	std::vector<SStatEvent>								scratchEvents;			/**< Scratch array of events collected from thread */
+	std::unordered_map<uint64, SStatNode>				nodes;					/**< Aggregated cycle counters, key is thread, parent and stat */
+	std::vector<SCounterValue>							counters;				/**< Aggregated counters, indexed by stat */
+	std::vector<uint64>									threadFrameCycles;		/**< Cycles of root scopes of threads in current frame */
+	std::vector<uint64>									threadTotalCycles;		/**< Cycles of root scopes of threads in window */
+	std::vector<uint64>									threadMaxCycles;		/**< Maximum cycles of root scopes of threads per frame in window */
+	uint32												numWindowFrames;		/**< Number of frames in window */
+	double												windowFrameTime;		/**< Total time of frames in window */
+	double												windowMaxFrameTime;		/**< Maximum time of frame in window */
+	double												windowStartTime;		/**< Time of window start */
+	std::vector<std::wstring>							displayLines;			/**< Lines of shown stats */
+	bool												bTraceCapture;			/**< Is trace capture in progress */
+	uint32												traceFramesLeft;		/**< Number of frames left to capture, zero if capture is limited by time */
+	double												traceEndTime;			/**< Time of capture end, used only if capture is limited by time */
+	uint64												traceStartCycles;		/**< Cycles at capture start */
+	uint64												traceFrameStartCycles;	/**< Cycles at start of current frame */
+	std::vector<STraceEvent>							traceEvents;			/**< Captured events */
+	std::unordered_map<uint32, std::wstring>			traceThreadNames;		/**< Names of captured threads, key is thread ID */
+	CCriticalSection									cs;						/**< Critical section of thread buffers */
+	CCriticalSection									displayCS;				/**< Critical section of display lines */
+};
+
+/**
+ * @ingroup Core
+ * @brief Scoped cycle counter
+ */
+class CScopeCycleCounter
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param InStat	Stat
+	 */
+	FORCEINLINE CScopeCycleCounter( const CStatDescriptor& InStat );
+
+	/**
+	 * @brief Destructor
+	 */
+	FORCEINLINE ~CScopeCycleCounter();
+
+private:
+	const CStatDescriptor*		stat;			/**< Stat, nullptr if collection was disabled at begin of scope */
+	uint64						startCycles;	/**< Cycles at begin of scope */
+};
+
+extern CStats			GStats;			/**< Global collector of stats */
+
+FORCEINLINE CScopeCycleCounter::CScopeCycleCounter( const CStatDescriptor& InStat )
+	: stat( nullptr )
+	, startCycles( 0 )
+{
+	if ( GStats.IsEnabled() )
+	{
+		stat		= &InStat;
+		GStats.BeginScope( InStat );
+		startCycles = appCycles();
+	}
+}
+
+FORCEINLINE CScopeCycleCounter::~CScopeCycleCounter()
+{
+	if ( stat )
+	{
+		GStats.EndScope( *stat, startCycles );
+	}
+}
+
+#if STATS
+	/**
+	 * @ingroup Core
+	 * @brief Macro for declare cycle stat
+	 *
+	 * Example usage: @code DECLARE_CYCLE_STAT( TEXT( "World tick" ), STAT_WorldTick, SG_Engine ); @endcode
+	 */
+	#define DECLARE_CYCLE_STAT( InName, InStatId, InGroup )			CStatDescriptor InStatId( InName, InGroup, ST_Cycle )
+
+	/**
+	 * @ingroup Core
+	 * @brief Macro for declare counter stat
+	 */
+	#define DECLARE_COUNTER_STAT( InName, InStatId, InGroup )		CStatDescriptor InStatId( InName, InGroup, ST_Counter )
+
+	/**
+	 * @ingroup Core
+	 * @brief Macro for declare memory stat
+	 */
+	#define DECLARE_MEMORY_STAT( InName, InStatId, InGroup )		CStatDescriptor InStatId( InName, InGroup, ST_Memory )
+
+	/**
+	 * @ingroup Core
+	 * @brief Macro for declare stat which is defined in other file
+	 */
+	#define DECLARE_STAT_EXTERN( InStatId )							extern CStatDescriptor InStatId
+
+	/**
+	 * @ingroup Core
+	 * @brief Macro for measure time of current scope
+	 */
+	#define SCOPE_CYCLE_COUNTER( InStatId )							CScopeCycleCounter		scopeCycleCounter_##InStatId( InStatId )
+
+	/**
+	 * @ingroup Core
+	 * @brief Macro for add value to counter stat
+	 */
+	#define INC_COUNTER_STAT( InStatId, InAmount )					InStatId.Add( InAmount )
+
+	/**
+	 * @ingroup Core
+	 * @brief Macro for set value of counter or memory stat
+	 */
+	#define SET_MEMORY_STAT( InStatId, InValue )					InStatId.Set( InValue )
+#else
+	#define DECLARE_CYCLE_STAT( InName, InStatId, InGroup )
+	#define DECLARE_COUNTER_STAT( InName, InStatId, InGroup )
+	#define DECLARE_MEMORY_STAT( InName, InStatId, InGroup )
+	#define DECLARE_STAT_EXTERN( InStatId )
+	#define SCOPE_CYCLE_COUNTER( InStatId )
+	#define INC_COUNTER_STAT( InStatId, InAmount )
+	#define SET_MEMORY_STAT( InStatId, InValue )
+#endif // STATS
+
+#endif // !STATS_H
@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @addtogroup Core Core
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <list>
+#include <functional>
+
+#include "Core.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Core
+ * @brief Interface of work which can be queued to thread pool
+ */
+class CQueuedWork
+{
+public:
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~CQueuedWork() {}
+
+	/**
+	 * @brief Do work
+	 * @note Called on worker thread. After this call work no longer touched by pool
+	 */
+	virtual void DoThreadedWork() = 0;
+
+	/**
+	 * @brief Abandon work
+	 * @note Called when pool is destroying and work was not started. After this call work no longer touched by pool
+	 */
+	virtual void Abandon() = 0;
+};
+
+/**
+ * @ingroup Core
+ * @brief Pool of worker threads which execute queued works
+ */
+class CQueuedThreadPool
+{
+public:
+	/**
+	 * @brief Constructor
+	 */
+	CQueuedThreadPool();
+
+	/**
+	 * @brief Destructor
+	 */
+	~CQueuedThreadPool();
+
+	/**
+	 * @brief Create worker threads
+	 *
+	 * @param InNumThreads		Number of worker threads
+	 * @param InStackSize		Size of stack for every thread. 0 means use the current thread's stack size
+	 * @param InThreadPriority	Priority of worker threads
+	 * @return Return TRUE if all threads created, else return FALSE
+	 */
+	bool Create( uint32 InNumThreads, uint32 InStackSize = 0, EThreadPriority InThreadPriority = TP_Normal );
+
+	/**
+	 * @brief Abandon not started works and destroy worker threads
+	 * @note Blocks until all started works will be finished
+	 */
+	void Destroy();
+
+	/**
+	 * @brief Add work to queue
+	 * @param InWork	Work
+	 */
+	void AddQueuedWork( CQueuedWork* InWork );
+
+	/**
+	 * @brief Remove work from queue if it's not started yet
+	 *
+	 * @param InWork	Work
+	 * @return Return TRUE if work removed from queue and it will never executed, else return FALSE
+	 */
+	bool RetractQueuedWork( CQueuedWork* InWork );
+
+	/**
+	 * @brief Get number of worker threads
+	 * @return Return number of worker threads
+	 */
+	FORCEINLINE uint32 GetNumThreads() const
+	{
+		return threads.size();
+	}
+
+private:
+	/**
+	 * @brief Runnable of worker thread
+	 */
+	class CQueuedThread : public CRunnable
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 * @param InPool	Owner pool
+		 */
+		CQueuedThread( CQueuedThreadPool* InPool );
+
+		/**
+		 * @brief Initialize
+		 * @return True if initialization was successful, false otherwise
+		 */
+		virtual bool Init() override;
+
+		/**
+		 * @brief Run
+		 * @return The exit code of the runnable object
+		 */
+		virtual uint32 Run() override;
+
+		/**
+		 * @brief Stop
+		 */
+		virtual void Stop() override;
+
+		/**
+		 * @brief Exit
+		 */
+		virtual void Exit() override;
+
+	private:
+		CQueuedThreadPool*		pool;		/**< Owner pool */
+	};
+
+	/**
+	 * @brief Get next work from queue
+	 * @return Return next work. If pool is destroying return NULL
+	 */
+	CQueuedWork* GetNextWork();
+
+	std::vector<CRunnableThread*>		threads;			/**< Worker threads */
+	std::list<CQueuedWork*>				queuedWorks;		/**< Not started works */
+	CSemaphore*							worksSemaphore;		/**< Semaphore counted number of queued works */
+	CCriticalSection					cs;					/**< Critical section */
+	bool								bIsDestroying;		/**< Is pool destroying */
+};
+
+/**
+ * @ingroup Core
+ * @brief Execute function for every index in range [0, InNum) on thread pool
+ * @note Calling thread executes part of range too and this function returns only when all range is done,
+ * so it's safe to use it from works of thread pool. If pool is not created range executes on calling thread
+ *
+ * @param InNum			Number of indices
+ * @param InFunction	Function to execute for index
+ */
+void appParallelFor( uint32 InNum, const std::function<void( uint32 )>& InFunction );
+
+#endif // !THREADPOOL_H
@@ -1,6 +1,7 @@
 #include <memory>
 
 #include "Core.h"
+#include "System/Malloc.h"
 #include "Containers/String.h"
 
 /**
@@ -28,8 +29,8 @@ std::wstring CString::Format( const tchar* InFormat, va_list InArguments )
 
 	while ( result == -1 )
 	{
-		free( buffer );
-		buffer = ( tchar* )malloc( bufferSize * sizeof( tchar ) );
+		appFree( buffer );
+		buffer = ( tchar* )appMalloc( bufferSize * sizeof( tchar ) );
 
 		// Get formated string with args
 		result = appGetVarArgs( buffer, bufferSize, bufferSize - 1, InFormat, InArguments );
@@ -43,6 +44,6 @@ std::wstring CString::Format( const tchar* InFormat, va_list InArguments )
 	buffer[ result ] = 0;
 
 	std::wstring		formatedString = buffer;
-	free( buffer );
+	appFree( buffer );
 	return formatedString;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "System/Config.h"
 #include "Scripts/ScriptEngine.h"
 #include "System/Package.h"
+#include "System/ThreadPool.h"
 #include "Misc/TableOfContents.h"
 #include "Misc/CommandLine.h"
 
@@ -24,6 +25,7 @@ double                  GCurrentTime                = GStartTime;
 double                  GLastTime                   = 0.0;
 double                  GDeltaTime                  = 0.0;
 CPackageManager*        GPackageManager             = new CPackageManager();
+CQueuedThreadPool*      GThreadPool                 = new CQueuedThreadPool();
 CTableOfContets		    GTableOfContents;
 std::wstring            GGameName                   = TEXT( "ExampleGame" );
 CCommandLine			GCommandLine;
@@ -18,6 +18,104 @@ extern "C"
 #include "Misc/CoreGlobals.h"
 #include "Logger/LoggerMacros.h"
 #include "Containers/StringConv.h"
+#include "System/Config.h"
+
+/** Time in milliseconds after which writer thread checks queue even without signal */
+#define LOG_WRITER_WAIT_TIME		100
+
+static const tchar* GLogTypeNames[] =
+{
+	TEXT( "Log" ),
+	TEXT( "Warning" ),
+	TEXT( "Error" )
+};
+
+static const tchar* GLogCategoryNames[] =
+{
+	TEXT( "None" ),
+	TEXT( "General" ),
+	TEXT( "Init" ),
+	TEXT( "Script" ),
+	TEXT( "Dev" ),
+	TEXT( "Shader" ),
+	TEXT( "Input" ),
+	TEXT( "Package" ),
+	TEXT( "Audio" ),
+	TEXT( "Physics" ),
+	TEXT( "Movie" ),
+	TEXT( "Render" ),
+	TEXT( "RHI" ),
+	TEXT( "Memory" ),
+
+#if WITH_EDITOR
+	TEXT( "Editor" ),
+	TEXT( "Commandlet" )
+#endif // WITH_EDITOR
+};
+static_assert( ARRAY_COUNT( GLogCategoryNames ) == LC_Num, "Names of all log categories must be in GLogCategoryNames" );
+
+/**
+ * Runnable of thread which writes messages from log queue to output device
+ */
+class CLogWriterRunnable : public CRunnable
+{
+public:
+	/**
+	 * Constructor
+	 */
+	CLogWriterRunnable( CBaseLogger* InLogger )
+		: logger( InLogger )
+	{}
+
+	/**
+	 * Initialize
+	 */
+	virtual bool Init() override
+	{
+		logger->writerThreadId = appGetCurrentThreadId();
+		return true;
+	}
+
+	/**
+	 * Run
+	 */
+	virtual uint32 Run() override
+	{
+		while ( logger->isWriterRunning )
+		{
+			if ( logger->ProcessRecords() )
+			{
+				continue;
+			}
+
+			// Queue is empty, producers will wake up us when it'll be needed
+			appInterlockedExchange( &logger->isWriterWaiting, 1 );
+			if ( !logger->ProcessRecords() )
+			{
+				logger->eventNewRecords->Wait( LOG_WRITER_WAIT_TIME );
+			}
+			appInterlockedExchange( &logger->isWriterWaiting, 0 );
+		}
+
+		logger->ProcessRecords();
+		return 0;
+	}
+
+	/**
+	 * Stop
+	 */
+	virtual void Stop() override
+	{}
+
+	/**
+	 * Exit
+	 */
+	virtual void Exit() override
+	{}
+
+private:
+	CBaseLogger*		logger;		/**< Logger */
+};
 
 void Print( std::string Instr )
 {
@@ -28,6 +126,151 @@ IMPLEMENT_SCRIPT_API( CBaseLogger,
 					  luabridge::getGlobalNamespace( InVM ).addFunction( "Log", &Print );
 					  )
 
+/**
+ * Convert log type to text
+ */
+const tchar* appLogTypeToText( ELogType InLogType )
+{
+	return GLogTypeNames[ ( uint32 )InLogType ];
+}
+
+/**
+ * Convert log category to text
+ */
+const tchar* appLogCategoryToText( ELogCategory InLogCategory )
+{
+	return GLogCategoryNames[ ( uint32 )InLogCategory ];
+}
+
+/**
+ * Constructor
+ */
+CBaseLogger::CBaseLogger()
+	: records( nullptr )
+	, enqueuePosition( 0 )
+	, dequeuePosition( 0 )
+	, numDroppedRecords( 0 )
+	, isWriterRunning( 0 )
+	, isWriterWaiting( 0 )
+	, writerThreadId( 0 )
+	, writerThread( nullptr )
+	, eventNewRecords( nullptr )
+{
+	for ( uint32 index = 0; index < LC_Num; ++index )
+	{
+		verbosity[ index ] = LT_Log;
+	}
+}
+
+/**
+ * Destructor
+ */
+CBaseLogger::~CBaseLogger()
+{
+	check( !writerThread );
+	delete[] records;
+}
+
+/**
+ * Initialize logger
+ */
+void CBaseLogger::Init()
+{
+#if !NO_LOGGING
+	// Load verbosity of categories from config, e.g. "Shader": "Warning"
+	const CConfigValue*		configVerbosity = GConfig.FindValue( CT_Engine, TEXT( "Engine.Logger" ), TEXT( "Verbosity" ) );
+	if ( configVerbosity && configVerbosity->IsA( CConfigValue::T_Object ) )
+	{
+		CConfigObject		configObject = configVerbosity->GetObject();
+		for ( uint32 category = 0; category < LC_Num; ++category )
+		{
+			const CConfigValue*		configValue = configObject.FindValue( GLogCategoryNames[ category ] );
+			if ( !configValue )
+			{
+				continue;
+			}
+
+			std::wstring		typeName = configValue->GetString();
+			for ( uint32 type = 0; type < ARRAY_COUNT( GLogTypeNames ); ++type )
+			{
+				if ( typeName == GLogTypeNames[ type ] )
+				{
+					verbosity[ category ] = ( ELogType )type;
+					break;
+				}
+			}
+		}
+	}
+
+	// Start writer thread
+	check( !writerThread );
+	if ( !records )
+	{
+		records = new SLogRecord[ LOG_QUEUE_SIZE ];
+	}
+
+	for ( uint32 index = 0; index < LOG_QUEUE_SIZE; ++index )
+	{
+		records[ index ].sequence		= index;
+		records[ index ].longMessage	= nullptr;
+	}
+	enqueuePosition		= 0;
+	dequeuePosition		= 0;
+	eventNewRecords		= GSynchronizeFactory->CreateSynchEvent();
+	isWriterRunning		= 1;
+	writerThread		= GThreadFactory->CreateThread( new CLogWriterRunnable( this ), TEXT( "LogWriterThread" ), false, true, 0, TP_BelowNormal );
+	if ( !writerThread )
+	{
+		isWriterRunning = 0;
+		GSynchronizeFactory->Destroy( eventNewRecords );
+		eventNewRecords = nullptr;
+	}
+#endif // !NO_LOGGING
+}
+
+/**
+ * Closes output device and cleans up
+ */
+void CBaseLogger::TearDown()
+{
+	if ( !writerThread )
+	{
+		return;
+	}
+
+	// Writer thread writes all messages in queue before exit
+	appInterlockedExchange( &isWriterRunning, 0 );
+	eventNewRecords->Trigger();
+	writerThread->WaitForCompletion();
+	GThreadFactory->Destroy( writerThread );
+	writerThread = nullptr;
+	writerThreadId = 0;
+
+	// Messages can be added while writer thread was stopping
+	ProcessRecords();
+
+	GSynchronizeFactory->Destroy( eventNewRecords );
+	eventNewRecords = nullptr;
+}
+
+/**
+ * Flush of output device
+ */
+void CBaseLogger::Flush()
+{
+	if ( !isWriterRunning || appGetCurrentThreadId() == writerThreadId )
+	{
+		return;
+	}
+
+	uint32		position = ( uint32 )enqueuePosition;
+	eventNewRecords->Trigger();
+	while ( isWriterRunning && ( int32 )( ( uint32 )dequeuePosition - position ) < 0 )
+	{
+		appSleep( 0.f );
+	}
+}
+
 /**
  * Print message to output device
  */
@@ -36,7 +279,180 @@ void CBaseLogger::Logf( ELogType InLogType, ELogCategory InLogCategory, const tc
 #if !NO_LOGGING
 	va_list			arguments;
 	va_start( arguments, InMessage );
-    Serialize( CString::Format( InMessage, arguments ).c_str(), InLogType, InLogCategory );  
+	Logv( LC_Default, InLogType, InLogCategory, InMessage, arguments );
+	va_end( arguments );
+#endif // !NO_LOGGING
+}
+
+/**
+ * Print message with color to output device
+ */
+void CBaseLogger::LogColorf( ELogColor InLogColor, ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, ... )
+{
+#if !NO_LOGGING
+	va_list			arguments;
+	va_start( arguments, InMessage );
+	Logv( InLogColor, InLogType, InLogCategory, InMessage, arguments );
 	va_end( arguments );
 #endif // !NO_LOGGING
-}
\ No newline at end of file
+}
+
+/**
+ * Print message to output device
+ */
+void CBaseLogger::Logv( ELogColor InLogColor, ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, va_list InArguments )
+{
+	if ( !IsLogEnabled( InLogType, InLogCategory ) )
+	{
+		return;
+	}
+
+	// Time of message is taken here, writer thread can write it much later
+	double			time = appSeconds() - GStartTime;
+
+	// Before start and after stop of writer thread messages are written immediately
+	if ( !isWriterRunning )
+	{
+		CScopeLock		scopeLock( csDevice );
+		WriteMessage( InLogColor, InLogType, InLogCategory, CString::Format( InMessage, InArguments ).c_str(), time );
+		return;
+	}
+
+	uint32			position	= 0;
+	SLogRecord*		record		= AllocateRecord( InLogType, position );
+	if ( !record )
+	{
+		appInterlockedIncrement( &numDroppedRecords );
+		return;
+	}
+
+	// Arguments can point to temporary strings, so message is formatted here. Most of messages fit in record without allocations
+	va_list			arguments;
+	const tchar*	format = InMessage;
+	va_copy( arguments, InArguments );
+	int32			length = appGetVarArgs( record->message, LOG_RECORD_MESSAGE_LENGTH, LOG_RECORD_MESSAGE_LENGTH - 1, format, arguments );
+	va_end( arguments );
+	if ( length < 0 || length >= LOG_RECORD_MESSAGE_LENGTH )
+	{
+		record->message[ 0 ]	= TEXT( '\0' );
+		record->longMessage		= new std::wstring( CString::Format( InMessage, InArguments ) );
+	}
+	else
+	{
+		record->message[ length ] = TEXT( '\0' );
+	}
+
+	record->logType		= InLogType;
+	record->logCategory	= InLogCategory;
+	record->logColor	= InLogColor;
+	record->time		= time;
+
+	// Publish record to writer thread
+	appInterlockedExchange( &record->sequence, ( int32 )( position + 1 ) );
+	WakeWriter();
+
+	// Errors must be written before possible crash
+	if ( InLogType == LT_Error )
+	{
+		Flush();
+	}
+}
+
+/**
+ * Allocate record in log queue
+ */
+CBaseLogger::SLogRecord* CBaseLogger::AllocateRecord( ELogType InLogType, uint32& OutPosition )
+{
+	// Only messages with type LT_Log can be dropped, warnings and errors wait for free record.
+	// Writer thread can't wait for itself
+	bool		bCanWait = InLogType != LT_Log && appGetCurrentThreadId() != writerThreadId;
+	uint32		position = ( uint32 )enqueuePosition;
+	for ( ; ; )
+	{
+		SLogRecord*		record		= &records[ position & ( LOG_QUEUE_SIZE - 1 ) ];
+		int32			difference	= ( int32 )( ( uint32 )record->sequence - position );
+		if ( difference == 0 )
+		{
+			uint32		oldPosition = ( uint32 )appInterlockedCompareExchange( &enqueuePosition, ( int32 )( position + 1 ), ( int32 )position );
+			if ( oldPosition == position )
+			{
+				OutPosition = position;
+				return record;
+			}
+			position = oldPosition;
+		}
+		else if ( difference < 0 )
+		{
+			// Queue is full
+			if ( !bCanWait )
+			{
+				return nullptr;
+			}
+
+			WakeWriter();
+			appSleep( 0.f );
+			position = ( uint32 )enqueuePosition;
+		}
+		else
+		{
+			position = ( uint32 )enqueuePosition;
+		}
+	}
+}
+
+/**
+ * Write messages from queue to output device
+ */
+bool CBaseLogger::ProcessRecords()
+{
+	bool		bWritten = false;
+	for ( ; ; )
+	{
+		uint32			position	= ( uint32 )dequeuePosition;
+		SLogRecord&		record		= records[ position & ( LOG_QUEUE_SIZE - 1 ) ];
+		if ( ( int32 )( ( uint32 )record.sequence - ( position + 1 ) ) < 0 )
+		{
+			break;
+		}
+
+		{
+			CScopeLock		scopeLock( csDevice );
+			WriteMessage( record.logColor, record.logType, record.logCategory, record.longMessage ? record.longMessage->c_str() : record.message, record.time );
+		}
+
+		delete record.longMessage;
+		record.longMessage = nullptr;
+
+		// Return record to producers
+		appInterlockedExchange( &record.sequence, ( int32 )( position + LOG_QUEUE_SIZE ) );
+		appInterlockedIncrement( &dequeuePosition );
+		bWritten = true;
+	}
+
+	int32		numDropped = numDroppedRecords ? appInterlockedExchange( &numDroppedRecords, 0 ) : 0;
+	if ( numDropped > 0 )
+	{
+		CScopeLock		scopeLock( csDevice );
+		WriteMessage( LC_Default, LT_Warning, LC_General, CString::Format( TEXT( "Log queue is full, %i messages were dropped" ), numDropped ).c_str(), appSeconds() - GStartTime );
+	}
+
+	return bWritten;
+}
+
+/**
+ * Write message to output device
+ */
+void CBaseLogger::WriteMessage( ELogColor InLogColor, ELogType InLogType, ELogCategory InLogCategory, const tchar* InMessage, double InTime )
+{
+	if ( InLogColor != LC_Default )
+	{
+		SetTextColor( InLogColor );
+	}
+
+	Serialize( InMessage, InLogType, InLogCategory, InTime );
+
+	if ( InLogColor != LC_Default )
+	{
+		ResetTextColor();
+	}
+}
@@ -1,7 +1,50 @@
+#include <unordered_map>
+
 #include "Misc/Class.h"
 
-// ----------------
-// STATIC VALUES
-// ----------------
+/**
+ * Registry of classes
+ */
+struct SClassRegistry
+{
+	std::vector<CClass*>										classes;		/**< Array of classes, index in array is class index */
+	std::unordered_map<CName, uint32, CName::SHashFunction>		classesMap;		/**< Map of class name to class index */
+};
+
+/**
+ * Get registry of classes
+ * @note Classes are registered from static constructors, so registry is created on first use
+ */
+static SClassRegistry& GetClassRegistry()
+{
+	static SClassRegistry		classRegistry;
+	return classRegistry;
+}
+
+void CClass::StaticRegisterClass( CClass* InClass )
+{
+	check( InClass && InClass->classIndex == INDEX_NONE );
+	SClassRegistry&		classRegistry = GetClassRegistry();
+	checkMsg( classRegistry.classesMap.find( InClass->cname ) == classRegistry.classesMap.end(), TEXT( "Class %s already registered" ), InClass->name.c_str() );
+
+	InClass->classIndex = ( uint32 )classRegistry.classes.size();
+	classRegistry.classes.push_back( InClass );
+	classRegistry.classesMap.insert( std::make_pair( InClass->cname, InClass->classIndex ) );
+}
+
+CClass* CClass::StaticFindClass( const CName& InClassName )
+{
+	const SClassRegistry&		classRegistry = GetClassRegistry();
+	auto						itClass = classRegistry.classesMap.find( InClassName );
+	if ( itClass == classRegistry.classesMap.end() )
+	{
+		return nullptr;
+	}
+
+	return classRegistry.classes[itClass->second];
+}
 
-std::unordered_map< std::wstring, const CClass* >			CClass::classesTable;
\ No newline at end of file
+const std::vector<CClass*>& CClass::StaticGetRegisteredClasses()
+{
+	return GetClassRegistry().classes;
+}
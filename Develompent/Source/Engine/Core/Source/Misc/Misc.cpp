@@ -4,15 +4,26 @@
 #include "Misc/Misc.h"
 #include "System/Archive.h"
 
-static bool appCompressMemoryZLIB( void* InCompressedBuffer, uint32& InOutCompressedSize, const void* InUncompressedBuffer, uint32 InUncompressedSize )
+static bool appCompressMemoryZLIB( ECompressionFlags InFlags, void* InCompressedBuffer, uint32& InOutCompressedSize, const void* InUncompressedBuffer, uint32 InUncompressedSize )
 {
 	// Zlib wants to use unsigned long.
 	unsigned long		zCompressedSize = InOutCompressedSize;
 	unsigned long		zUncompressedSize = InUncompressedSize;
 
+	// Select level of compression
+	int32				level = Z_DEFAULT_COMPRESSION;
+	if ( InFlags & CF_BiasSpeed )
+	{
+		level = Z_BEST_SPEED;
+	}
+	else if ( InFlags & CF_BiasSize )
+	{
+		level = Z_BEST_COMPRESSION;
+	}
+
 	// Compress data
-	bool		operationSucceeded = compress( ( byte* )InCompressedBuffer, &zCompressedSize, ( const byte* )InUncompressedBuffer, zUncompressedSize ) == Z_OK ? TRUE : FALSE;
-	
+	bool		operationSucceeded = compress2( ( byte* )InCompressedBuffer, &zCompressedSize, ( const byte* )InUncompressedBuffer, zUncompressedSize, level ) == Z_OK ? TRUE : FALSE;
+
 	// Propagate compressed size from intermediate variable back into out variable.
 	InOutCompressedSize = zCompressedSize;
 	return operationSucceeded;
@@ -34,14 +45,13 @@ static bool appUncompressMemoryZLIB( void* InUncompressedBuffer, uint32 InUncomp
 
 bool appCompressMemory( ECompressionFlags InFlags, void* InCompressedBuffer, uint32& InOutCompressedSize, const void* InUncompressedBuffer, uint32 InUncompressedSize )
 {
-	// Make sure a valid compression scheme was provided
-	check( InFlags | CF_ZLIB );
 	bool		compressSucceeded = false;
 
-	switch ( InFlags )
+	// Make sure a valid compression scheme was provided
+	switch ( InFlags & CF_CodecMask )
 	{
 	case CF_ZLIB:
-		compressSucceeded = appCompressMemoryZLIB( InCompressedBuffer, InOutCompressedSize, InUncompressedBuffer, InUncompressedSize );
+		compressSucceeded = appCompressMemoryZLIB( InFlags, InCompressedBuffer, InOutCompressedSize, InUncompressedBuffer, InUncompressedSize );
 		break;
 
 	default:
@@ -55,11 +65,10 @@ bool appCompressMemory( ECompressionFlags InFlags, void* InCompressedBuffer, uin
 
 bool appUncompressMemory( ECompressionFlags InFlags, void* InUncompressedBuffer, uint32 InUncompressedSize, const void* InCompressedBuffer, uint32 InCompressedSize )
 {
-	// Make sure a valid compression scheme was provided
-	check( InFlags | CF_ZLIB );
 	bool		uncompressSucceeded = false;
 
-	switch ( InFlags )
+	// Make sure a valid compression scheme was provided
+	switch ( InFlags & CF_CodecMask )
 	{
 	case CF_ZLIB:
 		uncompressSucceeded = appUncompressMemoryZLIB( InUncompressedBuffer, InUncompressedSize, InCompressedBuffer, InCompressedSize );
@@ -72,4 +81,13 @@ bool appUncompressMemory( ECompressionFlags InFlags, void* InUncompressedBuffer,
 	}
 
 	return uncompressSucceeded;
-}
\ No newline at end of file
+}
+
+uint32 appCompressMemoryBound( ECompressionFlags InFlags, uint32 InUncompressedSize )
+{
+	switch ( InFlags & CF_CodecMask )
+	{
+	case CF_ZLIB:	return compressBound( InUncompressedSize );
+	default:		return InUncompressedSize * 2;
+	}
+}
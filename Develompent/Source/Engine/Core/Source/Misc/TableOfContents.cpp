@@ -1,54 +1,364 @@
-#include <sstream>
-
 #include "Misc/CoreGlobals.h"
 #include "Misc/TableOfContents.h"
 #include "Logger/LoggerMacros.h"
-#include "Containers/StringConv.h"
 #include "System/Package.h"
 
+/**
+ * Magic number of binary table of contents ('LTOC')
+ */
+#define TOC_MAGIC		0x434F544C
+
+/**
+ * Version of binary table of contents
+ */
+#define TOC_VERSION		1
+
+/**
+ * Calculate hash of GUID for binary table
+ * @note Hash is stored in file, so it must not depend from other hash functions of engine
+ * 
+ * @param InGUID	GUID
+ * @return Return hash of GUID
+ */
+static FORCEINLINE uint32 TOCHashGuid( const uint32* InGUID )
+{
+	uint32		hash = 0;
+	for ( uint32 index = 0; index < 4; ++index )
+	{
+		hash = ( hash ^ InGUID[ index ] ) * 0x9E3779B1;
+		hash ^= hash >> 15;
+	}
+	return hash;
+}
+
+/**
+ * Calculate hash of package name for binary table (FNV-1a)
+ * @note Hash is stored in file, so it must not depend from other hash functions of engine
+ * 
+ * @param InName	Name of package
+ * @return Return hash of name
+ */
+static FORCEINLINE uint32 TOCHashName( const std::wstring& InName )
+{
+	uint32		hash = 0x811C9DC5;
+	for ( uint32 index = 0, count = InName.size(); index < count; ++index )
+	{
+		uint16		ch = ( uint16 )InName[ index ];
+		hash = ( hash ^ ( ch & 0xFF ) ) * 0x01000193;
+		hash = ( hash ^ ( ch >> 8 ) ) * 0x01000193;
+	}
+	return hash;
+}
+
+CTableOfContets::CTableOfContets()
+	: binaryHeader( nullptr )
+	, binaryEntries( nullptr )
+	, binaryGuidBuckets( nullptr )
+	, binaryNameBuckets( nullptr )
+	, binaryNameIndices( nullptr )
+	, binaryStrings( nullptr )
+{}
+
+bool CTableOfContets::Load( const std::wstring& InPath )
+{
+	MappedFileRef_t		file = GFileSystem->MapFile( InPath );
+	if ( !file.IsValid() )
+	{
+		return false;
+	}
+
+	CScopeLock		scopeLock( cs );
+	Clear();
+	if ( file->GetSize() > 0xFFFFFFFFull || !SetBinaryTable( file->GetData(), ( uint32 )file->GetSize() ) )
+	{
+		LE_LOG( LT_Warning, LC_Package, TEXT( "Table of contents '%s' is corrupted or has unsupported version" ), InPath.c_str() );
+		return false;
+	}
+
+	mappedFile = file;
+	return true;
+}
+
 void CTableOfContets::Serialize( CArchive& InArchive )
 {
+	CScopeLock		scopeLock( cs );
 	if ( InArchive.IsLoading() )
 	{
-		// Create string buffer and fill '\0'
-		uint32				archiveSize = InArchive.GetSize() + 1;
-		byte* buffer = new byte[ archiveSize ];
-		memset( buffer, '\0', archiveSize );
+		Clear();
+		binaryData.resize( InArchive.GetSize() );
+		InArchive.Serialize( binaryData.data(), binaryData.size() );
+		if ( !SetBinaryTable( binaryData.data(), binaryData.size() ) )
+		{
+			LE_LOG( LT_Warning, LC_Package, TEXT( "Table of contents '%s' is corrupted or has unsupported version" ), InArchive.GetPath().c_str() );
+			binaryData.clear();
+		}
+	}
+	else
+	{
+		MakeEditable();
+
+		// Calculate size of strings and number of buckets
+		uint32		numEntries = guidEntries.size();
+		uint32		numBuckets = 1;
+		uint32		numChars = 0;
+		while ( numBuckets < numEntries )
+		{
+			numBuckets <<= 1;
+		}
+
+		for ( auto itEntry = guidEntries.begin(), itEntryEnd = guidEntries.end(); itEntry != itEntryEnd; ++itEntry )
+		{
+			numChars += itEntry->second.name.size() + itEntry->second.path.size();
+		}
+
+		// Calculate layout of table
+		STOCBinaryHeader		header;
+		header.magic				= TOC_MAGIC;
+		header.version				= TOC_VERSION;
+		header.numEntries			= numEntries;
+		header.numBuckets			= numBuckets;
+		header.entriesOffset		= sizeof( STOCBinaryHeader );
+		header.guidBucketsOffset	= header.entriesOffset + numEntries * sizeof( STOCBinaryEntry );
+		header.nameBucketsOffset	= header.guidBucketsOffset + ( numBuckets + 1 ) * sizeof( uint32 );
+		header.nameIndicesOffset	= header.nameBucketsOffset + ( numBuckets + 1 ) * sizeof( uint32 );
+		header.stringsOffset		= header.nameIndicesOffset + numEntries * sizeof( uint32 );
+		header.numChars				= numChars;
 
-		// Serialize data to string buffer
-		InArchive.Serialize( buffer, archiveSize );
+		std::vector< byte >		data( header.stringsOffset + numChars * sizeof( uint16 ), 0 );
+		memcpy( data.data(), &header, sizeof( STOCBinaryHeader ) );
+		STOCBinaryEntry*		entries = ( STOCBinaryEntry* )( data.data() + header.entriesOffset );
+		uint32*					guidBuckets = ( uint32* )( data.data() + header.guidBucketsOffset );
+		uint32*					nameBuckets = ( uint32* )( data.data() + header.nameBucketsOffset );
+		uint32*					nameIndices = ( uint32* )( data.data() + header.nameIndicesOffset );
+		uint16*					strings = ( uint16* )( data.data() + header.stringsOffset );
+
+		// Count entries in every bucket
+		for ( auto itEntry = guidEntries.begin(), itEntryEnd = guidEntries.end(); itEntry != itEntryEnd; ++itEntry )
+		{
+			uint32		guid[4] = { itEntry->first[0], itEntry->first[1], itEntry->first[2], itEntry->first[3] };
+			++guidBuckets[ ( TOCHashGuid( guid ) & ( numBuckets - 1 ) ) + 1 ];
+			++nameBuckets[ ( TOCHashName( itEntry->second.name ) & ( numBuckets - 1 ) ) + 1 ];
+		}
 
-		// Parse table of content
-		std::stringstream		strStream( ( char* )buffer );
-		std::string				strGuid;
-		std::string				strName;
-		std::string				strPath;
+		for ( uint32 index = 0; index < numBuckets; ++index )
+		{
+			guidBuckets[ index + 1 ] += guidBuckets[ index ];
+			nameBuckets[ index + 1 ] += nameBuckets[ index ];
+		}
 
-		while ( strStream >> strGuid >> strName >> strPath )
+		// Fill entries, strings and indices of name table
+		std::vector< uint32 >	guidCursors( guidBuckets, guidBuckets + numBuckets );
+		std::vector< uint32 >	nameCursors( nameBuckets, nameBuckets + numBuckets );
+		uint32					charOffset = 0;
+		for ( auto itEntry = guidEntries.begin(), itEntryEnd = guidEntries.end(); itEntry != itEntryEnd; ++itEntry )
 		{
-			// Add content to table
-			CGuid			guid;
-			if ( !guid.InitFromString( ANSI_TO_TCHAR( strGuid.c_str() ) ) )
-			{ 
-				LE_LOG( LT_Warning, LC_Package, TEXT( "Failed init GUID for content '%s'" ), ANSI_TO_TCHAR( strPath.c_str() ) );
-				continue;
+			const STOCEntry&	tocEntry = itEntry->second;
+			uint32				guid[4] = { itEntry->first[0], itEntry->first[1], itEntry->first[2], itEntry->first[3] };
+			uint32				nameHash = TOCHashName( tocEntry.name );
+			uint32				entryIndex = guidCursors[ TOCHashGuid( guid ) & ( numBuckets - 1 ) ]++;
+			STOCBinaryEntry&	entry = entries[ entryIndex ];
+
+			memcpy( entry.guid, guid, sizeof( guid ) );
+			entry.nameHash		= nameHash;
+			entry.nameOffset	= charOffset;
+			entry.nameLength	= tocEntry.name.size();
+			for ( uint32 index = 0; index < entry.nameLength; ++index )
+			{
+				strings[ charOffset++ ] = ( uint16 )tocEntry.name[ index ];
 			}
 
-			AddEntry( guid, ANSI_TO_TCHAR( strName.c_str() ), ANSI_TO_TCHAR( strPath.c_str() ) );
+			entry.pathOffset	= charOffset;
+			entry.pathLength	= tocEntry.path.size();
+			for ( uint32 index = 0; index < entry.pathLength; ++index )
+			{
+				strings[ charOffset++ ] = ( uint16 )tocEntry.path[ index ];
+			}
+
+			nameIndices[ nameCursors[ nameHash & ( numBuckets - 1 ) ]++ ] = entryIndex;
 		}
 
-		delete[] buffer;
+		InArchive.Serialize( data.data(), data.size() );
 	}
-	else
+}
+
+bool CTableOfContets::SetBinaryTable( const byte* InData, uint32 InSize )
+{
+	ResetBinaryTable();
+	if ( !InData || InSize < sizeof( STOCBinaryHeader ) )
 	{
-		for ( auto itEntry = guidEntries.begin(), itEntryEnd = guidEntries.end(); itEntry != itEntryEnd; ++itEntry )
+		return false;
+	}
+
+	// Check header and that all parts of table are inside of data
+	const STOCBinaryHeader*		header = ( const STOCBinaryHeader* )InData;
+	if ( header->magic != TOC_MAGIC || header->version != TOC_VERSION ||
+		 header->numBuckets == 0 || ( header->numBuckets & ( header->numBuckets - 1 ) ) != 0 ||
+		 header->entriesOffset != sizeof( STOCBinaryHeader ) ||
+		 ( uint64 )header->entriesOffset + ( uint64 )header->numEntries * sizeof( STOCBinaryEntry ) > header->guidBucketsOffset ||
+		 ( uint64 )header->guidBucketsOffset + ( ( uint64 )header->numBuckets + 1 ) * sizeof( uint32 ) > header->nameBucketsOffset ||
+		 ( uint64 )header->nameBucketsOffset + ( ( uint64 )header->numBuckets + 1 ) * sizeof( uint32 ) > header->nameIndicesOffset ||
+		 ( uint64 )header->nameIndicesOffset + ( uint64 )header->numEntries * sizeof( uint32 ) > header->stringsOffset ||
+		 ( uint64 )header->stringsOffset + ( uint64 )header->numChars * sizeof( uint16 ) > InSize ||
+		 ( header->guidBucketsOffset | header->nameBucketsOffset | header->nameIndicesOffset | header->stringsOffset ) % sizeof( uint32 ) != 0 )
+	{
+		return false;
+	}
+
+	const STOCBinaryEntry*		entries		= ( const STOCBinaryEntry* )( InData + header->entriesOffset );
+	const uint32*				guidBuckets	= ( const uint32* )( InData + header->guidBucketsOffset );
+	const uint32*				nameBuckets	= ( const uint32* )( InData + header->nameBucketsOffset );
+	const uint32*				nameIndices	= ( const uint32* )( InData + header->nameIndicesOffset );
+
+	// Lookups trust to buckets and indices, so check them once here
+	if ( guidBuckets[ header->numBuckets ] != header->numEntries || nameBuckets[ header->numBuckets ] != header->numEntries )
+	{
+		return false;
+	}
+
+	for ( uint32 index = 0; index < header->numBuckets; ++index )
+	{
+		if ( guidBuckets[ index ] > guidBuckets[ index + 1 ] || nameBuckets[ index ] > nameBuckets[ index + 1 ] )
 		{
-			const STOCEntry&		tocEntry = itEntry->second;
+			return false;
+		}
+	}
 
-			//						GUID													Name										Path to content
-			InArchive << TCHAR_TO_ANSI( itEntry->first.String().c_str() ) << " " << TCHAR_TO_ANSI( tocEntry.name.c_str() ) << " " << TCHAR_TO_ANSI( tocEntry.path.c_str() ) << "\n";
+	for ( uint32 index = 0; index < header->numEntries; ++index )
+	{
+		const STOCBinaryEntry&		entry = entries[ index ];
+		if ( nameIndices[ index ] >= header->numEntries ||
+			 ( uint64 )entry.nameOffset + entry.nameLength > header->numChars ||
+			 ( uint64 )entry.pathOffset + entry.pathLength > header->numChars )
+		{
+			return false;
+		}
+	}
+
+	binaryHeader		= header;
+	binaryEntries		= entries;
+	binaryGuidBuckets	= guidBuckets;
+	binaryNameBuckets	= nameBuckets;
+	binaryNameIndices	= nameIndices;
+	binaryStrings		= ( const uint16* )( InData + header->stringsOffset );
+	return true;
+}
+
+void CTableOfContets::ResetBinaryTable()
+{
+	binaryHeader		= nullptr;
+	binaryEntries		= nullptr;
+	binaryGuidBuckets	= nullptr;
+	binaryNameBuckets	= nullptr;
+	binaryNameIndices	= nullptr;
+	binaryStrings		= nullptr;
+	mappedFile			= nullptr;
+	binaryData.clear();
+	binaryData.shrink_to_fit();
+}
+
+void CTableOfContets::MakeEditable()
+{
+	if ( !binaryHeader )
+	{
+		return;
+	}
+
+	for ( uint32 index = 0, count = binaryHeader->numEntries; index < count; ++index )
+	{
+		const STOCBinaryEntry&		entry = binaryEntries[ index ];
+		CGuid						guid( entry.guid[0], entry.guid[1], entry.guid[2], entry.guid[3] );
+		std::wstring				name = GetBinaryString( entry.nameOffset, entry.nameLength );
+		std::wstring				path = GetBinaryString( entry.pathOffset, entry.pathLength );
+		nameEntries.insert( std::make_pair( name, STOCEntry{ name, path } ) );
+		guidEntries.insert( std::make_pair( guid, STOCEntry{ name, path } ) );
+	}
+	ResetBinaryTable();
+}
+
+std::wstring CTableOfContets::GetBinaryString( uint32 InOffset, uint32 InLength ) const
+{
+	std::wstring		result;
+	result.resize( InLength );
+	for ( uint32 index = 0; index < InLength; ++index )
+	{
+		result[ index ] = ( tchar )binaryStrings[ InOffset + index ];
+	}
+	return result;
+}
+
+const CTableOfContets::STOCBinaryEntry* CTableOfContets::FindBinaryEntry( const CGuid& InGUID ) const
+{
+	if ( !binaryHeader )
+	{
+		return nullptr;
+	}
+
+	uint32		guid[4] = { InGUID[0], InGUID[1], InGUID[2], InGUID[3] };
+	uint32		bucket = TOCHashGuid( guid ) & ( binaryHeader->numBuckets - 1 );
+	for ( uint32 index = binaryGuidBuckets[ bucket ], end = binaryGuidBuckets[ bucket + 1 ]; index < end; ++index )
+	{
+		const STOCBinaryEntry&		entry = binaryEntries[ index ];
+		if ( !memcmp( entry.guid, guid, sizeof( guid ) ) )
+		{
+			return &entry;
 		}
 	}
+	return nullptr;
+}
+
+std::wstring CTableOfContets::GetPackagePath( const CGuid& InGUID ) const
+{
+	CScopeLock		scopeLock( cs );
+
+	// Runtime entries have priority over binary table
+	auto	itEntry = guidEntries.find( InGUID );
+	if ( itEntry != guidEntries.end() )
+	{
+		return itEntry->second.path;
+	}
+
+	const STOCBinaryEntry*		entry = FindBinaryEntry( InGUID );
+	return entry ? GetBinaryString( entry->pathOffset, entry->pathLength ) : TEXT( "" );
+}
+
+std::wstring CTableOfContets::GetPackagePath( const std::wstring& InName ) const
+{
+	CScopeLock		scopeLock( cs );
+
+	// Runtime entries have priority over binary table
+	auto	itEntry = nameEntries.find( InName );
+	if ( itEntry != nameEntries.end() )
+	{
+		return itEntry->second.path;
+	}
+
+	if ( !binaryHeader )
+	{
+		return TEXT( "" );
+	}
+
+	uint32		nameHash = TOCHashName( InName );
+	uint32		bucket = nameHash & ( binaryHeader->numBuckets - 1 );
+	for ( uint32 index = binaryNameBuckets[ bucket ], end = binaryNameBuckets[ bucket + 1 ]; index < end; ++index )
+	{
+		const STOCBinaryEntry&		entry = binaryEntries[ binaryNameIndices[ index ] ];
+		if ( entry.nameHash != nameHash || entry.nameLength != InName.size() )
+		{
+			continue;
+		}
+
+		bool		bEqual = true;
+		for ( uint32 charIndex = 0; charIndex < entry.nameLength && bEqual; ++charIndex )
+		{
+			bEqual = binaryStrings[ entry.nameOffset + charIndex ] == ( uint16 )InName[ charIndex ];
+		}
+
+		if ( bEqual )
+		{
+			return GetBinaryString( entry.pathOffset, entry.pathLength );
+		}
+	}
+	return TEXT( "" );
 }
 
 void CTableOfContets::AddEntry( const std::wstring& InPath )
@@ -61,6 +371,22 @@ void CTableOfContets::AddEntry( const std::wstring& InPath )
 	}
 }
 
+void CTableOfContets::AddEntry( const CGuid& InGUID, const std::wstring& InName, const std::wstring& InPath )
+{
+	CScopeLock		scopeLock( cs );
+
+	// Package which is already in binary table with the same path doesn't need an entry,
+	// so loading of cooked packages doesn't unpack the whole table
+	const STOCBinaryEntry*		binaryEntry = FindBinaryEntry( InGUID );
+	if ( binaryEntry && GetBinaryString( binaryEntry->pathOffset, binaryEntry->pathLength ) == InPath )
+	{
+		return;
+	}
+
+	nameEntries.insert( std::make_pair( InName, STOCEntry{ InName, InPath } ) );
+	guidEntries.insert( std::make_pair( InGUID, STOCEntry{ InName, InPath } ) );
+}
+
 void CTableOfContets::RemoveEntry( const std::wstring& InPath )
 {
 	PackageRef_t		package = GPackageManager->LoadPackage( InPath );
@@ -69,4 +395,4 @@ void CTableOfContets::RemoveEntry( const std::wstring& InPath )
 		RemoveEntry( package->GetGUID() );
 		GPackageManager->UnloadPackage( InPath );
 	}
-}
\ No newline at end of file
+}
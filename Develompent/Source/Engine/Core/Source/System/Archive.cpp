@@ -1,6 +1,7 @@
 #include "System/Archive.h"
 #include "Misc/Template.h"
 #include "LEVersion.h"
+#include "System/ThreadPool.h"
 
 CArchive::CArchive( const std::wstring& InPath )
 	: arVer( VER_PACKAGE_LATEST )
@@ -35,115 +36,110 @@ void CArchive::SerializeCompressed( void* InBuffer, uint32 InSize, ECompressionF
 		SCompressedChunkInfo		summary;
 		*this << summary;
 
+		// Since VER_CompressionCodecs flags of compression stored in archive, before it was only ZLIB
+		ECompressionFlags			flags = CF_ZLIB;
+		if ( arVer >= VER_CompressionCodecs )
+		{
+			uint32		storedFlags = CF_None;
+			*this << storedFlags;
+			flags = ( ECompressionFlags )storedFlags;
+		}
+		checkMsg( ( flags & CF_CodecMask ) == CF_ZLIB, TEXT( "Compression codec 0x%X of '%s' isn't supported" ), flags & CF_CodecMask, arPath.c_str() );
+
 		// Handle change in compression chunk size in backward compatible way
 		uint32			loadingCompressionChunkSize = LOADING_COMPRESSION_CHUNK_SIZE;
 
 		// Figure out how many chunks there are going to be based on uncompressed size and compression chunk size.
-		uint32	totalChunkCount = ( summary.uncompressedSize + loadingCompressionChunkSize - 1 ) / loadingCompressionChunkSize;
+		uint32			totalChunkCount = ( summary.uncompressedSize + loadingCompressionChunkSize - 1 ) / loadingCompressionChunkSize;
 
-		// Allocate compression chunk infos and serialize them, keeping track of max size of compression chunks used.
-		SCompressedChunkInfo*	compressionChunks = new SCompressedChunkInfo[ totalChunkCount ];
-		uint32					maxCompressedSize = 0;
+		// Serialize compression chunk infos
+		std::vector<SCompressedChunkInfo>		compressionChunks( totalChunkCount );
 		for ( uint32 chunkIndex = 0; chunkIndex < totalChunkCount; chunkIndex++ )
 		{
 			*this << compressionChunks[ chunkIndex ];
-			maxCompressedSize = Max( compressionChunks[ chunkIndex ].compressedSize, maxCompressedSize );
 		}
 
-		// Set up destination pointer and allocate memory for compressed chunk[s] (one at a time).
-		byte*			dest = ( byte* )InBuffer;
-		void*			compressedBuffer = malloc( maxCompressedSize );
+		// Read all compressed chunks at once into scratch buffer
+		compressedScratch.resize( summary.compressedSize );
+		Serialize( compressedScratch.data(), summary.compressedSize );
 
-		// Iterate over all chunks, serialize them into memory and decompress them directly into the destination pointer
-		for ( uint32 chunkIndex = 0; chunkIndex < totalChunkCount; chunkIndex++ )
+		// Calculate offsets of every chunk in compressed and uncompressed data
+		std::vector<uint32>		compressedOffsets( totalChunkCount );
+		std::vector<uint32>		uncompressedOffsets( totalChunkCount );
+		for ( uint32 chunkIndex = 0, compressedOffset = 0, uncompressedOffset = 0; chunkIndex < totalChunkCount; chunkIndex++ )
 		{
-			const SCompressedChunkInfo&			chunk = compressionChunks[ chunkIndex ];
-			
-			// Read compressed data.
-			Serialize( compressedBuffer, chunk.compressedSize );
-			
-			// Decompress into dest pointer directly.
-			bool		result = appUncompressMemory( InFlags, dest, chunk.uncompressedSize, compressedBuffer, chunk.compressedSize );
-			check( result );
-			
-			// And advance it by read amount.
-			dest += chunk.uncompressedSize;
+			compressedOffsets[ chunkIndex ]		= compressedOffset;
+			uncompressedOffsets[ chunkIndex ]	= uncompressedOffset;
+			compressedOffset					+= compressionChunks[ chunkIndex ].compressedSize;
+			uncompressedOffset					+= compressionChunks[ chunkIndex ].uncompressedSize;
 		}
 
-		// Free up allocated memory.
-		free( compressedBuffer );
-		delete[] compressionChunks;
+		// Chunks are independent, so decompress them in parallel directly into the destination pointer
+		byte*			dest = ( byte* )InBuffer;
+		volatile int32	numFailedChunks = 0;
+		appParallelFor( totalChunkCount, [&]( uint32 InChunkIndex )
+						{
+							const SCompressedChunkInfo&		chunk = compressionChunks[ InChunkIndex ];
+							if ( !appUncompressMemory( flags, dest + uncompressedOffsets[ InChunkIndex ], chunk.uncompressedSize, compressedScratch.data() + compressedOffsets[ InChunkIndex ], chunk.compressedSize ) )
+							{
+								appInterlockedIncrement( &numFailedChunks );
+							}
+						} );
+		checkMsg( numFailedChunks == 0, TEXT( "Failed to uncompress %i chunks in '%s'" ), numFailedChunks, arPath.c_str() );
 	}
 	else if ( IsSaving() )
 	{
-		// Figure out how many chunks there are going to be based on uncompressed size and compression chunk size
-		uint32			totalChunkCount = ( InSize + SAVING_COMPRESSION_CHUNK_SIZE - 1 ) / SAVING_COMPRESSION_CHUNK_SIZE + 1;
-
-		// Keep track of current position so we can later seek back and overwrite stub compression chunk infos
-		uint32			startPosition = Tell();
+		// Old archives know only about ZLIB
+		ECompressionFlags		flags = arVer >= VER_CompressionCodecs ? InFlags : ( ECompressionFlags )( ( InFlags & ~CF_CodecMask ) | CF_ZLIB );
+		checkMsg( ( flags & CF_CodecMask ) == CF_ZLIB, TEXT( "Compression codec 0x%X for '%s' isn't supported" ), flags & CF_CodecMask, arPath.c_str() );
 
-		// Allocate compression chunk infos and serialize them so we can later overwrite the data
-		SCompressedChunkInfo*		compressionChunks = new SCompressedChunkInfo[ totalChunkCount ];
-		for ( uint32 chunkIndex = 0; chunkIndex < totalChunkCount; ++chunkIndex )
+		// Figure out how many chunks there are going to be based on uncompressed size and compression chunk size
+		uint32					totalChunkCount = ( InSize + SAVING_COMPRESSION_CHUNK_SIZE - 1 ) / SAVING_COMPRESSION_CHUNK_SIZE;
+		uint32					compressedBound = appCompressMemoryBound( flags, SAVING_COMPRESSION_CHUNK_SIZE );
+		std::vector<SCompressedChunkInfo>		compressionChunks( totalChunkCount );
+		compressedScratch.resize( ( std::size_t )totalChunkCount * compressedBound );
+
+		// Chunks are independent, so compress them in parallel. Every chunk has own region in scratch buffer
+		const byte*		src = ( const byte* )InBuffer;
+		volatile int32	numFailedChunks = 0;
+		appParallelFor( totalChunkCount, [&]( uint32 InChunkIndex )
+						{
+							SCompressedChunkInfo&		chunk = compressionChunks[ InChunkIndex ];
+							uint32						offset = InChunkIndex * SAVING_COMPRESSION_CHUNK_SIZE;
+							chunk.uncompressedSize		= Min<uint32>( InSize - offset, SAVING_COMPRESSION_CHUNK_SIZE );
+							chunk.compressedSize		= compressedBound;
+							if ( !appCompressMemory( flags, compressedScratch.data() + ( std::size_t )InChunkIndex * compressedBound, chunk.compressedSize, src + offset, chunk.uncompressedSize ) )
+							{
+								appInterlockedIncrement( &numFailedChunks );
+							}
+						} );
+		checkMsg( numFailedChunks == 0, TEXT( "Failed to compress %i chunks in '%s'" ), numFailedChunks, arPath.c_str() );
+
+		// Summary keeps total sizes, the uncompressd size is equal to the passed in length
+		SCompressedChunkInfo	summary;
+		summary.uncompressedSize	= InSize;
+		summary.compressedSize		= 0;
+		for ( uint32 chunkIndex = 0; chunkIndex < totalChunkCount; chunkIndex++ )
 		{
-			*this << compressionChunks[ chunkIndex ];
+			summary.compressedSize += compressionChunks[ chunkIndex ].compressedSize;
 		}
-	
-		compressionChunks[ 0 ].uncompressedSize = InSize;		// The uncompressd size is equal to the passed in length
-		compressionChunks[ 0 ].compressedSize = 0;				// Zero initialize compressed size so we can update it during chunk compression
-
-		// Set up source pointer amount of data to copy (in bytes)
-		byte*		src = ( byte* )InBuffer;
 
-		int32		bytesRemaining = InSize;		
-		uint32		currentChunkIndex = 1;												// Start at index 1 as first chunk info is summary.
-		uint32		compressedBufferSize = SAVING_COMPRESSION_CHUNK_SIZE * 2;			// 2 times the uncompressed size should be more than enough; the compressed data shouldn't be that much larger
-		void*		compressedBuffer = malloc( compressedBufferSize );
-
-		while ( bytesRemaining > 0 )
+		// All sizes are known, so write summary and chunk infos before data without seeking back
+		*this << summary;
+		if ( arVer >= VER_CompressionCodecs )
 		{
-			uint32		bytesToCompress = Min( bytesRemaining, SAVING_COMPRESSION_CHUNK_SIZE );
-			uint32		compressedSize = compressedBufferSize;
-
-			bool		result = appCompressMemory( InFlags, compressedBuffer, compressedSize, src, bytesToCompress );
-			check( result );
-
-			// Move to next chunk
-			src += bytesToCompress;
-			Serialize( compressedBuffer, compressedSize );
-
-			// Keep track of total compressed size, stored in first chunk.
-			compressionChunks[ 0 ].compressedSize += compressedSize;
-
-			// Update current chunk.
-			check( currentChunkIndex < totalChunkCount );
-			compressionChunks[ currentChunkIndex ].compressedSize = compressedSize;
-			compressionChunks[ currentChunkIndex ].uncompressedSize = bytesToCompress;
-			currentChunkIndex++;
-
-			bytesRemaining -= SAVING_COMPRESSION_CHUNK_SIZE;
+			uint32		storedFlags = flags;
+			*this << storedFlags;
 		}
 
-		// Free allocated memory.
-		free( compressedBuffer );
-
-		// Overrwrite chunk infos by seeking to the beginning, serializing the data and then
-		// seeking back to the end.
-		uint32			endPosition = Tell();
-		
-		// Seek to the beginning.
-		Seek( startPosition );
-		
-		// Serialize chunk infos.
 		for ( uint32 chunkIndex = 0; chunkIndex < totalChunkCount; chunkIndex++ )
 		{
 			*this << compressionChunks[ chunkIndex ];
 		}
 
-		// Seek back to end.
-		Seek( endPosition );
-
-		// Free intermediate data.
-		delete[] compressionChunks;
+		for ( uint32 chunkIndex = 0; chunkIndex < totalChunkCount; chunkIndex++ )
+		{
+			Serialize( compressedScratch.data() + ( std::size_t )chunkIndex * compressedBound, compressionChunks[ chunkIndex ].compressedSize );
+		}
 	}
 }
\ No newline at end of file
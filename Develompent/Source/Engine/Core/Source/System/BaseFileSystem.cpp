@@ -1,5 +1,8 @@
 #include "Misc/Misc.h"
 #include "System/BaseFileSystem.h"
+#include "System/FileArchive.h"
+#include "System/FileHandleCache.h"
+#include "Logger/LoggerMacros.h"
 
 CFilename::CFilename()
 {}
@@ -153,4 +156,87 @@ bool CBaseFileSystem::DeleteDirectory( const std::wstring& InPath, bool InIsTree
 bool CBaseFileSystem::IsDrive( const std::wstring& InPath ) const
 {
 	return InPath.empty() || InPath == TEXT( "\\" ) || InPath == TEXT( "\\\\" ) || InPath == TEXT( "//" ) || InPath == TEXT( "////" );
-}
\ No newline at end of file
+}
+
+CArchive* CBaseFileSystem::CreateFileReader( const std::wstring& InFileName, uint32 InFlags /* = AR_None */ )
+{
+	FileReadHandleRef_t		handle = OpenReadHandle( InFileName, InFlags );
+	if ( !handle.IsValid() )
+	{
+		return nullptr;
+	}
+
+	return new CFileArchiveReader( handle );
+}
+
+void CBaseFileSystem::InvalidateCachedHandles( const std::wstring& InPath )
+{
+	if ( fileHandleCache )
+	{
+		fileHandleCache->Invalidate( InPath );
+	}
+}
+
+CArchive* CBaseFileSystem::CreateFileWriter( const std::wstring& InFileName, uint32 InFlags /* = AW_None */ )
+{
+	FileWriteHandleRef_t	handle = OpenWriteHandle( InFileName, InFlags );
+	if ( !handle.IsValid() )
+	{
+		return nullptr;
+	}
+
+	return new CFileArchiveWriter( handle, ( InFlags & AW_Append ) != 0 );
+}
+
+/**
+ * Mapped file which is fully read to memory
+ */
+class CMemoryMappedFile : public CMappedFile
+{
+public:
+	/**
+	 * Constructor
+	 */
+	CMemoryMappedFile( const std::wstring& InPath, std::vector<byte>& InData )
+		: CMappedFile( InPath )
+	{
+		data.swap( InData );
+	}
+
+	/**
+	 * Get pointer to data of file
+	 */
+	virtual const byte* GetData() const override
+	{
+		return data.data();
+	}
+
+	/**
+	 * Get size of file
+	 */
+	virtual uint64 GetSize() const override
+	{
+		return data.size();
+	}
+
+private:
+	std::vector<byte>		data;		/**< Data of file */
+};
+
+MappedFileRef_t CBaseFileSystem::MapFile( const std::wstring& InFileName, uint32 InFlags /* = AR_None */ )
+{
+	FileReadHandleRef_t		handle = OpenReadHandle( InFileName, InFlags );
+	if ( !handle.IsValid() )
+	{
+		return nullptr;
+	}
+
+	std::vector<byte>		data( ( std::size_t )handle->GetSize() );
+	if ( handle->ReadAt( data.data(), data.size(), 0 ) != data.size() )
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Failed to read file '%s'" ), InFileName.c_str() );
+		return nullptr;
+	}
+
+	return new CMemoryMappedFile( InFileName, data );
+}
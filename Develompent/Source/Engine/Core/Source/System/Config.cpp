@@ -68,6 +68,9 @@ void CConfigManager::Init()
 
 		configs[( EConfigType )index] = config;
 	}
+
+	// Values are changed, all config handles must be resolved again
+	++generation;
 }
 
 /**
@@ -283,6 +286,20 @@ CConfigValue CConfigObject::GetValue( const tchar* InName ) const
 	return itValue->second;
 }
 
+/**
+ * Find value
+ */
+const CConfigValue* CConfigObject::FindValue( const tchar* InName ) const
+{
+	auto		itValue = values.find( InName );
+	if ( itValue == values.end() )
+	{
+		return nullptr;
+	}
+
+	return &itValue->second;
+}
+
 /**
  * Copy value
  */
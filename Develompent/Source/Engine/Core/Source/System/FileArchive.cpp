@@ -0,0 +1,237 @@
+#include "Misc/Template.h"
+#include "Logger/LoggerMacros.h"
+#include "System/FileArchive.h"
+
+// ====================================
+// File archive reader
+// ====================================
+
+/**
+ * Constructor
+ */
+CFileArchiveReader::CFileArchiveReader( const FileReadHandleRef_t& InHandle, uint32 InBufferSize /* = DEFAULT_BUFFER_SIZE */ )
+	: CArchive( InHandle->GetPath() )
+	, handle( InHandle )
+	, size( ( uint32 )InHandle->GetSize() )
+	, position( 0 )
+	, bufferOffset( 0 )
+	, bufferCount( 0 )
+	, buffer( InBufferSize )
+{
+	checkMsg( InHandle->GetSize() <= 0xFFFFFFFFull, TEXT( "File '%s' is too big for archive" ), InHandle->GetPath().c_str() );
+}
+
+/**
+ * Serialize data
+ */
+void CFileArchiveReader::Serialize( void* InBuffer, uint32 InSize )
+{
+	byte*		dest = ( byte* )InBuffer;
+	while ( InSize > 0 )
+	{
+		// Copy data from read-ahead buffer if it's there
+		if ( position >= bufferOffset && position < bufferOffset + bufferCount )
+		{
+			uint32		copySize = Min( InSize, bufferOffset + bufferCount - position );
+			memcpy( dest, buffer.data() + ( position - bufferOffset ), copySize );
+			position	+= copySize;
+			dest		+= copySize;
+			InSize		-= copySize;
+			continue;
+		}
+
+		// Big reads go straight into destination, there is no sense to copy them twice
+		uint32		readSize = 0;
+		if ( InSize >= buffer.size() )
+		{
+			readSize = handle->ReadAt( dest, InSize, position );
+			position	+= readSize;
+			dest		+= readSize;
+			InSize		-= readSize;
+		}
+		else
+		{
+			bufferOffset	= position;
+			bufferCount		= handle->ReadAt( buffer.data(), ( uint32 )buffer.size(), position );
+			readSize		= bufferCount;
+		}
+
+		if ( readSize == 0 )
+		{
+			LE_LOG( LT_Warning, LC_General, TEXT( "Failed to read %u bytes at offset %u from '%s', reached end of file" ), InSize, position, GetPath().c_str() );
+			memset( dest, 0, InSize );
+			break;
+		}
+	}
+}
+
+/**
+ * Get current position in archive
+ */
+uint32 CFileArchiveReader::Tell()
+{
+	return position;
+}
+
+/**
+ * Set current position in archive
+ */
+void CFileArchiveReader::Seek( uint32 InPosition )
+{
+	position = InPosition;
+}
+
+/**
+ * Is loading archive
+ */
+bool CFileArchiveReader::IsLoading() const
+{
+	return true;
+}
+
+/**
+ * Is end of file
+ */
+bool CFileArchiveReader::IsEndOfFile()
+{
+	return position >= size;
+}
+
+/**
+ * Get size of archive
+ */
+uint32 CFileArchiveReader::GetSize()
+{
+	return size;
+}
+
+// ====================================
+// File archive writer
+// ====================================
+
+/**
+ * Constructor
+ */
+CFileArchiveWriter::CFileArchiveWriter( const FileWriteHandleRef_t& InHandle, bool InIsAppend /* = false */, uint32 InBufferSize /* = DEFAULT_BUFFER_SIZE */ )
+	: CArchive( InHandle->GetPath() )
+	, handle( InHandle )
+	, size( ( uint32 )InHandle->GetSize() )
+	, position( InIsAppend ? ( uint32 )InHandle->GetSize() : 0 )
+	, bufferOffset( 0 )
+	, bufferCount( 0 )
+	, buffer( InBufferSize )
+{
+	checkMsg( InHandle->GetSize() <= 0xFFFFFFFFull, TEXT( "File '%s' is too big for archive" ), InHandle->GetPath().c_str() );
+}
+
+/**
+ * Destructor
+ */
+CFileArchiveWriter::~CFileArchiveWriter()
+{
+	FlushBuffer();
+}
+
+/**
+ * Serialize data
+ */
+void CFileArchiveWriter::Serialize( void* InBuffer, uint32 InSize )
+{
+	// If data not continues buffered data, write the buffer first
+	if ( bufferCount > 0 && position != bufferOffset + bufferCount )
+	{
+		FlushBuffer();
+	}
+
+	// Big writes go straight to file
+	if ( InSize >= buffer.size() )
+	{
+		FlushBuffer();
+		if ( !handle->WriteAt( InBuffer, InSize, position ) )
+		{
+			LE_LOG( LT_Warning, LC_General, TEXT( "Failed to write %i bytes at offset %i to '%s'" ), InSize, position, GetPath().c_str() );
+		}
+	}
+	else
+	{
+		if ( bufferCount + InSize > buffer.size() )
+		{
+			FlushBuffer();
+		}
+
+		if ( bufferCount == 0 )
+		{
+			bufferOffset = position;
+		}
+		memcpy( buffer.data() + bufferCount, InBuffer, InSize );
+		bufferCount += InSize;
+	}
+
+	position	+= InSize;
+	size		= Max( size, position );
+}
+
+/**
+ * Write buffered data to file
+ */
+void CFileArchiveWriter::FlushBuffer()
+{
+	if ( bufferCount == 0 )
+	{
+		return;
+	}
+
+	if ( !handle->WriteAt( buffer.data(), bufferCount, bufferOffset ) )
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Failed to write %i bytes at offset %i to '%s'" ), bufferCount, bufferOffset, GetPath().c_str() );
+	}
+	bufferCount = 0;
+}
+
+/**
+ * Get current position in archive
+ */
+uint32 CFileArchiveWriter::Tell()
+{
+	return position;
+}
+
+/**
+ * Set current position in archive
+ */
+void CFileArchiveWriter::Seek( uint32 InPosition )
+{
+	position = InPosition;
+}
+
+/**
+ * Flush data
+ */
+void CFileArchiveWriter::Flush()
+{
+	FlushBuffer();
+}
+
+/**
+ * Is saving archive
+ */
+bool CFileArchiveWriter::IsSaving() const
+{
+	return true;
+}
+
+/**
+ * Is end of file
+ */
+bool CFileArchiveWriter::IsEndOfFile()
+{
+	return position >= size;
+}
+
+/**
+ * Get size of archive
+ */
+uint32 CFileArchiveWriter::GetSize()
+{
+	return size;
+}
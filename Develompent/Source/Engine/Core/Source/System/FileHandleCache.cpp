@@ -0,0 +1,168 @@
+#include "Misc/CoreGlobals.h"
+#include "Misc/Misc.h"
+#include "Containers/String.h"
+#include "System/FileArchive.h"
+#include "System/FileHandleCache.h"
+
+/**
+ * Constructor
+ */
+CFileHandleCache::CFileHandleCache()
+	: maxHandles( DEFAULT_MAX_HANDLES )
+	, generation( 0 )
+{}
+
+/**
+ * Destructor
+ */
+CFileHandleCache::~CFileHandleCache()
+{
+	handlesMap.clear();
+	handles.clear();
+}
+
+/**
+ * Get key of path in cache
+ */
+std::wstring CFileHandleCache::GetKey( const std::wstring& InPath )
+{
+	std::wstring		key = CString::ToLower( InPath );
+	appNormalizePathSeparators( key );
+	return key;
+}
+
+/**
+ * Get handle of file, open it if need
+ */
+FileReadHandleRef_t CFileHandleCache::Acquire( const std::wstring& InPath, uint32 InFlags /* = AR_None */ )
+{
+	std::wstring		key = GetKey( InPath );
+	uint32				openGeneration;
+	{
+		CScopeLock		scopeLock( cs );
+		auto			itHandle = handlesMap.find( key );
+		if ( itHandle != handlesMap.end() )
+		{
+			// Move handle to front of LRU list
+			handles.splice( handles.begin(), handles, itHandle->second );
+			return *itHandle->second;
+		}
+		openGeneration = generation;
+	}
+
+	// Open file without lock, it may be slow
+	FileReadHandleRef_t		handle = GFileSystem->OpenReadHandle( InPath, InFlags );
+	if ( !handle.IsValid() )
+	{
+		return nullptr;
+	}
+
+	CScopeLock		scopeLock( cs );
+
+	// Other thread could open this file while we opened it. In this case use its handle
+	auto			itHandle = handlesMap.find( key );
+	if ( itHandle != handlesMap.end() )
+	{
+		handles.splice( handles.begin(), handles, itHandle->second );
+		return *itHandle->second;
+	}
+
+	// File could be written, moved or deleted while we opened it, so our handle may point to old file. Don't keep it
+	if ( openGeneration != generation )
+	{
+		return handle;
+	}
+
+	handles.push_front( handle );
+	handlesMap.insert( std::make_pair( key, handles.begin() ) );
+	Trim();
+	return handle;
+}
+
+/**
+ * Create archive for reading file through cached handle
+ */
+CArchive* CFileHandleCache::CreateReader( const std::wstring& InPath, uint32 InFlags /* = AR_None */ )
+{
+	FileReadHandleRef_t		handle = Acquire( InPath, InFlags );
+	if ( !handle.IsValid() )
+	{
+		return nullptr;
+	}
+
+	return new CFileArchiveReader( handle );
+}
+
+/**
+ * Drop handles of file or of all files in directory from cache
+ */
+void CFileHandleCache::Invalidate( const std::wstring& InPath )
+{
+	std::wstring		key			= GetKey( InPath );
+	std::wstring		keyPrefix	= key + PATH_SEPARATOR;
+
+	CScopeLock			scopeLock( cs );
+	++generation;
+	for ( auto itHandle = handlesMap.begin(); itHandle != handlesMap.end(); )
+	{
+		if ( itHandle->first == key || itHandle->first.compare( 0, keyPrefix.size(), keyPrefix ) == 0 )
+		{
+			handles.erase( itHandle->second );
+			itHandle = handlesMap.erase( itHandle );
+		}
+		else
+		{
+			++itHandle;
+		}
+	}
+}
+
+/**
+ * Close all handles which not used outside of cache
+ */
+void CFileHandleCache::Flush()
+{
+	CScopeLock		scopeLock( cs );
+	for ( auto itHandle = handlesMap.begin(); itHandle != handlesMap.end(); )
+	{
+		if ( ( *itHandle->second )->GetRefCount() == 1 )
+		{
+			handles.erase( itHandle->second );
+			itHandle = handlesMap.erase( itHandle );
+		}
+		else
+		{
+			++itHandle;
+		}
+	}
+}
+
+/**
+ * Set maximum number of opened handles
+ */
+void CFileHandleCache::SetMaxHandles( uint32 InMaxHandles )
+{
+	CScopeLock		scopeLock( cs );
+	maxHandles = InMaxHandles;
+	Trim();
+}
+
+/**
+ * Close unused handles while there are more than maxHandles
+ */
+void CFileHandleCache::Trim()
+{
+	// Walk from least recently used handle. Handles which still used by readers we skip,
+	// they will be closed later when become free
+	for ( auto itHandle = handles.end(); handlesMap.size() > maxHandles && itHandle != handles.begin(); )
+	{
+		--itHandle;
+		if ( ( *itHandle )->GetRefCount() != 1 )
+		{
+			continue;
+		}
+
+		handlesMap.erase( GetKey( ( *itHandle )->GetPath() ) );
+		itHandle = handles.erase( itHandle );
+	}
+}
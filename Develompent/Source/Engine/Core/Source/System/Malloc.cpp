@@ -0,0 +1,521 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "Misc/Template.h"
+#include "System/Malloc.h"
+#include "System/MemoryTracker.h"
+
+/** Entry of page map for first page of large block */
+#define PAGEMAP_LARGE				0xFF
+
+/** Maximum alignment of small blocks, bigger alignments are allocated as large blocks */
+#define MALLOC_MAX_SMALL_ALIGNMENT	4096
+
+/** Maximum number of blocks of one size class in thread cache */
+#define MALLOC_MAX_CACHED_BLOCKS	256
+
+/**
+ * Size classes of small blocks. Sizes grow by 16 bytes up to 128 and after by four steps on every power of two,
+ * so internal fragmentation doesn't exceed 25%
+ */
+static const uint32		GMallocBinSizes[MALLOC_NUM_BINS] =
+{
+	16,		32,		48,		64,		80,		96,		112,	128,
+	160,	192,	224,	256,
+	320,	384,	448,	512,
+	640,	768,	896,	1024,
+	1280,	1536,	1792,	2048,
+	2560,	3072,	3584,	4096,
+	5120,	6144,	7168,	8192,
+	10240,	12288,	14336,	16384,
+	20480,	24576,	28672,	32768
+};
+
+/**
+ * Cache of free blocks of thread
+ */
+struct SMallocThreadCache
+{
+	/**
+	 * Destructor, returns cached blocks to bins when thread exits
+	 */
+	~SMallocThreadCache()
+	{
+		CMallocBinned::Get().FlushThreadCache();
+		bDestroyed = true;
+	}
+
+	CMallocBinned::SFreeBlock*		lists[MALLOC_NUM_BINS];		/**< Lists of free blocks for every bin */
+	uint32							counts[MALLOC_NUM_BINS];	/**< Number of blocks in lists */
+	bool							bDestroyed;					/**< Is cache destroyed. After it blocks go directly to bins */
+};
+
+/** Cache of current thread */
+static thread_local SMallocThreadCache		GMallocThreadCache;
+
+CMallocBinned& CMallocBinned::Get()
+{
+	// Allocator is placed in static memory and never destroyed, because memory may be freed by static destructors
+	alignas( CMallocBinned ) static byte	mallocStorage[sizeof( CMallocBinned )];
+	static CMallocBinned*					mallocBinned = new( mallocStorage ) CMallocBinned();
+	return *mallocBinned;
+}
+
+CMallocBinned::CMallocBinned()
+	: arenaCurrent( nullptr )
+	, arenaEnd( nullptr )
+	, largePageSize( 0 )
+{
+	memset( ( void* )pageMap, 0, sizeof( pageMap ) );
+	memset( &stats, 0, sizeof( stats ) );
+
+	// Init bins, blocks of one span must fit at least 8 blocks to keep waste of span small
+	uint32		binIndex = 0;
+	for ( uint32 index = 0; index < MALLOC_NUM_BINS; ++index )
+	{
+		SBin&		bin = bins[index];
+		bin.blockSize		= GMallocBinSizes[index];
+		bin.numSpanPages	= ( bin.blockSize * 8 + MALLOC_PAGE_SIZE - 1 ) / MALLOC_PAGE_SIZE;
+		bin.maxCached		= Clamp<uint32>( MALLOC_THREAD_CACHE_SIZE / bin.blockSize, 2, MALLOC_MAX_CACHED_BLOCKS );
+		bin.batchSize		= bin.maxCached / 2;
+		bin.freeList		= nullptr;
+
+		for ( ; binIndex * MALLOC_DEFAULT_ALIGNMENT <= bin.blockSize && binIndex < ARRAY_COUNT( sizeToBin ); ++binIndex )
+		{
+			sizeToBin[binIndex] = ( byte )index;
+		}
+	}
+
+#if USE_LARGE_PAGES
+	// Arenas must consist of whole large pages
+	largePageSize = appGetLargePageSize();
+	if ( largePageSize == 0 || MALLOC_ARENA_SIZE % largePageSize != 0 )
+	{
+		largePageSize = 0;
+	}
+#endif // USE_LARGE_PAGES
+}
+
+uint32 CMallocBinned::GetBinIndex( size_t InSize, uint32 InAlignment ) const
+{
+	if ( InAlignment > MALLOC_DEFAULT_ALIGNMENT )
+	{
+		if ( InAlignment > MALLOC_MAX_SMALL_ALIGNMENT )
+		{
+			return INDEX_NONE;
+		}
+		InSize = Align( InSize, InAlignment );
+	}
+
+	if ( InSize > MALLOC_MAX_SMALL_SIZE )
+	{
+		return INDEX_NONE;
+	}
+
+	// Spans are aligned to page, so block is aligned if its size is multiple of alignment
+	uint32		binIndex = sizeToBin[( InSize + MALLOC_DEFAULT_ALIGNMENT - 1 ) / MALLOC_DEFAULT_ALIGNMENT];
+	while ( binIndex < MALLOC_NUM_BINS && bins[binIndex].blockSize % InAlignment != 0 )
+	{
+		++binIndex;
+	}
+	return binIndex < MALLOC_NUM_BINS ? binIndex : INDEX_NONE;
+}
+
+byte CMallocBinned::GetPageMapEntry( const void* InPointer ) const
+{
+	uint64		address		= ( uint64 )InPointer;
+	byte*		pageTable	= pageMap[( address >> 32 ) & 0xFFFF];
+	return pageTable ? pageTable[( address / MALLOC_PAGE_SIZE ) & 0xFFFF] : 0;
+}
+
+void CMallocBinned::SetPageMapEntry( const void* InPage, byte InEntry )
+{
+	uint64		address		= ( uint64 )InPage;
+	byte*		pageTable	= pageMap[( address >> 32 ) & 0xFFFF];
+	if ( !pageTable )
+	{
+		// Table covers 4 GB of address space by pages of 64 KB, memory from OS is zeroed
+		pageTable = ( byte* )appPageAlloc( 0x10000, false );
+		checkMsg( pageTable, TEXT( "Out of memory for page map" ) );
+		pageMap[( address >> 32 ) & 0xFFFF] = pageTable;
+		stats.reservedSize += 0x10000;
+	}
+	pageTable[( address / MALLOC_PAGE_SIZE ) & 0xFFFF] = InEntry;
+}
+
+void* CMallocBinned::Malloc( size_t InSize, uint32 InAlignment /* = MALLOC_DEFAULT_ALIGNMENT */ )
+{
+#if USE_MALLOC_TRACKING
+	// Header is placed right before user memory, offset keeps user memory aligned.
+	// First page of large block must contain user memory, because it's found by page map
+	checkMsg( InAlignment < MALLOC_PAGE_SIZE / 2, TEXT( "Alignment %u isn't supported with memory tracking" ), InAlignment );
+	uint32		offset = Max<uint32>( sizeof( SMemoryTrackingHeader ), InAlignment );
+	byte*		memory = ( byte* )InternalMalloc( InSize + offset, InAlignment );
+	if ( !memory )
+	{
+		return nullptr;
+	}
+
+	CMemoryTracker::Get().TrackMalloc( ( SMemoryTrackingHeader* )( memory + offset ) - 1, offset, InSize );
+	return memory + offset;
+#else
+	return InternalMalloc( InSize, InAlignment );
+#endif // USE_MALLOC_TRACKING
+}
+
+void* CMallocBinned::Realloc( void* InPointer, size_t InNewSize, uint32 InAlignment /* = MALLOC_DEFAULT_ALIGNMENT */ )
+{
+#if USE_MALLOC_TRACKING
+	if ( !InPointer )
+	{
+		return Malloc( InNewSize, InAlignment );
+	}
+
+	if ( InNewSize == 0 )
+	{
+		Free( InPointer );
+		return nullptr;
+	}
+
+	// Foreign memory stays in CRT
+	if ( GetPageMapEntry( InPointer ) == 0 )
+	{
+		return realloc( InPointer, InNewSize );
+	}
+
+	// Block is always moved, so tag and call stack of allocation are updated
+	const SMemoryTrackingHeader*	header		= ( const SMemoryTrackingHeader* )InPointer - 1;
+	void*							newPointer	= Malloc( InNewSize, InAlignment );
+	if ( newPointer )
+	{
+		memcpy( newPointer, InPointer, Min<size_t>( header->size, InNewSize ) );
+		Free( InPointer );
+	}
+	return newPointer;
+#else
+	return InternalRealloc( InPointer, InNewSize, InAlignment );
+#endif // USE_MALLOC_TRACKING
+}
+
+void CMallocBinned::Free( void* InPointer )
+{
+	if ( !InPointer )
+	{
+		return;
+	}
+
+	byte		entry = GetPageMapEntry( InPointer );
+	if ( entry == 0 )
+	{
+		free( InPointer );
+		return;
+	}
+
+#if USE_MALLOC_TRACKING
+	const SMemoryTrackingHeader*	header = ( const SMemoryTrackingHeader* )InPointer - 1;
+	CMemoryTracker::Get().TrackFree( header );
+	InternalFree( ( byte* )InPointer - header->offset, entry );
+#else
+	InternalFree( InPointer, entry );
+#endif // USE_MALLOC_TRACKING
+}
+
+size_t CMallocBinned::GetAllocationSize( void* InPointer ) const
+{
+	byte		entry = GetPageMapEntry( InPointer );
+	if ( entry == 0 )
+	{
+		return 0;
+	}
+
+#if USE_MALLOC_TRACKING
+	uint32		offset = ( ( const SMemoryTrackingHeader* )InPointer - 1 )->offset;
+	return InternalGetAllocationSize( ( byte* )InPointer - offset, entry ) - offset;
+#else
+	return InternalGetAllocationSize( InPointer, entry );
+#endif // USE_MALLOC_TRACKING
+}
+
+void* CMallocBinned::InternalMalloc( size_t InSize, uint32 InAlignment )
+{
+	uint32		binIndex = GetBinIndex( InSize, InAlignment );
+	if ( binIndex == INDEX_NONE )
+	{
+		return MallocLarge( InSize, InAlignment );
+	}
+
+	// Fast path, take block from cache of thread without locks
+	SMallocThreadCache&		cache = GMallocThreadCache;
+	SFreeBlock*				block = cache.lists[binIndex];
+	if ( block )
+	{
+		cache.lists[binIndex] = block->next;
+		--cache.counts[binIndex];
+		return block;
+	}
+
+	// Cache is empty, refill it by batch from bin
+	uint32		numBlocks = AllocateBlocks( binIndex, cache.bDestroyed ? 1 : bins[binIndex].batchSize, block );
+	if ( !block )
+	{
+		return nullptr;
+	}
+
+	cache.lists[binIndex]	= block->next;
+	cache.counts[binIndex]	= numBlocks - 1;
+	return block;
+}
+
+void* CMallocBinned::InternalRealloc( void* InPointer, size_t InNewSize, uint32 InAlignment )
+{
+	if ( !InPointer )
+	{
+		return InternalMalloc( InNewSize, InAlignment );
+	}
+
+	// Foreign memory stays in CRT
+	byte		entry = GetPageMapEntry( InPointer );
+	if ( entry == 0 )
+	{
+		if ( InNewSize == 0 )
+		{
+			free( InPointer );
+			return nullptr;
+		}
+		return realloc( InPointer, InNewSize );
+	}
+
+	if ( InNewSize == 0 )
+	{
+		InternalFree( InPointer, entry );
+		return nullptr;
+	}
+
+	// Keep block if new size fits in it without much waste
+	size_t		oldSize = InternalGetAllocationSize( InPointer, entry );
+	if ( InNewSize <= oldSize && ( entry == PAGEMAP_LARGE ? InNewSize > oldSize / 2 : GetBinIndex( InNewSize, InAlignment ) == entry - 1 ) )
+	{
+		return InPointer;
+	}
+
+	void*		newPointer = InternalMalloc( InNewSize, InAlignment );
+	if ( newPointer )
+	{
+		memcpy( newPointer, InPointer, Min( oldSize, InNewSize ) );
+		InternalFree( InPointer, entry );
+	}
+	return newPointer;
+}
+
+void CMallocBinned::InternalFree( void* InPointer, byte InEntry )
+{
+	if ( InEntry == PAGEMAP_LARGE )
+	{
+		FreeLarge( InPointer );
+		return;
+	}
+
+	// Fast path, put block to cache of thread without locks
+	uint32					binIndex	= InEntry - 1;
+	SFreeBlock*				block		= ( SFreeBlock* )InPointer;
+	SMallocThreadCache&		cache		= GMallocThreadCache;
+	if ( cache.bDestroyed )
+	{
+		block->next = nullptr;
+		FreeBlocks( binIndex, block, block );
+		return;
+	}
+
+	block->next				= cache.lists[binIndex];
+	cache.lists[binIndex]	= block;
+	if ( ++cache.counts[binIndex] > bins[binIndex].maxCached )
+	{
+		// Cache is overflowed, return batch of blocks to bin
+		SFreeBlock*		first	= cache.lists[binIndex];
+		SFreeBlock*		last	= first;
+		for ( uint32 index = 1, count = bins[binIndex].batchSize; index < count; ++index )
+		{
+			last = last->next;
+		}
+
+		cache.lists[binIndex]	= last->next;
+		cache.counts[binIndex]	-= bins[binIndex].batchSize;
+		last->next				= nullptr;
+		FreeBlocks( binIndex, first, last );
+	}
+}
+
+size_t CMallocBinned::InternalGetAllocationSize( void* InPointer, byte InEntry ) const
+{
+	if ( InEntry == PAGEMAP_LARGE )
+	{
+		const SLargeHeader*		header = ( const SLargeHeader* )( ( uint64 )InPointer & ~( uint64 )( MALLOC_PAGE_SIZE - 1 ) );
+		return ( size_t )header->userSize;
+	}
+	return bins[InEntry - 1].blockSize;
+}
+
+void CMallocBinned::FlushThreadCache()
+{
+	SMallocThreadCache&		cache = GMallocThreadCache;
+	for ( uint32 binIndex = 0; binIndex < MALLOC_NUM_BINS; ++binIndex )
+	{
+		SFreeBlock*		first = cache.lists[binIndex];
+		if ( !first )
+		{
+			continue;
+		}
+
+		SFreeBlock*		last = first;
+		while ( last->next )
+		{
+			last = last->next;
+		}
+
+		FreeBlocks( binIndex, first, last );
+		cache.lists[binIndex]	= nullptr;
+		cache.counts[binIndex]	= 0;
+	}
+}
+
+SMallocStats CMallocBinned::GetStats() const
+{
+	CScopeLock		scopeLock( pageCS );
+	return stats;
+}
+
+uint32 CMallocBinned::AllocateBlocks( uint32 InBinIndex, uint32 InNumBlocks, SFreeBlock*& OutFirst )
+{
+	SBin&			bin = bins[InBinIndex];
+	CScopeLock		scopeLock( bin.cs );
+	if ( !bin.freeList )
+	{
+		byte*		span = nullptr;
+		{
+			CScopeLock		pageScopeLock( pageCS );
+			span = AllocatePages( bin.numSpanPages );
+			for ( uint32 index = 0; span && index < bin.numSpanPages; ++index )
+			{
+				SetPageMapEntry( span + index * MALLOC_PAGE_SIZE, ( byte )( InBinIndex + 1 ) );
+			}
+		}
+
+		if ( !span )
+		{
+			OutFirst = nullptr;
+			return 0;
+		}
+
+		// Link blocks in order of addresses
+		for ( uint32 index = bin.numSpanPages * MALLOC_PAGE_SIZE / bin.blockSize; index > 0; --index )
+		{
+			SFreeBlock*		block = ( SFreeBlock* )( span + ( index - 1 ) * bin.blockSize );
+			block->next		= bin.freeList;
+			bin.freeList	= block;
+		}
+	}
+
+	OutFirst = bin.freeList;
+	SFreeBlock*		last		= OutFirst;
+	uint32			numBlocks	= 1;
+	for ( ; numBlocks < InNumBlocks && last->next; ++numBlocks )
+	{
+		last = last->next;
+	}
+
+	bin.freeList	= last->next;
+	last->next		= nullptr;
+	return numBlocks;
+}
+
+void CMallocBinned::FreeBlocks( uint32 InBinIndex, SFreeBlock* InFirst, SFreeBlock* InLast )
+{
+	SBin&			bin = bins[InBinIndex];
+	CScopeLock		scopeLock( bin.cs );
+	InLast->next	= bin.freeList;
+	bin.freeList	= InFirst;
+}
+
+byte* CMallocBinned::AllocatePages( uint32 InNumPages )
+{
+	uint64		size = ( uint64 )InNumPages * MALLOC_PAGE_SIZE;
+	if ( ( uint64 )( arenaEnd - arenaCurrent ) < size )
+	{
+		// Rest of current arena is wasted, it's less than one span
+		byte*		arena = largePageSize > 0 ? ( byte* )appPageAlloc( MALLOC_ARENA_SIZE, true ) : nullptr;
+		stats.bLargePages = arena != nullptr;
+		if ( !arena )
+		{
+			// Process doesn't have privilege for large pages or physical memory is fragmented, don't try again
+			largePageSize	= 0;
+			arena			= ( byte* )appPageAlloc( MALLOC_ARENA_SIZE, false );
+			if ( !arena )
+			{
+				return nullptr;
+			}
+		}
+
+		arenaCurrent		= arena;
+		arenaEnd			= arena + MALLOC_ARENA_SIZE;
+		stats.reservedSize	+= MALLOC_ARENA_SIZE;
+		++stats.numArenas;
+	}
+
+	byte*		pages = arenaCurrent;
+	arenaCurrent += size;
+	return pages;
+}
+
+void* CMallocBinned::MallocLarge( size_t InSize, uint32 InAlignment )
+{
+	checkMsg( InAlignment < MALLOC_PAGE_SIZE, TEXT( "Alignment %u isn't supported" ), InAlignment );
+
+	// Header is placed at start of memory, user memory starts right after it with needed alignment
+	uint32		headerSize	= Max<uint32>( sizeof( SLargeHeader ), InAlignment );
+	uint64		size		= Align( ( uint64 )InSize + headerSize, ( uint64 )MALLOC_PAGE_SIZE );
+	byte*		memory		= nullptr;
+	uint64		largePages	= largePageSize;
+	if ( largePages > 0 && size >= largePages && Align( size, largePages ) - size <= size / 8 )
+	{
+		memory = ( byte* )appPageAlloc( Align( size, largePages ), true );
+		if ( memory )
+		{
+			size = Align( size, largePages );
+		}
+	}
+
+	if ( !memory )
+	{
+		memory = ( byte* )appPageAlloc( size, false );
+		if ( !memory )
+		{
+			return nullptr;
+		}
+	}
+
+	SLargeHeader*	header = ( SLargeHeader* )memory;
+	header->size		= size;
+	header->userSize	= size - headerSize;
+	{
+		CScopeLock		scopeLock( pageCS );
+		SetPageMapEntry( memory, PAGEMAP_LARGE );
+		stats.reservedSize	+= size;
+		stats.largeSize		+= size;
+		++stats.numLargeBlocks;
+	}
+	return memory + headerSize;
+}
+
+void CMallocBinned::FreeLarge( void* InPointer )
+{
+	SLargeHeader*	header	= ( SLargeHeader* )( ( uint64 )InPointer & ~( uint64 )( MALLOC_PAGE_SIZE - 1 ) );
+	uint64			size	= header->size;
+	{
+		CScopeLock		scopeLock( pageCS );
+		SetPageMapEntry( header, 0 );
+		stats.reservedSize	-= size;
+		stats.largeSize		-= size;
+		--stats.numLargeBlocks;
+	}
+	appPageFree( header, size );
+}
@@ -0,0 +1,248 @@
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include "Misc/Template.h"
+#include "Logger/LoggerMacros.h"
+#include "System/Malloc.h"
+#include "System/MemoryTracker.h"
+
+/** Magic number in header of tracked allocation */
+#define MEMTRACKER_MAGIC		0xA7
+
+/**
+ * Names of memory tags
+ */
+static const tchar*		GMemoryTagNames[MT_Num] =
+{
+	TEXT( "Default" ),
+	TEXT( "Objects" ),
+	TEXT( "Package" ),
+	TEXT( "Texture" ),
+	TEXT( "StaticMesh" ),
+	TEXT( "Material" ),
+	TEXT( "Audio" ),
+	TEXT( "Script" ),
+	TEXT( "Physics" ),
+	TEXT( "Shader" )
+};
+
+/** Memory tag of current thread */
+static thread_local uint8		GMemoryThreadTag = MT_Default;
+
+const tchar* appMemoryTagToText( EMemoryTag InTag )
+{
+	return InTag < MT_Num ? GMemoryTagNames[InTag] : TEXT( "Unknown" );
+}
+
+CMemoryTracker& CMemoryTracker::Get()
+{
+	// Tracker is placed in static memory and never destroyed, because memory may be freed by static destructors
+	alignas( CMemoryTracker ) static byte	trackerStorage[sizeof( CMemoryTracker )];
+	static CMemoryTracker*					memoryTracker = new( trackerStorage ) CMemoryTracker();
+	return *memoryTracker;
+}
+
+CMemoryTracker::CMemoryTracker()
+	: callstacks( nullptr )
+	, numCallstacks( 0 )
+{
+	memset( ( void* )tags, 0, sizeof( tags ) );
+	memset( snapshot, 0, sizeof( snapshot ) );
+
+#if MALLOC_TRACKING_CALLSTACKS
+	// Table is taken directly from OS, so it doesn't recurse into allocator. Memory from OS is zeroed
+	callstacks = ( SCallstack* )appPageAlloc( Align( ( uint64 )sizeof( SCallstack ) * MEMTRACKER_MAX_CALLSTACKS, ( uint64 )MALLOC_PAGE_SIZE ), false );
+	checkMsg( callstacks, TEXT( "Out of memory for call stacks of memory tracker" ) );
+#endif // MALLOC_TRACKING_CALLSTACKS
+}
+
+EMemoryTag CMemoryTracker::SetThreadTag( EMemoryTag InTag )
+{
+	EMemoryTag		prevTag = ( EMemoryTag )GMemoryThreadTag;
+	GMemoryThreadTag		= ( uint8 )InTag;
+	return prevTag;
+}
+
+void CMemoryTracker::TrackMalloc( SMemoryTrackingHeader* InHeader, uint32 InOffset, uint64 InSize )
+{
+	InHeader->size			= InSize;
+	InHeader->offset		= ( uint16 )InOffset;
+	InHeader->tag			= GMemoryThreadTag;
+	InHeader->magic			= MEMTRACKER_MAGIC;
+	InHeader->callstackId	= callstacks ? FindOrAddCallstack() : 0;
+
+	STagCounters&	counters	= tags[InHeader->tag];
+	int64			liveBytes	= appInterlockedAdd64( &counters.liveBytes, InSize ) + InSize;
+	appInterlockedAdd64( &counters.numLive, 1 );
+	appInterlockedAdd64( &counters.numTotal, 1 );
+
+	// Update peak only if it grew, usually it doesn't
+	for ( int64 peakBytes = counters.peakBytes; liveBytes > peakBytes; peakBytes = counters.peakBytes )
+	{
+		if ( appInterlockedCompareExchange64( &counters.peakBytes, liveBytes, peakBytes ) == peakBytes )
+		{
+			break;
+		}
+	}
+
+	if ( InHeader->callstackId != 0 )
+	{
+		SCallstack&		callstack = callstacks[InHeader->callstackId - 1];
+		appInterlockedAdd64( &callstack.liveBytes, InSize );
+		appInterlockedAdd64( &callstack.numLive, 1 );
+	}
+}
+
+void CMemoryTracker::TrackFree( const SMemoryTrackingHeader* InHeader )
+{
+	checkMsg( InHeader->magic == MEMTRACKER_MAGIC && InHeader->tag < MT_Num, TEXT( "Header of tracked allocation is corrupted or memory is freed twice" ) );
+
+	STagCounters&	counters = tags[InHeader->tag];
+	appInterlockedAdd64( &counters.liveBytes, -( int64 )InHeader->size );
+	appInterlockedAdd64( &counters.numLive, -1 );
+
+	if ( InHeader->callstackId != 0 )
+	{
+		SCallstack&		callstack = callstacks[InHeader->callstackId - 1];
+		appInterlockedAdd64( &callstack.liveBytes, -( int64 )InHeader->size );
+		appInterlockedAdd64( &callstack.numLive, -1 );
+	}
+}
+
+void CMemoryTracker::GetTagStats( SMemoryTagStats OutStats[MT_Num] ) const
+{
+	for ( uint32 index = 0; index < MT_Num; ++index )
+	{
+		OutStats[index].liveBytes	= tags[index].liveBytes;
+		OutStats[index].peakBytes	= tags[index].peakBytes;
+		OutStats[index].numLive		= tags[index].numLive;
+		OutStats[index].numTotal	= tags[index].numTotal;
+	}
+}
+
+void CMemoryTracker::DumpSnapshot()
+{
+#if USE_MALLOC_TRACKING
+	SMemoryTagStats		stats[MT_Num];
+	SMemoryTagStats		prevStats[MT_Num];
+	GetTagStats( stats );
+	{
+		CScopeLock		scopeLock( cs );
+		memcpy( prevStats, snapshot, sizeof( snapshot ) );
+		memcpy( snapshot, stats, sizeof( snapshot ) );
+	}
+
+	int64		totalBytes		= 0;
+	int64		totalDiffBytes	= 0;
+	LE_LOG( LT_Log, LC_Memory, TEXT( "Memory by tags (live / peak / diff with previous report):" ) );
+	for ( uint32 index = 0; index < MT_Num; ++index )
+	{
+		int64		diffBytes = stats[index].liveBytes - prevStats[index].liveBytes;
+		LE_LOG( LT_Log, LC_Memory, TEXT( "  %-12s %10.2f KB / %10.2f KB / %+10.2f KB, allocations %lli (total %lli)" ),
+				GMemoryTagNames[index], stats[index].liveBytes / 1024.f, stats[index].peakBytes / 1024.f, diffBytes / 1024.f, stats[index].numLive, stats[index].numTotal );
+		totalBytes		+= stats[index].liveBytes;
+		totalDiffBytes	+= diffBytes;
+	}
+	LE_LOG( LT_Log, LC_Memory, TEXT( "  Total: %.2f MB (%+.2f KB)" ), totalBytes / ( 1024.f * 1024.f ), totalDiffBytes / 1024.f );
+#else
+	LE_LOG( LT_Warning, LC_Memory, TEXT( "Memory tracking is disabled, rebuild with USE_MALLOC_TRACKING" ) );
+#endif // USE_MALLOC_TRACKING
+}
+
+void CMemoryTracker::DumpLeaks( uint32 InMaxCallstacks )
+{
+#if MALLOC_TRACKING_CALLSTACKS
+	// Collect call stacks which grew since previous report, strings for log are built after unlock
+	struct SLeak
+	{
+		uint32		callstackId;
+		int64		liveBytes;
+		int64		diffBytes;
+		int64		numLive;
+	};
+
+	std::vector<SLeak>		leaks;
+	{
+		CScopeLock		scopeLock( cs );
+		for ( uint32 index = 0; index < MEMTRACKER_MAX_CALLSTACKS; ++index )
+		{
+			SCallstack&		callstack = callstacks[index];
+			int64			liveBytes = callstack.liveBytes;
+			if ( callstack.numFrames == 0 || liveBytes <= callstack.reportedBytes )
+			{
+				callstack.reportedBytes = Min( callstack.reportedBytes, liveBytes );
+				continue;
+			}
+
+			SLeak		leak;
+			leak.callstackId	= index + 1;
+			leak.liveBytes		= liveBytes;
+			leak.diffBytes		= liveBytes - callstack.reportedBytes;
+			leak.numLive		= callstack.numLive;
+			leaks.push_back( leak );
+			callstack.reportedBytes = liveBytes;
+		}
+	}
+
+	std::sort( leaks.begin(), leaks.end(), []( const SLeak& InA, const SLeak& InB ) { return InA.diffBytes > InB.diffBytes; } );
+	LE_LOG( LT_Log, LC_Memory, TEXT( "Call stacks with grown memory since previous report: %u (%u in table)" ), ( uint32 )leaks.size(), numCallstacks );
+	for ( uint32 index = 0, count = Min<uint32>( leaks.size(), InMaxCallstacks ); index < count; ++index )
+	{
+		const SLeak&		leak		= leaks[index];
+		const SCallstack&	callstack	= callstacks[leak.callstackId - 1];
+		LE_LOG( LT_Log, LC_Memory, TEXT( "  %+.2f KB, live %.2f KB in %lli allocations, tag %s:" ), leak.diffBytes / 1024.f, leak.liveBytes / 1024.f, leak.numLive, GMemoryTagNames[callstack.tag] );
+		for ( uint32 frameIndex = 0; frameIndex < callstack.numFrames; ++frameIndex )
+		{
+			LE_LOG( LT_Log, LC_Memory, TEXT( "    %s" ), appCodeAddressToString( callstack.frames[frameIndex] ).c_str() );
+		}
+	}
+#else
+	LE_LOG( LT_Warning, LC_Memory, TEXT( "Call stacks of allocations aren't captured, rebuild with MALLOC_TRACKING_CALLSTACKS" ) );
+#endif // MALLOC_TRACKING_CALLSTACKS
+}
+
+uint32 CMemoryTracker::FindOrAddCallstack()
+{
+	// Skip frames of tracker and allocator
+	void*		frames[MEMTRACKER_MAX_FRAMES];
+	uint32		numFrames	= appCaptureCallStack( 3, frames, MEMTRACKER_MAX_FRAMES );
+	if ( numFrames == 0 )
+	{
+		return 0;
+	}
+
+	uint64		hash		= 14695981039346656037ULL;
+	for ( uint32 index = 0; index < numFrames; ++index )
+	{
+		hash ^= ( uint64 )frames[index];
+		hash *= 1099511628211ULL;
+	}
+
+	// Open addressing, call stacks are never removed from table
+	CScopeLock		scopeLock( cs );
+	for ( uint32 probe = 0, index = ( uint32 )hash & ( MEMTRACKER_MAX_CALLSTACKS - 1 ); probe < MEMTRACKER_MAX_CALLSTACKS; ++probe, index = ( index + 1 ) & ( MEMTRACKER_MAX_CALLSTACKS - 1 ) )
+	{
+		SCallstack&		callstack = callstacks[index];
+		if ( callstack.numFrames == 0 )
+		{
+			if ( numCallstacks >= MEMTRACKER_MAX_CALLSTACKS / 2 )
+			{
+				// Table is too full for fast probing, new call stacks aren't tracked
+				return 0;
+			}
+
+			callstack.hash		= hash;
+			callstack.numFrames	= numFrames;
+			callstack.tag		= GMemoryThreadTag;
+			memcpy( callstack.frames, frames, sizeof( void* ) * numFrames );
+			++numCallstacks;
+			return index + 1;
+		}
+		else if ( callstack.hash == hash && callstack.numFrames == numFrames && !memcmp( callstack.frames, frames, sizeof( void* ) * numFrames ) )
+		{
+			return index + 1;
+		}
+	}
+	return 0;
+}
@@ -1,18 +1,211 @@
-#include <list>
+#include <cwctype>
 
 #include "Misc/Misc.h"
 #include "Containers/String.h"
+#include "System/ThreadingBase.h"
 #include "System/Name.h"
 
-static std::vector<CName::SNameEntry>& GetGlobalNameTable()
+/** Number of shards in name table. Must be power of two */
+#define NAME_NUM_SHARDS				16
+
+/** Number of hash buckets in one shard. Must be power of two */
+#define NAME_NUM_SHARD_BUCKETS		4096
+
+/** Number of entries in one chunk of index table */
+#define NAME_ENTRY_CHUNK_SIZE		16384
+
+/** Maximum number of chunks in index table */
+#define NAME_MAX_ENTRY_CHUNKS		1024
+
+/**
+ * Convert char to upper case. Fast path for ASCII
+ */
+static FORCEINLINE tchar NameToUpper( tchar InChar )
+{
+	if ( InChar < 128 )
+	{
+		return InChar >= TEXT( 'a' ) && InChar <= TEXT( 'z' ) ? InChar - ( TEXT( 'a' ) - TEXT( 'A' ) ) : InChar;
+	}
+	return ( tchar )towupper( InChar );
+}
+
+/**
+ * Calculate case-insensitive hash of name (FNV-1a by upper case chars)
+ */
+static FORCEINLINE uint32 NameHash( const tchar* InString, uint32 InLength )
+{
+	uint32		hash = 2166136261U;
+	for ( uint32 index = 0; index < InLength; ++index )
+	{
+		hash ^= ( uint32 )NameToUpper( InString[index] );
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * Case-insensitive compare of names
+ */
+static FORCEINLINE bool NameEquals( const std::wstring& InName, const tchar* InString, uint32 InLength )
+{
+	if ( InName.size() != InLength )
+	{
+		return false;
+	}
+
+	for ( uint32 index = 0; index < InLength; ++index )
+	{
+		if ( InName[index] != InString[index] && NameToUpper( InName[index] ) != NameToUpper( InString[index] ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Global table of names
+ *
+ * Entries are never removed and never moved in memory. Hash buckets are split to shards,
+ * lookups walk bucket lists without locks, only adding of new entry locks its shard.
+ * New entry is fully initialized before it is published in bucket and index table
+ */
+class CNameTable
+{
+public:
+	/**
+	 * Constructor
+	 */
+	CNameTable()
+		: numEntries( 0 )
+	{
+		memset( ( void* )chunks, 0, sizeof( chunks ) );
+		for ( uint32 shardId = 0; shardId < NAME_NUM_SHARDS; ++shardId )
+		{
+			memset( ( void* )shards[shardId].buckets, 0, sizeof( shards[shardId].buckets ) );
+		}
+	}
+
+	/**
+	 * Find entry by name or add new one
+	 * @return Return index of name
+	 */
+	uint32 FindOrAdd( const tchar* InString, uint32 InLength )
+	{
+		uint32							hash	= NameHash( InString, InLength );
+		SShard&							shard	= shards[hash & ( NAME_NUM_SHARDS - 1 )];
+		CName::SNameEntry* volatile&	bucket	= shard.buckets[( hash / NAME_NUM_SHARDS ) & ( NAME_NUM_SHARD_BUCKETS - 1 )];
+
+		// Fast path without lock, most of names already exist
+		CName::SNameEntry*				head	= bucket;
+		CName::SNameEntry*				entry	= Find( head, nullptr, hash, InString, InLength );
+		if ( entry )
+		{
+			return entry->index;
+		}
+
+		// Name isn't found, lock the shard and search again in entries added after we read the head
+		CScopeLock		scopeLock( &shard.cs );
+		entry = Find( bucket, head, hash, InString, InLength );
+		if ( entry )
+		{
+			return entry->index;
+		}
+
+		// Allocate new entry and publish it in index table and in bucket
+		uint32		index = appInterlockedIncrement( &numEntries ) - 1;
+		checkMsg( index < NAME_ENTRY_CHUNK_SIZE * NAME_MAX_ENTRY_CHUNKS, TEXT( "Name table is overflowed" ) );
+
+		entry		= new CName::SNameEntry( InString, InLength, hash, index );
+		entry->next = bucket;
+		SetEntry( index, entry );
+		appInterlockedCompareExchangePointer( ( void** )&bucket, entry, entry->next );
+		return index;
+	}
+
+	/**
+	 * Get entry by index
+	 * @return Return entry, if index isn't valid returns NULL
+	 */
+	FORCEINLINE const CName::SNameEntry* GetEntry( uint32 InIndex ) const
+	{
+		if ( InIndex >= NAME_ENTRY_CHUNK_SIZE * NAME_MAX_ENTRY_CHUNKS )
+		{
+			return nullptr;
+		}
+
+		CName::SNameEntry* volatile*	chunk = chunks[InIndex / NAME_ENTRY_CHUNK_SIZE];
+		return chunk ? chunk[InIndex % NAME_ENTRY_CHUNK_SIZE] : nullptr;
+	}
+
+private:
+	/**
+	 * Shard of hash buckets
+	 */
+	struct SShard
+	{
+		CCriticalSection				cs;										/**< Critical section for adding new entries */
+		CName::SNameEntry* volatile		buckets[NAME_NUM_SHARD_BUCKETS];		/**< Heads of bucket lists */
+	};
+
+	/**
+	 * Find entry in bucket list
+	 * @return Return found entry, if not found returns NULL
+	 */
+	static FORCEINLINE CName::SNameEntry* Find( CName::SNameEntry* InFirst, CName::SNameEntry* InLast, uint32 InHash, const tchar* InString, uint32 InLength )
+	{
+		for ( CName::SNameEntry* entry = InFirst; entry != InLast; entry = entry->next )
+		{
+			if ( entry->hash == InHash && NameEquals( entry->name, InString, InLength ) )
+			{
+				return entry;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Set entry in index table, allocates chunk if need
+	 */
+	void SetEntry( uint32 InIndex, CName::SNameEntry* InEntry )
+	{
+		CName::SNameEntry* volatile*&	chunk = chunks[InIndex / NAME_ENTRY_CHUNK_SIZE];
+		if ( !chunk )
+		{
+			// Chunk can be allocated at the same time from other shard
+			CName::SNameEntry** 	newChunk = new CName::SNameEntry*[NAME_ENTRY_CHUNK_SIZE];
+			memset( newChunk, 0, sizeof( CName::SNameEntry* ) * NAME_ENTRY_CHUNK_SIZE );
+			if ( appInterlockedCompareExchangePointer( ( void** )&chunk, newChunk, nullptr ) != nullptr )
+			{
+				delete[] newChunk;
+			}
+		}
+
+		appInterlockedCompareExchangePointer( ( void** )&chunk[InIndex % NAME_ENTRY_CHUNK_SIZE], InEntry, nullptr );
+	}
+
+	SShard							shards[NAME_NUM_SHARDS];				/**< Shards of hash buckets */
+	CName::SNameEntry* volatile*	chunks[NAME_MAX_ENTRY_CHUNKS];			/**< Chunks of index table */
+	volatile int32					numEntries;								/**< Number of allocated entries */
+};
+
+/**
+ * Get global name table
+ */
+static CNameTable& GetGlobalNameTable()
 {
-	static std::vector<CName::SNameEntry>		globalNameTable;
+	static CNameTable		globalNameTable;
 	return globalNameTable;
 }
 
-static FORCEINLINE void AllocateNameEntry( const std::wstring& InName, uint32 InHash )
+/**
+ * Get name entry by index, invalid index is NAME_None
+ */
+static FORCEINLINE const CName::SNameEntry* GetNameEntry( uint32 InIndex )
 {
-	GetGlobalNameTable().push_back( CName::SNameEntry( InName, InHash ) );
+	CNameTable&					globalNameTable = GetGlobalNameTable();
+	const CName::SNameEntry*	nameEntry		= globalNameTable.GetEntry( InIndex );
+	return nameEntry ? nameEntry : globalNameTable.GetEntry( NAME_None );
 }
 
 void CName::StaticInit()
@@ -23,53 +216,25 @@ void CName::StaticInit()
 		return;
 	}
 
-	check( GetGlobalNameTable().empty() );
 	GetIsInitialized() = true;
 
 	// Register all hardcoded names
 	#define REGISTER_NAME( InNum, InName )	\
 	{ \
-		check( InNum == GetGlobalNameTable().size() ); \
-		AllocateNameEntry( TEXT( #InName ), appCalcHash( CString::ToUpper( TEXT( #InName ) ) ) ); \
+		uint32		index = GetGlobalNameTable().FindOrAdd( TEXT( #InName ), ( uint32 )wcslen( TEXT( #InName ) ) ); \
+		check( InNum == index ); \
 	}
 	#include "Misc/Names.h"
 }
 
-void CName::Init( const std::wstring& InString )
+void CName::Init( const tchar* InString, uint32 InLength )
 {
-	// Calculate hash for string
-	uint32				hash = appCalcHash( CString::ToUpper( InString ) );
-
-	// Try find already exist name in global table
-	std::vector<CName::SNameEntry>&		globalNameTable = GetGlobalNameTable();
-	for ( uint32 nameEntryId = 0, numNameEntries = globalNameTable.size(); nameEntryId < numNameEntries; ++nameEntryId )
-	{
-		const CName::SNameEntry&		nameEntry = globalNameTable[nameEntryId];
-		if ( nameEntry.hash == hash )
-		{
-			index = nameEntryId;
-			return;
-		}
-	}
-
-	// Getting index of name
-	index = globalNameTable.size();
-
-	// Allocate new name entry
-	AllocateNameEntry( InString, hash );
+	index = GetGlobalNameTable().FindOrAdd( InString, InLength );
 }
 
 void CName::ToString( std::wstring& OutString ) const
 {
-	std::vector<CName::SNameEntry>&		globalNameTable = GetGlobalNameTable();
-	if ( !IsValid() )
-	{
-		OutString = globalNameTable[NAME_None].name;
-	}
-	else
-	{
-		OutString = globalNameTable[index].name;
-	}
+	OutString = GetNameEntry( index )->name;
 }
 
 std::wstring CName::ToString() const
@@ -81,21 +246,15 @@ std::wstring CName::ToString() const
 
 bool CName::operator==( const std::wstring& InOther ) const
 {
-	// Calculate hash for string
-	std::vector<CName::SNameEntry>&		globalNameTable = GetGlobalNameTable();
-	uint32								hash = appCalcHash( CString::ToUpper( InOther ) );
-
-	return globalNameTable[IsValid() ? index : NAME_None].hash == hash;
+	return NameEquals( GetNameEntry( index )->name, InOther.c_str(), ( uint32 )InOther.size() );
 }
 
 CArchive& operator<<( CArchive& InArchive, CName& InValue )
 {
-	std::vector<CName::SNameEntry>&		globalNameTable = GetGlobalNameTable();
-
 	if ( InArchive.IsSaving() )
 	{
-		const CName::SNameEntry& nameEntry = globalNameTable[InValue.IsValid() ? InValue.index : NAME_None];
-		InArchive << nameEntry.name;
+		const CName::SNameEntry*	nameEntry = GetNameEntry( InValue.index );
+		InArchive << nameEntry->name;
 		InArchive << InValue.index;
 	}
 	else
@@ -113,14 +272,15 @@ CArchive& operator<<( CArchive& InArchive, CName& InValue )
 
 		// Else we init name
 		else
-		{	
-			if ( index < globalNameTable.size() && globalNameTable[index].name == name )
+		{
+			const CName::SNameEntry*	nameEntry = GetGlobalNameTable().GetEntry( index );
+			if ( nameEntry && nameEntry->name == name )
 			{
 				InValue.index = index;
 			}
 			else
 			{
-				InValue.Init( name );
+				InValue.Init( name.c_str(), ( uint32 )name.size() );
 			}
 		}
 	}
@@ -130,11 +290,9 @@ CArchive& operator<<( CArchive& InArchive, CName& InValue )
 
 CArchive& operator<<( CArchive& InArchive, const CName& InValue )
 {
-	std::vector<CName::SNameEntry>&	globalNameTable = GetGlobalNameTable();
-	const CName::SNameEntry&		nameEntry		= globalNameTable[InValue.IsValid() ? InValue.index : NAME_None];
-
 	check( InArchive.IsSaving() );
-	InArchive << nameEntry.name;
+	const CName::SNameEntry*	nameEntry = GetNameEntry( InValue.index );
+	InArchive << nameEntry->name;
 	InArchive << InValue.index;
 	return InArchive;
-}
\ No newline at end of file
+}
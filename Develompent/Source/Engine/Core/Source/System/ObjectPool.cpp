@@ -0,0 +1,70 @@
+#include <new>
+
+#include "Misc/Template.h"
+#include "System/ObjectPool.h"
+
+CObjectPool::CObjectPool( uint32 InElementSize )
+	: elementSize( Align( Max<uint32>( InElementSize, sizeof( SFreeElement ) ), OBJECTPOOL_ALIGNMENT ) )
+	, numSlabElements( 1 )
+	, maxSlabElements( 0 )
+	, numAllocated( 0 )
+	, reservedSize( 0 )
+	, freeList( nullptr )
+{
+	maxSlabElements = Max<uint32>( OBJECTPOOL_SLAB_SIZE / elementSize, 1 );
+}
+
+CObjectPool::~CObjectPool()
+{
+	for ( uint32 index = 0, count = slabs.size(); index < count; ++index )
+	{
+		::operator delete( slabs[index] );
+	}
+}
+
+void* CObjectPool::Allocate()
+{
+	CScopeLock		scopeLock( cs );
+	if ( !freeList )
+	{
+		AllocateSlab();
+	}
+
+	SFreeElement*	element = freeList;
+	freeList = element->next;
+	++numAllocated;
+	return element;
+}
+
+void CObjectPool::Free( void* InPointer )
+{
+	if ( !InPointer )
+	{
+		return;
+	}
+
+	CScopeLock		scopeLock( cs );
+	check( numAllocated > 0 );
+
+	// Freed element is pushed to head of free list, so it will be reused at first while it is hot in cache
+	SFreeElement*	element = ( SFreeElement* )InPointer;
+	element->next	= freeList;
+	freeList		= element;
+	--numAllocated;
+}
+
+void CObjectPool::AllocateSlab()
+{
+	byte*		slab = ( byte* )::operator new( numSlabElements * elementSize );
+	slabs.push_back( slab );
+	reservedSize += numSlabElements * elementSize;
+
+	// Link elements in order of addresses, so new objects are allocated sequentially
+	for ( uint32 index = numSlabElements; index > 0; --index )
+	{
+		SFreeElement*	element = ( SFreeElement* )( slab + ( index - 1 ) * elementSize );
+		element->next	= freeList;
+		freeList		= element;
+	}
+	numSlabElements = Min( numSlabElements * 2, maxSlabElements );
+}
@@ -4,6 +4,8 @@
 #include "Logger/LoggerMacros.h"
 #include "System/BaseFileSystem.h"
 #include "System/Archive.h"
+#include "System/MemoryTracker.h"
+#include "System/Stats.h"
 #include "System/Package.h"
 #include "System/BaseEngine.h"
 #include "Render/Texture.h"
@@ -18,6 +20,37 @@
 #include "WorldEd.h"
 #endif // WITH_EDITOR
 
+DECLARE_CYCLE_STAT( TEXT( "Load package" ), STAT_LoadPackage, SG_Loading );
+DECLARE_CYCLE_STAT( TEXT( "Load asset" ), STAT_LoadAsset, SG_Loading );
+DECLARE_CYCLE_STAT( TEXT( "Package manager tick" ), STAT_PackageManagerTick, SG_Loading );
+
+/** Number of weak references which every loaded asset holds to itself: SharedThis, GetAssetHandle and self this resource */
+#define ASSET_NUM_SELF_WEAK_REFERENCES		3
+
+/**
+ * Get number of asset handles to asset
+ * 
+ * @param InAsset	Asset
+ * @return Return number of weak references to asset without references of asset to itself
+ */
+static FORCEINLINE uint32 GetNumAssetHandles( const TSharedPtr<CAsset>& InAsset )
+{
+	return Max<int32>( ( int32 )InAsset.GetWeakReferenceCount() - ASSET_NUM_SELF_WEAK_REFERENCES, 0 );
+}
+
+/**
+ * Is asset referenced by someone except known owners
+ * 
+ * @param InAsset				Asset
+ * @param InNumKnownShared		Number of known shared references (package, SAssetInfo copies of caller)
+ * @param InNumKnownHandles		Number of known asset handles (dependent assets sets of caller)
+ * @return Return TRUE if asset has more references than known owners hold, else return FALSE
+ */
+static FORCEINLINE bool IsAssetReferenced( const TSharedPtr<CAsset>& InAsset, uint32 InNumKnownShared, uint32 InNumKnownHandles )
+{
+	return InAsset.GetSharedReferenceCount() > InNumKnownShared || GetNumAssetHandles( InAsset ) > InNumKnownHandles;
+}
+
 //
 // ASSET
 //
@@ -100,6 +133,11 @@ void CAsset::GetDependentAssets( SetDependentAssets_t& OutDependentAssets, EAsse
 void CAsset::ReloadDependentAssets( bool InForce /* = false */ )
 {}
 
+uint64 CAsset::GetResidentSize() const
+{
+	return 0;
+}
+
 SAssetReference CAsset::GetAssetReference() const
 {
 	return SAssetReference( type, guid, package ? package->GetGUID() : CGuid() );
@@ -192,13 +230,23 @@ CPackage::CPackage( const std::wstring& InName /* = TEXT( "" ) */ )
 CPackage::~CPackage()
 {
 	RemoveAll( true );
+
+	// Dirty assets could remain in memory, they no longer belong to the package
+	for ( auto itAsset = assetsTable.begin(), itAssetEnd = assetsTable.end(); itAsset != itAssetEnd; ++itAsset )
+	{
+		if ( itAsset->second.data )
+		{
+			GPackageManager->RemoveResidentAsset( itAsset->second );
+		}
+	}
 }
 
 bool CPackage::Load( const std::wstring& InPath )
 {
+	SCOPE_CYCLE_COUNTER( STAT_LoadPackage );
 	RemoveAll( true );
 
-	CArchive*		archive = GFileSystem->CreateFileReader( InPath );
+	CArchive*		archive = GPackageManager->GetFileHandleCache().CreateReader( InPath );
 	if ( !archive )
 	{
 		return false;
@@ -279,7 +327,7 @@ void CPackage::FullyLoad( std::vector< TAssetHandle<CAsset> >& OutAssetArray )
 	}
 
 	// Serialize all assets to memory
-	CArchive*		archive = GFileSystem->CreateFileReader( filename, AR_NoFail );
+	CArchive*		archive = GPackageManager->GetFileHandleCache().CreateReader( filename, AR_NoFail );
 	archive->SerializeHeader();
 	SerializeHeader( *archive, true );
 
@@ -320,6 +368,7 @@ TAssetHandle<CAsset> CPackage::Find( const CGuid& InGUID )
 	// If asset already in memory - return it
 	if ( itAsset->second.data )
 	{
+		GPackageManager->TouchResidentAsset( itAsset->second );
 		return itAsset->second.data->GetAssetHandle();
 	}
 
@@ -330,7 +379,7 @@ TAssetHandle<CAsset> CPackage::Find( const CGuid& InGUID )
 	}
 
 	// Serialize asset from package
-	CArchive*	archive = GFileSystem->CreateFileReader( filename );
+	CArchive*	archive = GPackageManager->GetFileHandleCache().CreateReader( filename );
 	if ( !archive )
 	{
 		return nullptr;
@@ -465,6 +514,9 @@ void CPackage::SerializeHeader( CArchive& InArchive, bool InIsNeedSkip /* = fals
 
 TAssetHandle<CAsset> CPackage::LoadAsset( CArchive& InArchive, const CGuid& InAssetGUID, SAssetInfo& InAssetInfo, bool InNeedReload /* = false */ )
 {
+	SCOPED_MEMORY_TAG( MT_Package );
+	SCOPE_CYCLE_COUNTER( STAT_LoadAsset );
+
 	uint32		oldOffset = InArchive.Tell();
 
 	// If asset info is not valid - return nullptr
@@ -489,6 +541,7 @@ TAssetHandle<CAsset> CPackage::LoadAsset( CArchive& InArchive, const CGuid& InAs
 	// If asset not need reload - return already created handle
 	if ( bValidAsset && !InNeedReload )
 	{
+		GPackageManager->TouchResidentAsset( InAssetInfo );
 		return InAssetInfo.data->GetAssetHandle();
 	}
 
@@ -516,6 +569,9 @@ TAssetHandle<CAsset> CPackage::LoadAsset( CArchive& InArchive, const CGuid& InAs
 		++numLoadedAssets;
 	}
 
+	// Account memory of asset, size of reloaded asset could be changed
+	GPackageManager->AddResidentAsset( this, InAssetInfo );
+
 	// Seek to old offset and exit
 	InArchive.Seek( oldOffset );
 	return InAssetInfo.data->GetAssetHandle();
@@ -702,6 +758,9 @@ bool CPackage::UnloadAsset( SAssetInfo& InAssetInfo, bool InForceUnload /* = fal
 			bIsDirty = false;
 		}
 
+		// Asset no longer uses memory
+		GPackageManager->RemoveResidentAsset( InAssetInfo );
+
 		// If the asset was added to the package only in memory, then we remove its mention 
 		// from the package itself, since data is needed to write to the HDD, which is now unloading
 		if ( InAssetInfo.offset == INVALID_ID && InAssetInfo.size == INVALID_ID )
@@ -812,7 +871,7 @@ bool CPackage::ReloadAsset( SAssetInfo& InAssetInfo )
 	}
 
 	// Open package for reload asset
-	CArchive*		archive = GFileSystem->CreateFileReader( filename );
+	CArchive*		archive = GPackageManager->GetFileHandleCache().CreateReader( filename );
 	if ( !archive )
 	{
 		return false;
@@ -855,7 +914,7 @@ bool CPackage::ReloadPackage( bool InOnlyAsset /* = false */ )
 	}
 
 	// Open package for reload asset
-	CArchive*		archive = GFileSystem->CreateFileReader( filename );
+	CArchive*		archive = GPackageManager->GetFileHandleCache().CreateReader( filename );
 	if ( !archive )
 	{
 		return false;
@@ -938,16 +997,52 @@ bool CPackage::ReloadPackage( bool InOnlyAsset /* = false */ )
 //
 
 CPackageManager::CPackageManager()
-{}
+{
+	memset( memoryUsage, 0, sizeof( memoryUsage ) );
+	memset( memoryBudgets, 0, sizeof( memoryBudgets ) );
+}
 
 void CPackageManager::Init()
-{}
+{
+	// Get maximum number of opened file handles
+	CConfigValue		configMaxOpenFileHandles = GConfig.GetValue( CT_Engine, TEXT( "Engine.PackageManager" ), TEXT( "MaxOpenFileHandles" ) );
+	if ( configMaxOpenFileHandles.IsA( CConfigValue::T_Int ) )
+	{
+		fileHandleCache.SetMaxHandles( Max( configMaxOpenFileHandles.GetInt(), 1 ) );
+	}
+
+	// Cached handles must be dropped on every write, move and delete of file
+	GFileSystem->SetFileHandleCache( &fileHandleCache );
+
+	// Get memory budgets of assets (in megabytes)
+	CConfigValue		configMemoryBudgets = GConfig.GetValue( CT_Engine, TEXT( "Engine.PackageManager" ), TEXT( "MemoryBudgetsMB" ) );
+	if ( configMemoryBudgets.IsA( CConfigValue::T_Object ) )
+	{
+		CConfigObject		objectMemoryBudgets = configMemoryBudgets.GetObject();
+		for ( uint32 type = AT_Unknown; type < AT_Count; ++type )
+		{
+			CConfigValue	configBudget = objectMemoryBudgets.GetValue( type == AT_Unknown ? TEXT( "Total" ) : ConvertAssetTypeToText( ( EAssetType )type ).c_str() );
+			if ( configBudget.IsA( CConfigValue::T_Int ) )
+			{
+				memoryBudgets[ type ] = ( uint64 )Max( configBudget.GetInt(), 0 ) * 1024 * 1024;
+			}
+		}
+	}
+}
 
 void CPackageManager::Tick()
-{}
+{
+	SCOPE_CYCLE_COUNTER( STAT_PackageManagerTick );
+
+	// Unload not referenced assets if we over budgets
+	EvictUnreferencedAssets();
+}
 
 void CPackageManager::Shutdown()
-{}
+{
+	GFileSystem->SetFileHandleCache( nullptr );
+	fileHandleCache.Flush();
+}
 
 bool ParseReferenceToAsset( const std::wstring& InString, std::wstring& OutPackageName, std::wstring& OutAssetName, EAssetType& OutAssetType )
 {
@@ -1271,9 +1366,8 @@ void CPackageManager::GarbageCollector()
 				continue;
 			}
 
-			// Unload asset only if weak references is not exist
-			bool		bCanUnloadAsset = assetInfo.data.GetSharedReferenceCount() <= 2 && assetInfo.data.GetWeakReferenceCount() <= 3;		// 2 shared reference this is two SAssetInfo, one in current section, other in package
-																																			// 3 weak references containing in SharedThis, GetAssetHandle and self this resource
+			// Unload asset only if asset handles is not exist. 2 shared reference this is two SAssetInfo, one in current section, other in package
+			bool		bCanUnloadAsset = !IsAssetReferenced( assetInfo.data, 2, 0 );
 			if ( bCanUnloadAsset && package->UnloadAsset( assetInfo.data->GetGUID(), true ) )
 			{
 				// Try unload dependent assets
@@ -1290,8 +1384,9 @@ void CPackageManager::GarbageCollector()
 					}
 
 					// Is we can unload this asset?
-					bool	bCanUnloadDependentAsset = dependetAsset.GetSharedReferenceCount() <= 2 && dependetAsset.GetWeakReferenceCount() <= 5;		// Shared reference: 2 because one in current section, other in package
-																																						// Weak reference: 5 because one in current section (SetDependentAssets_t), second in parent asset and other self this resource, SharedThis and GetAssetHandle
+					// Shared reference: 2 because one in current section, other in package
+					// Asset handles: 2 because one in current section (SetDependentAssets_t), second in parent asset
+					bool	bCanUnloadDependentAsset = !IsAssetReferenced( dependetAsset, 2, 2 );
 					if ( !bCanUnloadDependentAsset )
 					{
 						continue;
@@ -1342,7 +1437,175 @@ void CPackageManager::GarbageCollector()
 		packages.erase( package->GetFileName() );
 	}
 
+	// Close file handles of unloaded packages
+	fileHandleCache.Flush();
+
 	double		endGCTime = appSeconds();
 	LE_LOG( LT_Log, LC_Package, TEXT( "Unloaded %i assets and %i packages" ), numUnloadedAssets, numUnloadedPackages );
 	LE_LOG( LT_Log, LC_Package, TEXT( "%f ms for realtime GC" ), ( endGCTime - startGCTime ) / 1000.f );
-}
\ No newline at end of file
+}
+
+void CPackageManager::AddResidentAsset( CPackage* InPackage, const SAssetInfo& InAssetInfo )
+{
+	// Assets which not exist on HDD we can't unload, so not account them
+	check( InPackage && InAssetInfo.data );
+	if ( InAssetInfo.offset == ( uint32 )INVALID_ID || InAssetInfo.size == ( uint32 )INVALID_ID )
+	{
+		return;
+	}
+
+	CScopeLock	scopeLock( residentAssetsCS );
+	auto		itAsset = residentAssetsMap.find( InAssetInfo.data.Get() );
+	if ( itAsset != residentAssetsMap.end() )
+	{
+		SResidentAsset&		residentAsset = *itAsset->second;
+		memoryUsage[ AT_Unknown ]			-= residentAsset.size;
+		memoryUsage[ residentAsset.type ]	-= residentAsset.size;
+		residentAssets.splice( residentAssets.begin(), residentAssets, itAsset->second );
+	}
+	else
+	{
+		residentAssets.push_front( SResidentAsset{ InPackage, InAssetInfo.data->GetGUID(), InAssetInfo.type, 0 } );
+		residentAssetsMap.insert( std::make_pair( InAssetInfo.data.Get(), residentAssets.begin() ) );
+	}
+
+	SResidentAsset&		residentAsset = residentAssets.front();
+	residentAsset.size					= InAssetInfo.data->GetResidentSize();
+	memoryUsage[ AT_Unknown ]			+= residentAsset.size;
+	memoryUsage[ residentAsset.type ]	+= residentAsset.size;
+}
+
+void CPackageManager::RemoveResidentAsset( const SAssetInfo& InAssetInfo )
+{
+	CScopeLock	scopeLock( residentAssetsCS );
+	auto		itAsset = residentAssetsMap.find( InAssetInfo.data.Get() );
+	if ( itAsset == residentAssetsMap.end() )
+	{
+		return;
+	}
+
+	const SResidentAsset&		residentAsset = *itAsset->second;
+	memoryUsage[ AT_Unknown ]			-= residentAsset.size;
+	memoryUsage[ residentAsset.type ]	-= residentAsset.size;
+	residentAssets.erase( itAsset->second );
+	residentAssetsMap.erase( itAsset );
+}
+
+void CPackageManager::TouchResidentAsset( const SAssetInfo& InAssetInfo )
+{
+	CScopeLock	scopeLock( residentAssetsCS );
+	auto		itAsset = residentAssetsMap.find( InAssetInfo.data.Get() );
+	if ( itAsset == residentAssetsMap.end() )
+	{
+		return;
+	}
+
+	// Memory of asset can be changed after loading (e.g. streamed mips of texture), so update it
+	SResidentAsset&		residentAsset = *itAsset->second;
+	uint64				newSize = InAssetInfo.data->GetResidentSize();
+	memoryUsage[ AT_Unknown ]			+= newSize - residentAsset.size;
+	memoryUsage[ residentAsset.type ]	+= newSize - residentAsset.size;
+	residentAsset.size					= newSize;
+	residentAssets.splice( residentAssets.begin(), residentAssets, itAsset->second );
+}
+
+uint32 CPackageManager::EvictUnreferencedAssets( bool InIgnoreBudgets /* = false */ )
+{
+	// Unloading of asset removes it from resident assets, it is safe because critical section is recursive
+	CScopeLock		scopeLock( residentAssetsCS );
+
+	// Quick exit if all budgets are respected
+	if ( !InIgnoreBudgets )
+	{
+		bool	bOverBudget = false;
+		for ( uint32 type = AT_Unknown; type < AT_Count && !bOverBudget; ++type )
+		{
+			bOverBudget = IsOverBudget( ( EAssetType )type );
+		}
+
+		if ( !bOverBudget )
+		{
+			return 0;
+		}
+	}
+
+	// Walk from least recently used asset. Assets which still referenced or dirty we skip
+	uint32															numUnloadedAssets = 0;
+	std::unordered_set< PackageRef_t, PackageRef_t::SHashFunction >	touchedPackages;
+	for ( auto itAsset = residentAssets.end(); itAsset != residentAssets.begin(); )
+	{
+		--itAsset;
+		CPackage*		package = itAsset->package;
+		if ( !InIgnoreBudgets && !IsOverBudget( itAsset->type ) )
+		{
+			continue;
+		}
+
+		auto			itAssetInfo = package->assetsTable.find( itAsset->guid );
+		check( itAssetInfo != package->assetsTable.end() && itAssetInfo->second.data );
+
+		// Asset can be unloaded only if shared reference is in package and asset handles is not exist
+		SAssetInfo&		assetInfo = itAssetInfo->second;
+		if ( assetInfo.data->IsDirty() || IsAssetReferenced( assetInfo.data, 1, 0 ) )
+		{
+			continue;
+		}
+
+		// Item of unloaded asset will be removed from list, so remember next one
+		auto			itNextAsset = std::next( itAsset );
+		if ( package->UnloadAsset( assetInfo, true ) )
+		{
+			LE_LOG( LT_Log, LC_Package, TEXT( "Asset '%s:%s' evicted" ), package->GetName().c_str(), assetInfo.name.c_str() );
+			touchedPackages.insert( PackageRef_t( package ) );
+			itAsset = itNextAsset;
+			++numUnloadedAssets;
+		}
+	}
+
+	// Unload packages which have no loaded assets
+	for ( auto itPackage = touchedPackages.begin(), itPackageEnd = touchedPackages.end(); itPackage != itPackageEnd; ++itPackage )
+	{
+		PackageRef_t		package = *itPackage;
+		if ( !package->IsDirty() && package->GetNumLoadedAssets() <= 0 && !package->GetFileName().empty() )
+		{
+			LE_LOG( LT_Log, LC_Package, TEXT( "Package '%s' unloaded" ), package->GetName().c_str() );
+			packages.erase( package->GetFileName() );
+		}
+	}
+
+	return numUnloadedAssets;
+}
+
+void CPackageManager::DumpMemoryUsage() const
+{
+	CScopeLock		scopeLock( residentAssetsCS );
+	LE_LOG( LT_Log, LC_Package, TEXT( "Memory of assets:" ) );
+	for ( uint32 type = AT_Unknown; type < AT_Count; ++type )
+	{
+		std::wstring		typeName = type == AT_Unknown ? TEXT( "Total" ) : ConvertAssetTypeToText( ( EAssetType )type );
+		if ( memoryBudgets[ type ] > 0 )
+		{
+			LE_LOG( LT_Log, LC_Package, TEXT( "  %s: %.2f / %.2f MB" ), typeName.c_str(), memoryUsage[ type ] / ( 1024.f * 1024.f ), memoryBudgets[ type ] / ( 1024.f * 1024.f ) );
+		}
+		else
+		{
+			LE_LOG( LT_Log, LC_Package, TEXT( "  %s: %.2f MB (no budget)" ), typeName.c_str(), memoryUsage[ type ] / ( 1024.f * 1024.f ) );
+		}
+	}
+}
+
+void CPackageManager::DumpResidentAssets() const
+{
+	CScopeLock		scopeLock( residentAssetsCS );
+	LE_LOG( LT_Log, LC_Package, TEXT( "Loaded assets (most recently used first):" ) );
+	for ( auto itAsset = residentAssets.begin(), itAssetEnd = residentAssets.end(); itAsset != itAssetEnd; ++itAsset )
+	{
+		const SResidentAsset&		residentAsset = *itAsset;
+		auto						itAssetInfo = residentAsset.package->assetsTable.find( residentAsset.guid );
+		check( itAssetInfo != residentAsset.package->assetsTable.end() && itAssetInfo->second.data );
+
+		const SAssetInfo&			assetInfo = itAssetInfo->second;
+		LE_LOG( LT_Log, LC_Package, TEXT( "  %s'%s:%s': %.2f KB, %i handles%s" ), ConvertAssetTypeToText( residentAsset.type ).c_str(), residentAsset.package->GetName().c_str(), assetInfo.name.c_str(), residentAsset.size / 1024.f, GetNumAssetHandles( assetInfo.data ), assetInfo.data->IsDirty() ? TEXT( ", dirty" ) : TEXT( "" ) );
+	}
+	LE_LOG( LT_Log, LC_Package, TEXT( "%u assets, %.2f MB" ), ( uint32 )residentAssets.size(), memoryUsage[ AT_Unknown ] / ( 1024.f * 1024.f ) );
+}
@@ -0,0 +1,735 @@
+#include <stdio.h>
+#include <algorithm>
+#include <ctime>
+
+#include "Misc/CoreGlobals.h"
+#include "Misc/Misc.h"
+#include "Containers/String.h"
+#include "Logger/LoggerMacros.h"
+#include "System/Archive.h"
+#include "System/BaseFileSystem.h"
+#include "System/Malloc.h"
+#include "System/MemoryTracker.h"
+#include "System/Stats.h"
+
+/**
+ * Names of stat groups
+ */
+static const tchar*		GStatGroupNames[SG_Num] =
+{
+	TEXT( "Engine" ),
+	TEXT( "Scene" ),
+	TEXT( "Audio" ),
+	TEXT( "Physics" ),
+	TEXT( "Loading" ),
+	TEXT( "Memory" )
+};
+
+/**
+ * Size of chunks in which trace is written to file
+ */
+#define STATS_TRACE_WRITE_CHUNK		( 1024 * 1024 )
+
+/**
+ * Owner of buffer of thread, frees buffer when thread exits
+ */
+struct SStatThreadBufferOwner
+{
+	/**
+	 * Destructor
+	 */
+	~SStatThreadBufferOwner()
+	{
+		if ( buffer )
+		{
+			CScopeLock		scopeLock( GStats.cs );
+			buffer->bFree = true;
+		}
+	}
+
+	SStatThreadBuffer*		buffer;		/**< Buffer of thread */
+};
+
+/** Buffer of current thread */
+static thread_local SStatThreadBufferOwner		GStatThreadBuffer;
+
+CStats			GStats;
+
+const tchar* appStatGroupToText( EStatGroup InGroup )
+{
+	return InGroup < SG_Num ? GStatGroupNames[InGroup] : TEXT( "Unknown" );
+}
+
+/**
+ * Convert cycles to milliseconds
+ */
+static FORCEINLINE double CyclesToMs( uint64 InCycles )
+{
+	return InCycles * GSecondsPerCycle * 1000.0;
+}
+
+/**
+ * Append string to JSON with escaping, not ASCII chars are replaced by '?'
+ */
+static void AppendJsonString( std::string& OutJson, const tchar* InString )
+{
+	OutJson += '"';
+	for ( const tchar* ch = InString; *ch; ++ch )
+	{
+		if ( *ch == TEXT( '"' ) || *ch == TEXT( '\\' ) )
+		{
+			OutJson += '\\';
+			OutJson += ( achar )*ch;
+		}
+		else if ( *ch < 32 || *ch > 126 )
+		{
+			OutJson += *ch < 32 ? ' ' : '?';
+		}
+		else
+		{
+			OutJson += ( achar )*ch;
+		}
+	}
+	OutJson += '"';
+}
+
+CStatDescriptor::CStatDescriptor( const tchar* InName, EStatGroup InGroup, EStatType InType )
+	: name( InName )
+	, group( InGroup )
+	, type( InType )
+	, value( 0 )
+{
+	// Descriptors are registered at static initialization, so there are no other threads yet
+	std::vector<CStatDescriptor*>&		descriptors = CStats::GetDescriptors();
+	index = ( uint32 )descriptors.size();
+	descriptors.push_back( this );
+	check( index < 0xFFFF );
+}
+
+CStats::CStats()
+	: bEnabled( false )
+	, bShowUnit( false )
+	, numWindowFrames( 0 )
+	, windowFrameTime( 0.0 )
+	, windowMaxFrameTime( 0.0 )
+	, windowStartTime( 0.0 )
+	, bTraceCapture( false )
+	, traceFramesLeft( 0 )
+	, traceEndTime( 0.0 )
+	, traceStartCycles( 0 )
+	, traceFrameStartCycles( 0 )
+{
+	memset( bShowGroups, 0, sizeof( bShowGroups ) );
+}
+
+std::vector<CStatDescriptor*>& CStats::GetDescriptors()
+{
+	static std::vector<CStatDescriptor*>		descriptors;
+	return descriptors;
+}
+
+SStatThreadBuffer* CStats::GetThreadBuffer()
+{
+	if ( !GStatThreadBuffer.buffer )
+	{
+		// Threads like audio streaming are created often, so buffers of exited threads are reused.
+		// Buffer with not collected events is skipped, else its events would be attributed to new thread.
+		// While stats are disabled events are never collected, they would be dropped on enabling, so we drop them here
+		CScopeLock				scopeLock( GStats.cs );
+		SStatThreadBuffer*		buffer = nullptr;
+		for ( uint32 index = 0, count = ( uint32 )GStats.threadBuffers.size(); index < count && !buffer; ++index )
+		{
+			SStatThreadBuffer*		freeBuffer = GStats.threadBuffers[index];
+			CScopeLock				bufferScopeLock( freeBuffer->cs );
+			if ( freeBuffer->bFree && ( freeBuffer->events.empty() || !GStats.bEnabled ) )
+			{
+				freeBuffer->events.clear();
+				buffer = freeBuffer;
+			}
+		}
+
+		if ( !buffer )
+		{
+			buffer = new SStatThreadBuffer();
+			GStats.threadBuffers.push_back( buffer );
+		}
+
+		buffer->threadId	= appGetCurrentThreadId();
+		buffer->depth		= 0;
+		buffer->bFree		= false;
+		buffer->name		= CString::Format( TEXT( "Thread_%u" ), buffer->threadId );
+		GStatThreadBuffer.buffer = buffer;
+	}
+	return GStatThreadBuffer.buffer;
+}
+
+void CStats::SetThreadName( const std::wstring& InName )
+{
+	SStatThreadBuffer*		buffer = GetThreadBuffer();
+	CScopeLock				scopeLock( cs );
+	buffer->name = InName;
+}
+
+void CStats::EndScope( const CStatDescriptor& InStat, uint64 InStartCycles )
+{
+	uint64					endCycles	= appCycles();
+	SStatThreadBuffer*		buffer		= GetThreadBuffer();
+	check( buffer->depth > 0 );
+
+	// Too deep scopes aren't recorded, but still counted for correct depth of others
+	uint32		depth = --buffer->depth;
+	if ( depth >= STATS_MAX_DEPTH )
+	{
+		return;
+	}
+
+	SStatEvent		event;
+	event.startCycles		= InStartCycles;
+	event.endCycles			= endCycles;
+	event.statIndex			= InStat.GetIndex();
+	event.parentStatIndex	= depth > 0 ? buffer->stack[depth - 1] : 0xFFFF;
+	event.depth				= ( uint16 )depth;
+	event.threadId			= buffer->threadId;
+
+	CScopeLock		scopeLock( buffer->cs );
+	if ( buffer->events.size() < STATS_MAX_THREAD_EVENTS )
+	{
+		buffer->events.push_back( event );
+	}
+}
+
+void CStats::AdvanceFrame( float InDeltaSeconds )
+{
+	std::vector<CStatDescriptor*>&		descriptors = GetDescriptors();
+	if ( !bEnabled )
+	{
+		// Counters aren't shown, only keep them from growing
+		for ( uint32 index = 0, count = ( uint32 )descriptors.size(); index < count; ++index )
+		{
+			if ( descriptors[index]->type == ST_Counter )
+			{
+				descriptors[index]->Set( 0 );
+			}
+		}
+		return;
+	}
+
+	CScopeLock		scopeLock( cs );
+	threadFrameCycles.resize( threadBuffers.size(), 0 );
+	threadTotalCycles.resize( threadBuffers.size(), 0 );
+	threadMaxCycles.resize( threadBuffers.size(), 0 );
+	counters.resize( descriptors.size() );
+
+	// Collect events from all threads, buffers are swapped to keep locks short
+	for ( uint32 threadIndex = 0, numThreads = ( uint32 )threadBuffers.size(); threadIndex < numThreads; ++threadIndex )
+	{
+		SStatThreadBuffer*		buffer = threadBuffers[threadIndex];
+		{
+			CScopeLock		bufferScopeLock( buffer->cs );
+			scratchEvents.swap( buffer->events );
+		}
+
+		// Keep raw events for trace
+		if ( bTraceCapture )
+		{
+			AppendTraceEvents( scratchEvents, buffer->name );
+		}
+
+		for ( uint32 index = 0, count = ( uint32 )scratchEvents.size(); index < count; ++index )
+		{
+			const SStatEvent&	event		= scratchEvents[index];
+			uint64				cycles		= event.endCycles - event.startCycles;
+			uint64				key			= ( ( uint64 )threadIndex << 32 ) | ( ( uint64 )event.parentStatIndex << 16 ) | event.statIndex;
+			auto				itNode		= nodes.find( key );
+			if ( itNode == nodes.end() )
+			{
+				SStatNode		node;
+				node.threadIndex		= threadIndex;
+				node.statIndex			= event.statIndex;
+				node.parentStatIndex	= event.parentStatIndex != 0xFFFF ? event.parentStatIndex : INDEX_NONE;
+				node.depth				= event.depth;
+				node.firstCycles		= event.startCycles;
+				node.totalCycles		= 0;
+				node.frameCycles		= 0;
+				node.maxFrameCycles		= 0;
+				node.numCalls			= 0;
+				itNode = nodes.insert( std::make_pair( key, node ) ).first;
+			}
+
+			SStatNode&		node = itNode->second;
+			node.firstCycles	= Min( node.firstCycles, event.startCycles );
+			node.frameCycles	+= cycles;
+			++node.numCalls;
+			if ( event.depth == 0 )
+			{
+				threadFrameCycles[threadIndex] += cycles;
+			}
+		}
+		scratchEvents.clear();
+	}
+
+	// Close the frame
+	for ( auto itNode = nodes.begin(), itNodeEnd = nodes.end(); itNode != itNodeEnd; ++itNode )
+	{
+		SStatNode&		node = itNode->second;
+		node.totalCycles	+= node.frameCycles;
+		node.maxFrameCycles	= Max( node.maxFrameCycles, node.frameCycles );
+		node.frameCycles	= 0;
+	}
+
+	for ( uint32 threadIndex = 0, numThreads = ( uint32 )threadBuffers.size(); threadIndex < numThreads; ++threadIndex )
+	{
+		threadTotalCycles[threadIndex]	+= threadFrameCycles[threadIndex];
+		threadMaxCycles[threadIndex]	= Max( threadMaxCycles[threadIndex], threadFrameCycles[threadIndex] );
+		threadFrameCycles[threadIndex]	= 0;
+	}
+
+	for ( uint32 index = 0, count = ( uint32 )descriptors.size(); index < count; ++index )
+	{
+		if ( descriptors[index]->type == ST_Counter )
+		{
+			int64		value = appInterlockedExchange64( &descriptors[index]->value, 0 );
+			counters[index].total	+= value;
+			counters[index].max		= Max( counters[index].max, value );
+		}
+	}
+
+	++numWindowFrames;
+	windowFrameTime		+= InDeltaSeconds;
+	windowMaxFrameTime	= Max<double>( windowMaxFrameTime, InDeltaSeconds );
+	if ( appSeconds() - windowStartTime >= STATS_UPDATE_PERIOD )
+	{
+		UpdateDisplayLines();
+	}
+
+	if ( bTraceCapture )
+	{
+		// Frames are written on separate track
+		STraceEvent		frameEvent;
+		frameEvent.startCycles		= traceFrameStartCycles;
+		frameEvent.endCycles		= appCycles();
+		frameEvent.statIndex		= ( uint32 )INDEX_NONE;
+		frameEvent.threadId			= 0;
+		traceEvents.push_back( frameEvent );
+		traceFrameStartCycles		= frameEvent.endCycles;
+
+		bool		bOverflow = traceEvents.size() >= STATS_MAX_TRACE_EVENTS;
+		if ( bOverflow )
+		{
+			LE_LOG( LT_Warning, LC_General, TEXT( "Trace capture reached maximum number of events (%u), it's finished earlier" ), STATS_MAX_TRACE_EVENTS );
+		}
+
+		if ( bOverflow || ( traceFramesLeft > 0 ? --traceFramesLeft == 0 : appSeconds() >= traceEndTime ) )
+		{
+			EndTraceCapture();
+		}
+	}
+}
+
+void CStats::AppendTraceEvents( const std::vector<SStatEvent>& InEvents, const std::wstring& InThreadName )
+{
+	if ( InEvents.empty() )
+	{
+		return;
+	}
+
+	// Buffer with events isn't reused by other thread, so all events of buffer are from thread with buffer's name
+	traceThreadNames[InEvents[0].threadId] = InThreadName;
+	for ( uint32 index = 0, count = ( uint32 )InEvents.size(); index < count && traceEvents.size() < STATS_MAX_TRACE_EVENTS; ++index )
+	{
+		const SStatEvent&	event = InEvents[index];
+		if ( event.startCycles >= traceStartCycles )
+		{
+			STraceEvent		traceEvent;
+			traceEvent.startCycles	= event.startCycles;
+			traceEvent.endCycles	= event.endCycles;
+			traceEvent.statIndex	= event.statIndex;
+			traceEvent.threadId		= event.threadId;
+			traceEvents.push_back( traceEvent );
+		}
+	}
+}
+
+void CStats::UpdateDisplayLines()
+{
+	std::vector<CStatDescriptor*>&		descriptors = GetDescriptors();
+	std::vector<std::wstring>			lines;
+	double								numFrames	= Max<uint32>( numWindowFrames, 1 );
+
+	if ( bShowUnit )
+	{
+		lines.push_back( CString::Format( TEXT( "Frame: %.2f ms (max %.2f ms), %.1f FPS" ), windowFrameTime * 1000.0 / numFrames, windowMaxFrameTime * 1000.0, windowFrameTime > 0.0 ? numFrames / windowFrameTime : 0.0 ) );
+		for ( uint32 threadIndex = 0, numThreads = ( uint32 )threadBuffers.size(); threadIndex < numThreads; ++threadIndex )
+		{
+			if ( threadTotalCycles[threadIndex] > 0 )
+			{
+				lines.push_back( CString::Format( TEXT( "%s: %.2f ms (max %.2f ms)" ), threadBuffers[threadIndex]->name.c_str(), CyclesToMs( threadTotalCycles[threadIndex] ) / numFrames, CyclesToMs( threadMaxCycles[threadIndex] ) ) );
+			}
+		}
+	}
+
+	// Sort cycle counters by thread and by first call, so parent scopes go before children
+	std::vector<const SStatNode*>		sortedNodes;
+	sortedNodes.reserve( nodes.size() );
+	for ( auto itNode = nodes.begin(), itNodeEnd = nodes.end(); itNode != itNodeEnd; ++itNode )
+	{
+		sortedNodes.push_back( &itNode->second );
+	}
+
+	std::sort( sortedNodes.begin(), sortedNodes.end(), []( const SStatNode* InA, const SStatNode* InB )
+			   {
+				   return InA->threadIndex != InB->threadIndex ? InA->threadIndex < InB->threadIndex : InA->firstCycles < InB->firstCycles;
+			   } );
+
+	for ( uint32 group = 0; group < SG_Num; ++group )
+	{
+		if ( !bShowGroups[group] )
+		{
+			continue;
+		}
+
+		lines.push_back( CString::Format( TEXT( "[%s]" ), GStatGroupNames[group] ) );
+		uint32		lastThreadIndex = INDEX_NONE;
+		for ( uint32 index = 0, count = ( uint32 )sortedNodes.size(); index < count; ++index )
+		{
+			const SStatNode*		node = sortedNodes[index];
+			const CStatDescriptor*	stat = descriptors[node->statIndex];
+			if ( stat->group != group )
+			{
+				continue;
+			}
+
+			if ( node->threadIndex != lastThreadIndex )
+			{
+				lines.push_back( CString::Format( TEXT( "  %s" ), threadBuffers[node->threadIndex]->name.c_str() ) );
+				lastThreadIndex = node->threadIndex;
+			}
+
+			lines.push_back( CString::Format( TEXT( "%*s%s: %.2f ms (max %.2f ms), %.1f calls" ), 4 + node->depth * 2, TEXT( "" ), stat->name,
+											  CyclesToMs( node->totalCycles ) / numFrames, CyclesToMs( node->maxFrameCycles ), node->numCalls / numFrames ) );
+		}
+
+		for ( uint32 index = 0, count = ( uint32 )descriptors.size(); index < count; ++index )
+		{
+			const CStatDescriptor*		stat = descriptors[index];
+			if ( stat->group != group )
+			{
+				continue;
+			}
+
+			if ( stat->type == ST_Counter )
+			{
+				lines.push_back( CString::Format( TEXT( "  %s: %.1f (max %lli)" ), stat->name, counters[index].total / numFrames, counters[index].max ) );
+			}
+			else if ( stat->type == ST_Memory )
+			{
+				lines.push_back( CString::Format( TEXT( "  %s: %.2f MB" ), stat->name, stat->value / ( 1024.0 * 1024.0 ) ) );
+			}
+		}
+
+		if ( group == SG_Memory )
+		{
+#if USE_MALLOC_BINNED
+			SMallocStats		mallocStats = CMallocBinned::Get().GetStats();
+			lines.push_back( CString::Format( TEXT( "  Allocator reserved: %.2f MB, %u arenas%s" ), mallocStats.reservedSize / ( 1024.0 * 1024.0 ), mallocStats.numArenas, mallocStats.bLargePages ? TEXT( " (large pages)" ) : TEXT( "" ) ) );
+			lines.push_back( CString::Format( TEXT( "  Allocator large blocks: %.2f MB in %u blocks" ), mallocStats.largeSize / ( 1024.0 * 1024.0 ), mallocStats.numLargeBlocks ) );
+#else
+			lines.push_back( TEXT( "  Allocator: n/a (built without USE_MALLOC_BINNED)" ) );
+#endif // USE_MALLOC_BINNED
+
+#if USE_MALLOC_TRACKING
+			SMemoryTagStats		tagStats[MT_Num];
+			CMemoryTracker::Get().GetTagStats( tagStats );
+			for ( uint32 tag = 0; tag < MT_Num; ++tag )
+			{
+				lines.push_back( CString::Format( TEXT( "  %s: %.2f MB (peak %.2f MB)" ), appMemoryTagToText( ( EMemoryTag )tag ), tagStats[tag].liveBytes / ( 1024.0 * 1024.0 ), tagStats[tag].peakBytes / ( 1024.0 * 1024.0 ) ) );
+			}
+#else
+			lines.push_back( TEXT( "  Memory tags: n/a (built without USE_MALLOC_TRACKING)" ) );
+#endif // USE_MALLOC_TRACKING
+		}
+	}
+
+	// Reset window
+	nodes.clear();
+	counters.assign( counters.size(), SCounterValue() );
+	std::fill( threadTotalCycles.begin(), threadTotalCycles.end(), 0 );
+	std::fill( threadMaxCycles.begin(), threadMaxCycles.end(), 0 );
+	numWindowFrames		= 0;
+	windowFrameTime		= 0.0;
+	windowMaxFrameTime	= 0.0;
+	windowStartTime		= appSeconds();
+
+#if !WITH_IMGUI
+	// Without UI stats are written to log
+	for ( uint32 index = 0, count = ( uint32 )lines.size(); index < count; ++index )
+	{
+		LE_LOG( LT_Log, LC_General, TEXT( "%s" ), lines[index].c_str() );
+	}
+#endif // !WITH_IMGUI
+
+	CScopeLock		scopeLock( displayCS );
+	displayLines.swap( lines );
+}
+
+void CStats::ToggleUnit()
+{
+	bShowUnit = !bShowUnit;
+	UpdateEnabled();
+}
+
+void CStats::ToggleGroup( EStatGroup InGroup )
+{
+	check( InGroup < SG_Num );
+	bShowGroups[InGroup] = !bShowGroups[InGroup];
+	UpdateEnabled();
+}
+
+void CStats::HideAll()
+{
+	bShowUnit = false;
+	memset( bShowGroups, 0, sizeof( bShowGroups ) );
+	UpdateEnabled();
+}
+
+void CStats::UpdateEnabled()
+{
+	bool		bNewEnabled = bShowUnit || bTraceCapture;
+	for ( uint32 group = 0; group < SG_Num && !bNewEnabled; ++group )
+	{
+		bNewEnabled = bShowGroups[group];
+	}
+
+	if ( bNewEnabled && !bEnabled )
+	{
+		// Start new window and drop events recorded before, so first shown values aren't stale
+		CScopeLock		scopeLock( cs );
+		for ( uint32 index = 0, count = ( uint32 )threadBuffers.size(); index < count; ++index )
+		{
+			CScopeLock		bufferScopeLock( threadBuffers[index]->cs );
+			threadBuffers[index]->events.clear();
+		}
+
+		nodes.clear();
+		numWindowFrames		= 0;
+		windowFrameTime		= 0.0;
+		windowMaxFrameTime	= 0.0;
+		windowStartTime		= appSeconds();
+		std::fill( threadTotalCycles.begin(), threadTotalCycles.end(), 0 );
+		std::fill( threadMaxCycles.begin(), threadMaxCycles.end(), 0 );
+		counters.assign( counters.size(), SCounterValue() );
+	}
+	else if ( !bNewEnabled )
+	{
+		CScopeLock		scopeLock( displayCS );
+		displayLines.clear();
+	}
+	bEnabled = bNewEnabled;
+}
+
+void CStats::GetDisplayLines( std::vector<std::wstring>& OutLines )
+{
+	CScopeLock		scopeLock( displayCS );
+	OutLines = displayLines;
+}
+
+void CStats::ExecCommand( const std::vector<std::wstring>& InArguments )
+{
+	if ( InArguments.empty() )
+	{
+		std::wstring		groups;
+		for ( uint32 group = 0; group < SG_Num; ++group )
+		{
+			groups += TEXT( "|" ) + CString::ToLower( GStatGroupNames[group] );
+		}
+		LE_LOG( LT_Log, LC_General, TEXT( "Usage: stat unit%s|none" ), groups.c_str() );
+		return;
+	}
+
+	std::wstring		name = CString::ToUpper( InArguments[0] );
+	if ( name == TEXT( "UNIT" ) )
+	{
+		ToggleUnit();
+		return;
+	}
+	else if ( name == TEXT( "NONE" ) )
+	{
+		HideAll();
+		return;
+	}
+
+	for ( uint32 group = 0; group < SG_Num; ++group )
+	{
+		if ( name == CString::ToUpper( GStatGroupNames[group] ) )
+		{
+			ToggleGroup( ( EStatGroup )group );
+			return;
+		}
+	}
+	LE_LOG( LT_Warning, LC_General, TEXT( "Unknown stat group '%s'" ), InArguments[0].c_str() );
+}
+
+void CStats::BeginTraceCapture( uint32 InNumFrames, float InSeconds )
+{
+	if ( bTraceCapture )
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Trace capture is already in progress" ) );
+		return;
+	}
+
+	bTraceCapture			= true;
+	traceFramesLeft			= InNumFrames;
+	traceEndTime			= appSeconds() + InSeconds;
+	traceStartCycles		= appCycles();
+	traceFrameStartCycles	= traceStartCycles;
+	UpdateEnabled();
+
+	if ( InNumFrames > 0 )
+	{
+		LE_LOG( LT_Log, LC_General, TEXT( "Started trace capture of %u frames" ), InNumFrames );
+	}
+	else
+	{
+		LE_LOG( LT_Log, LC_General, TEXT( "Started trace capture of %.1f seconds" ), InSeconds );
+	}
+}
+
+void CStats::EndTraceCapture()
+{
+	if ( !bTraceCapture )
+	{
+		return;
+	}
+
+	// Events recorded since last frame are still in buffers of threads (e.g. at exit), so collect them too
+	{
+		CScopeLock		scopeLock( cs );
+		for ( uint32 threadIndex = 0, numThreads = ( uint32 )threadBuffers.size(); threadIndex < numThreads; ++threadIndex )
+		{
+			SStatThreadBuffer*		buffer = threadBuffers[threadIndex];
+			{
+				CScopeLock		bufferScopeLock( buffer->cs );
+				scratchEvents.swap( buffer->events );
+			}
+
+			AppendTraceEvents( scratchEvents, buffer->name );
+			scratchEvents.clear();
+		}
+	}
+
+	bTraceCapture = false;
+	UpdateEnabled();
+
+	time_t				timeNow		= time( nullptr );
+	tm*					tmTimeNow	= localtime( &timeNow );
+	std::wstring		directory	= appGameDir() + PATH_SEPARATOR + TEXT( "Profiling" );
+	std::wstring		path		= CString::Format( TEXT( "%s" ) PATH_SEPARATOR TEXT( "Trace-%s-%i.%02i.%02i-%02i.%02i.%02i.json" ), directory.c_str(), GGameName.c_str(), 1900 + tmTimeNow->tm_year, 1 + tmTimeNow->tm_mon, tmTimeNow->tm_mday, tmTimeNow->tm_hour, tmTimeNow->tm_min, tmTimeNow->tm_sec );
+	GFileSystem->MakeDirectory( directory, true );
+
+	if ( WriteTrace( path ) )
+	{
+		LE_LOG( LT_Log, LC_General, TEXT( "Trace capture with %u events is written to '%s'" ), ( uint32 )traceEvents.size(), path.c_str() );
+	}
+	else
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Failed writing trace capture to '%s'" ), path.c_str() );
+	}
+
+	// Free memory of capture
+	std::vector<STraceEvent>().swap( traceEvents );
+	traceThreadNames.clear();
+}
+
+void CStats::ExecTraceCommand( const std::vector<std::wstring>& InArguments )
+{
+	if ( InArguments.empty() )
+	{
+		LE_LOG( LT_Log, LC_General, TEXT( "Usage: tracecapture <NumFrames>|<Seconds>s|stop" ) );
+		return;
+	}
+
+	if ( CString::ToUpper( InArguments[0] ) == TEXT( "STOP" ) )
+	{
+		EndTraceCapture();
+		return;
+	}
+
+	// Number with suffix 's' is time in seconds, else it's number of frames
+	tchar*		end		= nullptr;
+	double		value	= wcstod( InArguments[0].c_str(), &end );
+	bool		bTime	= *end == TEXT( 's' ) || *end == TEXT( 'S' );
+	if ( end == InArguments[0].c_str() || value <= 0.0 || ( *end && !( bTime && !end[1] ) ) )
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Invalid length of trace capture '%s'" ), InArguments[0].c_str() );
+		return;
+	}
+
+	if ( bTime )
+	{
+		BeginTraceCapture( 0, ( float )value );
+	}
+	else
+	{
+		BeginTraceCapture( Max<uint32>( ( uint32 )value, 1 ), 0.f );
+	}
+}
+
+bool CStats::WriteTrace( const std::wstring& InPath )
+{
+	CArchive*		archive = GFileSystem->CreateFileWriter( InPath );
+	if ( !archive )
+	{
+		return false;
+	}
+
+	std::vector<CStatDescriptor*>&		descriptors = GetDescriptors();
+	std::string							json;
+	achar								buffer[256];
+	json.reserve( STATS_TRACE_WRITE_CHUNK + 1024 );
+
+	// Names of threads, frames have own track with ID 0
+	json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+	for ( auto itThread = traceThreadNames.begin(), itThreadEnd = traceThreadNames.end(); itThread != itThreadEnd; ++itThread )
+	{
+		snprintf( buffer, sizeof( buffer ), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", itThread->first );
+		json += buffer;
+		AppendJsonString( json, itThread->second.c_str() );
+		json += "}}";
+	}
+
+	// Complete events with time in microseconds from capture start
+	uint32		frame = 0;
+	for ( uint32 index = 0, count = ( uint32 )traceEvents.size(); index < count; ++index )
+	{
+		const STraceEvent&		event		= traceEvents[index];
+		double					timestamp	= ( event.startCycles - traceStartCycles ) * GSecondsPerCycle * 1000000.0;
+		double					duration	= ( event.endCycles - event.startCycles ) * GSecondsPerCycle * 1000000.0;
+		if ( event.statIndex == ( uint32 )INDEX_NONE )
+		{
+			snprintf( buffer, sizeof( buffer ), ",\n{\"name\":\"Frame\",\"cat\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}", timestamp, duration, frame++ );
+			json += buffer;
+		}
+		else
+		{
+			const CStatDescriptor*		stat = descriptors[event.statIndex];
+			json += ",\n{\"name\":";
+			AppendJsonString( json, stat->name );
+			json += ",\"cat\":";
+			AppendJsonString( json, GStatGroupNames[stat->group] );
+			snprintf( buffer, sizeof( buffer ), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", event.threadId, timestamp, duration );
+			json += buffer;
+		}
+
+		if ( json.size() >= STATS_TRACE_WRITE_CHUNK )
+		{
+			archive->Serialize( ( void* )json.data(), ( uint32 )json.size() );
+			json.clear();
+		}
+	}
+
+	json += "\n]}\n";
+	archive->Serialize( ( void* )json.data(), ( uint32 )json.size() );
+	delete archive;
+	return true;
+}
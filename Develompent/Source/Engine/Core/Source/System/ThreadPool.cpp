@@ -0,0 +1,318 @@
+#include "Misc/CoreGlobals.h"
+#include "Containers/String.h"
+#include "Logger/LoggerMacros.h"
+#include "System/ThreadPool.h"
+#include "System/Stats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Queued work" ), STAT_QueuedWork, SG_Engine );
+
+// ====================================
+// Queued thread
+// ====================================
+
+/**
+ * Constructor
+ */
+CQueuedThreadPool::CQueuedThread::CQueuedThread( CQueuedThreadPool* InPool )
+	: pool( InPool )
+{}
+
+/**
+ * Initialize
+ */
+bool CQueuedThreadPool::CQueuedThread::Init()
+{
+	return true;
+}
+
+/**
+ * Run
+ */
+uint32 CQueuedThreadPool::CQueuedThread::Run()
+{
+	for ( CQueuedWork* work = pool->GetNextWork(); work; work = pool->GetNextWork() )
+	{
+		SCOPE_CYCLE_COUNTER( STAT_QueuedWork );
+		work->DoThreadedWork();
+	}
+	return 0;
+}
+
+/**
+ * Stop
+ */
+void CQueuedThreadPool::CQueuedThread::Stop()
+{}
+
+/**
+ * Exit
+ */
+void CQueuedThreadPool::CQueuedThread::Exit()
+{}
+
+// ====================================
+// Queued thread pool
+// ====================================
+
+/**
+ * Constructor
+ */
+CQueuedThreadPool::CQueuedThreadPool()
+	: worksSemaphore( nullptr )
+	, bIsDestroying( false )
+{}
+
+/**
+ * Destructor
+ */
+CQueuedThreadPool::~CQueuedThreadPool()
+{
+	Destroy();
+}
+
+/**
+ * Create worker threads
+ */
+bool CQueuedThreadPool::Create( uint32 InNumThreads, uint32 InStackSize /* = 0 */, EThreadPriority InThreadPriority /* = TP_Normal */ )
+{
+	check( threads.empty() && !worksSemaphore );
+	bIsDestroying	= false;
+	worksSemaphore	= GSynchronizeFactory->CreateSemaphore( 0x7FFFFFFF, 0 );
+	check( worksSemaphore );
+
+	for ( uint32 index = 0; index < InNumThreads; ++index )
+	{
+		CRunnableThread*	thread = GThreadFactory->CreateThread( new CQueuedThread( this ), CString::Format( TEXT( "PoolThread_%i" ), index ).c_str(), false, true, InStackSize, InThreadPriority );
+		if ( !thread )
+		{
+			LE_LOG( LT_Warning, LC_General, TEXT( "Failed to create worker thread %i of thread pool" ), index );
+			return false;
+		}
+		threads.push_back( thread );
+	}
+
+	LE_LOG( LT_Log, LC_Init, TEXT( "Created thread pool with %i worker threads" ), InNumThreads );
+	return true;
+}
+
+/**
+ * Abandon not started works and destroy worker threads
+ */
+void CQueuedThreadPool::Destroy()
+{
+	if ( !worksSemaphore )
+	{
+		return;
+	}
+
+	// Abandon all not started works
+	std::list<CQueuedWork*>		abandonedWorks;
+	{
+		CScopeLock		scopeLock( cs );
+		bIsDestroying	= true;
+		abandonedWorks.swap( queuedWorks );
+	}
+
+	for ( auto itWork = abandonedWorks.begin(), itWorkEnd = abandonedWorks.end(); itWork != itWorkEnd; ++itWork )
+	{
+		( *itWork )->Abandon();
+	}
+
+	// Wake up all threads and wait when they finish
+	worksSemaphore->Post( threads.size() );
+	for ( uint32 index = 0, count = threads.size(); index < count; ++index )
+	{
+		threads[index]->WaitForCompletion();
+		GThreadFactory->Destroy( threads[index] );
+	}
+	threads.clear();
+
+	GSynchronizeFactory->Destroy( worksSemaphore );
+	worksSemaphore = nullptr;
+}
+
+/**
+ * Add work to queue
+ */
+void CQueuedThreadPool::AddQueuedWork( CQueuedWork* InWork )
+{
+	check( InWork );
+	{
+		CScopeLock		scopeLock( cs );
+		if ( bIsDestroying || threads.empty() )
+		{
+			InWork->Abandon();
+			return;
+		}
+		queuedWorks.push_back( InWork );
+	}
+	worksSemaphore->Signal();
+}
+
+/**
+ * Remove work from queue if it's not started yet
+ */
+bool CQueuedThreadPool::RetractQueuedWork( CQueuedWork* InWork )
+{
+	CScopeLock		scopeLock( cs );
+	for ( auto itWork = queuedWorks.begin(), itWorkEnd = queuedWorks.end(); itWork != itWorkEnd; ++itWork )
+	{
+		if ( *itWork == InWork )
+		{
+			// Semaphore count we not change, worker thread just wakes up and finds nothing
+			queuedWorks.erase( itWork );
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Get next work from queue
+ */
+CQueuedWork* CQueuedThreadPool::GetNextWork()
+{
+	while ( true )
+	{
+		worksSemaphore->Wait();
+
+		CScopeLock		scopeLock( cs );
+		if ( bIsDestroying )
+		{
+			return nullptr;
+		}
+
+		// Queue can be empty if work was retracted
+		if ( !queuedWorks.empty() )
+		{
+			CQueuedWork*	work = queuedWorks.front();
+			queuedWorks.pop_front();
+			return work;
+		}
+	}
+}
+
+// ====================================
+// Parallel for
+// ====================================
+
+/**
+ * @ingroup Core
+ * @brief Shared state of one appParallelFor call
+ */
+struct SParallelForContext
+{
+	/**
+	 * @brief Execute indices while they are there
+	 */
+	FORCEINLINE void Process()
+	{
+		for ( int32 index = appInterlockedIncrement( &nextIndex ) - 1; index < ( int32 )num; index = appInterlockedIncrement( &nextIndex ) - 1 )
+		{
+			( *function )( index );
+		}
+	}
+
+	const std::function<void( uint32 )>*	function;			/**< Function to execute */
+	uint32									num;				/**< Number of indices */
+	volatile int32							nextIndex;			/**< Next index to execute */
+	volatile int32							numPendingWorks;	/**< Number of works which not finished yet */
+	CEvent*									doneEvent;			/**< Event triggered when last work is finished */
+};
+
+/**
+ * @ingroup Core
+ * @brief Work of thread pool helping to execute appParallelFor
+ */
+class CParallelForWork : public CQueuedWork
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param InContext		Context of appParallelFor
+	 */
+	CParallelForWork( SParallelForContext* InContext = nullptr )
+		: context( InContext )
+	{}
+
+	/**
+	 * @brief Do work
+	 */
+	virtual void DoThreadedWork() override
+	{
+		context->Process();
+		Finish();
+	}
+
+	/**
+	 * @brief Abandon work
+	 */
+	virtual void Abandon() override
+	{
+		Finish();
+	}
+
+private:
+	/**
+	 * @brief Mark work as finished
+	 */
+	FORCEINLINE void Finish()
+	{
+		// After this point context may be destroyed, so we not touch it
+		CEvent*		doneEvent = context->doneEvent;
+		if ( appInterlockedDecrement( &context->numPendingWorks ) == 0 )
+		{
+			doneEvent->Trigger();
+		}
+	}
+
+	SParallelForContext*		context;		/**< Context of appParallelFor */
+};
+
+/**
+ * Execute function for every index in range [0, InNum) on thread pool
+ */
+void appParallelFor( uint32 InNum, const std::function<void( uint32 )>& InFunction )
+{
+	uint32		numWorks = GThreadPool ? Min( GThreadPool->GetNumThreads(), InNum > 0 ? InNum - 1 : 0 ) : 0;
+	if ( numWorks == 0 )
+	{
+		for ( uint32 index = 0; index < InNum; ++index )
+		{
+			InFunction( index );
+		}
+		return;
+	}
+
+	SParallelForContext		context;
+	context.function		= &InFunction;
+	context.num				= InNum;
+	context.nextIndex		= 0;
+	context.numPendingWorks	= numWorks;
+	context.doneEvent		= GSynchronizeFactory->CreateSynchEvent( true );
+
+	std::vector<CParallelForWork>		works( numWorks, CParallelForWork( &context ) );
+	for ( uint32 index = 0; index < numWorks; ++index )
+	{
+		GThreadPool->AddQueuedWork( &works[index] );
+	}
+
+	// Calling thread works too
+	context.Process();
+
+	// Works which not started yet we take back, all indices already done
+	bool		bNeedWait = true;
+	for ( uint32 index = 0; index < numWorks; ++index )
+	{
+		if ( GThreadPool->RetractQueuedWork( &works[index] ) && appInterlockedDecrement( &context.numPendingWorks ) == 0 )
+		{
+			bNeedWait = false;
+		}
+	}
+
+	if ( bNeedWait )
+	{
+		context.doneEvent->Wait();
+	}
+	GSynchronizeFactory->Destroy( context.doneEvent );
+}
@@ -61,6 +61,14 @@ public:
 	 */
 	virtual void AddToDrawList( const class CSceneView& InSceneView );
 
+	/**
+	 * @brief Get textures used by primitive
+	 * @note Called on rendering thread for texture streaming
+	 *
+	 * @param OutTextures	Output array of textures. Textures are added to end of array
+	 */
+	virtual void GetUsedTextures( std::vector< TSharedPtr<class CTexture2D> >& OutTextures ) const;
+
 	/**
 	 * @brief Called when the owning Actor is spawned
 	 */
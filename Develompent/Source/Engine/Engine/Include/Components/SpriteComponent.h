@@ -45,6 +45,12 @@ public:
 	 */
 	virtual void AddToDrawList( const class CSceneView& InSceneView ) override;
 
+	/**
+	 * @brief Get textures used by primitive
+	 * @param OutTextures	Output array of textures. Textures are added to end of array
+	 */
+	virtual void GetUsedTextures( std::vector< TSharedPtr<class CTexture2D> >& OutTextures ) const override;
+
 	/**
 	 * @brief Serialize component
 	 * @param[in] InArchive Archive for serialize
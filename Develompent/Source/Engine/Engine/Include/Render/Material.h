@@ -293,6 +293,12 @@ public:
 	 */
 	bool GetVectorParameterValue( const CName& InParameterName, Vector4D& OutValue ) const;
 
+	/**
+	 * Get textures used by material
+	 * @param OutTextures	Output array of textures. Textures are added to end of array
+	 */
+	void GetTextures( std::vector< TSharedPtr<CTexture2D> >& OutTextures ) const;
+
 	/**
 	 * Get dependent assets
 	 * @param OutDependentAssets	Output set of dependent assets
@@ -49,6 +49,31 @@ extern SPixelFormatInfo			GPixelFormats[ PF_Max ];
  */
 extern float					GPixelCenterOffset;
 
+/**
+ * @ingroup Engine
+ * @brief Calculate size of mip in bytes
+ * @note Block compressed mips smaller of block still take one block
+ *
+ * @param InFormat		Pixel format
+ * @param InSizeX		Width of top mip
+ * @param InSizeY		Height of top mip
+ * @param InMipIndex	Index of mip
+ * @return Return size of mip in bytes
+ */
+uint32 CalcTextureMipSize( EPixelFormat InFormat, uint32 InSizeX, uint32 InSizeY, uint32 InMipIndex );
+
+/**
+ * @ingroup Engine
+ * @brief Calculate size of texture with all mips in bytes
+ *
+ * @param InFormat		Pixel format
+ * @param InSizeX		Width of top mip
+ * @param InSizeY		Height of top mip
+ * @param InNumMips		Number of mips
+ * @return Return size of texture in bytes
+ */
+uint32 CalcTextureSize( EPixelFormat InFormat, uint32 InSizeX, uint32 InSizeY, uint32 InNumMips );
+
 /**
  * @ingroup Engine
  * Handles initialization/release for a global resource
@@ -15,6 +15,19 @@
 #include "Misc/EngineGlobals.h"
 #include "RHI/BaseRHI.h"
 #include "RHI/BaseDeviceContextRHI.h"
+#include "System/Stats.h"
+
+/**
+ * @ingroup Engine
+ * @brief Stat of number of draw calls in frame
+ */
+DECLARE_STAT_EXTERN( STAT_DrawCalls );
+
+/**
+ * @ingroup Engine
+ * @brief Stat of number of drawn primitives in frame
+ */
+DECLARE_STAT_EXTERN( STAT_DrawPrimitives );
 
 // Colors that are defined for a particular mesh type
 // Each event type will be displayed using the defined color
@@ -12,51 +12,46 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 
 #include "Containers/BulkData.h"
 #include "System/Archive.h"
+#include "System/BaseFileSystem.h"
 #include "RHI/BaseShaderRHI.h"
 
 /**
  * @ingroup Engine
  * @brief A map of shader parameter names to registers allocated to that parameter
+ *
+ * Parameters are stored as compact table of slots sorted by hash of name, so binding of parameter
+ * is binary search by integer key without allocation of strings
  */
 class CShaderParameterMap
 {
 public:
+	/**
+	 * @brief Slot of parameter
+	 * @note This is POD, table of slots is serialized as raw memory
+	 */
 	struct SParameterAllocation
 	{
-		/**
-		 * @brief Construct a new SParameterAllocation object
-		 */
-		SParameterAllocation() :
-			isBound( false )
-		{}
-
-		/**
-		 * Overload operator << for serialize
-		 */
-		FORCEINLINE friend CArchive& operator<<( CArchive& InAr, SParameterAllocation& InParameterAllocation )
-		{
-			return InAr << InParameterAllocation.bufferIndex << InParameterAllocation.baseIndex << InParameterAllocation.size << InParameterAllocation.samplerIndex << InParameterAllocation.isBound;
-		}
-
-		/**
-		 * Overload operator << for serialize
-		 */
-		FORCEINLINE friend CArchive& operator<<( CArchive& InAr, const SParameterAllocation& InParameterAllocation )
-		{
-			return InAr << InParameterAllocation.bufferIndex << InParameterAllocation.baseIndex << InParameterAllocation.size << InParameterAllocation.samplerIndex << InParameterAllocation.isBound;
-		}
-
+		uint64			nameHash;			/**< Hash of parameter name */
 		uint32			bufferIndex;		/**< Buffer index */
 		uint32			baseIndex;			/**< Base index */
 		uint32			size;				/**< Size parameter */
 		uint32			samplerIndex;		/**< Sampler index */
-		mutable bool 	isBound;			/**< Is bound */
 	};
 
+	/**
+	 * @brief Calculate hash of parameter name
+	 *
+	 * @param InParameterName Parameter name
+	 * @return Return hash of parameter name
+	 */
+	static FORCEINLINE uint64 HashParameterName( const tchar* InParameterName )
+	{
+		return appMemFastHash( InParameterName, wcslen( InParameterName ) * sizeof( tchar ) );
+	}
+
 	/**
 	 * @brief Find parameter allocation
 	 * 
@@ -67,7 +62,22 @@ public:
 	 * @param OutSamplerIndex Output sampler index
 	 * @return Return true if parameter is finded, else return false
 	 */
-	bool FindParameterAllocation( const tchar* InParameterName, uint32& OutBufferIndex, uint32& OutBaseIndex, uint32& OutSize, uint32& OutSamplerIndex ) const;
+	FORCEINLINE bool FindParameterAllocation( const tchar* InParameterName, uint32& OutBufferIndex, uint32& OutBaseIndex, uint32& OutSize, uint32& OutSamplerIndex ) const
+	{
+		return FindParameterAllocation( HashParameterName( InParameterName ), OutBufferIndex, OutBaseIndex, OutSize, OutSamplerIndex );
+	}
+
+	/**
+	 * @brief Find parameter allocation by hash of name
+	 * 
+	 * @param InNameHash Hash of parameter name (see HashParameterName)
+	 * @param OutBufferIndex Output buffer index
+	 * @param OutBaseIndex Output base index
+	 * @param OutSize Output size
+	 * @param OutSamplerIndex Output sampler index
+	 * @return Return true if parameter is finded, else return false
+	 */
+	bool FindParameterAllocation( uint64 InNameHash, uint32& OutBufferIndex, uint32& OutBaseIndex, uint32& OutSize, uint32& OutSamplerIndex ) const;
 
 	/**
 	 * @brief Add parameter allocation
@@ -80,12 +90,42 @@ public:
 	 */
 	void AddParameterAllocation( const tchar* InParameterName, uint32 InBufferIndex, uint32 InBaseIndex, uint32 InSize, uint32 InSamplerIndex );
 
+#if WITH_EDITOR
+	/**
+	 * @brief Set reflected size of constant buffer
+	 * @note Called by shader compiler, it needs for verify layout of constant buffers
+	 *
+	 * @param InBufferIndex Buffer index
+	 * @param InSize Size of constant buffer in bytes
+	 */
+	void SetConstantBufferSize( uint32 InBufferIndex, uint32 InSize );
+
+	/**
+	 * @brief Verify bindings of shader
+	 * @note Works only for map filled by compiler, loaded from cache map has no names of parameters.
+	 * Not bound parameters are reported as warnings, bound constant buffer parameters which not fit in
+	 * reflected size of their constant buffer, cross 16-byte register or overlap each other are errors
+	 *
+	 * @param InShaderName Shader name for log
+	 * @param OutErrorMsg Output error message of first layout mismatch
+	 * @return Return FALSE if layout of bound parameters mismatch constant buffers, else return TRUE
+	 */
+	bool VerifyBindings( const std::wstring& InShaderName, std::wstring& OutErrorMsg ) const;
+#endif // WITH_EDITOR
+
+	/**
+	 * @brief Serialize
+	 * @param InArchive Archive
+	 */
+	void Serialize( CArchive& InArchive );
+
 	/**
 	 * Overload operator << for serialize
 	 */
 	FORCEINLINE friend CArchive& operator<<( CArchive& InAr, CShaderParameterMap& InShaderParameterMap )
 	{
-		return InAr << InShaderParameterMap.parameterMap;
+		InShaderParameterMap.Serialize( InAr );
+		return InAr;
 	}
 
 	/**
@@ -93,11 +133,19 @@ public:
 	 */
 	FORCEINLINE friend CArchive& operator<<( CArchive& InAr, const CShaderParameterMap& InShaderParameterMap )
 	{
-		return InAr << InShaderParameterMap.parameterMap;
+		check( InAr.IsSaving() );
+		const_cast< CShaderParameterMap& >( InShaderParameterMap ).Serialize( InAr );
+		return InAr;
 	}
 
 private:
-	std::unordered_map< std::wstring, SParameterAllocation >		parameterMap;		/**< Parameter map */
+	std::vector< SParameterAllocation >		allocations;		/**< Slots of parameters sorted by hash of name */
+
+#if WITH_EDITOR
+	std::vector< std::wstring >				names;				/**< Names of parameters in order of slots. Filled only by compiler */
+	mutable std::vector< bool >				boundSlots;			/**< Is slot bound by shader. Need for verify bindings */
+	std::vector< uint32 >					constantBufferSizes;	/**< Reflected sizes of constant buffers by buffer index. Filled only by compiler */
+#endif // WITH_EDITOR
 };
 
 /**
@@ -112,18 +160,51 @@ public:
 	 */
 	struct SShaderCacheItem
 	{
+		/**
+		 * @brief Constructor
+		 */
+		SShaderCacheItem()
+			: frequency( SF_Vertex )
+			, vertexFactoryHash( ( uint64 )INVALID_HASH )
+			, numInstructions( 0 )
+			, sourceHash( 0 )
+			, mappedCode( nullptr )
+			, mappedCodeSize( 0 )
+		{}
+
 		/**
 		 * @brief Serialize
 		 * @param[in] InArchive Archive
 		 */
 		void						Serialize( CArchive& InArchive );
 
+		/**
+		 * @brief Get byte code of shader
+		 * @return Return pointer to byte code. If shader cache is mapped, it points to mapped file
+		 */
+		FORCEINLINE const byte*		GetCode() const
+		{
+			return mappedCode ? mappedCode : code.GetData();
+		}
+
+		/**
+		 * @brief Get size of byte code
+		 * @return Return size of byte code in bytes
+		 */
+		FORCEINLINE uint32			GetCodeSize() const
+		{
+			return mappedCode ? mappedCodeSize : code.Num();
+		}
+
 		std::wstring				name;				/**< Name of class shader */
 		EShaderFrequency			frequency;			/**< Frequency of shader */
 		uint64						vertexFactoryHash;	/**< Vertex factory hash */
 		CBulkData< byte >			code;				/**< Byte code of shader */
 		uint32						numInstructions;	/**< Number instructions in shader */
 		CShaderParameterMap			parameterMap;		/**< Parameter map */
+		uint64						sourceHash;			/**< Hash of compile inputs (source with includes, definitions, vertex factory and compiler flags). 0 if unknown */
+		const byte*					mappedCode;			/**< Byte code of shader in mapped file. If not NULL, field 'code' is empty */
+		uint32						mappedCodeSize;		/**< Size of byte code in mapped file */
 	};
 
 	/**
@@ -132,15 +213,46 @@ public:
 	 */
 	void													Serialize( CArchive& InArchive );
 
+	/**
+	 * @brief Load shader cache from file
+	 * @note Loaded items are merged with items already in cache
+	 *
+	 * @param InPath	Path to file of shader cache
+	 * @return Return TRUE if file is exist and loaded, else return FALSE
+	 */
+	bool													Load( const std::wstring& InPath );
+
+	/**
+	 * @brief Map shader cache file to memory
+	 * @note Only index of items is read, byte code of shaders stays in mapped file while cache is alive.
+	 * Shader cache saved before VER_ShaderCacheIndex is fully loaded
+	 *
+	 * @param InPath	Path to file of shader cache
+	 * @return Return TRUE if file is exist and mapped, else return FALSE
+	 */
+	bool													Map( const std::wstring& InPath );
+
+	/**
+	 * @brief Save shader cache to file
+	 * @note Before saving items of shaders and vertex factories which are no longer registered are removed
+	 * @param InPath	Path to file of shader cache
+	 */
+	void													Save( const std::wstring& InPath );
+
 	/**
 	 * @brief Add to cache compiled shader
+	 * @note If shader with the same name and vertex factory already in cache, it will be replaced.
+	 * Byte code from mapped file is copied to item
+	 *
 	 * @param[in] InShaderCacheItem Shader cache item
 	 */
-	FORCEINLINE void										Add( const SShaderCacheItem& InShaderCacheItem )
-	{
-		items.push_back( InShaderCacheItem );
-		itemsMap[ InShaderCacheItem.vertexFactoryHash ].insert( InShaderCacheItem.name );
-	}
+	void													Add( const SShaderCacheItem& InShaderCacheItem );
+
+	/**
+	 * @brief Remove items which shader type or vertex factory is no longer registered
+	 * @return Return number of removed items
+	 */
+	uint32													RemoveUnregisteredItems();
 
 	/**
 	 * @brief Get array of items shader cache
@@ -159,25 +271,52 @@ public:
 	 * @return Return true if shader exist in cache, else return false
 	 */
 	FORCEINLINE bool IsExist( const std::wstring& InShaderName, uint64 InVertexFactoryHash ) const
+	{
+		return FindItem( InShaderName, InVertexFactoryHash ) != nullptr;
+	}
+
+	/**
+	 * @brief Is shader in cache compiled from the same inputs
+	 * 
+	 * @param InShaderName			Shader name
+	 * @param InVertexFactoryHash	Vertex factory hash
+	 * @param InSourceHash			Hash of compile inputs
+	 * @return Return TRUE if shader exist in cache and its inputs not changed, else return FALSE
+	 */
+	FORCEINLINE bool IsUpToDate( const std::wstring& InShaderName, uint64 InVertexFactoryHash, uint64 InSourceHash ) const
+	{
+		const SShaderCacheItem*		item = FindItem( InShaderName, InVertexFactoryHash );
+		return item && item->sourceHash != 0 && item->sourceHash == InSourceHash;
+	}
+
+	/**
+	 * @brief Find item in cache
+	 * 
+	 * @param InShaderName			Shader name
+	 * @param InVertexFactoryHash	Vertex factory hash
+	 * @return Return pointer to item if it exist in cache, else return NULL
+	 */
+	FORCEINLINE const SShaderCacheItem* FindItem( const std::wstring& InShaderName, uint64 InVertexFactoryHash ) const
 	{
 		auto		itVFtype = itemsMap.find( InVertexFactoryHash );
 		if ( itVFtype == itemsMap.end() )
 		{
-			return false;
+			return nullptr;
 		}
 
 		auto		itShader = itVFtype->second.find( InShaderName );
 		if ( itShader == itVFtype->second.end() )
 		{
-			return false;
+			return nullptr;
 		}
 
-		return true;
+		return &items[ itShader->second ];
 	}
 
 private:
-	std::vector< SShaderCacheItem >											items;		/**< Array of items shader cache */
-	std::unordered_map< uint64, std::unordered_set< std::wstring > >		itemsMap;	/**< Map of items separated by vertex factory. Need for check on exist in cache */
+	std::vector< SShaderCacheItem >													items;		/**< Array of items shader cache */
+	std::unordered_map< uint64, std::unordered_map< std::wstring, uint32 > >		itemsMap;	/**< Map of indices to items separated by vertex factory. Need for fast search in cache */
+	MappedFileRef_t																	mappedFile;	/**< Mapped file of shader cache, byte code of items points to it */
 };
 
 #endif // !SHADERCACHE_H
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "RHI/BaseShaderRHI.h"
@@ -115,6 +116,33 @@ struct SShaderCompilerOutput
 	CShaderParameterMap			parameterMap;		/**< Shader parameter map */
 	uint32						numInstructions;	/**< Number instructions in shader */
 	std::wstring				errorMsg;			/**< Error message. Compiler puting to this field message when shader compiled is fail */
+	std::vector< std::wstring >	warnings;			/**< Warnings of compiler. They are logged by caller, because compiler can work on worker thread */
+};
+
+/**
+ * @ingroup Engine
+ * @brief Job of compiling one permutation of shader (shader type and vertex factory)
+ */
+struct SShaderCompileJob
+{
+	/**
+	 * @brief Constructor
+	 *
+	 * @param InShaderMetaType		Shader meta type
+	 * @param InVertexFactoryType	Vertex factory type
+	 */
+	SShaderCompileJob( class CShaderMetaType* InShaderMetaType = nullptr, class CVertexFactoryMetaType* InVertexFactoryType = nullptr ) :
+		shaderMetaType( InShaderMetaType ),
+		vertexFactoryType( InVertexFactoryType ),
+		sourceHash( 0 ),
+		bSucceed( false )
+	{}
+
+	class CShaderMetaType*				shaderMetaType;			/**< Shader meta type */
+	class CVertexFactoryMetaType*		vertexFactoryType;		/**< Vertex factory type */
+	uint64								sourceHash;				/**< Hash of compile inputs. If 0 it will be calculated before compiling */
+	SShaderCompilerOutput				output;					/**< Output of compiler */
+	bool								bSucceed;				/**< Is shader compiled successfully */
 };
 
 /**
@@ -126,6 +154,7 @@ class CShaderCompiler
 public:
 	/**
 	 * @brief Compile all shaders
+	 * @note If file with cache already exist, it is updated incrementally. Only shaders which compile inputs changed are recompiled
 	 * 
 	 * @param[in] InOutputCache	Path to output file with cache (example: ../../Content/GlobalShaderCache.bin)
 	 * @param[in] InShaderPlatform Shader platform enum
@@ -136,6 +165,7 @@ public:
 
 	/**
 	 * @brief Compile all shaders
+	 * @note Shaders which already in cache and compile inputs of which not changed are skipped
 	 * 
 	 * @param InOutShaderCache		Shader cache
 	 * @param InShaderPlatform		Shader platform enum
@@ -144,6 +174,29 @@ public:
 	 */
 	bool CompileAll( CShaderCache& InOutShaderCache, EShaderPlatform InShaderPlatform, bool InOnlyGlobals = false );
 
+	/**
+	 * @brief Recompile items of shader cache which compile inputs changed
+	 * @note Items of shader or vertex factory types not registered in engine are left as is
+	 *
+	 * @param InOutShaderCache		Shader cache
+	 * @param InShaderPlatform		Shader platform enum
+	 * @param OutErrorMsg			Compile error message of first failed shader
+	 * @return Return TRUE if all outdated shaders compile successed, else return FALSE
+	 */
+	bool UpdateCache( CShaderCache& InOutShaderCache, EShaderPlatform InShaderPlatform, std::wstring& OutErrorMsg );
+
+	/**
+	 * @brief Calculate hash of compile inputs of shader
+	 * @note Hash includes source of shader with all included files, definitions, vertex factory and compiler flags.
+	 * Content of shader files is cached in compiler, so files are read once
+	 *
+	 * @param InShaderMetaType		Shader meta type
+	 * @param InShaderPlatform		Shader platform enum
+	 * @param InVertexFactoryType	Vertex factory type
+	 * @return Return hash of compile inputs
+	 */
+	uint64 CalcSourceHash( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CVertexFactoryMetaType* InVertexFactoryType = nullptr );
+
 	/**
 	 * Compile shader
 	 * 
@@ -155,6 +208,89 @@ public:
 	 * @return Return true if shader compile successed, else return false
 	 */
 	bool CompileShader( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg, class CVertexFactoryMetaType* InVertexFactoryType = nullptr );
+
+	/**
+	 * @brief Compile shaders
+	 * @note Jobs are compiled concurrently on thread pool (if it allowed in config 'Editor.Editor:ParallelShaderCompile'),
+	 * compiled shaders are validated and added to cache in order of jobs, so result not depends from number of threads
+	 *
+	 * @param InOutJobs				Jobs of compiling
+	 * @param InShaderPlatform		Shader platform enum
+	 * @param InOutShaderCache		Shader cache
+	 * @param OutErrorMsg			Compile error message of first failed job
+	 * @return Return TRUE if all shaders compile successed, else return FALSE
+	 */
+	bool CompileShaders( std::vector<SShaderCompileJob>& InOutJobs, EShaderPlatform InShaderPlatform, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg );
+
+private:
+	/**
+	 * @brief Info about shader file
+	 */
+	struct SShaderFileInfo
+	{
+		uint64							hash;		/**< Hash of file content */
+		std::vector< std::wstring >		includes;	/**< Names of included files */
+	};
+
+	/**
+	 * @brief Gather jobs of all shaders which not in cache or outdated
+	 *
+	 * @param InShaderCache			Shader cache
+	 * @param InShaderPlatform		Shader platform enum
+	 * @param InOnlyGlobals			Gather only global shaders
+	 * @param OutJobs				Output jobs of compiling
+	 */
+	void GatherOutdatedJobs( const CShaderCache& InShaderCache, EShaderPlatform InShaderPlatform, bool InOnlyGlobals, std::vector<SShaderCompileJob>& OutJobs );
+
+	/**
+	 * @brief Get info about shader file
+	 *
+	 * @param InPath		Path to shader file
+	 * @return Return info about shader file. If file not exist, hash is 0
+	 */
+	const SShaderFileInfo& GetShaderFileInfo( const std::wstring& InPath );
+
+	/**
+	 * @brief Calculate hash of shader file with all included files
+	 *
+	 * @param InPath						Path to shader file
+	 * @param InVertexFactoryFileName		Vertex factory file name, it is included as 'VertexFactory.hlsl'
+	 * @param InHash						Start hash
+	 * @param InOutVisitedFiles				Already hashed files. Need for skip repeated includes
+	 * @return Return hash of shader file with all included files
+	 */
+	uint64 HashShaderFile( const std::wstring& InPath, const std::wstring& InVertexFactoryFileName, uint64 InHash, std::unordered_set< std::wstring >& InOutVisitedFiles );
+
+	/**
+	 * @brief Setup environment for compile shader
+	 *
+	 * @param InShaderMetaType		Shader meta type
+	 * @param InShaderPlatform		Shader platform enum
+	 * @param InVertexFactoryType	Vertex factory type
+	 * @param OutEnvironment		Output environment
+	 */
+	static void SetupEnvironment( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CVertexFactoryMetaType* InVertexFactoryType, SShaderCompilerEnvironment& OutEnvironment );
+
+	/**
+	 * @brief Compile job
+	 * @note Thread safe. Nothing is logged here, result of job is reported by caller after all jobs are finished
+	 *
+	 * @param InOutJob				Job of compiling
+	 * @param InEnvironment			Environment of job, it's set up on calling thread
+	 */
+	static void CompileJob( SShaderCompileJob& InOutJob, const SShaderCompilerEnvironment& InEnvironment );
+
+	/**
+	 * @brief Validate compiled shader and add it to cache
+	 *
+	 * @param InJob					Compiled job
+	 * @param InOutShaderCache		Shader cache
+	 * @param OutErrorMsg			Output error message if shader failed validation
+	 * @return Return TRUE if shader is valid and added to cache, else return FALSE
+	 */
+	static bool AddToCache( const SShaderCompileJob& InJob, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg );
+
+	std::unordered_map< std::wstring, SShaderFileInfo >		shaderFiles;	/**< Cache of info about shader files */
 };
 
 #endif // !WITH_EDITOR
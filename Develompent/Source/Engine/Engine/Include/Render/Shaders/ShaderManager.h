@@ -14,6 +14,7 @@
 
 #include "Misc/Misc.h"
 #include "Misc/EngineGlobals.h"
+#include "System/ThreadingBase.h"
 #include "RHI/BaseRHI.h"
 #include "Shader.h"
 #include "ShaderCache.h"
@@ -497,6 +498,12 @@ class CShaderManager
 public:
     friend CShaderMetaType;
     friend class CShaderCompiler;
+    friend class CShaderPrewarmWork;
+
+    /**
+     * @brief Constructor
+     */
+    CShaderManager();
 
     /**
      * @brief Initialize shader manager
@@ -505,11 +512,13 @@ public:
 
     /**
      * Shutdown shader manager
+     * @note Saves list of used shaders for pre-warm at next run
      */
     void Shutdown();
 
     /**
      * Find instance of shader by name
+     * @note Thread safe. RHI shader is created from shader cache at first call
      *
      * @param[in] InShaderName Shader name
      * @param[in] InVertexFactoryHash Vertex factory hash
@@ -576,12 +585,38 @@ public:
      */
     static std::wstring GetShaderCacheFilename( EShaderPlatform InShaderPlatform );
 
+    /**
+     * Get filename of list of shaders for pre-warm
+     *
+     * @param InShaderPlatform Shader platform
+     * @return Return filename of list of shaders for pre-warm
+     */
+    static std::wstring GetShaderPrewarmFilename( EShaderPlatform InShaderPlatform );
+
 private:
+    /**
+     * @brief Entry of shader in shader map
+     */
+    struct SShaderEntry
+    {
+        /**
+         * @brief Constructor
+         * @param InItemIndex   Index of item in shader cache
+         */
+        SShaderEntry( uint32 InItemIndex = 0 )
+            : itemIndex( InItemIndex )
+            , shader( nullptr )
+        {}
+
+        uint32                  itemIndex;      /**< Index of item in shader cache */
+        CShader* volatile       shader;         /**< Instance of shader, NULL if it not created yet */
+    };
+
     /**
      * @ingroup Engine
      * Typedef shader map
      */
-    typedef std::unordered_map< std::wstring, CShader* >        ShaderMap_t;
+    typedef std::unordered_map< std::wstring, SShaderEntry >    ShaderMap_t;
 
     /**
      * @ingroup Engine
@@ -634,13 +669,38 @@ private:
 
     /**
      * @brief Loading shader from cache
+     * @note Shader cache is mapped to memory, shaders are created on first use in FindInstance
      * 
      * @param[in] InPathShaderCache Path to shader cache
      * @return Return true if shader successed loaded, else return false
      */
     bool                                                    LoadShaders( const tchar* InPathShaderCache );
 
-    MeshShaderMap_t            shaders;            /**< Map of loaded shaders */
+    /**
+     * @brief Create instance of shader
+     * @note Must be called with locked critical section
+     *
+     * @param InOutEntry    Entry of shader
+     */
+    void                                                    CreateInstance( SShaderEntry& InOutEntry );
+
+    /**
+     * @brief Start background pre-warm of shaders used at previous run
+     * @param InPathPrewarmList     Path to list of shaders for pre-warm
+     */
+    void                                                    StartPrewarm( const std::wstring& InPathPrewarmList );
+
+    /**
+     * @brief Save list of created shaders for pre-warm at next run
+     * @param InPathPrewarmList     Path to list of shaders for pre-warm
+     */
+    void                                                    SavePrewarmList( const std::wstring& InPathPrewarmList );
+
+    MeshShaderMap_t                 shaders;            /**< Map of loaded shaders */
+    CShaderCache                    shaderCache;        /**< Mapped shader cache */
+    std::wstring                    pathPrewarmList;    /**< Path to list of shaders for pre-warm in user directory, it's saved at shutdown */
+    class CShaderPrewarmWork*       prewarmWork;        /**< Work of pre-warm shaders in flight */
+    CCriticalSection                cs;                 /**< Critical section for create shaders */
 };
 
 //
@@ -232,6 +232,12 @@ public:
 	 */
 	virtual void ReloadDependentAssets( bool InForce = false );
 
+	/**
+	 * @brief Get memory used by loaded asset
+	 * @return Return size in bytes of verteces and indeces in CPU and GPU memory
+	 */
+	virtual uint64 GetResidentSize() const override;
+
 	/**
 	 * @brief Adds a drawing policy link in SDGs
 	 * @note When CStaticMesh is deleting, all this drawing policy links unlinks from scenes
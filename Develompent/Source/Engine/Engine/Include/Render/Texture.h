@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "RenderResource.h"
+#include "Render/TextureStreaming.h"
 #include "Containers/BulkData.h"
 #include "System/Package.h"
 #include "RHI/BaseSurfaceRHI.h"
@@ -25,6 +26,8 @@
  */
 class CTexture2D : public CAsset, public CRenderResource
 {
+	friend class CTextureStreamingManager;
+
 public:
 	/**
 	 * Constructor
@@ -43,15 +46,22 @@ public:
 	 */
 	virtual void Serialize( class CArchive& InArchive ) override;
 
+	/**
+	 * Get memory used by loaded asset
+	 * @return Return size in bytes of mips in CPU memory and of RHI texture
+	 */
+	virtual uint64 GetResidentSize() const override;
+
 	/**
 	 * Set texture data
 	 * 
 	 * @param[in] InPixelFormat Pixel format
 	 * @param[in] InSizeX Width
 	 * @param[in] InSizeY Height
-	 * @param[in] InData Data
+	 * @param[in] InData Data of all mips, one after another from the largest
+	 * @param[in] InNumMips Number of mips in data
 	 */
-	void SetData( EPixelFormat InPixelFormat, uint32 InSizeX, uint32 InSizeY, const std::vector< byte >& InData );
+	void SetData( EPixelFormat InPixelFormat, uint32 InSizeX, uint32 InSizeY, const std::vector< byte >& InData, uint32 InNumMips = 1 );
 
 	/**
 	 * Set address mod for U coord
@@ -131,6 +141,24 @@ public:
 		return sizeY;
 	}
 
+	/**
+	 * Get number of mips
+	 * @return Return number of mips in texture
+	 */
+	FORCEINLINE uint32 GetNumMips() const
+	{
+		return numMips;
+	}
+
+	/**
+	 * Get streaming state
+	 * @return Return streaming state of texture
+	 */
+	FORCEINLINE const STextureStreamingInfo& GetStreamingInfo() const
+	{
+		return streamingInfo;
+	}
+
 	/**
 	 * Get address mod for U coord
 	 * @return Return address mode for U coord
@@ -189,14 +217,58 @@ protected:
 	virtual void ReleaseRHI() override;
 
 private:
+	/**
+	 * Serialize texture stored in package before VER_TextureStreaming
+	 * @param InArchive		Archive
+	 */
+	void SerializeLegacy( class CArchive& InArchive );
+
+	/**
+	 * Serialize mips. Every mip stored in own compressed block, so high mips can be streamed separately
+	 * @param InArchive		Archive
+	 */
+	void SerializeMips( class CArchive& InArchive );
+
+	/**
+	 * Calculate first mip which always resident in memory
+	 * @return Return first mip with size not greater than CTextureStreamingManager::GetResidentMipSize()
+	 */
+	uint32 CalcFirstResidentMip() const;
+
+	/**
+	 * Update RHI texture with streamed mips
+	 * @note Called by CTextureStreamingManager on game thread
+	 *
+	 * @param InFirstMip	New first mip of RHI texture
+	 * @param InMipsData	Data of mips from InFirstMip to first resident mip. After call it is empty
+	 */
+	void UpdateStreamedMips( uint32 InFirstMip, std::vector<byte>& InMipsData );
+
+	/**
+	 * Drop streamed mips above InFirstMip without reading package
+	 * @note Called by CTextureStreamingManager on game thread. Kept streamed mips are taken from CPU copy
+	 *
+	 * @param InFirstMip	New first mip of RHI texture. Must be between current first mip and first resident mip
+	 */
+	void DropStreamedMips( uint32 InFirstMip );
+
+	/**
+	 * Recreate RHI texture from CPU copy of streamed mips and resident mips
+	 * @note Called on game thread
+	 */
+	void BeginUpdateStreamedRHI();
+
 	uint32						sizeX;				/**< Width of texture */
 	uint32						sizeY;				/**< Height of texture */
-	CBulkData<byte>				data;				/**< Data used when loading texture */
+	uint32						numMips;			/**< Number of mips */
+	CBulkData<byte>				data;				/**< Data of mips used when loading texture. For streamed texture contains resident mips only */
+	std::vector<byte>			streamedData;		/**< CPU copy of streamed mips from first mip of RHI texture to first resident mip */
 	EPixelFormat				pixelFormat;		/**< Pixel format of texture */
 	Texture2DRHIRef_t			texture;			/**< Reference to RHI texture */
 	ESamplerAddressMode			addressU;			/**< Address mode for U coord */
 	ESamplerAddressMode			addressV;			/**< Address mode for V coord */
 	ESamplerFilter				samplerFilter;		/**< Sampler filter */
+	STextureStreamingInfo		streamingInfo;		/**< Streaming state */
 };
 
 //
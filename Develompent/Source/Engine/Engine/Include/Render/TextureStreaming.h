@@ -0,0 +1,182 @@
+/**
+ * @file
+ * @addtogroup Engine Engine
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef TEXTURESTREAMING_H
+#define TEXTURESTREAMING_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_set>
+
+#include "Core.h"
+#include "Misc/Misc.h"
+#include "Misc/SharedPointer.h"
+#include "System/ThreadingBase.h"
+
+/**
+ * @ingroup Engine
+ * @brief Streaming state of texture 2D
+ */
+struct STextureStreamingInfo
+{
+	/**
+	 * @brief Constructor
+	 */
+	STextureStreamingInfo()
+		: firstResidentMip( 0 )
+		, firstMip( 0 )
+		, frameScreenSize( 0 )
+		, screenSize( 0 )
+		, lastRenderTimeMS( 0 )
+		, compressionFlags( CF_ZLIB )
+		, request( nullptr )
+	{}
+
+	/**
+	 * @brief Is texture streamed
+	 * @return Return TRUE if texture has streamable mips, else return FALSE
+	 */
+	FORCEINLINE bool IsStreamed() const
+	{
+		return firstResidentMip > 0;
+	}
+
+	std::wstring						packagePath;		/**< Path to package from which mips are streamed */
+	std::vector<uint32>					mipOffsets;			/**< Offsets in package of compressed mips above firstResidentMip */
+	uint32								firstResidentMip;	/**< First mip which always resident in memory. Mips above it are streamed */
+	uint32								firstMip;			/**< First mip of RHI texture, updated on game thread when streaming request is finished */
+	volatile int32						frameScreenSize;	/**< Maximum size on screen in pixels at the current frame. Written by rendering thread in CScene::BuildView */
+	int32								screenSize;			/**< Maximum size on screen in pixels at the last rendered frame */
+	volatile int64						lastRenderTimeMS;	/**< Time in milliseconds when texture was visible last time. Written by rendering thread, read by game thread */
+	ECompressionFlags					compressionFlags;	/**< Compression flags of mips in package */
+	class CTextureStreamingRequest*		request;			/**< Streaming request in flight, if not null */
+};
+
+/**
+ * @ingroup Engine
+ * @brief Manager of texture streaming
+ *
+ * Low mips of textures always resident in memory, higher mips loaded on demand by screen size of primitives
+ * which use the textures. All streamed mips must fit in the memory pool, when pool is full
+ * mips of textures with smaller size on screen are dropped at first.
+ * Mips are read from packages asynchronously on thread pool
+ */
+class CTextureStreamingManager
+{
+public:
+	/**
+	 * @brief Constructor
+	 */
+	CTextureStreamingManager();
+
+	/**
+	 * @brief Initialize manager
+	 */
+	void Init();
+
+	/**
+	 * @brief Shutdown manager
+	 * @note Waits for all requests in flight
+	 */
+	void Shutdown();
+
+	/**
+	 * @brief Update streaming
+	 * @note Must be called on game thread
+	 *
+	 * Applies finished requests, recalculates wanted mips of textures in the memory pool and issues new requests
+	 */
+	void Tick();
+
+	/**
+	 * @brief Register streamed texture
+	 * @param InTexture		Texture
+	 */
+	void AddTexture( class CTexture2D* InTexture );
+
+	/**
+	 * @brief Unregister streamed texture
+	 * @note Request in flight of texture is abandoned
+	 *
+	 * @param InTexture		Texture
+	 */
+	void RemoveTexture( class CTexture2D* InTexture );
+
+	/**
+	 * @brief Update screen size of textures used by primitive
+	 * @note Called on rendering thread for every visible primitive in CScene::BuildView
+	 *
+	 * @param InSceneView	Scene view
+	 * @param InPrimitive	Visible primitive
+	 */
+	void UpdatePrimitive( const class CSceneView& InSceneView, class CPrimitiveComponent* InPrimitive );
+
+	/**
+	 * @brief Print to log state of texture streaming
+	 */
+	void DumpStreamingInfo();
+
+	/**
+	 * @brief Is enabled texture streaming
+	 * @return Return TRUE if texture streaming is enabled, else return FALSE
+	 */
+	FORCEINLINE bool IsEnabled() const
+	{
+		return bEnabled;
+	}
+
+	/**
+	 * @brief Get maximum size of resident mips
+	 * @return Return maximum size of mips which always resident in memory
+	 */
+	FORCEINLINE uint32 GetResidentMipSize() const
+	{
+		return residentMipSize;
+	}
+
+private:
+	/**
+	 * @brief Calculate first mip which texture needs for its size on screen
+	 *
+	 * @param InTexture		Texture
+	 * @return Return first wanted mip of texture
+	 */
+	uint32 CalcWantedFirstMip( class CTexture2D* InTexture ) const;
+
+	/**
+	 * @brief Calculate memory size of streamed mips
+	 *
+	 * @param InTexture		Texture
+	 * @param InFirstMip	First mip of texture
+	 * @return Return size in bytes of mips from InFirstMip to first resident mip
+	 */
+	static uint32 CalcStreamedSize( class CTexture2D* InTexture, uint32 InFirstMip );
+
+	/**
+	 * @brief Apply finished requests and delete abandoned ones
+	 * @note Must be called with locked critical section
+	 */
+	void ProcessFinishedRequests();
+
+	bool										bEnabled;				/**< Is enabled texture streaming */
+	uint32										residentMipSize;		/**< Maximum size of mips which always resident in memory */
+	uint64										poolSize;				/**< Size of memory pool for streamed mips in bytes */
+	uint64										poolUsage;				/**< Size of streamed mips loaded to RHI textures and reserved by requests in flight in bytes */
+	uint32										maxRequestsInFlight;	/**< Maximum number of requests in flight */
+	float										streamOutDelay;			/**< Time in seconds after which mips of not visible texture are dropped */
+	float										mipBias;				/**< Bias of wanted mips. Positive value drops mips, negative value loads more */
+	std::unordered_set<class CTexture2D*>		textures;				/**< Registered streamed textures */
+	std::list<class CTextureStreamingRequest*>	requests;				/**< Requests in flight */
+	std::vector< TSharedPtr<class CTexture2D> >	usedTextures;			/**< Scratch array of textures used by primitive. Used only on rendering thread */
+	CCriticalSection							cs;						/**< Critical section */
+};
+
+extern CTextureStreamingManager			GTextureStreamingManager;		/**< Global texture streaming manager */
+
+#endif // !TEXTURESTREAMING_H
@@ -37,6 +37,12 @@ public:
 	 */
 	virtual void						Serialize( class CArchive& InArchive ) override;
 
+	/**
+	 * @brief Get memory used by loaded asset
+	 * @return Return size in bytes of byte code and of Lua VM at the last script call
+	 */
+	virtual uint64						GetResidentSize() const override;
+
 	/**
 	 * @brief Execute function
 	 * 
@@ -50,6 +56,7 @@ public:
 		if ( luaRef && luaRef.isFunction() )
 		{
 			luaRef( InArgs... );
+			UpdateVMMemoryUsage();
 		}
 		else
 		{
@@ -70,7 +77,9 @@ public:
 		luabridge::LuaRef		luaRef = luabridge::getGlobal( luaVM, InFunctionName );
 		if ( luaRef && luaRef.isFunction() )
 		{
-			return luaRef( InArgs... );
+			TReturnType		result = luaRef( InArgs... );
+			UpdateVMMemoryUsage();
+			return result;
 		}
 
 		LE_LOG( LT_Warning, LC_Script, TEXT( "Script function [%s] not found in script" ), ANSI_TO_TCHAR( InFunctionName ) );
@@ -133,7 +142,14 @@ public:
 	}
 
 private:
+	/**
+	 * @brief Update cached size of memory in use by Lua VM
+	 * @note Must be called on thread which runs the script
+	 */
+	void								UpdateVMMemoryUsage();
+
 	struct lua_State*		luaVM;				/**< Pointer to lua virtual machine */
+	uint64					vmMemoryUsage;		/**< Size of memory in use by Lua VM, updated after script calls */
 	std::vector< byte >		byteCode;			/**< Byte code */
 	std::string				name;				/**< Name of script */
 };
@@ -70,6 +70,9 @@ void CPrimitiveComponent::UnlinkDrawList()
 void CPrimitiveComponent::AddToDrawList( const class CSceneView& InSceneView )
 {}
 
+void CPrimitiveComponent::GetUsedTextures( std::vector< TSharedPtr<class CTexture2D> >& OutTextures ) const
+{}
+
 void CPrimitiveComponent::InitPrimitivePhysics()
 {
 	if ( bodySetup )
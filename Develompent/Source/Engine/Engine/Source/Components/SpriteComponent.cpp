@@ -221,3 +221,12 @@ void CSpriteComponent::AddToDrawList( const class CSceneView& InSceneView )
     // Update AABB
     boundbox = CBox::BuildAABB( GetComponentLocation(), Vector( GetSpriteSize(), 1.f ) );
 }
+
+void CSpriteComponent::GetUsedTextures( std::vector< TSharedPtr<class CTexture2D> >& OutTextures ) const
+{
+	TSharedPtr<CMaterial>		materialRef = GetMaterial().ToSharedPtr();
+	if ( materialRef )
+	{
+		materialRef->GetTextures( OutTextures );
+	}
+}
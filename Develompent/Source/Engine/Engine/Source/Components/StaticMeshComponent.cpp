@@ -94,3 +94,15 @@ void CStaticMeshComponent::AddToDrawList( const class CSceneView& InSceneView )
 										} );
 	}
 }
+
+void CStaticMeshComponent::GetUsedTextures( std::vector< TSharedPtr<class CTexture2D> >& OutTextures ) const
+{
+	for ( uint32 index = 0, count = overrideMaterials.size(); index < count; ++index )
+	{
+		TSharedPtr<CMaterial>		materialRef = GetMaterial( index ).ToSharedPtr();
+		if ( materialRef )
+		{
+			materialRef->GetTextures( OutTextures );
+		}
+	}
+}
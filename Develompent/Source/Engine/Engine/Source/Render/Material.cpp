@@ -1,5 +1,6 @@
 #include "Misc/CoreGlobals.h"
 #include "Logger/LoggerMacros.h"
+#include "System/MemoryTracker.h"
 #include "System/Package.h"
 #include "Render/Material.h"
 #include "Render/VertexFactory/StaticMeshVertexFactory.h"
@@ -28,6 +29,8 @@ CMaterial::~CMaterial()
 
 void CMaterial::Serialize( class CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Material );
+
 	if ( InArchive.Ver() < VER_ShaderMap )
 	{
 		return;
@@ -209,6 +212,18 @@ bool CMaterial::GetVectorParameterValue( const CName& InParameterName, Vector4D&
 	return true;
 }
 
+void CMaterial::GetTextures( std::vector< TSharedPtr<CTexture2D> >& OutTextures ) const
+{
+	for ( auto itTexture = textureParameters.begin(), itTextureEnd = textureParameters.end(); itTexture != itTextureEnd; ++itTexture )
+	{
+		TSharedPtr<CTexture2D>		texture2DRef = itTexture->second.ToSharedPtr();
+		if ( texture2DRef )
+		{
+			OutTextures.push_back( texture2DRef );
+		}
+	}
+}
+
 void CMaterial::GetDependentAssets( SetDependentAssets_t& OutDependentAssets, EAssetType InFilter /* = AT_Unknown */ ) const
 {
 	// Fill set of dependent assets
@@ -28,12 +28,33 @@ SPixelFormatInfo		GPixelFormats[ PF_Max ] =
 	{ TEXT( "BC3" ),					4,			4,			1,			16,			4,				0,				0,				0,				PF_BC3						},
 	{ TEXT( "BC5" ),					4,			4,			1,			16,			2,				0,				0,				0,				PF_BC5						},
 	{ TEXT( "BC6H" ),					1,			1,			1,			16,			3,				0,				0,				0,				PF_BC6H						},
-	{ TEXT( "BC7" ),					4,			4,			1,			16,			4,				0,				0,				0,				PF_BC7						}
+	{ TEXT( "BC7" ),					4,			4,			1,			16,			4,				0,				0,				0,				PF_BC7						},
+	{ TEXT( "BC4" ),					4,			4,			1,			8,			1,				0,				0,				0,				PF_BC4						}
 };
 
 /** Offset to center of the pixel */
 float			GPixelCenterOffset		= 0.5f;
 
+uint32 CalcTextureMipSize( EPixelFormat InFormat, uint32 InSizeX, uint32 InSizeY, uint32 InMipIndex )
+{
+	const SPixelFormatInfo&		formatInfo	= GPixelFormats[ InFormat ];
+	uint32						mipSizeX	= Max<uint32>( InSizeX >> InMipIndex, 1 );
+	uint32						mipSizeY	= Max<uint32>( InSizeY >> InMipIndex, 1 );
+	uint32						numBlocksX	= ( mipSizeX + formatInfo.blockSizeX - 1 ) / formatInfo.blockSizeX;
+	uint32						numBlocksY	= ( mipSizeY + formatInfo.blockSizeY - 1 ) / formatInfo.blockSizeY;
+	return numBlocksX * numBlocksY * formatInfo.blockBytes;
+}
+
+uint32 CalcTextureSize( EPixelFormat InFormat, uint32 InSizeX, uint32 InSizeY, uint32 InNumMips )
+{
+	uint32		size = 0;
+	for ( uint32 mipIndex = 0; mipIndex < InNumMips; ++mipIndex )
+	{
+		size += CalcTextureMipSize( InFormat, InSizeX, InSizeY, mipIndex );
+	}
+	return size;
+}
+
 void DrawDenormalizedQuad( class CBaseDeviceContextRHI* InDeviceContextRHI, float InX, float InY, float InSizeX, float InSizeY, float InU, float InV, float InSizeU, float InSizeV, uint32 InTargetSizeX, uint32 InTargetSizeY, uint32 InTextureSizeX, uint32 InTextureSizeY, float InClipSpaceQuadZ )
 {
 	// Set up the vertices
@@ -1,6 +1,7 @@
 #include "Math/Math.h"
 #include "Render/SceneRenderTargets.h"
 #include "Render/Scene.h"
+#include "Render/TextureStreaming.h"
 
 CSceneView::CSceneView( const Vector& InPosition, const Matrix& InProjectionMatrix, const Matrix& InViewMatrix, float InSizeX, float InSizeY, const CColor& InBackgroundColor, ShowFlags_t InShowFlags )
 	: viewMatrix( InViewMatrix )
@@ -158,13 +159,18 @@ void CScene::Clear()
 
 void CScene::BuildView( const CSceneView& InSceneView )
 {
-	// Add to SDGs visible primitives
+	// Add to SDGs visible primitives and update screen size of their textures for streaming
+	bool		bTextureStreaming = GTextureStreamingManager.IsEnabled();
 	for ( auto it = primitives.begin(), itEnd = primitives.end(); it != itEnd; ++it )
 	{
 		CPrimitiveComponent*		primitiveComponent = *it;
 		if ( primitiveComponent->IsVisibility() && InSceneView.GetFrustum().IsIn( primitiveComponent->GetBoundBox() ) )
 		{
 			primitiveComponent->AddToDrawList( InSceneView );
+			if ( bTextureStreaming )
+			{
+				GTextureStreamingManager.UpdatePrimitive( InSceneView, primitiveComponent );
+			}
 		}
 	}
 
@@ -19,6 +19,12 @@
 #include "Render/VertexFactory/SimpleElementVertexFactory.h"
 #include "Render/SceneRenderTargets.h"
 
+DECLARE_CYCLE_STAT( TEXT( "Build view" ), STAT_BuildView, SG_Scene );
+DECLARE_CYCLE_STAT( TEXT( "Render scene" ), STAT_RenderScene, SG_Scene );
+DECLARE_CYCLE_STAT( TEXT( "Render SDG" ), STAT_RenderSDG, SG_Scene );
+DECLARE_COUNTER_STAT( TEXT( "Draw calls" ), STAT_DrawCalls, SG_Scene );
+DECLARE_COUNTER_STAT( TEXT( "Draw primitives" ), STAT_DrawPrimitives, SG_Scene );
+
 CSceneRenderer::CSceneRenderer( CSceneView* InSceneView, class CScene* InScene /* = nullptr */ )
 	: scene( InScene )
 	, sceneView( InSceneView )
@@ -53,6 +59,7 @@ void CSceneRenderer::BeginRenderViewTarget( ViewportRHIParamRef_t InViewportRHI
 	// Build visible view on scene
 	if ( scene )
 	{
+		SCOPE_CYCLE_COUNTER( STAT_BuildView );
 		scene->BuildView( *sceneView );
 	}
 }
@@ -64,6 +71,8 @@ void CSceneRenderer::Render( ViewportRHIParamRef_t InViewportRHI )
 		return;
 	}
 
+	SCOPE_CYCLE_COUNTER( STAT_RenderScene );
+
 	CBaseDeviceContextRHI*	immediateContext	= GRHI->GetImmediateContext();
 	ShowFlags_t				showFlags			= sceneView->GetShowFlags();
 	bool					bDirty				= false;
@@ -119,6 +128,8 @@ bool CSceneRenderer::RenderSDG( class CBaseDeviceContextRHI* InDeviceContext, ui
 		return false;
 	}
 
+	SCOPE_CYCLE_COUNTER( STAT_RenderSDG );
+
 	SCOPED_DRAW_EVENT( EventSDG, DEC_SCENE_ITEMS, CString::Format( TEXT( "SDG %s" ), GetSceneSDGName( ( ESceneDepthGroup )InSDGIndex ) ).c_str() );
 
 #if WITH_EDITOR
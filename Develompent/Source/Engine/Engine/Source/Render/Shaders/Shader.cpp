@@ -19,27 +19,27 @@ void CShader::Init( const CShaderCache::SShaderCacheItem& InShaderCacheItem )
 	switch ( frequency )
 	{
 	case SF_Vertex:
-		vertexShader = GRHI->CreateVertexShader( name.c_str(), InShaderCacheItem.code.GetData(), InShaderCacheItem.code.Num() );
+		vertexShader = GRHI->CreateVertexShader( name.c_str(), InShaderCacheItem.GetCode(), InShaderCacheItem.GetCodeSize() );
 		check( vertexShader );
 		break;
 
 	case SF_Hull:
-		hullShader = GRHI->CreateHullShader( name.c_str(), InShaderCacheItem.code.GetData(), InShaderCacheItem.code.Num() );
+		hullShader = GRHI->CreateHullShader( name.c_str(), InShaderCacheItem.GetCode(), InShaderCacheItem.GetCodeSize() );
 		check( hullShader );
 		break;
 
 	case SF_Domain:
-		domainShader = GRHI->CreateDomainShader( name.c_str(), InShaderCacheItem.code.GetData(), InShaderCacheItem.code.Num() );
+		domainShader = GRHI->CreateDomainShader( name.c_str(), InShaderCacheItem.GetCode(), InShaderCacheItem.GetCodeSize() );
 		check( domainShader );
 		break;
 
 	case SF_Pixel:
-		pixelShader = GRHI->CreatePixelShader( name.c_str(), InShaderCacheItem.code.GetData(), InShaderCacheItem.code.Num() );
+		pixelShader = GRHI->CreatePixelShader( name.c_str(), InShaderCacheItem.GetCode(), InShaderCacheItem.GetCodeSize() );
 		check( pixelShader );
 		break;
 
 	case SF_Geometry:
-		geometryShader = GRHI->CreateGeometryShader( name.c_str(), InShaderCacheItem.code.GetData(), InShaderCacheItem.code.Num() );
+		geometryShader = GRHI->CreateGeometryShader( name.c_str(), InShaderCacheItem.GetCode(), InShaderCacheItem.GetCodeSize() );
 		check( geometryShader );
 		break;
 
@@ -1,35 +1,215 @@
-#include "Render/Shaders/ShaderCache.h"
+#include <algorithm>
+
+#include "Containers/String.h"
+#include "Misc/CoreGlobals.h"
+#include "Logger/LoggerMacros.h"
 #include "System/Archive.h"
+#include "System/MemoryTracker.h"
+#include "System/BaseFileSystem.h"
+#include "Render/Shaders/ShaderCache.h"
+#include "Render/Shaders/ShaderManager.h"
+#include "Render/VertexFactory/VertexFactory.h"
 
 #define SHADER_CACHE_VERSION			4
 
-bool CShaderParameterMap::FindParameterAllocation( const tchar* InParameterName, uint32& OutBufferIndex, uint32& OutBaseIndex, uint32& OutSize, uint32& OutSamplerIndex ) const
+/**
+ * Slot of parameter in shader parameter map before VER_ShaderParameterSlots
+ */
+struct SLegacyParameterAllocation
 {
-	auto		itParamAllocation = parameterMap.find( InParameterName );
-	if ( itParamAllocation != parameterMap.end() )
+	/**
+	 * Overload operator << for serialize
+	 */
+	FORCEINLINE friend CArchive& operator<<( CArchive& InAr, SLegacyParameterAllocation& InParameterAllocation )
 	{
-		const SParameterAllocation&		allocation = itParamAllocation->second;
-		OutBufferIndex = allocation.bufferIndex;
-		OutBaseIndex = allocation.baseIndex;
-		OutSize = allocation.size;
-		OutSamplerIndex = allocation.samplerIndex;
-		allocation.isBound = true;
-		return true;
+		return InAr << InParameterAllocation.bufferIndex << InParameterAllocation.baseIndex << InParameterAllocation.size << InParameterAllocation.samplerIndex << InParameterAllocation.isBound;
 	}
-	else
+
+	uint32			bufferIndex;		/**< Buffer index */
+	uint32			baseIndex;			/**< Base index */
+	uint32			size;				/**< Size parameter */
+	uint32			samplerIndex;		/**< Sampler index */
+	bool			isBound;			/**< Is bound */
+};
+
+/**
+ * Find parameter allocation by hash of name
+ */
+bool CShaderParameterMap::FindParameterAllocation( uint64 InNameHash, uint32& OutBufferIndex, uint32& OutBaseIndex, uint32& OutSize, uint32& OutSamplerIndex ) const
+{
+	auto		itAllocation = std::lower_bound( allocations.begin(), allocations.end(), InNameHash, []( const SParameterAllocation& InAllocation, uint64 InHash )
+											 {
+												 return InAllocation.nameHash < InHash;
+											 } );
+	if ( itAllocation == allocations.end() || itAllocation->nameHash != InNameHash )
 	{
 		return false;
 	}
+
+	OutBufferIndex = itAllocation->bufferIndex;
+	OutBaseIndex = itAllocation->baseIndex;
+	OutSize = itAllocation->size;
+	OutSamplerIndex = itAllocation->samplerIndex;
+
+#if WITH_EDITOR
+	if ( !boundSlots.empty() )
+	{
+		boundSlots[ itAllocation - allocations.begin() ] = true;
+	}
+#endif // WITH_EDITOR
+	return true;
 }
 
+/**
+ * Add parameter allocation
+ */
 void CShaderParameterMap::AddParameterAllocation( const tchar* InParameterName, uint32 InBufferIndex, uint32 InBaseIndex, uint32 InSize, uint32 InSamplerIndex )
 {
 	SParameterAllocation 		allocation;
+	allocation.nameHash = HashParameterName( InParameterName );
 	allocation.bufferIndex = InBufferIndex;
 	allocation.baseIndex = InBaseIndex;
 	allocation.size = InSize;
 	allocation.samplerIndex = InSamplerIndex;
-	parameterMap[ InParameterName ] = allocation;
+
+	auto		itAllocation = std::lower_bound( allocations.begin(), allocations.end(), allocation.nameHash, []( const SParameterAllocation& InAllocation, uint64 InHash )
+											 {
+												 return InAllocation.nameHash < InHash;
+											 } );
+	uint32		index = itAllocation - allocations.begin();
+	if ( itAllocation != allocations.end() && itAllocation->nameHash == allocation.nameHash )
+	{
+#if WITH_EDITOR
+		checkMsg( names.empty() || names[ index ] == InParameterName, TEXT( "Hash collision of shader parameters '%s' and '%s'" ), names[ index ].c_str(), InParameterName );
+#endif // WITH_EDITOR
+		*itAllocation = allocation;
+		return;
+	}
+
+	allocations.insert( itAllocation, allocation );
+#if WITH_EDITOR
+	// Names are known only for map filled by compiler
+	if ( names.size() + 1 == allocations.size() )
+	{
+		names.insert( names.begin() + index, InParameterName );
+		boundSlots.insert( boundSlots.begin() + index, false );
+	}
+	else
+	{
+		names.clear();
+		boundSlots.clear();
+	}
+#endif // WITH_EDITOR
+}
+
+#if WITH_EDITOR
+/**
+ * Set reflected size of constant buffer
+ */
+void CShaderParameterMap::SetConstantBufferSize( uint32 InBufferIndex, uint32 InSize )
+{
+	if ( InBufferIndex >= constantBufferSizes.size() )
+	{
+		constantBufferSizes.resize( InBufferIndex + 1, 0 );
+	}
+	constantBufferSizes[ InBufferIndex ] = InSize;
+}
+
+/**
+ * Verify bindings of shader
+ */
+bool CShaderParameterMap::VerifyBindings( const std::wstring& InShaderName, std::wstring& OutErrorMsg ) const
+{
+	OutErrorMsg = TEXT( "" );
+	for ( uint32 index = 0, count = names.size(); index < count; ++index )
+	{
+		if ( !boundSlots[ index ] )
+		{
+			LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader %s has parameter '%s' which not bound, engine never sets it" ), InShaderName.c_str(), names[ index ].c_str() );
+			continue;
+		}
+
+		// Variables of constant buffers have valid base index and zero sampler index, textures and samplers are skipped
+		const SParameterAllocation&		allocation = allocations[ index ];
+		if ( allocation.samplerIndex != 0 || allocation.baseIndex == ( uint32 )-1 || !OutErrorMsg.empty() )
+		{
+			continue;
+		}
+
+		// Bound parameter must fit in reflected constant buffer
+		if ( allocation.bufferIndex >= constantBufferSizes.size() || allocation.baseIndex + allocation.size > constantBufferSizes[ allocation.bufferIndex ] )
+		{
+			OutErrorMsg = CString::Format( TEXT( "Shader %s has parameter '%s' at offset %i size %i which out of constant buffer %i" ), InShaderName.c_str(), names[ index ].c_str(), allocation.baseIndex, allocation.size, allocation.bufferIndex );
+			continue;
+		}
+
+		// HLSL packs variables in 16-byte registers, variable not bigger than register can't cross it and bigger one starts at register
+		uint32		registerOffset = allocation.baseIndex % 16;
+		if ( allocation.size <= 16 ? registerOffset + allocation.size > 16 : registerOffset != 0 )
+		{
+			OutErrorMsg = CString::Format( TEXT( "Shader %s has parameter '%s' at offset %i size %i which cross 16-byte register" ), InShaderName.c_str(), names[ index ].c_str(), allocation.baseIndex, allocation.size );
+			continue;
+		}
+
+		// Bound parameters in one constant buffer can't overlap
+		for ( uint32 otherIndex = index + 1; otherIndex < count; ++otherIndex )
+		{
+			const SParameterAllocation&		otherAllocation = allocations[ otherIndex ];
+			if ( boundSlots[ otherIndex ] && otherAllocation.samplerIndex == 0 && otherAllocation.baseIndex != ( uint32 )-1 && otherAllocation.bufferIndex == allocation.bufferIndex &&
+				 otherAllocation.baseIndex < allocation.baseIndex + allocation.size && allocation.baseIndex < otherAllocation.baseIndex + otherAllocation.size )
+			{
+				OutErrorMsg = CString::Format( TEXT( "Shader %s has overlapped parameters '%s' and '%s' in constant buffer %i" ), InShaderName.c_str(), names[ index ].c_str(), names[ otherIndex ].c_str(), allocation.bufferIndex );
+				break;
+			}
+		}
+	}
+
+	if ( !OutErrorMsg.empty() )
+	{
+		LE_LOG( LT_Error, LC_Shader, TEXT( "%s" ), OutErrorMsg.c_str() );
+		return false;
+	}
+	return true;
+}
+#endif // WITH_EDITOR
+
+/**
+ * Serialize shader parameter map
+ */
+void CShaderParameterMap::Serialize( CArchive& InArchive )
+{
+	// Before VER_ShaderParameterSlots map was keyed by names, we convert it to table of slots
+	if ( InArchive.IsLoading() && InArchive.Ver() < VER_ShaderParameterSlots )
+	{
+		std::unordered_map< std::wstring, SLegacyParameterAllocation >		legacyParameterMap;
+		InArchive << legacyParameterMap;
+
+		allocations.clear();
+		for ( auto itParameter = legacyParameterMap.begin(), itParameterEnd = legacyParameterMap.end(); itParameter != itParameterEnd; ++itParameter )
+		{
+			const SLegacyParameterAllocation&		allocation = itParameter->second;
+			AddParameterAllocation( itParameter->first.c_str(), allocation.bufferIndex, allocation.baseIndex, allocation.size, allocation.samplerIndex );
+		}
+	}
+	else
+	{
+		uint32		numAllocations = allocations.size();
+		InArchive << numAllocations;
+		if ( InArchive.IsLoading() )
+		{
+			allocations.resize( numAllocations );
+		}
+		InArchive.Serialize( allocations.data(), numAllocations * sizeof( SParameterAllocation ) );
+	}
+
+#if WITH_EDITOR
+	// Loaded map has no names of parameters
+	if ( InArchive.IsLoading() )
+	{
+		names.clear();
+		boundSlots.clear();
+	}
+#endif // WITH_EDITOR
 }
 
 /**
@@ -58,16 +238,27 @@ void CShaderCache::SShaderCacheItem::Serialize( CArchive& InArchive )
 		InArchive << parameterMap;
 	}
 
+	// Since VER_ShaderCacheIndex byte code stored after index of shader cache, see CShaderCache::Serialize
 	if ( InArchive.Ver() < VER_CompressedZlib )
 	{
 		std::vector<byte>		tmpCode;
 		InArchive << tmpCode;
 		code = tmpCode;
 	}
-	else
+	else if ( InArchive.Ver() < VER_ShaderCacheIndex )
 	{
 		InArchive << code;
 	}
+
+	// Items of old shader cache have unknown inputs, so they will be recompiled at first update of cache
+	if ( InArchive.Ver() >= VER_ShaderSourceHash )
+	{
+		InArchive << sourceHash;
+	}
+	else if ( InArchive.IsLoading() )
+	{
+		sourceHash = 0;
+	}
 }
 
 /**
@@ -75,6 +266,8 @@ void CShaderCache::SShaderCacheItem::Serialize( CArchive& InArchive )
  */
 void CShaderCache::Serialize( CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Shader );
+
 	check( InArchive.Type() == AT_ShaderCache );
 
 	if ( InArchive.IsLoading() )
@@ -90,14 +283,65 @@ void CShaderCache::Serialize( CArchive& InArchive )
 
 		uint32			countItems = 0;
 		InArchive << countItems;
-		items.resize( countItems );
 
-		// Loading all items from archive
+		// Loading index of items from archive
+		std::vector< SShaderCacheItem >		loadedItems( countItems );
+		std::vector< uint32 >				codeOffsets( countItems );
 		for ( uint32 indexItem = 0; indexItem < countItems; ++indexItem )
 		{
-			SShaderCacheItem&		item = items[ indexItem ];
+			SShaderCacheItem&		item = loadedItems[ indexItem ];
 			item.Serialize( InArchive );
-			itemsMap[ item.vertexFactoryHash ].insert( item.name );
+			if ( InArchive.Ver() >= VER_ShaderCacheIndex )
+			{
+				InArchive << item.mappedCodeSize;
+				InArchive << codeOffsets[ indexItem ];
+			}
+		}
+
+		// Byte code of shaders we take from mapped file if it is, else read it from archive
+		if ( InArchive.Ver() >= VER_ShaderCacheIndex )
+		{
+			for ( uint32 indexItem = 0; indexItem < countItems; ++indexItem )
+			{
+				SShaderCacheItem&		item = loadedItems[ indexItem ];
+				if ( mappedFile.IsValid() )
+				{
+					checkMsg( ( uint64 )codeOffsets[ indexItem ] + item.mappedCodeSize <= mappedFile->GetSize(), TEXT( "Shader cache '%s' is corrupted" ), InArchive.GetPath().c_str() );
+					item.mappedCode = mappedFile->GetData() + codeOffsets[ indexItem ];
+				}
+				else
+				{
+					item.code.Resize( item.mappedCodeSize );
+					InArchive.Seek( codeOffsets[ indexItem ] );
+					InArchive.Serialize( item.code.GetData(), item.mappedCodeSize );
+					item.mappedCodeSize = 0;
+				}
+			}
+		}
+
+		// Keys of items in old shader cache are calculated by old hash function, so we drop them and they will be recompiled
+		if ( InArchive.Ver() < VER_FastHash )
+		{
+			LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader cache '%s' is outdated, all shaders need to be recompiled" ), InArchive.GetPath().c_str() );
+			return;
+		}
+
+		// Items with mapped byte code we insert as is, Add would copy it
+		items.reserve( items.size() + countItems );
+		for ( uint32 indexItem = 0; indexItem < countItems; ++indexItem )
+		{
+			const SShaderCacheItem&							item		= loadedItems[ indexItem ];
+			std::unordered_map< std::wstring, uint32 >&		shaderMap	= itemsMap[ item.vertexFactoryHash ];
+			auto											itShader	= shaderMap.find( item.name );
+			if ( itShader != shaderMap.end() )
+			{
+				items[ itShader->second ] = item;
+			}
+			else
+			{
+				shaderMap.insert( std::make_pair( item.name, ( uint32 )items.size() ) );
+				items.push_back( item );
+			}
 		}
 	}
 	else if ( InArchive.IsSaving() )
@@ -106,10 +350,158 @@ void CShaderCache::Serialize( CArchive& InArchive )
 		InArchive << SHADER_CACHE_VERSION;
 		InArchive << countItems;
 
-		// Save all items to archive
+		// Save index of items. Offsets to byte code not known yet, so we remember their positions and patch them later
+		std::vector< uint32 >		offsetPositions( countItems );
 		for ( uint32 indexItem = 0; indexItem < countItems; ++indexItem )
 		{
+			const SShaderCacheItem&		item = items[ indexItem ];
 			items[ indexItem ].Serialize( InArchive );
+			InArchive << item.GetCodeSize();
+			offsetPositions[ indexItem ] = InArchive.Tell();
+			InArchive << ( uint32 )0;
+		}
+
+		// Save uncompressed byte code of all shaders after index, so it can be used directly from mapped file
+		std::vector< uint32 >		codeOffsets( countItems );
+		for ( uint32 indexItem = 0; indexItem < countItems; ++indexItem )
+		{
+			const SShaderCacheItem&		item = items[ indexItem ];
+			codeOffsets[ indexItem ] = InArchive.Tell();
+			InArchive.Serialize( ( void* )item.GetCode(), item.GetCodeSize() );
+		}
+
+		uint32		endPosition = InArchive.Tell();
+		for ( uint32 indexItem = 0; indexItem < countItems; ++indexItem )
+		{
+			InArchive.Seek( offsetPositions[ indexItem ] );
+			InArchive << codeOffsets[ indexItem ];
 		}
+		InArchive.Seek( endPosition );
 	}
-}
\ No newline at end of file
+}
+
+/**
+ * Load shader cache from file
+ */
+bool CShaderCache::Load( const std::wstring& InPath )
+{
+	CArchive*		archive = GFileSystem->CreateFileReader( InPath );
+	if ( !archive )
+	{
+		return false;
+	}
+
+	archive->SerializeHeader();
+	Serialize( *archive );
+	delete archive;
+	return true;
+}
+
+/**
+ * Map shader cache file to memory
+ */
+bool CShaderCache::Map( const std::wstring& InPath )
+{
+	CArchive*		archive = GFileSystem->CreateFileReader( InPath );
+	if ( !archive )
+	{
+		return false;
+	}
+
+	// Old shader cache has compressed byte code inside of items, so it can't be mapped
+	archive->SerializeHeader();
+	if ( archive->Ver() >= VER_ShaderCacheIndex )
+	{
+		mappedFile = GFileSystem->MapFile( InPath );
+		if ( !mappedFile.IsValid() )
+		{
+			delete archive;
+			return false;
+		}
+	}
+
+	Serialize( *archive );
+	delete archive;
+	return true;
+}
+
+/**
+ * Save shader cache to file
+ */
+void CShaderCache::Save( const std::wstring& InPath )
+{
+	// Shaders and vertex factories removed from engine stay in cache forever if we not drop them here
+	uint32			numRemovedItems = RemoveUnregisteredItems();
+	if ( numRemovedItems > 0 )
+	{
+		LE_LOG( LT_Log, LC_Shader, TEXT( "Removed %u items of unregistered shaders or vertex factories from shader cache '%s'" ), numRemovedItems, InPath.c_str() );
+	}
+
+	CArchive*		archive = GFileSystem->CreateFileWriter( InPath, AW_NoFail );
+	archive->SetType( AT_ShaderCache );
+	archive->SerializeHeader();
+	Serialize( *archive );
+	delete archive;
+}
+
+/**
+ * Add to cache compiled shader
+ */
+void CShaderCache::Add( const SShaderCacheItem& InShaderCacheItem )
+{
+	std::unordered_map< std::wstring, uint32 >&		shaderMap	= itemsMap[ InShaderCacheItem.vertexFactoryHash ];
+	auto											itShader	= shaderMap.find( InShaderCacheItem.name );
+	uint32											index		= ( uint32 )items.size();
+	if ( itShader != shaderMap.end() )
+	{
+		index			= itShader->second;
+		items[ index ]	= InShaderCacheItem;
+	}
+	else
+	{
+		shaderMap.insert( std::make_pair( InShaderCacheItem.name, index ) );
+		items.push_back( InShaderCacheItem );
+	}
+
+	// Mapped file of other cache can be closed, so we copy byte code
+	SShaderCacheItem&		item = items[ index ];
+	if ( item.mappedCode )
+	{
+		item.code.SetElements( item.mappedCode, item.mappedCodeSize );
+		item.mappedCode		= nullptr;
+		item.mappedCodeSize	= 0;
+	}
+}
+
+/**
+ * Remove items which shader type or vertex factory is no longer registered
+ */
+uint32 CShaderCache::RemoveUnregisteredItems()
+{
+	CVertexFactoryMetaType::SContainerVertexFactoryMetaType*		vertexFactoryTypes	= CVertexFactoryMetaType::SContainerVertexFactoryMetaType::Get();
+	std::vector< SShaderCacheItem >									keptItems;
+	keptItems.reserve( items.size() );
+	for ( uint32 indexItem = 0, countItems = ( uint32 )items.size(); indexItem < countItems; ++indexItem )
+	{
+		const SShaderCacheItem&		item = items[ indexItem ];
+		if ( CShaderManager::FindShaderType( item.name ) && ( item.vertexFactoryHash == ( uint64 )INVALID_HASH || vertexFactoryTypes->FindRegisteredType( item.vertexFactoryHash ) ) )
+		{
+			keptItems.push_back( item );
+		}
+	}
+
+	uint32		numRemovedItems = ( uint32 )( items.size() - keptItems.size() );
+	if ( numRemovedItems == 0 )
+	{
+		return 0;
+	}
+
+	// Indices of items are changed, so map is rebuilt
+	items.swap( keptItems );
+	itemsMap.clear();
+	for ( uint32 indexItem = 0, countItems = ( uint32 )items.size(); indexItem < countItems; ++indexItem )
+	{
+		itemsMap[ items[ indexItem ].vertexFactoryHash ].insert( std::make_pair( items[ indexItem ].name, indexItem ) );
+	}
+	return numRemovedItems;
+}
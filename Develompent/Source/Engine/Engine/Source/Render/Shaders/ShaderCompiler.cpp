@@ -1,11 +1,17 @@
 #include "LEBuild.h"
 
 #if WITH_EDITOR
+#include <algorithm>
+#include <map>
+
 #include "Containers/String.h"
+#include "Containers/StringConv.h"
 #include "Logger/LoggerMacros.h"
 #include "Misc/CoreGlobals.h"
 #include "Misc/EngineGlobals.h"
 #include "System/BaseFileSystem.h"
+#include "System/Config.h"
+#include "System/ThreadPool.h"
 #include "System/SplashScreen.h"
 #include "RHI/BaseRHI.h"
 #include "Render/Shaders/ShaderCompiler.h"
@@ -17,34 +23,87 @@
  */
 bool CShaderCompiler::CompileAll( const tchar* InOutputCache, EShaderPlatform InShaderPlatform, bool InOnlyGlobals /* = false */ )
 {
-	CShaderCache	shaderCache;
-	bool			result = CompileAll( shaderCache, InShaderPlatform, InOnlyGlobals );
-	if ( !result )
+	// Shader cache from previous compile we update, so shaders which inputs not changed will not be recompiled
+	CShaderCache						shaderCache;
+	bool								bCacheExist = shaderCache.Load( InOutputCache );
+	std::vector<SShaderCompileJob>		jobs;
+	GatherOutdatedJobs( shaderCache, InShaderPlatform, InOnlyGlobals, jobs );
+	if ( bCacheExist && jobs.empty() )
 	{
-		return false;
+		return true;
 	}
 
+	std::wstring		errorMsg;
+	appSetSplashText( STT_StartupProgress, CString::Format( TEXT( "Compiling %i shaders..." ), jobs.size() ).c_str() );
+	bool				result = CompileShaders( jobs, InShaderPlatform, shaderCache, errorMsg );
+	checkMsg( result, errorMsg.c_str() );
+
 	// Save shader cache
-	CArchive*			archive = GFileSystem->CreateFileWriter( InOutputCache, AW_NoFail );
-	if ( archive )
+	shaderCache.Save( InOutputCache );
+	return true;
+}
+
+bool CShaderCompiler::CompileAll( CShaderCache& InOutShaderCache, EShaderPlatform InShaderPlatform, bool InOnlyGlobals /* = false */ )
+{
+	std::vector<SShaderCompileJob>		jobs;
+	GatherOutdatedJobs( InOutShaderCache, InShaderPlatform, InOnlyGlobals, jobs );
+	if ( jobs.empty() )
 	{
-		archive->SetType( AT_ShaderCache );
+		return true;
+	}
 
-		archive->SerializeHeader();
-		shaderCache.Serialize( *archive );
-		delete archive;
+	std::wstring		errorMsg;
+	appSetSplashText( STT_StartupProgress, CString::Format( TEXT( "Compiling %i shaders..." ), jobs.size() ).c_str() );
+	bool				result = CompileShaders( jobs, InShaderPlatform, InOutShaderCache, errorMsg );
+	if ( !result )
+	{
+		LE_LOG( LT_Error, LC_Shader, TEXT( "%s" ), errorMsg.c_str() );
 	}
-	
-	return true;
+	return result;
 }
 
-bool CShaderCompiler::CompileAll( CShaderCache& InOutShaderCache, EShaderPlatform InShaderPlatform, bool InOnlyGlobals /* = false */ )
+/**
+ * Recompile items of shader cache which compile inputs changed
+ */
+bool CShaderCompiler::UpdateCache( CShaderCache& InOutShaderCache, EShaderPlatform InShaderPlatform, std::wstring& OutErrorMsg )
+{
+	const std::unordered_map< std::wstring, CShaderMetaType* >&		shaderTypes = CShaderManager::SContainerShaderTypes::Get()->shaderMetaTypes;
+	const std::vector< CShaderCache::SShaderCacheItem >&			items		= InOutShaderCache.GetItems();
+	std::vector<SShaderCompileJob>									jobs;
+	for ( uint32 index = 0, count = ( uint32 )items.size(); index < count; ++index )
+	{
+		const CShaderCache::SShaderCacheItem&		item				= items[ index ];
+		auto										itShaderType		= shaderTypes.find( item.name );
+		CVertexFactoryMetaType*						vertexFactoryType	= CVertexFactoryMetaType::SContainerVertexFactoryMetaType::Get()->FindRegisteredType( item.vertexFactoryHash );
+		if ( itShaderType == shaderTypes.end() || !vertexFactoryType )
+		{
+			continue;
+		}
+
+		SShaderCompileJob		job( itShaderType->second, vertexFactoryType );
+		job.sourceHash			= CalcSourceHash( job.shaderMetaType, InShaderPlatform, job.vertexFactoryType );
+		if ( job.sourceHash != item.sourceHash )
+		{
+			jobs.push_back( job );
+		}
+	}
+
+	LE_LOG( LT_Log, LC_Shader, TEXT( "%u of %u shaders in cache are outdated" ), ( uint32 )jobs.size(), ( uint32 )items.size() );
+	OutErrorMsg = TEXT( "" );
+	return jobs.empty() || CompileShaders( jobs, InShaderPlatform, InOutShaderCache, OutErrorMsg );
+}
+
+/**
+ * Gather jobs of all shaders which not in cache or outdated
+ */
+void CShaderCompiler::GatherOutdatedJobs( const CShaderCache& InShaderCache, EShaderPlatform InShaderPlatform, bool InOnlyGlobals, std::vector<SShaderCompileJob>& OutJobs )
 {
-	std::wstring																			errorMsg;
 	const std::unordered_map< std::wstring, CShaderMetaType* >&								shaderTypes = CShaderManager::SContainerShaderTypes::Get()->shaderMetaTypes;
 	const CVertexFactoryMetaType::SContainerVertexFactoryMetaType::VertexFactoryMap_t&		vertexFactoryTypes = CVertexFactoryMetaType::SContainerVertexFactoryMetaType::Get()->GetRegisteredTypes();
 	checkMsg( !vertexFactoryTypes.empty(), TEXT( "In engine not a single vertex factory registered" ) );
 	
+	// Gather all permutations of shaders for each vertex factory
+	uint32		numShaders = 0;
 	for ( auto itShader = shaderTypes.begin(), itShaderEnd = shaderTypes.end(); itShader != itShaderEnd; ++itShader )
 	{
 		CShaderMetaType*					metaType = itShader->second;
@@ -52,9 +111,7 @@ bool CShaderCompiler::CompileAll( CShaderCache& InOutShaderCache, EShaderPlatfor
 		{
 			continue;
 		}
-		const std::wstring&					shaderName = metaType->GetName();
 
-		// Compile shader for each vertex factory
 		for ( auto itVFType = vertexFactoryTypes.begin(), itVFTypeEnd = vertexFactoryTypes.end(); itVFType != itVFTypeEnd; ++itVFType )
 		{
 			CVertexFactoryMetaType*			vertexFactoryType = itVFType->second;
@@ -63,58 +120,266 @@ bool CShaderCompiler::CompileAll( CShaderCache& InOutShaderCache, EShaderPlatfor
 				continue;
 			}
 
-			appSetSplashText( STT_StartupProgress, CString::Format( TEXT( "Compiling shader %s for %s..." ), shaderName.c_str(), vertexFactoryType->GetName().c_str() ).c_str() );
-			bool		result = CompileShader( metaType, InShaderPlatform, InOutShaderCache, errorMsg, vertexFactoryType );
-			checkMsg( result, errorMsg.c_str() );
+			SShaderCompileJob		job( metaType, vertexFactoryType );
+			job.sourceHash			= CalcSourceHash( metaType, InShaderPlatform, vertexFactoryType );
+			++numShaders;
+			if ( !InShaderCache.IsUpToDate( metaType->GetName(), vertexFactoryType->GetHash(), job.sourceHash ) )
+			{
+				OutJobs.push_back( job );
+			}
 		}
 	}
 
-	return true;
+	// Order of types in maps is not defined, so we sort jobs for getting same shader cache at every build
+	std::sort( OutJobs.begin(), OutJobs.end(), []( const SShaderCompileJob& InA, const SShaderCompileJob& InB )
+			   {
+				   if ( InA.shaderMetaType != InB.shaderMetaType )
+				   {
+					   return InA.shaderMetaType->GetName() < InB.shaderMetaType->GetName();
+				   }
+				   return InA.vertexFactoryType->GetName() < InB.vertexFactoryType->GetName();
+			   } );
+
+	LE_LOG( LT_Log, LC_Shader, TEXT( "%u of %u shaders are up to date in cache" ), numShaders - ( uint32 )OutJobs.size(), numShaders );
 }
 
-bool CShaderCompiler::CompileShader( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg, class CVertexFactoryMetaType* InVertexFactoryType /* = nullptr */ )
+/**
+ * Calculate hash of compile inputs of shader
+ */
+uint64 CShaderCompiler::CalcSourceHash( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CVertexFactoryMetaType* InVertexFactoryType /* = nullptr */ )
 {
-	SShaderCompilerOutput			output;
-	uint64							vertexFactoryHash = ( uint64 )INVALID_HASH;
-	EShaderFrequency				shaderFrequency = InShaderMetaType->GetFrequency();
-	
-	SShaderCompilerEnvironment		environment( shaderFrequency );
-	InShaderMetaType->ModifyCompilationEnvironment( InShaderPlatform, environment );
+	SShaderCompilerEnvironment		environment( InShaderMetaType->GetFrequency() );
+	SetupEnvironment( InShaderMetaType, InShaderPlatform, InVertexFactoryType, environment );
 
-	if ( InVertexFactoryType )
+	EShaderFrequency				frequency	= InShaderMetaType->GetFrequency();
+	uint64							hash		= appMemFastHash( &InShaderPlatform, sizeof( InShaderPlatform ) );
+	hash	= appMemFastHash( &frequency, sizeof( frequency ), hash );
+	hash	= appCalcHash( InShaderMetaType->GetFunctionName(), hash );
+	hash	= appCalcHash( environment.vertexFactoryFileName, hash );
+
+	// Order of elements in unordered maps is not defined, so we sort them
+	std::map< std::wstring, std::wstring >		difinitions( environment.difinitions.begin(), environment.difinitions.end() );
+	for ( auto it = difinitions.begin(), itEnd = difinitions.end(); it != itEnd; ++it )
+	{
+		hash	= appCalcHash( it->first, hash );
+		hash	= appCalcHash( it->second, hash );
+	}
+
+	std::map< std::wstring, std::wstring >		includeFiles( environment.includeFiles.begin(), environment.includeFiles.end() );
+	for ( auto it = includeFiles.begin(), itEnd = includeFiles.end(); it != itEnd; ++it )
+	{
+		hash	= appCalcHash( it->first, hash );
+		hash	= appCalcHash( it->second, hash );
+	}
+
+	for ( uint32 index = 0, count = environment.compilerFlags.size(); index < count; ++index )
+	{
+		hash	= appMemFastHash( &environment.compilerFlags[ index ], sizeof( ECompilerFlags ), hash );
+	}
+
+	std::unordered_set< std::wstring >		visitedFiles;
+	return HashShaderFile( InShaderMetaType->GetFileName(), environment.vertexFactoryFileName, hash, visitedFiles );
+}
+
+/**
+ * Get info about shader file
+ */
+const CShaderCompiler::SShaderFileInfo& CShaderCompiler::GetShaderFileInfo( const std::wstring& InPath )
+{
+	auto		itFile = shaderFiles.find( InPath );
+	if ( itFile != shaderFiles.end() )
 	{
-		environment.vertexFactoryFileName = InVertexFactoryType->GetFileName();
-		vertexFactoryHash = InVertexFactoryType->GetHash();
-		InVertexFactoryType->ModifyCompilationEnvironment( InShaderPlatform, environment );
+		return itFile->second;
 	}
 
-	bool		result = GRHI->CompileShader( InShaderMetaType->GetFileName().c_str(), InShaderMetaType->GetFunctionName().c_str(), shaderFrequency, environment, output, GAllowDebugShaderDump );
-	if ( result )
+	SShaderFileInfo&	fileInfo = shaderFiles[ InPath ];
+	fileInfo.hash		= 0;
+
+	CArchive*			archive = GFileSystem->CreateFileReader( InPath );
+	if ( !archive )
 	{
-		CShaderCache::SShaderCacheItem			shaderCacheItem;
-		shaderCacheItem.name = InShaderMetaType->GetName();
-		shaderCacheItem.frequency = shaderFrequency;
-		shaderCacheItem.vertexFactoryHash = vertexFactoryHash;
-		shaderCacheItem.code = output.code;
-		shaderCacheItem.numInstructions = output.numInstructions;
-		shaderCacheItem.parameterMap = output.parameterMap;
-		OutErrorMsg = TEXT( "" );
+		LE_LOG( LT_Warning, LC_Shader, TEXT( "Not found shader file '%s'" ), InPath.c_str() );
+		return fileInfo;
+	}
 
-		// Validate compiled shader
-		CShader*		shader = InShaderMetaType->CreateCompiledInstance();
-		shader->Init( shaderCacheItem );
-		delete shader;
+	std::string			source( archive->GetSize(), '\0' );
+	archive->Serialize( ( byte* )source.data(), source.size() );
+	delete archive;
+	fileInfo.hash		= appMemFastHash( source.data(), source.size() );
 
-		// Add shader to cache
-		InOutShaderCache.Add( shaderCacheItem );
-		LE_LOG( LT_Log, LC_Shader, TEXT( "Shader %s for %s compiled" ), InShaderMetaType->GetName().c_str(), InVertexFactoryType->GetName().c_str() );
+	// Find all included files. Includes in comments or disabled blocks are found too, it only can lead to extra recompile
+	for ( std::size_t posInclude = source.find( "#include" ); posInclude != std::string::npos; posInclude = source.find( "#include", posInclude + 1 ) )
+	{
+		std::size_t		posStart = source.find_first_of( "\"<\n", posInclude + 8 );
+		if ( posStart == std::string::npos || source[ posStart ] == '\n' )
+		{
+			continue;
+		}
+
+		std::size_t		posEnd = source.find_first_of( "\">\n", posStart + 1 );
+		if ( posEnd == std::string::npos || source[ posEnd ] == '\n' )
+		{
+			continue;
+		}
+
+		fileInfo.includes.push_back( ANSI_TO_TCHAR( source.substr( posStart + 1, posEnd - posStart - 1 ).c_str() ) );
+	}
+
+	return fileInfo;
+}
+
+/**
+ * Calculate hash of shader file with all included files
+ */
+uint64 CShaderCompiler::HashShaderFile( const std::wstring& InPath, const std::wstring& InVertexFactoryFileName, uint64 InHash, std::unordered_set< std::wstring >& InOutVisitedFiles )
+{
+	if ( !InOutVisitedFiles.insert( InPath ).second )
+	{
+		return InHash;
+	}
+
+	// Copy of info is needed, because recursive calls can rehash map of shader files
+	SShaderFileInfo		fileInfo = GetShaderFileInfo( InPath );
+	InHash				= appCalcHash( InPath, InHash );
+	InHash				= appMemFastHash( &fileInfo.hash, sizeof( uint64 ), InHash );
+	for ( uint32 index = 0, count = fileInfo.includes.size(); index < count; ++index )
+	{
+		// Includes are resolved same as in RHI: 'VertexFactory.hlsl' is file of vertex factory, other files are searched in root shader dir
+		const std::wstring&		include = fileInfo.includes[ index ];
+		if ( include == TEXT( "VertexFactory.hlsl" ) )
+		{
+			InHash = HashShaderFile( appShaderDir() + TEXT( "VertexFactory/" ) + InVertexFactoryFileName, InVertexFactoryFileName, InHash, InOutVisitedFiles );
+		}
+		else
+		{
+			InHash = HashShaderFile( appShaderDir() + include, InVertexFactoryFileName, InHash, InOutVisitedFiles );
+		}
+	}
+
+	return InHash;
+}
+
+bool CShaderCompiler::CompileShader( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg, class CVertexFactoryMetaType* InVertexFactoryType /* = nullptr */ )
+{
+	std::vector<SShaderCompileJob>		jobs( 1, SShaderCompileJob( InShaderMetaType, InVertexFactoryType ) );
+	return CompileShaders( jobs, InShaderPlatform, InOutShaderCache, OutErrorMsg );
+}
+
+bool CShaderCompiler::CompileShaders( std::vector<SShaderCompileJob>& InOutJobs, EShaderPlatform InShaderPlatform, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg )
+{
+	// Hash of inputs and environments calculate before compiling, because cache of shader files is not thread safe
+	// and meta types of shaders and vertex factories can touch global state (e.g. names) while modifying environment
+	std::vector<SShaderCompilerEnvironment>		environments;
+	environments.reserve( InOutJobs.size() );
+	for ( uint32 index = 0, count = InOutJobs.size(); index < count; ++index )
+	{
+		SShaderCompileJob&		job = InOutJobs[ index ];
+		if ( !job.sourceHash )
+		{
+			job.sourceHash = CalcSourceHash( job.shaderMetaType, InShaderPlatform, job.vertexFactoryType );
+		}
+
+		environments.push_back( SShaderCompilerEnvironment( job.shaderMetaType->GetFrequency() ) );
+		SetupEnvironment( job.shaderMetaType, InShaderPlatform, job.vertexFactoryType, environments.back() );
+	}
+
+	// Compile all jobs, every job writes only to self, so they can be compiled concurrently
+	CConfigValue		configParallelCompile = GConfig.GetValue( CT_Editor, TEXT( "Editor.Editor" ), TEXT( "ParallelShaderCompile" ) );
+	if ( InOutJobs.size() > 1 && ( !configParallelCompile.IsValid() || configParallelCompile.GetBool() ) )
+	{
+		appParallelFor( InOutJobs.size(), [&]( uint32 InIndex )
+						{
+							CompileJob( InOutJobs[ InIndex ], environments[ InIndex ] );
+						} );
 	}
 	else
 	{
-		OutErrorMsg = output.errorMsg;
-		LE_LOG( LT_Error, LC_Shader, TEXT( "Failed compiling shader %s for %s" ), InShaderMetaType->GetName().c_str(), InVertexFactoryType->GetName().c_str() );
+		for ( uint32 index = 0, count = InOutJobs.size(); index < count; ++index )
+		{
+			CompileJob( InOutJobs[ index ], environments[ index ] );
+		}
 	}
 
-	return result;
+	// Report results, validate and add to cache compiled shaders in order of jobs on calling thread
+	bool		bResult = true;
+	OutErrorMsg = TEXT( "" );
+	for ( uint32 index = 0, count = InOutJobs.size(); index < count; ++index )
+	{
+		const SShaderCompileJob&		job					= InOutJobs[ index ];
+		const tchar*					vertexFactoryName	= job.vertexFactoryType ? job.vertexFactoryType->GetName().c_str() : TEXT( "none" );
+		for ( uint32 warningIndex = 0, numWarnings = job.output.warnings.size(); warningIndex < numWarnings; ++warningIndex )
+		{
+			LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader %s for %s: %s" ), job.shaderMetaType->GetName().c_str(), vertexFactoryName, job.output.warnings[ warningIndex ].c_str() );
+		}
+
+		if ( !job.bSucceed )
+		{
+			LE_LOG( LT_Error, LC_Shader, TEXT( "Failed compiling shader %s for %s: %s" ), job.shaderMetaType->GetName().c_str(), vertexFactoryName, job.output.errorMsg.c_str() );
+			if ( bResult )
+			{
+				OutErrorMsg = job.output.errorMsg;
+			}
+			bResult = false;
+			continue;
+		}
+
+		LE_LOG( LT_Log, LC_Shader, TEXT( "Shader %s for %s compiled" ), job.shaderMetaType->GetName().c_str(), vertexFactoryName );
+
+		std::wstring		errorMsg;
+		if ( !AddToCache( job, InOutShaderCache, errorMsg ) )
+		{
+			if ( bResult )
+			{
+				OutErrorMsg = errorMsg;
+			}
+			bResult = false;
+		}
+	}
+
+	return bResult;
+}
+
+void CShaderCompiler::SetupEnvironment( class CShaderMetaType* InShaderMetaType, EShaderPlatform InShaderPlatform, class CVertexFactoryMetaType* InVertexFactoryType, SShaderCompilerEnvironment& OutEnvironment )
+{
+	InShaderMetaType->ModifyCompilationEnvironment( InShaderPlatform, OutEnvironment );
+	if ( InVertexFactoryType )
+	{
+		OutEnvironment.vertexFactoryFileName = InVertexFactoryType->GetFileName();
+		InVertexFactoryType->ModifyCompilationEnvironment( InShaderPlatform, OutEnvironment );
+	}
+}
+
+void CShaderCompiler::CompileJob( SShaderCompileJob& InOutJob, const SShaderCompilerEnvironment& InEnvironment )
+{
+	CShaderMetaType*		shaderMetaType = InOutJob.shaderMetaType;
+	InOutJob.bSucceed		= GRHI->CompileShader( shaderMetaType->GetFileName().c_str(), shaderMetaType->GetFunctionName().c_str(), shaderMetaType->GetFrequency(), InEnvironment, InOutJob.output, GAllowDebugShaderDump );
+}
+
+bool CShaderCompiler::AddToCache( const SShaderCompileJob& InJob, class CShaderCache& InOutShaderCache, std::wstring& OutErrorMsg )
+{
+	CShaderCache::SShaderCacheItem			shaderCacheItem;
+	shaderCacheItem.name = InJob.shaderMetaType->GetName();
+	shaderCacheItem.frequency = InJob.shaderMetaType->GetFrequency();
+	shaderCacheItem.vertexFactoryHash = InJob.vertexFactoryType ? InJob.vertexFactoryType->GetHash() : ( uint64 )INVALID_HASH;
+	shaderCacheItem.code = InJob.output.code;
+	shaderCacheItem.numInstructions = InJob.output.numInstructions;
+	shaderCacheItem.parameterMap = InJob.output.parameterMap;
+	shaderCacheItem.sourceHash = InJob.sourceHash;
+
+	// Validate compiled shader. Non-optional parameters are checked in Init, here we check that shader not skipped any parameter
+	// and layout of bound parameters match reflected constant buffers
+	CShader*		shader = InJob.shaderMetaType->CreateCompiledInstance();
+	shader->Init( shaderCacheItem );
+	bool			bValidLayout = shaderCacheItem.parameterMap.VerifyBindings( CString::Format( TEXT( "%s for %s" ), shaderCacheItem.name.c_str(), InJob.vertexFactoryType ? InJob.vertexFactoryType->GetName().c_str() : TEXT( "none" ) ), OutErrorMsg );
+	delete shader;
+
+	if ( !bValidLayout )
+	{
+		return false;
+	}
+
+	// Add shader to cache
+	InOutShaderCache.Add( shaderCacheItem );
+	return true;
 }
 #endif // WITH_EDITOR
\ No newline at end of file
@@ -5,16 +5,14 @@
 #include "Containers/String.h"
 #include "System/Archive.h"
 #include "System/BaseFileSystem.h"
+#include "System/Config.h"
+#include "System/ThreadPool.h"
 #include "RHI/BaseRHI.h"
 #include "Render/Shaders/Shader.h"
 #include "Render/Shaders/ShaderManager.h"
 #include "Render/VertexFactory/VertexFactory.h"
 #include "Render/Shaders/ShaderCompiler.h"
 
-#if WITH_EDITOR
-#include "System/SplashScreen.h"
-#endif // WITH_EDITOR
-
 CShaderParameter::CShaderParameter()
 	: bufferIndex( 0 )
 	, baseIndex( 0 )
@@ -97,81 +95,248 @@ CShader* CShaderManager::SContainerShaderTypes::CreateShaderInstance( const tcha
 	return itShaderMetaType->second->CreateSerializedInstace();
 }
 
+/**
+ * @ingroup Engine
+ * @brief Work of pre-warm shaders used at previous run
+ */
+class CShaderPrewarmWork : public CQueuedWork
+{
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param InShaders		Shaders for pre-warm. Pairs of shader name and vertex factory hash
+	 */
+	CShaderPrewarmWork( const std::vector< std::pair< std::wstring, uint64 > >& InShaders )
+		: shaders( InShaders )
+		, bCanceled( 0 )
+		, bFinished( 0 )
+	{}
+
+	/**
+	 * Do work
+	 */
+	virtual void DoThreadedWork() override
+	{
+		uint32		numCreatedShaders = 0;
+		for ( uint32 index = 0, count = shaders.size(); index < count && !bCanceled; ++index )
+		{
+			// List is from previous run, so shaders in it can be missed in cache
+			MeshShaderMap_t::iterator		itMeshShaderMap = GShaderManager->shaders.find( shaders[ index ].second );
+			if ( itMeshShaderMap == GShaderManager->shaders.end() )
+			{
+				continue;
+			}
+
+			ShaderMap_t::iterator			itShaderMap = itMeshShaderMap->second.find( shaders[ index ].first );
+			if ( itShaderMap == itMeshShaderMap->second.end() )
+			{
+				continue;
+			}
+
+			CScopeLock		scopeLock( GShaderManager->cs );
+			if ( !itShaderMap->second.shader )
+			{
+				GShaderManager->CreateInstance( itShaderMap->second );
+				++numCreatedShaders;
+			}
+		}
+
+		LE_LOG( LT_Log, LC_Shader, TEXT( "Pre-warmed %i shaders" ), numCreatedShaders );
+		appInterlockedExchange( &bFinished, 1 );
+	}
+
+	/**
+	 * Abandon work
+	 */
+	virtual void Abandon() override
+	{
+		appInterlockedExchange( &bFinished, 1 );
+	}
+
+	/**
+	 * Cancel work
+	 */
+	FORCEINLINE void Cancel()
+	{
+		appInterlockedExchange( &bCanceled, 1 );
+	}
+
+	/**
+	 * Is work finished
+	 * @return Return TRUE if work is finished, else return FALSE
+	 */
+	FORCEINLINE bool IsFinished() const
+	{
+		return bFinished != 0;
+	}
+
+private:
+	typedef CShaderManager::MeshShaderMap_t		MeshShaderMap_t;
+	typedef CShaderManager::ShaderMap_t			ShaderMap_t;
+
+	std::vector< std::pair< std::wstring, uint64 > >		shaders;		/**< Shaders for pre-warm */
+	volatile int32											bCanceled;		/**< Is work canceled */
+	volatile int32											bFinished;		/**< Is work finished */
+};
+
+/**
+ * Constructor of CShaderManager
+ */
+CShaderManager::CShaderManager()
+	: prewarmWork( nullptr )
+{}
+
 /**
  * Loading shader from cache
  */
 bool CShaderManager::LoadShaders( const tchar* InPathShaderCache )
 {
-	CArchive*		archive = GFileSystem->CreateFileReader( InPathShaderCache );
-	if ( !archive )
+	if ( !shaderCache.Map( InPathShaderCache ) )
 	{
 		return false;
 	}
 
-	CShaderCache		shaderCache;
-	archive->SerializeHeader();
-	shaderCache.Serialize( *archive );
-	delete archive;
-
 	uint32														numLoadedShaders = 0;
 	uint32														numLegacyShaders = 0;
-	const std::vector< CShaderCache::SShaderCacheItem >			shaderCacheItems = shaderCache.GetItems();
+	const std::vector< CShaderCache::SShaderCacheItem >&		shaderCacheItems = shaderCache.GetItems();
 	for ( uint32 indexItem = 0, countItems = ( uint32 )shaderCacheItems.size(); indexItem < countItems; ++indexItem )
 	{
 		const CShaderCache::SShaderCacheItem&		item = shaderCacheItems[ indexItem ];
-		CShader*									shader = SContainerShaderTypes::CreateShaderInstance( item.name.c_str() );
-		if ( !shader )
+		if ( !FindShaderType( item.name ) )
 		{
 			LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader %s not loaded, because not found meta type" ), item.name.c_str() );
 			++numLegacyShaders;
 			continue;
 		}
 
-		CVertexFactoryMetaType*			vertexFactoryType = CVertexFactoryMetaType::SContainerVertexFactoryMetaType::Get()->FindRegisteredType( item.vertexFactoryHash );
-
-#if WITH_EDITOR
-		if ( GIsEditor )
+		if ( !CVertexFactoryMetaType::SContainerVertexFactoryMetaType::Get()->FindRegisteredType( item.vertexFactoryHash ) )
 		{
-			appSetSplashText( STT_StartupProgress, CString::Format( TEXT( "Loading shader %s for %s..." ), item.name.c_str(), vertexFactoryType->GetName().c_str() ).c_str() );
-			appSleep( 0.01f );
+			LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader %s for vertex factory with hash 0x%X not loaded, because factory not found" ), item.name.c_str(), item.vertexFactoryHash );
+			continue;
 		}
-#endif // WITH_EDITOR
 
-		shader->Init( item );
+		// RHI shader will be created at first use
+		shaders[ item.vertexFactoryHash ][ item.name ] = SShaderEntry( indexItem );
 		++numLoadedShaders;
-	
-		if ( vertexFactoryType )
-		{
-			LE_LOG( LT_Log, LC_Shader, TEXT( "Shader %s for %s loaded" ), item.name.c_str(), vertexFactoryType->GetName().c_str() );
-			shaders[ item.vertexFactoryHash ][ item.name ] = shader;
-		}
-		else
-		{
-			LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader %s for vertex factory with hash 0x%X not loaded, because factory not found" ), item.name.c_str(), item.vertexFactoryHash );
-		}	
 	}
 
 	LE_LOG( LT_Log, LC_Shader, TEXT( "Loaded %i shaders, %i legacy" ), numLoadedShaders, numLegacyShaders );
 	return true;
 }
 
+/**
+ * Create instance of shader
+ */
+void CShaderManager::CreateInstance( SShaderEntry& InOutEntry )
+{
+	const CShaderCache::SShaderCacheItem&		item	= shaderCache.GetItems()[ InOutEntry.itemIndex ];
+	CShader*									shader	= SContainerShaderTypes::CreateShaderInstance( item.name.c_str() );
+	check( shader );
+
+	// Shader is published only after full initialization, because other threads read it without lock.
+	// Interlocked exchange is full barrier, so initialized shader is visible to them before the pointer
+	shader->Init( item );
+	appInterlockedCompareExchangePointer( ( void** )&InOutEntry.shader, shader, nullptr );
+}
+
 CShader* CShaderManager::FindInstance( const std::wstring& InShaderName, uint64 InVertexFactoryHash )
 {
-	MeshShaderMap_t::const_iterator		itMeshShaderMap = shaders.find( InVertexFactoryHash );
+	MeshShaderMap_t::iterator		itMeshShaderMap = shaders.find( InVertexFactoryHash );
 	if ( itMeshShaderMap == shaders.end() )
 	{
 		LE_LOG( LT_Warning, LC_Shader, TEXT( "For vertex factory hash 0x%X does not exist in the shaders cache" ), InVertexFactoryHash );
 		return nullptr;
 	}
 
-	ShaderMap_t::const_iterator			itShaderMap = itMeshShaderMap->second.find( InShaderName );
+	ShaderMap_t::iterator			itShaderMap = itMeshShaderMap->second.find( InShaderName );
 	if ( itShaderMap == itMeshShaderMap->second.end() )
 	{
 		LE_LOG( LT_Warning, LC_Shader, TEXT( "Shader %s with vertex factory hash 0x%X not found in cache" ), InShaderName.c_str(), InVertexFactoryHash );
 		return nullptr;
 	}
 
-	return itShaderMap->second;
+	// Read of pointer is interlocked, so initialization of shader published by other thread is visible here
+	SShaderEntry&		entry	= itShaderMap->second;
+	CShader*			shader	= ( CShader* )appInterlockedCompareExchangePointer( ( void** )&entry.shader, nullptr, nullptr );
+	if ( !shader )
+	{
+		CScopeLock		scopeLock( cs );
+		if ( !entry.shader )
+		{
+			CreateInstance( entry );
+		}
+		shader = entry.shader;
+	}
+
+	return shader;
+}
+
+/**
+ * Start background pre-warm of shaders used at previous run
+ */
+void CShaderManager::StartPrewarm( const std::wstring& InPathPrewarmList )
+{
+	CArchive*		archive = GFileSystem->CreateFileReader( InPathPrewarmList );
+	if ( !archive )
+	{
+		return;
+	}
+
+	uint32												numShaders = 0;
+	std::vector< std::pair< std::wstring, uint64 > >	prewarmShaders;
+	archive->SerializeHeader();
+	*archive << numShaders;
+	prewarmShaders.resize( numShaders );
+	for ( uint32 index = 0; index < numShaders; ++index )
+	{
+		*archive << prewarmShaders[ index ].first;
+		*archive << prewarmShaders[ index ].second;
+	}
+	delete archive;
+
+	if ( !prewarmShaders.empty() )
+	{
+		prewarmWork = new CShaderPrewarmWork( prewarmShaders );
+		GThreadPool->AddQueuedWork( prewarmWork );
+	}
+}
+
+/**
+ * Save list of created shaders for pre-warm at next run
+ */
+void CShaderManager::SavePrewarmList( const std::wstring& InPathPrewarmList )
+{
+	std::vector< std::pair< std::wstring, uint64 > >	prewarmShaders;
+	for ( auto itMeshShaderMap = shaders.begin(), itMeshShaderMapEnd = shaders.end(); itMeshShaderMap != itMeshShaderMapEnd; ++itMeshShaderMap )
+	{
+		for ( auto itShaderMap = itMeshShaderMap->second.begin(), itShaderMapEnd = itMeshShaderMap->second.end(); itShaderMap != itShaderMapEnd; ++itShaderMap )
+		{
+			if ( itShaderMap->second.shader )
+			{
+				prewarmShaders.push_back( std::make_pair( itShaderMap->first, itMeshShaderMap->first ) );
+			}
+		}
+	}
+
+	GFileSystem->MakeDirectory( CFilename( InPathPrewarmList ).GetPath(), true );
+	CArchive*		archive = GFileSystem->CreateFileWriter( InPathPrewarmList );
+	if ( !archive )
+	{
+		LE_LOG( LT_Warning, LC_Shader, TEXT( "Failed saving list of shaders for pre-warm to '%s'" ), InPathPrewarmList.c_str() );
+		return;
+	}
+
+	uint32		numShaders = prewarmShaders.size();
+	archive->SetType( AT_ShaderCache );
+	archive->SerializeHeader();
+	*archive << numShaders;
+	for ( uint32 index = 0; index < numShaders; ++index )
+	{
+		*archive << prewarmShaders[ index ].first;
+		*archive << prewarmShaders[ index ].second;
+	}
+	delete archive;
 }
 
 std::wstring CShaderManager::GetShaderCacheFilename( EShaderPlatform InShaderPlatform )
@@ -179,6 +344,11 @@ std::wstring CShaderManager::GetShaderCacheFilename( EShaderPlatform InShaderPla
 	return CString::Format( TEXT( "GlobalShaderCache-%s.bin" ), ShaderPlatformToText( InShaderPlatform ) );
 }
 
+std::wstring CShaderManager::GetShaderPrewarmFilename( EShaderPlatform InShaderPlatform )
+{
+	return CString::Format( TEXT( "ShaderPrewarm-%s.bin" ), ShaderPlatformToText( InShaderPlatform ) );
+}
+
 /**
  * Initialize shader manager
  */
@@ -196,34 +366,59 @@ void CShaderManager::Init()
 		pathShaderCache = GCookedDir + PATH_SEPARATOR + GetShaderCacheFilename( GRHI->GetShaderPlatform() );
 	}
 		
+#if WITH_EDITOR
+	// Compile shaders only in cooker or commandlets. Shader cache is updated incrementally,
+	// so only shaders which sources, definitions or vertex factory changed are recompiled
+	if ( GIsCooker || GIsCommandlet || GIsEditor )
+	{
+		CShaderCompiler			shaderCompiler;
+		bool					result = shaderCompiler.CompileAll( pathShaderCache.c_str(), GRHI->GetShaderPlatform() );
+		check( result );
+	}
+#endif // WITH_EDITOR
+
 	if ( !LoadShaders( pathShaderCache.c_str() ) )
 	{
-#if WITH_EDITOR
-		// Compile shaders only in cooker or commandlets
-		if ( GIsCooker || GIsCommandlet || GIsEditor )
-		{
-			CShaderCompiler			shaderCompiler;
-			bool					result = shaderCompiler.CompileAll( pathShaderCache.c_str(), GRHI->GetShaderPlatform() );
-			check( result );
+		appErrorf( TEXT( "Shader cache [%s] not found" ), pathShaderCache.c_str() );
+		return;
+	}
 
-			result = LoadShaders( pathShaderCache.c_str() );
-			if ( !result )
-			{
-				appErrorf( TEXT( "Failed loading shader cache [%s]" ), pathShaderCache.c_str() );
-				return;
-			}
-		}
-		else
-#endif // WITH_EDITOR
+	// Shaders used at previous run of game we create in background, so they will be ready when they are needed
+	if ( !GIsEditor && !GIsCooker && !GIsCommandlet )
+	{
+		// List is saved to user directory, cooked directory can be read only. Cooked copy of list is used until game saved own one
+		CConfigValue		configPrewarmShaders = GConfig.GetValue( CT_Engine, TEXT( "Engine.ShaderManager" ), TEXT( "PrewarmShaders" ) );
+		pathPrewarmList		= appGameDir() + PATH_SEPARATOR + TEXT( "Saved" ) + PATH_SEPARATOR + GetShaderPrewarmFilename( GRHI->GetShaderPlatform() );
+		if ( !configPrewarmShaders.IsValid() || configPrewarmShaders.GetBool() )
 		{
-			appErrorf( TEXT( "Shader cache [%s] not found" ), pathShaderCache.c_str() );
-			return;
+			StartPrewarm( GFileSystem->IsExistFile( pathPrewarmList ) ? pathPrewarmList : GCookedDir + PATH_SEPARATOR + GetShaderPrewarmFilename( GRHI->GetShaderPlatform() ) );
 		}
 	}
 }
 
 void CShaderManager::Shutdown()
 {
+	if ( prewarmWork )
+	{
+		prewarmWork->Cancel();
+		if ( !GThreadPool->RetractQueuedWork( prewarmWork ) )
+		{
+			while ( !prewarmWork->IsFinished() )
+			{
+				appSleep( 0.001f );
+			}
+		}
+
+		delete prewarmWork;
+		prewarmWork = nullptr;
+	}
+
+	if ( !pathPrewarmList.empty() )
+	{
+		SavePrewarmList( pathPrewarmList );
+	}
+
 	shaders.clear();
+	shaderCache = CShaderCache();
 	LE_LOG( LT_Log, LC_Shader, TEXT( "All shaders unloaded" ) );
 }
\ No newline at end of file
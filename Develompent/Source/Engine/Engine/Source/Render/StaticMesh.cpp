@@ -1,6 +1,7 @@
 #include "Containers/String.h"
 #include "Logger/LoggerMacros.h"
 #include "System/Archive.h"
+#include "System/MemoryTracker.h"
 #include "Render/Scene.h"
 #include "Render/StaticMesh.h"
 #include "Render/SceneUtils.h"
@@ -63,6 +64,8 @@ void CStaticMesh::ReleaseRHI()
 
 void CStaticMesh::Serialize( class CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_StaticMesh );
+
 	if ( InArchive.Ver() < VER_StaticMesh )
 	{
 		return;
@@ -98,6 +101,20 @@ void CStaticMesh::Serialize( class CArchive& InArchive )
 	}
 }
 
+uint64 CStaticMesh::GetResidentSize() const
+{
+	// CPU copy of verteces and indeces (in game it is freed after creating RHI buffers)
+	uint64		cpuSize = ( uint64 )verteces.Num() * sizeof( SStaticMeshVertexType ) + ( uint64 )indeces.Num() * sizeof( uint32 );
+
+	// RHI buffers. While they not created yet, they will take the same memory as CPU copy
+	uint64		gpuSize = cpuSize;
+	if ( vertexBufferRHI || indexBufferRHI )
+	{
+		gpuSize = ( vertexBufferRHI ? vertexBufferRHI->GetSize() : 0 ) + ( indexBufferRHI ? indexBufferRHI->GetSize() : 0 );
+	}
+	return CAsset::GetResidentSize() + cpuSize + gpuSize;
+}
+
 void CStaticMesh::SetData( const std::vector<SStaticMeshVertexType>& InVerteces, const std::vector<uint32>& InIndeces, const std::vector<SStaticMeshSurface>& InSurfaces, std::vector< TAssetHandle<CMaterial> >& InMaterials )
 {
 	// Copy new parameters of static mesh
@@ -5,8 +5,10 @@
 #include "System/BaseFileSystem.h"
 #include "Logger/LoggerMacros.h"
 #include "Misc/EngineGlobals.h"
+#include "System/MemoryTracker.h"
 #include "Render/Texture.h"
 #include "Render/RenderUtils.h"
+#include "Render/RenderingThread.h"
 #include "RHI/BaseRHI.h"
 #include "RHI/BaseSurfaceRHI.h"
 
@@ -14,6 +16,7 @@ CTexture2D::CTexture2D()
 	: CAsset( AT_Texture2D )
 	, sizeX( 0 )
 	, sizeY( 0 )
+	, numMips( 1 )
 	, pixelFormat( PF_Unknown )
 	, addressU( SAM_Wrap )
 	, addressV( SAM_Wrap )
@@ -21,14 +24,26 @@ CTexture2D::CTexture2D()
 {}
 
 CTexture2D::~CTexture2D()
-{}
+{
+	if ( streamingInfo.IsStreamed() )
+	{
+		GTextureStreamingManager.RemoveTexture( this );
+
+		// Render commands of streaming hold pointer to this texture, we must wait them before freeing members
+		FlushRenderingCommands();
+	}
+}
 
 void CTexture2D::InitRHI()
 {
 	check( data.Num() > 0 );
-	texture = GRHI->CreateTexture2D( CString::Format( TEXT( "%s" ), GetAssetName().c_str() ).c_str(), sizeX, sizeY, pixelFormat, 1, 0, data.GetData() );
 
-	if ( !GIsEditor && !GIsCommandlet )
+	// For streamed texture in data only resident mips, streamed mips will be loaded by CTextureStreamingManager
+	uint32		firstMip = streamingInfo.firstResidentMip;
+	texture = GRHI->CreateTexture2D( CString::Format( TEXT( "%s" ), GetAssetName().c_str() ).c_str(), Max<uint32>( sizeX >> firstMip, 1 ), Max<uint32>( sizeY >> firstMip, 1 ), pixelFormat, numMips - firstMip, 0, data.GetData() );
+
+	// Resident mips of streamed texture we keep, they are needed for recreating RHI texture with streamed mips
+	if ( !GIsEditor && !GIsCommandlet && !streamingInfo.IsStreamed() )
 	{
 		data.RemoveAllElements();
 	}
@@ -39,11 +54,13 @@ void CTexture2D::ReleaseRHI()
 	texture.SafeRelease();
 }
 
-void CTexture2D::SetData( EPixelFormat InPixelFormat, uint32 InSizeX, uint32 InSizeY, const std::vector<byte>& InData )
+void CTexture2D::SetData( EPixelFormat InPixelFormat, uint32 InSizeX, uint32 InSizeY, const std::vector<byte>& InData, uint32 InNumMips /* = 1 */ )
 {
+	check( InNumMips > 0 && InData.size() == CalcTextureSize( InPixelFormat, InSizeX, InSizeY, InNumMips ) );
 	pixelFormat		= InPixelFormat;
 	sizeX			= InSizeX;
 	sizeY			= InSizeY;
+	numMips			= InNumMips;
 	data			= InData;
 
 	MarkDirty();
@@ -52,8 +69,62 @@ void CTexture2D::SetData( EPixelFormat InPixelFormat, uint32 InSizeX, uint32 InS
 
 void CTexture2D::Serialize( class CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Texture );
+
 	CAsset::Serialize( InArchive );
 
+	// If texture is reloaded, we drop old streaming state
+	if ( InArchive.IsLoading() && streamingInfo.IsStreamed() )
+	{
+		GTextureStreamingManager.RemoveTexture( this );
+		streamingInfo.firstResidentMip	= 0;
+		streamingInfo.firstMip			= 0;
+		streamingInfo.mipOffsets.clear();
+		streamedData.clear();
+	}
+
+	if ( InArchive.Ver() >= VER_TextureStreaming )
+	{
+		InArchive << sizeX;
+		InArchive << sizeY;
+		InArchive << numMips;
+		InArchive << pixelFormat;
+		InArchive << addressU;
+		InArchive << addressV;
+		InArchive << samplerFilter;
+		SerializeMips( InArchive );
+
+		// Streamed texture register in streaming manager
+		if ( InArchive.IsLoading() && streamingInfo.IsStreamed() )
+		{
+			GTextureStreamingManager.AddTexture( this );
+		}
+	}
+	else
+	{
+		SerializeLegacy( InArchive );
+	}
+
+	// If we loading Texture2D - update render resource
+	if ( InArchive.IsLoading() )
+	{
+		BeginUpdateResource( this );
+	}
+}
+
+uint64 CTexture2D::GetResidentSize() const
+{
+	// Resident mips and copy of streamed mips in CPU memory. In game they kept only for streamed texture
+	uint64		size = data.Num() + streamedData.size();
+
+	// Mips of RHI texture, including streamed in ones
+	uint32		firstMip = streamingInfo.firstMip;
+	size		+= CalcTextureSize( pixelFormat, Max<uint32>( sizeX >> firstMip, 1 ), Max<uint32>( sizeY >> firstMip, 1 ), numMips - firstMip );
+	return CAsset::GetResidentSize() + size;
+}
+
+void CTexture2D::SerializeLegacy( class CArchive& InArchive )
+{
 	if ( InArchive.Ver() < VER_RemovedTFC )
 	{
 		std::wstring		textureCachePath;
@@ -77,14 +148,115 @@ void CTexture2D::Serialize( class CArchive& InArchive )
 
 	InArchive << sizeX;
 	InArchive << sizeY;
+	if ( InArchive.Ver() >= VER_TextureMips )
+	{
+		InArchive << numMips;
+	}
+	else
+	{
+		numMips = 1;
+	}
+
 	InArchive << pixelFormat;
 	InArchive << addressU;
 	InArchive << addressV;
 	InArchive << samplerFilter;
+}
 
-	// If we loading Texture2D - update render resource
+void CTexture2D::SerializeMips( class CArchive& InArchive )
+{
+	// Mips above first resident mip not loaded, we only remember where they are in package
+	uint32		firstLoadedMip = 0;
 	if ( InArchive.IsLoading() )
 	{
-		BeginUpdateResource( this );
+		firstLoadedMip					= GTextureStreamingManager.IsEnabled() && !GIsEditor && !GIsCommandlet ? CalcFirstResidentMip() : 0;
+		streamingInfo.packagePath		= InArchive.GetPath();
+		streamingInfo.firstResidentMip	= firstLoadedMip;
+		streamingInfo.firstMip			= firstLoadedMip;
+		streamingInfo.compressionFlags	= data.GetCompressionFlags();
+		data.Resize( CalcTextureSize( pixelFormat, Max<uint32>( sizeX >> firstLoadedMip, 1 ), Max<uint32>( sizeY >> firstLoadedMip, 1 ), numMips - firstLoadedMip ) );
 	}
+	else
+	{
+		checkMsg( !streamingInfo.IsStreamed(), TEXT( "Streamed texture '%s' can't be saved" ), GetAssetName().c_str() );
+	}
+
+	uint32		dataOffset = 0;
+	for ( uint32 mipIndex = 0; mipIndex < numMips; ++mipIndex )
+	{
+		uint32		blockSize	= 0;
+		uint32		blockOffset = InArchive.Tell();
+		InArchive << blockSize;
+
+		if ( mipIndex < firstLoadedMip )
+		{
+			streamingInfo.mipOffsets.push_back( blockOffset + sizeof( blockSize ) );
+			InArchive.Seek( blockOffset + sizeof( blockSize ) + blockSize );
+			continue;
+		}
+
+		uint32		mipSize = CalcTextureMipSize( pixelFormat, sizeX, sizeY, mipIndex );
+		InArchive.SerializeCompressed( data.GetData() + dataOffset, mipSize, data.GetCompressionFlags() );
+		dataOffset += mipSize;
+
+		// Update size of compressed block
+		if ( InArchive.IsSaving() )
+		{
+			uint32		currentOffset = InArchive.Tell();
+			blockSize	= currentOffset - blockOffset - sizeof( blockSize );
+			InArchive.Seek( blockOffset );
+			InArchive << blockSize;
+			InArchive.Seek( currentOffset );
+		}
+	}
+}
+
+uint32 CTexture2D::CalcFirstResidentMip() const
+{
+	uint32		firstResidentMip = 0;
+	while ( firstResidentMip + 1 < numMips && ( Max( sizeX, sizeY ) >> firstResidentMip ) > GTextureStreamingManager.GetResidentMipSize() )
+	{
+		++firstResidentMip;
+	}
+	return firstResidentMip;
+}
+
+void CTexture2D::UpdateStreamedMips( uint32 InFirstMip, std::vector<byte>& InMipsData )
+{
+	check( InFirstMip <= streamingInfo.firstResidentMip );
+	streamingInfo.firstMip = InFirstMip;
+	streamedData.swap( InMipsData );
+	InMipsData.clear();
+	BeginUpdateStreamedRHI();
+}
+
+void CTexture2D::DropStreamedMips( uint32 InFirstMip )
+{
+	check( InFirstMip > streamingInfo.firstMip && InFirstMip < streamingInfo.firstResidentMip );
+
+	// Dropped mips are at begin of CPU copy, kept ones stay as is
+	uint32		droppedSize = CalcTextureSize( pixelFormat, Max<uint32>( sizeX >> streamingInfo.firstMip, 1 ), Max<uint32>( sizeY >> streamingInfo.firstMip, 1 ), InFirstMip - streamingInfo.firstMip );
+	check( droppedSize <= streamedData.size() );
+	streamedData.erase( streamedData.begin(), streamedData.begin() + droppedSize );
+	streamedData.shrink_to_fit();
+	streamingInfo.firstMip = InFirstMip;
+	BeginUpdateStreamedRHI();
+}
+
+void CTexture2D::BeginUpdateStreamedRHI()
+{
+	// Data of all mips we build on game thread, so render command not touch CPU data of texture
+	uint32					firstMip = streamingInfo.firstMip;
+	std::vector<byte>*		mipsData = new std::vector<byte>();
+	mipsData->reserve( streamedData.size() + data.Num() );
+	mipsData->insert( mipsData->end(), streamedData.begin(), streamedData.end() );
+
+	// Resident mips are placed after streamed ones
+	mipsData->insert( mipsData->end(), data.GetData(), data.GetData() + data.Num() );
+
+	UNIQUE_RENDER_COMMAND_THREEPARAMETER( CUpdateStreamedMipsCommand, CTexture2D*, texture2D, this, uint32, firstMip, firstMip, std::vector<byte>*, mipsData, mipsData,
+		{
+			texture2D->texture = GRHI->CreateTexture2D( CString::Format( TEXT( "%s" ), texture2D->GetAssetName().c_str() ).c_str(), Max<uint32>( texture2D->sizeX >> firstMip, 1 ), Max<uint32>( texture2D->sizeY >> firstMip, 1 ), texture2D->pixelFormat, texture2D->numMips - firstMip, 0, mipsData->data() );
+			delete mipsData;
+		} );
 }
\ No newline at end of file
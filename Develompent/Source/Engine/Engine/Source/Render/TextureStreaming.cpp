@@ -0,0 +1,536 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Misc/CoreGlobals.h"
+#include "Misc/Template.h"
+#include "Logger/LoggerMacros.h"
+#include "System/Config.h"
+#include "System/Package.h"
+#include "System/ThreadPool.h"
+#include "System/Stats.h"
+#include "Components/PrimitiveComponent.h"
+#include "Render/Scene.h"
+#include "Render/RenderUtils.h"
+#include "Render/Texture.h"
+#include "Render/TextureStreaming.h"
+
+CTextureStreamingManager		GTextureStreamingManager;
+
+DECLARE_CYCLE_STAT( TEXT( "Texture streaming tick" ), STAT_TextureStreamingTick, SG_Loading );
+DECLARE_CYCLE_STAT( TEXT( "Texture streaming read" ), STAT_TextureStreamingRead, SG_Loading );
+DECLARE_MEMORY_STAT( TEXT( "Texture streaming pool" ), STAT_TextureStreamingPool, SG_Memory );
+
+/**
+ * Request for reading streamed mips of texture from package
+ */
+class CTextureStreamingRequest : public CQueuedWork
+{
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param InTexture		Texture
+	 * @param InFirstMip	First mip to load
+	 * @param InPoolReserve	Size of memory reserved in pool for this request
+	 */
+	CTextureStreamingRequest( CTexture2D* InTexture, uint32 InFirstMip, uint64 InPoolReserve )
+		: texture( InTexture )
+		, firstMip( InFirstMip )
+		, poolReserve( InPoolReserve )
+		, sizeX( InTexture->GetSizeX() )
+		, sizeY( InTexture->GetSizeY() )
+		, pixelFormat( InTexture->GetPixelFormat() )
+		, packagePath( InTexture->GetStreamingInfo().packagePath )
+		, compressionFlags( InTexture->GetStreamingInfo().compressionFlags )
+		, bFinished( 0 )
+		, bFailed( false )
+	{
+		const STextureStreamingInfo&		streamingInfo = InTexture->GetStreamingInfo();
+		mipOffsets.assign( streamingInfo.mipOffsets.begin() + firstMip, streamingInfo.mipOffsets.begin() + streamingInfo.firstResidentMip );
+	}
+
+	/**
+	 * Do work
+	 */
+	virtual void DoThreadedWork() override
+	{
+		SCOPE_CYCLE_COUNTER( STAT_TextureStreamingRead );
+		ReadMips();
+		appInterlockedExchange( &bFinished, 1 );
+	}
+
+	/**
+	 * Abandon work
+	 */
+	virtual void Abandon() override
+	{
+		bFailed = true;
+		appInterlockedExchange( &bFinished, 1 );
+	}
+
+	/**
+	 * Is request finished
+	 * @return Return TRUE if request is finished, else return FALSE
+	 */
+	FORCEINLINE bool IsFinished() const
+	{
+		return bFinished != 0;
+	}
+
+	/**
+	 * Is request failed
+	 * @return Return TRUE if mips not loaded, else return FALSE
+	 */
+	FORCEINLINE bool IsFailed() const
+	{
+		return bFailed;
+	}
+
+	/**
+	 * Abandon texture. After this request not touch the texture and it will be deleted when finished
+	 */
+	FORCEINLINE void AbandonTexture()
+	{
+		texture = nullptr;
+	}
+
+	/**
+	 * Get texture
+	 * @return Return texture, if texture is abandoned return NULL
+	 */
+	FORCEINLINE CTexture2D* GetTexture() const
+	{
+		return texture;
+	}
+
+	/**
+	 * Get first mip
+	 * @return Return first mip of request
+	 */
+	FORCEINLINE uint32 GetFirstMip() const
+	{
+		return firstMip;
+	}
+
+	/**
+	 * Get size of memory reserved in pool
+	 * @return Return size of memory reserved in pool for this request
+	 */
+	FORCEINLINE uint64 GetPoolReserve() const
+	{
+		return poolReserve;
+	}
+
+	/**
+	 * Get data of loaded mips
+	 * @return Return data of mips from first mip to first resident mip
+	 */
+	FORCEINLINE std::vector<byte>& GetMipsData()
+	{
+		return mipsData;
+	}
+
+private:
+	/**
+	 * Read mips from package
+	 */
+	void ReadMips()
+	{
+		CArchive*		archive = GPackageManager->GetFileHandleCache().CreateReader( packagePath );
+		if ( !archive )
+		{
+			bFailed = true;
+			return;
+		}
+
+		// Header of archive contains version of package, it need for decompression
+		archive->SerializeHeader();
+		mipsData.resize( CalcTextureSize( pixelFormat, Max<uint32>( sizeX >> firstMip, 1 ), Max<uint32>( sizeY >> firstMip, 1 ), mipOffsets.size() ) );
+
+		uint32		dataOffset = 0;
+		for ( uint32 index = 0, count = mipOffsets.size(); index < count; ++index )
+		{
+			uint32		mipSize = CalcTextureMipSize( pixelFormat, sizeX, sizeY, firstMip + index );
+			archive->Seek( mipOffsets[ index ] );
+			archive->SerializeCompressed( mipsData.data() + dataOffset, mipSize, compressionFlags );
+			dataOffset += mipSize;
+		}
+
+		delete archive;
+	}
+
+	CTexture2D*				texture;		/**< Texture */
+	uint32					firstMip;		/**< First mip to load */
+	uint64					poolReserve;	/**< Size of memory reserved in pool for this request */
+	uint32					sizeX;			/**< Width of texture */
+	uint32					sizeY;			/**< Height of texture */
+	EPixelFormat			pixelFormat;	/**< Pixel format of texture */
+	std::wstring			packagePath;	/**< Path to package */
+	ECompressionFlags		compressionFlags;	/**< Compression flags of mips */
+	std::vector<uint32>		mipOffsets;		/**< Offsets of mips to load */
+	std::vector<byte>		mipsData;		/**< Data of loaded mips */
+	volatile int32			bFinished;		/**< Is request finished */
+	bool					bFailed;		/**< Is request failed */
+};
+
+/**
+ * Candidate for streaming
+ */
+struct STextureStreamingCandidate
+{
+	CTexture2D*		texture;		/**< Texture */
+	int32			screenSize;		/**< Size on screen in pixels */
+};
+
+/**
+ * Constructor
+ */
+CTextureStreamingManager::CTextureStreamingManager()
+	: bEnabled( false )
+	, residentMipSize( 64 )
+	, poolSize( 0 )
+	, poolUsage( 0 )
+	, maxRequestsInFlight( 4 )
+	, streamOutDelay( 5.f )
+	, mipBias( 0.f )
+{}
+
+/**
+ * Initialize manager
+ */
+void CTextureStreamingManager::Init()
+{
+	// In editor and commandlets textures are always fully loaded, they can be modified and saved
+	bEnabled = !GIsEditor && !GIsCommandlet && GConfig.GetValue( CT_Engine, TEXT( "Engine.TextureStreaming" ), TEXT( "Enable" ) ).GetBool();
+	if ( !bEnabled )
+	{
+		return;
+	}
+
+	CConfigValue		configPoolSize = GConfig.GetValue( CT_Engine, TEXT( "Engine.TextureStreaming" ), TEXT( "PoolSizeMB" ) );
+	if ( configPoolSize.IsA( CConfigValue::T_Int ) )
+	{
+		poolSize = ( uint64 )Max( configPoolSize.GetInt(), 0 ) * 1024 * 1024;
+	}
+
+	CConfigValue		configResidentMipSize = GConfig.GetValue( CT_Engine, TEXT( "Engine.TextureStreaming" ), TEXT( "ResidentMipSize" ) );
+	if ( configResidentMipSize.IsA( CConfigValue::T_Int ) )
+	{
+		residentMipSize = Max( configResidentMipSize.GetInt(), 1 );
+	}
+
+	CConfigValue		configMaxRequestsInFlight = GConfig.GetValue( CT_Engine, TEXT( "Engine.TextureStreaming" ), TEXT( "MaxRequestsInFlight" ) );
+	if ( configMaxRequestsInFlight.IsA( CConfigValue::T_Int ) )
+	{
+		maxRequestsInFlight = Max( configMaxRequestsInFlight.GetInt(), 1 );
+	}
+
+	CConfigValue		configStreamOutDelay = GConfig.GetValue( CT_Engine, TEXT( "Engine.TextureStreaming" ), TEXT( "StreamOutDelay" ) );
+	if ( configStreamOutDelay.IsValid() )
+	{
+		streamOutDelay = Max( configStreamOutDelay.GetNumber(), 0.f );
+	}
+
+	CConfigValue		configMipBias = GConfig.GetValue( CT_Engine, TEXT( "Engine.TextureStreaming" ), TEXT( "MipBias" ) );
+	if ( configMipBias.IsValid() )
+	{
+		mipBias = configMipBias.GetNumber();
+	}
+
+	LE_LOG( LT_Log, LC_Init, TEXT( "Texture streaming: pool %.2f MB, resident mip size %i" ), poolSize / ( 1024.f * 1024.f ), residentMipSize );
+}
+
+/**
+ * Shutdown manager
+ */
+void CTextureStreamingManager::Shutdown()
+{
+	CScopeLock		scopeLock( cs );
+	for ( auto itRequest = requests.begin(), itRequestEnd = requests.end(); itRequest != itRequestEnd; ++itRequest )
+	{
+		CTextureStreamingRequest*		request = *itRequest;
+		if ( !GThreadPool->RetractQueuedWork( request ) )
+		{
+			while ( !request->IsFinished() )
+			{
+				appSleep( 0.001f );
+			}
+		}
+
+		if ( request->GetTexture() )
+		{
+			request->GetTexture()->streamingInfo.request = nullptr;
+		}
+		delete request;
+	}
+
+	requests.clear();
+	textures.clear();
+	poolUsage = 0;
+}
+
+/**
+ * Update streaming
+ */
+void CTextureStreamingManager::Tick()
+{
+	if ( !bEnabled )
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER( STAT_TextureStreamingTick );
+	CScopeLock		scopeLock( cs );
+	ProcessFinishedRequests();
+
+	// Take screen sizes reported by rendering thread.
+	// If texture not rendered at this tick we keep old size, while it is visible not later than streamOutDelay
+	std::vector<STextureStreamingCandidate>		candidates;
+	candidates.reserve( textures.size() );
+	for ( auto itTexture = textures.begin(), itTextureEnd = textures.end(); itTexture != itTextureEnd; ++itTexture )
+	{
+		STextureStreamingInfo&		streamingInfo	= ( *itTexture )->streamingInfo;
+		int32						frameScreenSize = appInterlockedExchange( &streamingInfo.frameScreenSize, 0 );
+		if ( frameScreenSize > 0 )
+		{
+			streamingInfo.screenSize = frameScreenSize;
+		}
+		else if ( GCurrentTime - appInterlockedCompareExchange64( &streamingInfo.lastRenderTimeMS, 0, 0 ) / 1000.0 > streamOutDelay )
+		{
+			streamingInfo.screenSize = 0;
+		}
+
+		candidates.push_back( STextureStreamingCandidate{ *itTexture, streamingInfo.screenSize } );
+	}
+
+	// Textures with bigger size on screen get memory of pool at first
+	std::sort( candidates.begin(), candidates.end(), []( const STextureStreamingCandidate& InA, const STextureStreamingCandidate& InB )
+			   {
+				   return InA.screenSize > InB.screenSize;
+			   } );
+
+	uint64		plannedPoolUsage = 0;
+	for ( uint32 index = 0, count = candidates.size(); index < count; ++index )
+	{
+		CTexture2D*					texture			= candidates[ index ].texture;
+		STextureStreamingInfo&		streamingInfo	= texture->streamingInfo;
+
+		// Drop mips while they not fit in pool
+		uint32		wantedFirstMip = CalcWantedFirstMip( texture );
+		while ( wantedFirstMip < streamingInfo.firstResidentMip && plannedPoolUsage + CalcStreamedSize( texture, wantedFirstMip ) > poolSize )
+		{
+			++wantedFirstMip;
+		}
+		plannedPoolUsage += CalcStreamedSize( texture, wantedFirstMip );
+
+		if ( wantedFirstMip == streamingInfo.firstMip || streamingInfo.request )
+		{
+			continue;
+		}
+
+		// Dropping of mips not need reading anything, smaller texture is built from mips which already in memory
+		uint64		currentSize = CalcStreamedSize( texture, streamingInfo.firstMip );
+		uint64		wantedSize	= CalcStreamedSize( texture, wantedFirstMip );
+		if ( wantedFirstMip > streamingInfo.firstMip )
+		{
+			poolUsage -= currentSize - wantedSize;
+			if ( wantedFirstMip == streamingInfo.firstResidentMip )
+			{
+				std::vector<byte>		emptyData;
+				texture->UpdateStreamedMips( wantedFirstMip, emptyData );
+			}
+			else
+			{
+				texture->DropStreamedMips( wantedFirstMip );
+			}
+			continue;
+		}
+
+		// Growing of texture must fit in pool right now, else we wait while other textures drop their mips
+		uint64		poolReserve = wantedSize - currentSize;
+		if ( requests.size() >= maxRequestsInFlight || poolUsage + poolReserve > poolSize )
+		{
+			continue;
+		}
+
+		CTextureStreamingRequest*		request = new CTextureStreamingRequest( texture, wantedFirstMip, poolReserve );
+		poolUsage				+= poolReserve;
+		streamingInfo.request	= request;
+		requests.push_back( request );
+		GThreadPool->AddQueuedWork( request );
+	}
+
+	SET_MEMORY_STAT( STAT_TextureStreamingPool, poolUsage );
+}
+
+/**
+ * Apply finished requests and delete abandoned ones
+ */
+void CTextureStreamingManager::ProcessFinishedRequests()
+{
+	for ( auto itRequest = requests.begin(); itRequest != requests.end(); )
+	{
+		CTextureStreamingRequest*		request = *itRequest;
+		if ( !request->IsFinished() )
+		{
+			++itRequest;
+			continue;
+		}
+
+		itRequest = requests.erase( itRequest );
+		CTexture2D*		texture = request->GetTexture();
+		if ( texture )
+		{
+			STextureStreamingInfo&		streamingInfo = texture->streamingInfo;
+			streamingInfo.request		= nullptr;
+			poolUsage					-= request->GetPoolReserve();
+
+			// If we failed reading mips, texture stays with resident mips only
+			if ( request->IsFailed() )
+			{
+				LE_LOG( LT_Warning, LC_Package, TEXT( "Failed streaming mips of texture '%s' from '%s'" ), texture->GetAssetName().c_str(), streamingInfo.packagePath.c_str() );
+				poolUsage -= CalcStreamedSize( texture, streamingInfo.firstMip );
+				if ( streamingInfo.firstMip != streamingInfo.firstResidentMip )
+				{
+					std::vector<byte>		emptyData;
+					texture->UpdateStreamedMips( streamingInfo.firstResidentMip, emptyData );
+				}
+				textures.erase( texture );
+			}
+			else
+			{
+				poolUsage -= CalcStreamedSize( texture, streamingInfo.firstMip );
+				poolUsage += CalcStreamedSize( texture, request->GetFirstMip() );
+				texture->UpdateStreamedMips( request->GetFirstMip(), request->GetMipsData() );
+			}
+		}
+
+		delete request;
+	}
+}
+
+/**
+ * Register streamed texture
+ */
+void CTextureStreamingManager::AddTexture( CTexture2D* InTexture )
+{
+	check( InTexture && InTexture->streamingInfo.IsStreamed() );
+	CScopeLock		scopeLock( cs );
+	textures.insert( InTexture );
+}
+
+/**
+ * Unregister streamed texture
+ */
+void CTextureStreamingManager::RemoveTexture( CTexture2D* InTexture )
+{
+	CScopeLock		scopeLock( cs );
+	auto			itTexture = textures.find( InTexture );
+	if ( itTexture == textures.end() )
+	{
+		return;
+	}
+
+	STextureStreamingInfo&		streamingInfo = InTexture->streamingInfo;
+	textures.erase( itTexture );
+	poolUsage -= CalcStreamedSize( InTexture, streamingInfo.firstMip );
+
+	// Request in flight we abandon, if it already started it will be deleted when finished
+	CTextureStreamingRequest*	request = streamingInfo.request;
+	if ( request )
+	{
+		poolUsage -= request->GetPoolReserve();
+		if ( GThreadPool->RetractQueuedWork( request ) )
+		{
+			requests.remove( request );
+			delete request;
+		}
+		else
+		{
+			request->AbandonTexture();
+		}
+		streamingInfo.request = nullptr;
+	}
+}
+
+/**
+ * Update screen size of textures used by primitive
+ */
+void CTextureStreamingManager::UpdatePrimitive( const CSceneView& InSceneView, CPrimitiveComponent* InPrimitive )
+{
+	// Size of primitive on screen we calculate by its bounding sphere
+	const CBox&			boundBox		= InPrimitive->GetBoundBox();
+	Vector				center			= ( boundBox.GetMin() + boundBox.GetMax() ) * 0.5f;
+	float				radius			= SMath::LengthVector( boundBox.GetMax() - center );
+	const Matrix&		projection		= InSceneView.GetProjectionMatrix();
+
+	// In orthographic projection size on screen not depends on distance
+	bool		bOrthographic	= projection[ 3 ][ 3 ] == 1.f;
+	float		distance		= bOrthographic ? 1.f : Max( SMath::DistanceVector( center, InSceneView.GetPosition() ) - radius, 1.f );
+	float		screenSize		= radius * projection[ 1 ][ 1 ] * InSceneView.GetSizeY() / distance;
+	int32		pixels			= ( int32 )Clamp( screenSize, 1.f, 65536.f );
+
+	InPrimitive->GetUsedTextures( usedTextures );
+	for ( uint32 index = 0, count = usedTextures.size(); index < count; ++index )
+	{
+		STextureStreamingInfo&		streamingInfo = usedTextures[ index ]->streamingInfo;
+		if ( !streamingInfo.IsStreamed() )
+		{
+			continue;
+		}
+
+		// Game thread only resets size, so lost update here costs one frame at most
+		if ( pixels > streamingInfo.frameScreenSize )
+		{
+			streamingInfo.frameScreenSize = pixels;
+		}
+		appInterlockedExchange64( &streamingInfo.lastRenderTimeMS, ( int64 )( GCurrentTime * 1000.0 ) );
+	}
+	usedTextures.clear();
+}
+
+/**
+ * Calculate first mip which texture needs for its size on screen
+ */
+uint32 CTextureStreamingManager::CalcWantedFirstMip( CTexture2D* InTexture ) const
+{
+	const STextureStreamingInfo&		streamingInfo = InTexture->streamingInfo;
+	if ( streamingInfo.screenSize <= 0 )
+	{
+		return streamingInfo.firstResidentMip;
+	}
+
+	// We want mip with about one texel per pixel on screen
+	float		wantedMip = log2( ( float )Max( InTexture->sizeX, InTexture->sizeY ) / streamingInfo.screenSize ) + mipBias;
+	return Clamp<int32>( ( int32 )floor( wantedMip ), 0, streamingInfo.firstResidentMip );
+}
+
+/**
+ * Calculate memory size of streamed mips
+ */
+uint32 CTextureStreamingManager::CalcStreamedSize( CTexture2D* InTexture, uint32 InFirstMip )
+{
+	const STextureStreamingInfo&		streamingInfo = InTexture->streamingInfo;
+	check( InFirstMip <= streamingInfo.firstResidentMip );
+	return CalcTextureSize( InTexture->pixelFormat, Max<uint32>( InTexture->sizeX >> InFirstMip, 1 ), Max<uint32>( InTexture->sizeY >> InFirstMip, 1 ), streamingInfo.firstResidentMip - InFirstMip );
+}
+
+/**
+ * Print to log state of texture streaming
+ */
+void CTextureStreamingManager::DumpStreamingInfo()
+{
+	CScopeLock		scopeLock( cs );
+	LE_LOG( LT_Log, LC_General, TEXT( "Texture streaming: %s" ), bEnabled ? TEXT( "enabled" ) : TEXT( "disabled" ) );
+	LE_LOG( LT_Log, LC_General, TEXT( "  Pool: %.2f / %.2f MB" ), poolUsage / ( 1024.f * 1024.f ), poolSize / ( 1024.f * 1024.f ) );
+	LE_LOG( LT_Log, LC_General, TEXT( "  Textures: %u, requests in flight: %u" ), ( uint32 )textures.size(), ( uint32 )requests.size() );
+
+	for ( auto itTexture = textures.begin(), itTextureEnd = textures.end(); itTexture != itTextureEnd; ++itTexture )
+	{
+		CTexture2D*						texture			= *itTexture;
+		const STextureStreamingInfo&	streamingInfo	= texture->streamingInfo;
+		LE_LOG( LT_Log, LC_General, TEXT( "  %s: %ix%i, mip %i (resident %i), on screen %i px, %.2f KB%s" ),
+				texture->GetAssetName().c_str(), texture->sizeX, texture->sizeY, streamingInfo.firstMip, streamingInfo.firstResidentMip, streamingInfo.screenSize,
+				CalcStreamedSize( texture, streamingInfo.firstMip ) / 1024.f, streamingInfo.request ? TEXT( ", streaming" ) : TEXT( "" ) );
+	}
+}
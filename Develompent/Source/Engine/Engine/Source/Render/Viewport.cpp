@@ -6,6 +6,9 @@
 #include "Render/Viewport.h"
 #include "Render/SceneRenderTargets.h"
 #include "Render/Scene.h"
+#include "System/Stats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Present" ), STAT_Present, SG_Scene );
 
 CViewport::CViewport() 
 	: windowHandle( nullptr )
@@ -137,6 +140,7 @@ void CViewport::Draw( bool InIsShouldPresent /* = true */ )
 										ViewportRHIRef_t, viewportRHI, viewportRHI,
 										bool, isShouldPresent, InIsShouldPresent,
 										{
+											SCOPE_CYCLE_COUNTER( STAT_Present );
 											CBaseDeviceContextRHI*		immediateContext = GRHI->GetImmediateContext();
 											GRHI->EndDrawingViewport( immediateContext, viewportRHI, isShouldPresent, false );
 										} );
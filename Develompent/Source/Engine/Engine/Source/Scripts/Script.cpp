@@ -1,4 +1,5 @@
 #include "System/Archive.h"
+#include "System/MemoryTracker.h"
 #include "Misc/Class.h"
 #include "Scripts/Script.h"
 
@@ -7,7 +8,8 @@
  */
 CScript::CScript() : 
 	CAsset( AT_Script ),
-	luaVM( luaL_newstate() )
+	luaVM( luaL_newstate() ),
+	vmMemoryUsage( 0 )
 {
 	check( luaVM );
 
@@ -37,6 +39,8 @@ CScript::~CScript()
  */
 void CScript::Serialize( CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Script );
+
 	if ( InArchive.Type() != AT_TextFile )
 	{
 		CAsset::Serialize( InArchive );
@@ -93,6 +97,24 @@ void CScript::Serialize( CArchive& InArchive )
 	}
 }
 
+/**
+ * Get memory used by loaded asset
+ */
+uint64 CScript::GetResidentSize() const
+{
+	// Lua VM isn't thread-safe, so we take its size cached on the thread which runs the script
+	return CAsset::GetResidentSize() + byteCode.size() + vmMemoryUsage;
+}
+
+/**
+ * Update cached size of memory in use by Lua VM
+ */
+void CScript::UpdateVMMemoryUsage()
+{
+	// LUA_GCCOUNT returns size in KB and LUA_GCCOUNTB returns remainder in bytes
+	vmMemoryUsage = ( uint64 )lua_gc( luaVM, LUA_GCCOUNT, 0 ) * 1024 + lua_gc( luaVM, LUA_GCCOUNTB, 0 );
+}
+
 /**
  * Set byte code
  */
@@ -111,4 +133,5 @@ void CScript::SetByteCode( const byte* InByteCode, uint32 InSize )
 	// Save byte code for serialization
 	byteCode.resize( InSize );
 	memcpy( byteCode.data(), InByteCode, InSize );
+	UpdateVMMemoryUsage();
 }
\ No newline at end of file
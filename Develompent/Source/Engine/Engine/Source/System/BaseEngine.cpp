@@ -16,12 +16,46 @@
 #include "Render/Shaders/BasePassShader.h"
 #include "Render/Shaders/WireframeShader.h"
 #include "Render/RenderingThread.h"
+#include "Render/TextureStreaming.h"
 #include "System/CameraManager.h"
+#include "System/ConsoleSystem.h"
+#include "System/MemoryTracker.h"
+#include "System/Stats.h"
 
 IMPLEMENT_CLASS( CBaseEngine )
 
+//
+// GLOBALS
+//
+CConCmd		CCmdDumpAssetMemory( TEXT( "dumpassetmemory" ), TEXT( "Show memory usage and budgets of assets" ), []( const std::vector<std::wstring>& InArguments ) { GPackageManager->DumpMemoryUsage(); } );
+CConCmd		CCmdDumpAssets( TEXT( "dumpassets" ), TEXT( "Show loaded assets in LRU order" ), []( const std::vector<std::wstring>& InArguments ) { GPackageManager->DumpResidentAssets(); } );
+CConCmd		CCmdEvictAssets( TEXT( "evictassets" ), TEXT( "Unload all not referenced assets" ), []( const std::vector<std::wstring>& InArguments ) { GPackageManager->EvictUnreferencedAssets( true ); } );
+CConCmd		CCmdDumpTextureStreaming( TEXT( "dumptexturestreaming" ), TEXT( "Show state of texture streaming" ), []( const std::vector<std::wstring>& InArguments ) { GTextureStreamingManager.DumpStreamingInfo(); } );
+CConCmd		CCmdMemReport( TEXT( "memreport" ), TEXT( "Show memory by tags and its difference with previous report" ), []( const std::vector<std::wstring>& InArguments ) { CMemoryTracker::Get().DumpSnapshot(); } );
+CConCmd		CCmdMemLeaks( TEXT( "memleaks" ), TEXT( "Show call stacks of allocations which grew since previous call. Usage: memleaks [MaxCallstacks]" ), []( const std::vector<std::wstring>& InArguments )
+{
+	uint32		maxCallstacks = 20;
+	if ( !InArguments.empty() )
+	{
+		tchar*		end		= nullptr;
+		long		value	= wcstol( InArguments[0].c_str(), &end, 10 );
+		if ( end == InArguments[0].c_str() || *end || value <= 0 )
+		{
+			LE_LOG( LT_Warning, LC_General, TEXT( "Invalid number of call stacks '%s'. Usage: memleaks [MaxCallstacks]" ), InArguments[0].c_str() );
+			return;
+		}
+		maxCallstacks = ( uint32 )value;
+	}
+	CMemoryTracker::Get().DumpLeaks( maxCallstacks );
+} );
+CConCmd		CCmdStat( TEXT( "stat" ), TEXT( "Toggle showing of stats. Usage: stat unit|engine|scene|audio|physics|loading|memory|none" ), []( const std::vector<std::wstring>& InArguments ) { GStats.ExecCommand( InArguments ); } );
+CConCmd		CCmdTraceCapture( TEXT( "tracecapture" ), TEXT( "Capture events of all threads to Chrome Trace Event JSON in Profiling directory. Usage: tracecapture <NumFrames>|<Seconds>s|stop" ), []( const std::vector<std::wstring>& InArguments ) { GStats.ExecTraceCommand( InArguments ); } );
+
 void CBaseEngine::Init()
 {
+	// Texture streaming must be initialized before loading any texture
+	GTextureStreamingManager.Init();
+
 	// Load default texture
 	{	
 		// Loading default texture from packages only when we in game
@@ -152,6 +186,7 @@ void CBaseEngine::Shutdown()
 	// Wait while render thread is rendering of the frame
 	FlushRenderingCommands();
 
+	GTextureStreamingManager.Shutdown();
 	GWorld->CleanupWorld();
 	GUIEngine->Shutdown();
 	GPhysicsEngine.Shutdown();
@@ -161,6 +196,7 @@ void CBaseEngine::Tick( float InDeltaSeconds )
 {
 	GUIEngine->Tick( InDeltaSeconds );
 	GPhysicsEngine.Tick( InDeltaSeconds );
+	GTextureStreamingManager.Tick();
 }
 
 void CBaseEngine::ProcessEvent( struct SWindowEvent& InWindowEvent )
@@ -172,13 +208,9 @@ void CBaseEngine::ProcessEvent( struct SWindowEvent& InWindowEvent )
 
 float CBaseEngine::GetMaxTickRate() const
 {
-	CConfigValue		configMaxTickRate = GConfig.GetValue( CT_Engine, TEXT( "Engine.Engine" ), TEXT( "MaxTickRate" ) );
-	if ( configMaxTickRate.IsValid() )
-	{
-		return configMaxTickRate.GetNumber();
-	}
-
-	return 0.f;
+	// Called every frame, so value is cached in handle
+	static TConfigHandle<float>		configMaxTickRate( CT_Engine, TEXT( "Engine.Engine" ), TEXT( "MaxTickRate" ), 0.f );
+	return configMaxTickRate.Get();
 }
 
 bool CBaseEngine::LoadMap( const std::wstring& InMap, std::wstring& OutError )
@@ -2,6 +2,8 @@
 #include "Misc/EngineGlobals.h"
 #include "Misc/PhysicsGlobals.h"
 #include "System/CameraManager.h"
+#include "System/MemoryTracker.h"
+#include "System/Stats.h"
 #include "System/Package.h"
 #include "PhysicsInterface.h"
 #include "Actors/Actor.h"
@@ -13,6 +15,8 @@
 #include "WorldEd.h"
 #endif // WITH_EDITOR
 
+DECLARE_CYCLE_STAT( TEXT( "World tick" ), STAT_WorldTick, SG_Engine );
+
 CWorld::CWorld() 
 	: isBeginPlay( false )
 	, scene( new CScene() )
@@ -73,6 +77,8 @@ void CWorld::EndPlay()
 
 void CWorld::Tick( float InDeltaTime )
 {
+	SCOPE_CYCLE_COUNTER( STAT_WorldTick );
+
 	// Tick all actors
 	for ( uint32 index = 0, count = ( uint32 )actors.size(); index < count; ++index )
 	{
@@ -185,6 +191,8 @@ void CWorld::CleanupWorld()
 
 ActorRef_t CWorld::SpawnActor( class CClass* InClass, const Vector& InLocation, const Quaternion& InRotation /* = SMath::quaternionZero */ )
 {
+	SCOPED_MEMORY_TAG( MT_Objects );
+
 	check( InClass );
 
 	AActor*		actor = InClass->CreateObject< AActor >();
@@ -10,6 +10,7 @@
 #include "System/BaseWindow.h"
 #include "System/Config.h"
 #include "System/ThreadingBase.h"
+#include "System/ThreadPool.h"
 #include "System/InputSystem.h"
 #include "System/Package.h"
 #include "System/AudioEngine.h"
@@ -33,6 +34,7 @@
 #include "System/BaseEngine.h"
 #include "System/FullScreenMovie.h"
 #include "System/Name.h"
+#include "System/Stats.h"
 #include "LEBuild.h"
 
 #if USE_THEORA_CODEC
@@ -46,6 +48,8 @@
 #include "Misc/WorldEdGlobals.h"
 #endif // WITH_EDITOR
 
+DECLARE_CYCLE_STAT( TEXT( "Game thread" ), STAT_GameThread, SG_Engine );
+
 /**
  *	Returns the path to the cooked data for the given platform
  *
@@ -154,6 +158,7 @@ void CEngineLoop::InitConfigs()
 int32 CEngineLoop::PreInit( const tchar* InCmdLine )
 {
 	GGameThreadId = appGetCurrentThreadId();
+	GStats.SetThreadName( TEXT( "GameThread" ) );
 	GGameName = ANSI_TO_TCHAR( GAMENAME );
 	appGetCookedContentPath( GPlatform, GCookedDir );
 	
@@ -176,6 +181,17 @@ int32 CEngineLoop::PreInit( const tchar* InCmdLine )
 
 	GLog->Init();
 	int32		result = appPlatformPreInit();
+
+	// Create thread pool. If number of worker threads not set in config, we use one thread per core except game thread
+	{
+		CConfigValue	configNumWorkerThreads	= GConfig.GetValue( CT_Engine, TEXT( "Engine.Engine" ), TEXT( "NumWorkerThreads" ) );
+		uint32			numWorkerThreads		= configNumWorkerThreads.IsA( CConfigValue::T_Int ) ? Max( configNumWorkerThreads.GetInt(), 0 ) : 0;
+		if ( numWorkerThreads == 0 )
+		{
+			numWorkerThreads = Max<uint32>( appNumberOfCores() - 1, 1 );
+		}
+		GThreadPool->Create( numWorkerThreads );
+	}
 	
 	// Loading table of contents
 	if ( !GIsEditor && !GIsCooker )
@@ -191,13 +207,7 @@ int32 CEngineLoop::PreInit( const tchar* InCmdLine )
 		}
 #endif // WITH_EDITOR
 		
-		CArchive*		archiveTOC	= GFileSystem->CreateFileReader( tocPath );
-		if ( archiveTOC )
-		{
-			GTableOfContents.Serialize( *archiveTOC );
-			delete archiveTOC;
-		}
-		else
+		if ( !GTableOfContents.Load( tocPath ) )
 		{
 			LE_LOG( LT_Warning, LC_Package, TEXT( "TOC file '%s' not found.." ), tocPath.c_str() );
 		}
@@ -287,6 +297,12 @@ int32 CEngineLoop::Init()
 	}
 #endif // WITH_EDITOR
 
+	// If command line has param 'tracecapture', we capture trace from loading of map, e.g. '-tracecapture 300' or '-tracecapture 10s'
+	if ( GCommandLine.HasParam( TEXT( "tracecapture" ) ) )
+	{
+		GStats.ExecTraceCommand( GCommandLine.GetValues( TEXT( "tracecapture" ) ) );
+	}
+
 	// Loading map
 	std::wstring		map;
 
@@ -380,14 +396,21 @@ void CEngineLoop::Tick()
 
 	appUpdateTimeAndHandleMaxTickRate();
 
-	// Update package manager
-	GPackageManager->Tick();
+	{
+		SCOPE_CYCLE_COUNTER( STAT_GameThread );
+
+		// Update package manager
+		GPackageManager->Tick();
 	
-	// Update engine
-	GEngine->Tick( GDeltaTime );
+		// Update engine
+		GEngine->Tick( GDeltaTime );
+
+		// Reset input events after game frame
+		GInputSystem->ResetEvents();
+	}
 
-	// Reset input events after game frame
-	GInputSystem->ResetEvents();
+	// Collect stats of finished frame
+	GStats.AdvanceFrame( GDeltaTime );
 }
 
 /**
@@ -395,6 +418,8 @@ void CEngineLoop::Tick()
  */
 void CEngineLoop::Exit()
 {
+	// Write trace if capture isn't finished yet
+	GStats.EndTraceCapture();
 	StopRenderingThread();
 
 	GPackageManager->Shutdown();
@@ -409,6 +434,7 @@ void CEngineLoop::Exit()
 	GAudioEngine.Shutdown();
 	GShaderManager->Shutdown();
 	GRHI->Destroy();
+	GThreadPool->Destroy();
 
 	GWindow->Close();
 	GLog->TearDown();
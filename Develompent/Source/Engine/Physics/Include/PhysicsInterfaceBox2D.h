@@ -181,8 +181,6 @@ struct SPhysicsActorHandleBox2D
 	 */
 	SPhysicsActorHandleBox2D()
 		: bx2Body( nullptr )
-		, physicsMaterialUpdateHandle( nullptr )
-		, physicsMaterialDestroyedHandle( nullptr )
 	{}
 
 	/**
@@ -197,8 +195,8 @@ struct SPhysicsActorHandleBox2D
 
 	b2Body*											bx2Body;						/**< Box2D rigid body */
 	std::unordered_map< b2Shape*, b2Fixture* >		fixtureMap;						/**< Fixture map */
-	COnPhysicsMaterialUpdate::DelegateType_t*		physicsMaterialUpdateHandle;	/**< Handle delegate of physics material is updated */
-	COnPhysicsMaterialDestroyed::DelegateType_t*	physicsMaterialDestroyedHandle;	/**< Handle delegate of physics material is destroyed */
+	CDelegateHandle									physicsMaterialUpdateHandle;	/**< Handle delegate of physics material is updated */
+	CDelegateHandle									physicsMaterialDestroyedHandle;	/**< Handle delegate of physics material is destroyed */
 };
 
 /**
@@ -1,3 +1,4 @@
+#include "System/MemoryTracker.h"
 #include "System/PhysicsBodySetup.h"
 
 CPhysicsBodySetup::CPhysicsBodySetup()
@@ -10,6 +11,8 @@ CPhysicsBodySetup::~CPhysicsBodySetup()
 
 void CPhysicsBodySetup::Serialize( class CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Physics );
+
 	InArchive << boxGeometries;
 }
 
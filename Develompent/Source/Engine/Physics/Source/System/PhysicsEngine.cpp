@@ -4,8 +4,11 @@
 #include "System/Config.h"
 #include "System/PhysicsEngine.h"
 #include "System/Package.h"
+#include "System/Stats.h"
 #include "PhysicsInterface.h"
 
+DECLARE_CYCLE_STAT( TEXT( "Physics tick" ), STAT_PhysicsTick, SG_Physics );
+
 FORCEINLINE ECollisionChannel TextToECollisionChannel( const std::wstring& InStr )
 {
 	if ( InStr == TEXT( "WorldStatic" ) )
@@ -143,6 +146,7 @@ void CPhysicsEngine::Init()
 
 void CPhysicsEngine::Tick( float InDeltaTime )
 {
+	SCOPE_CYCLE_COUNTER( STAT_PhysicsTick );
 	GPhysicsScene.Tick( InDeltaTime );
 }
 
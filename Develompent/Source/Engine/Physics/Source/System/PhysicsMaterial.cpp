@@ -1,4 +1,5 @@
 #include "Misc/PhysicsGlobals.h"
+#include "System/MemoryTracker.h"
 #include "System/PhysicsEngine.h"
 #include "System/PhysicsMaterial.h"
 
@@ -19,6 +20,8 @@ CPhysicsMaterial::~CPhysicsMaterial()
 
 void CPhysicsMaterial::Serialize( class CArchive& InArchive )
 {
+	SCOPED_MEMORY_TAG( MT_Physics );
+
 	CAsset::Serialize( InArchive );
 	InArchive << staticFriction;
 	InArchive << dynamicFriction;
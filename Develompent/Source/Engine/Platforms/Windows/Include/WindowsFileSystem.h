@@ -9,8 +9,132 @@
 #ifndef WINDOWSFILESYSTEM_H
 #define WINDOWSFILESYSTEM_H
 
+#include <Windows.h>
+
 #include "System/BaseFileSystem.h"
 
+/**
+ * @ingroup WindowsPlatform
+ * @brief Handle of file opened for positional reading on Windows
+ */
+class CWindowsFileReadHandle : public CFileReadHandle
+{
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param InHandle  Windows handle of opened file
+     * @param InPath    Path to file
+     */
+                                                    CWindowsFileReadHandle( HANDLE InHandle, const std::wstring& InPath );
+
+    /**
+     * @brief Destructor
+     */
+                                                    ~CWindowsFileReadHandle();
+
+    /**
+     * @brief Read data from file at offset
+     *
+     * @param InBuffer  Pointer to destination buffer
+     * @param InSize    Number of bytes to read
+     * @param InOffset  Offset in file from which to start reading
+     * @return Return number of readed bytes. If it less then InSize - reached end of file or happened error
+     */
+    virtual uint32                                  ReadAt( void* InBuffer, uint32 InSize, uint64 InOffset ) override;
+
+    /**
+     * @brief Get size of file
+     * @return Return size of file in bytes
+     */
+    virtual uint64                                  GetSize() const override;
+
+private:
+    HANDLE                                          handle;     /**< Windows handle of file */
+    uint64                                          size;       /**< Size of file */
+};
+
+/**
+ * @ingroup WindowsPlatform
+ * @brief Handle of file opened for positional writing on Windows
+ */
+class CWindowsFileWriteHandle : public CFileWriteHandle
+{
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param InHandle  Windows handle of opened file
+     * @param InPath    Path to file
+     */
+                                                    CWindowsFileWriteHandle( HANDLE InHandle, const std::wstring& InPath );
+
+    /**
+     * @brief Destructor
+     */
+                                                    ~CWindowsFileWriteHandle();
+
+    /**
+     * @brief Write data to file at offset
+     *
+     * @param InBuffer  Pointer to source buffer
+     * @param InSize    Number of bytes to write
+     * @param InOffset  Offset in file from which to start writing
+     * @return Return TRUE if all data is written, else return FALSE
+     */
+    virtual bool                                    WriteAt( const void* InBuffer, uint32 InSize, uint64 InOffset ) override;
+
+    /**
+     * @brief Get size of file at the moment of opening
+     * @return Return size of file in bytes
+     */
+    virtual uint64                                  GetSize() const override;
+
+private:
+    HANDLE                                          handle;     /**< Windows handle of file */
+    uint64                                          size;       /**< Size of file at the moment of opening */
+};
+
+/**
+ * @ingroup WindowsPlatform
+ * @brief File mapped to memory on Windows
+ */
+class CWindowsMappedFile : public CMappedFile
+{
+public:
+    /**
+     * @brief Constructor
+     * 
+     * @param InMapping Windows handle of file mapping
+     * @param InData    Pointer to view of file
+     * @param InSize    Size of file
+     * @param InPath    Path to file
+     */
+                                                    CWindowsMappedFile( HANDLE InMapping, const byte* InData, uint64 InSize, const std::wstring& InPath );
+
+    /**
+     * @brief Destructor
+     */
+                                                    ~CWindowsMappedFile();
+
+    /**
+     * @brief Get pointer to data of file
+     * @return Return pointer to data of file
+     */
+    virtual const byte*                             GetData() const override;
+
+    /**
+     * @brief Get size of file
+     * @return Return size of file in bytes
+     */
+    virtual uint64                                  GetSize() const override;
+
+private:
+    HANDLE                                          mapping;    /**< Windows handle of file mapping */
+    const byte*                                     data;       /**< Pointer to view of file */
+    uint64                                          size;       /**< Size of file */
+};
+
 /**
  * @ingroup WindowsPlatform
  * @brief Class for work with file system in Windows
@@ -29,26 +153,31 @@ public:
                                                     ~CWindowsFileSystem();
 
     /**
-     * @brief Create file reader
+     * @brief Open file for positional reading
      *
-     * @param[in] InFileName Path to file
-     * @param[in] InFlags Flags of open file
-     * @return Pointer on file reader, if file not opened return null
-     *
-     * @warning After use need delete file reader
+     * @param InFileName    Path to file
+     * @param InFlags       Combinations flags of EArchiveRead for open mode
+     * @return Return handle of opened file, if file not opened return NULL
      */
-    virtual class CArchive*                     CreateFileReader( const std::wstring& InFileName, uint32 InFlags = AR_None ) override;
+    virtual FileReadHandleRef_t                     OpenReadHandle( const std::wstring& InFileName, uint32 InFlags = AR_None ) override;
 
     /**
-     * @brief Create file writer
+     * @brief Open file for positional writing
      *
-     * @param[in] InFileName Path to file
-     * @param[in] InFlags Flags of write file
-     * @return Pointer on file writer, if file not opened return null
+     * @param InFileName    Path to file
+     * @param InFlags       Combinations flags of EArchiveWrite for opening mode
+     * @return Return handle of opened file, if file not opened return NULL
+     */
+    virtual FileWriteHandleRef_t                    OpenWriteHandle( const std::wstring& InFileName, uint32 InFlags = AW_None ) override;
+
+    /**
+     * @brief Map file to memory for reading
      *
-     * @warning After use need delete file writer
+     * @param InFileName    Path to file
+     * @param InFlags       Combinations flags of EArchiveRead for open mode
+     * @return Return mapped file, if file not opened return NULL
      */
-    virtual class CArchive*                     CreateFileWriter( const std::wstring& InFileName, uint32 InFlags = AW_None ) override;
+    virtual MappedFileRef_t                         MapFile( const std::wstring& InFileName, uint32 InFlags = AR_None ) override;
 
     /**
      * @brief Find files in directory
@@ -12,7 +12,7 @@
 #include <chrono>
 
 #include "Logger/BaseLogger.h"
-#include "WindowsArchive.h"
+#include "System/Archive.h"
 
 /**
  * @ingroup WindowsPlatform
@@ -44,8 +44,9 @@ public:
      *
      * @param[in] InMessage Message
      * @param[in] InEvent Type event of message
+     * @param[in] InTime Time of message in seconds since start of engine
      */
-    virtual void            Serialize( const tchar* InMessage, ELogType InLogType, ELogCategory InLogCategory );
+    virtual void            Serialize( const tchar* InMessage, ELogType InLogType, ELogCategory InLogCategory, double InTime );
 
     /**
      * @brief Closes output device and cleans up
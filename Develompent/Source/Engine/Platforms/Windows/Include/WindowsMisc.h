@@ -26,4 +26,16 @@ FORCEINLINE double appSeconds()
 	return cycles.QuadPart * GSecondsPerCycle + 16777216.0;
 }
 
+/**
+ * @ingroup WindowsPlatform
+ * Get value of high resolution counter. Convert to seconds by GSecondsPerCycle
+ * @return Return number of cycles
+ */
+FORCEINLINE uint64 appCycles()
+{
+	LARGE_INTEGER		cycles;
+	QueryPerformanceCounter( &cycles );
+	return cycles.QuadPart;
+}
+
 #endif // !WINDOWSMISC_H
\ No newline at end of file
@@ -9,6 +9,8 @@
 #ifndef WINDOWSTHREADING_H
 #define WINDOWSTHREADING_H
 
+#include <string>
+
 #include "Misc/Types.h"
 
 FORCEINLINE int32 appInterlockedIncrement( volatile int32* InValue )
@@ -26,6 +28,11 @@ FORCEINLINE int32 appInterlockedAdd( volatile int32* InValue, int32 InAmount )
 	return ( int32 )InterlockedExchangeAdd( ( LPLONG )InValue, ( LONG )InAmount );
 }
 
+FORCEINLINE int64 appInterlockedAdd64( volatile int64* InValue, int64 InAmount )
+{
+	return ( int64 )InterlockedExchangeAdd64( InValue, InAmount );
+}
+
 FORCEINLINE int32 appInterlockedExchange( volatile int32* InValue, int32 InExchange )
 {
 	return ( int32 )InterlockedExchange( ( LPLONG )InValue, ( LONG )InExchange );
@@ -173,6 +180,7 @@ private:
 
 	uint32					threadId;				/**< ID of thread */
 	HANDLE					thread;					/**< Windows handle of thread */
+	std::wstring			threadName;				/**< Name of thread */
 	CRunnable*				runnable;				/**< Runnable object */
 	CEvent*					threadInitSyncEvent;	/**< Sync event to make sure that Init() has been completed before allowing the main thread to continue */
 	EThreadPriority			threadPriority;			/**< The priority to run the thread at */
@@ -2,10 +2,142 @@
 
 #include "Core.h"
 #include "WindowsFileSystem.h"
-#include "WindowsArchive.h"
 #include "Containers/String.h"
 #include "Logger/LoggerMacros.h"
 
+// ====================================
+// File read handle
+// ====================================
+
+CWindowsFileReadHandle::CWindowsFileReadHandle( HANDLE InHandle, const std::wstring& InPath )
+	: CFileReadHandle( InPath )
+	, handle( InHandle )
+	, size( 0 )
+{
+	check( handle != INVALID_HANDLE_VALUE );
+
+	LARGE_INTEGER		fileSize;
+	if ( GetFileSizeEx( handle, &fileSize ) )
+	{
+		size = ( uint64 )fileSize.QuadPart;
+	}
+}
+
+CWindowsFileReadHandle::~CWindowsFileReadHandle()
+{
+	CloseHandle( handle );
+}
+
+uint32 CWindowsFileReadHandle::ReadAt( void* InBuffer, uint32 InSize, uint64 InOffset )
+{
+	// Offset is passed through OVERLAPPED, so the read not depends on the file pointer
+	// and one handle can be used from several threads at once
+	OVERLAPPED		overlapped;
+	appMemzero( &overlapped, sizeof( OVERLAPPED ) );
+	overlapped.Offset		= ( DWORD )( InOffset & 0xFFFFFFFF );
+	overlapped.OffsetHigh	= ( DWORD )( InOffset >> 32 );
+
+	DWORD			numReadBytes = 0;
+	if ( !ReadFile( handle, InBuffer, InSize, &numReadBytes, &overlapped ) )
+	{
+		DWORD		error = GetLastError();
+		if ( error != ERROR_HANDLE_EOF )
+		{
+			LE_LOG( LT_Warning, LC_General, TEXT( "Failed read %u bytes at offset %llu from file '%s' (GetLastError: %d)" ), InSize, InOffset, GetPath().c_str(), error );
+		}
+	}
+
+	return numReadBytes;
+}
+
+uint64 CWindowsFileReadHandle::GetSize() const
+{
+	return size;
+}
+
+// ====================================
+// File write handle
+// ====================================
+
+CWindowsFileWriteHandle::CWindowsFileWriteHandle( HANDLE InHandle, const std::wstring& InPath )
+	: CFileWriteHandle( InPath )
+	, handle( InHandle )
+	, size( 0 )
+{
+	check( handle != INVALID_HANDLE_VALUE );
+
+	LARGE_INTEGER		fileSize;
+	if ( GetFileSizeEx( handle, &fileSize ) )
+	{
+		size = ( uint64 )fileSize.QuadPart;
+	}
+}
+
+CWindowsFileWriteHandle::~CWindowsFileWriteHandle()
+{
+	CloseHandle( handle );
+}
+
+bool CWindowsFileWriteHandle::WriteAt( const void* InBuffer, uint32 InSize, uint64 InOffset )
+{
+	OVERLAPPED		overlapped;
+	appMemzero( &overlapped, sizeof( OVERLAPPED ) );
+	overlapped.Offset		= ( DWORD )( InOffset & 0xFFFFFFFF );
+	overlapped.OffsetHigh	= ( DWORD )( InOffset >> 32 );
+
+	DWORD			numWrittenBytes = 0;
+	if ( !WriteFile( handle, InBuffer, InSize, &numWrittenBytes, &overlapped ) )
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Failed write %i bytes at offset %llu to file '%s' (GetLastError: %d)" ), InSize, InOffset, GetPath().c_str(), GetLastError() );
+		return false;
+	}
+
+	return numWrittenBytes == InSize;
+}
+
+uint64 CWindowsFileWriteHandle::GetSize() const
+{
+	return size;
+}
+
+// ====================================
+// Mapped file
+// ====================================
+
+CWindowsMappedFile::CWindowsMappedFile( HANDLE InMapping, const byte* InData, uint64 InSize, const std::wstring& InPath )
+	: CMappedFile( InPath )
+	, mapping( InMapping )
+	, data( InData )
+	, size( InSize )
+{}
+
+CWindowsMappedFile::~CWindowsMappedFile()
+{
+	if ( data )
+	{
+		UnmapViewOfFile( data );
+	}
+
+	if ( mapping )
+	{
+		CloseHandle( mapping );
+	}
+}
+
+const byte* CWindowsMappedFile::GetData() const
+{
+	return data;
+}
+
+uint64 CWindowsMappedFile::GetSize() const
+{
+	return size;
+}
+
+// ====================================
+// File system
+// ====================================
+
 /**
  * Constructor
  */
@@ -19,41 +151,29 @@ CWindowsFileSystem::~CWindowsFileSystem()
 {}
 
 /**
- * Create file reader
+ * Open file for positional reading
  */
-class CArchive* CWindowsFileSystem::CreateFileReader( const std::wstring& InFileName, uint32 InFlags )
+FileReadHandleRef_t CWindowsFileSystem::OpenReadHandle( const std::wstring& InFileName, uint32 InFlags /* = AR_None */ )
 {
-	std::ifstream*			inputFile = new std::ifstream();
-
-	// Create file and create archive reader
-	inputFile->open( InFileName, std::ios::binary );
-	if ( !inputFile->is_open() )
+	// We allow to write and delete the file while it opened, because handles can be cached for a long time
+	HANDLE		handle = CreateFileW( InFileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr );
+	if ( handle == INVALID_HANDLE_VALUE )
 	{
 		if ( InFlags & AR_NoFail )
 		{
-			appErrorf( TEXT( "Failed to create file: %s, InFlags = 0x%X" ), InFileName.c_str(), InFlags );
+			appErrorf( TEXT( "Failed to open file: %s, InFlags = 0x%X" ), InFileName.c_str(), InFlags );
 		}
-
-		delete inputFile;
 		return nullptr;
 	}
 
-	return new CWindowsArchiveReading( inputFile, InFileName );
+	return new CWindowsFileReadHandle( handle, InFileName );
 }
 
 /**
- * Create file writer
+ * Open file for positional writing
  */
-class CArchive* CWindowsFileSystem::CreateFileWriter( const std::wstring& InFileName, uint32 InFlags )
+FileWriteHandleRef_t CWindowsFileSystem::OpenWriteHandle( const std::wstring& InFileName, uint32 InFlags /* = AW_None */ )
 {
-	std::ofstream*			outputFile = new std::ofstream();
-	int						flags = 0;
-
-	if ( InFlags & AW_Append )
-	{
-		flags = std::ios::app;		
-	}
-
 	// Create directory for file
 	{
 		std::wstring			path = InFileName;
@@ -70,20 +190,72 @@ class CArchive* CWindowsFileSystem::CreateFileWriter( const std::wstring& InFile
 		}
 	}
 
-	// Create file and create archive writer
-	outputFile->open( InFileName, flags | std::ios::binary | std::ios::ate );
-	if ( !outputFile->is_open() )
+	// Cached read handle must not see file while it is rewritten
+	InvalidateCachedHandles( InFileName );
+
+	// Create file, without AW_Append it will be truncated
+	HANDLE		handle = CreateFileW( InFileName.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, ( InFlags & AW_Append ) ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if ( handle == INVALID_HANDLE_VALUE )
 	{
 		if ( InFlags & AW_NoFail )
 		{
 			appErrorf( TEXT( "Failed to create file: %s, InFlags = %X" ), InFileName.c_str(), InFlags );
 		}
+		return nullptr;
+	}
+
+	return new CWindowsFileWriteHandle( handle, InFileName );
+}
+
+/**
+ * Map file to memory for reading
+ */
+MappedFileRef_t CWindowsFileSystem::MapFile( const std::wstring& InFileName, uint32 InFlags /* = AR_None */ )
+{
+	HANDLE		file = CreateFileW( InFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if ( file == INVALID_HANDLE_VALUE )
+	{
+		if ( InFlags & AR_NoFail )
+		{
+			appErrorf( TEXT( "Failed to open file: %s, InFlags = 0x%X" ), InFileName.c_str(), InFlags );
+		}
+		return nullptr;
+	}
+
+	LARGE_INTEGER	fileSize;
+	if ( !GetFileSizeEx( file, &fileSize ) )
+	{
+		fileSize.QuadPart = 0;
+	}
+
+	// Empty file can't be mapped, so return empty view
+	if ( fileSize.QuadPart == 0 )
+	{
+		CloseHandle( file );
+		return new CWindowsMappedFile( nullptr, nullptr, 0, InFileName );
+	}
+
+	// Mapping keeps reference to file, so handle of file we can close right now
+	HANDLE		mapping = CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	CloseHandle( file );
+
+	const byte*	data = mapping ? ( const byte* )MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+	if ( !data )
+	{
+		LE_LOG( LT_Warning, LC_General, TEXT( "Failed to map file '%s' (GetLastError: %d)" ), InFileName.c_str(), GetLastError() );
+		if ( mapping )
+		{
+			CloseHandle( mapping );
+		}
 
-		delete outputFile;
+		if ( InFlags & AR_NoFail )
+		{
+			appErrorf( TEXT( "Failed to map file: %s, InFlags = 0x%X" ), InFileName.c_str(), InFlags );
+		}
 		return nullptr;
 	}
 
-	return new CWindowsArchiveWriter( outputFile, InFileName );
+	return new CWindowsMappedFile( mapping, data, ( uint64 )fileSize.QuadPart, InFileName );
 }
 
 /**
@@ -118,6 +290,7 @@ std::vector< std::wstring > CWindowsFileSystem::FindFiles( const std::wstring& I
 
 bool CWindowsFileSystem::Delete( const std::wstring& InPath, bool InIsEvenReadOnly /* = false */ )
 {
+	InvalidateCachedHandles( InPath );
 	if ( InIsEvenReadOnly )
 	{
 		SetFileAttributesW( InPath.c_str(), FILE_ATTRIBUTE_NORMAL );
@@ -158,6 +331,7 @@ bool CWindowsFileSystem::DeleteDirectory( const std::wstring& InPath, bool InIsT
 		return CBaseFileSystem::DeleteDirectory( InPath, InIsTree );
 	}
 
+	InvalidateCachedHandles( InPath );
 	bool		result = RemoveDirectoryW( InPath.c_str() );
 	if ( !result )
 	{
@@ -174,6 +348,7 @@ ECopyMoveResult CWindowsFileSystem::Copy( const std::wstring& InDstFile, const s
 	}
 
 	ECopyMoveResult		result;
+	InvalidateCachedHandles( InDstFile );
 	MakeDirectory( CFilename( InDstFile ).GetPath(), true );
 	if ( CopyFileW( InSrcFile.c_str(), InDstFile.c_str(), !InIsReplaceExisting ) != 0 )
 	{
@@ -193,6 +368,9 @@ ECopyMoveResult CWindowsFileSystem::Copy( const std::wstring& InDstFile, const s
 
 ECopyMoveResult CWindowsFileSystem::Move( const std::wstring& InDstFile, const std::wstring& InSrcFile, bool InIsReplaceExisting /* = false */, bool InIsEvenReadOnly /* = false */ )
 {
+	// Handle follows file after move, so old path must not keep it. Also file at destination will be replaced
+	InvalidateCachedHandles( InSrcFile );
+	InvalidateCachedHandles( InDstFile );
 	MakeDirectory( CFilename( InDstFile ).GetPath(), true );
 
 	DWORD		moveFlags = ( InIsReplaceExisting ? MOVEFILE_REPLACE_EXISTING : 0x0 ) | MOVEFILE_WRITE_THROUGH;
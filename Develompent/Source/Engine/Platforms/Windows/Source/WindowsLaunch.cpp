@@ -23,6 +23,7 @@
 #include "Misc/Misc.h"
 #include "System/Config.h"
 #include "System/SplashScreen.h"
+#include "System/Malloc.h"
 
 #if WITH_EDITOR
 #include "WorldEd.h"
@@ -30,6 +31,10 @@
 #include "System/EditorEngine.h"
 #endif // WITH_EDITOR
 
+#if USE_MALLOC_BINNED
+REPLACEMENT_OPERATOR_NEW_AND_DELETE
+#endif // USE_MALLOC_BINNED
+
 /**
  * Pre-Initialize platform
  */
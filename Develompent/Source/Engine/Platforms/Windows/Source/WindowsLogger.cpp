@@ -14,35 +14,6 @@
 #include "Misc/WorldEdGlobals.h"
 #endif // WITH_EDITOR
 
-const tchar* GLogTypeNames[] =
-{
-	TEXT( "Log" ),
-	TEXT( "Warning" ),
-	TEXT( "Error" )
-};
-
-const tchar* GLogCategoryNames[] =
-{
-	TEXT( "None" ),
-	TEXT( "General" ),
-	TEXT( "Init" ),
-	TEXT( "Script" ),
-	TEXT( "Dev" ),
-	TEXT( "Shader" ),
-	TEXT( "Input" ),
-	TEXT( "Package" ),
-	TEXT( "Audio" ),
-	TEXT( "Physics" ),
-	TEXT( "Movie" ),
-	TEXT( "Render" ),
-	TEXT( "RHI" ),
-
-#if WITH_EDITOR
-	TEXT( "Editor" ),
-	TEXT( "Commandlet" )
-#endif // WITH_EDITOR
-};
-
 const uint16 GLogColors[] =
 {
 	0x7,			// LC_Default
@@ -108,6 +79,9 @@ void CWindowsLogger::Init()
 		Logf( LT_Log, LC_Init, TEXT( "Opened log file '%s'" ), logFile.c_str() );
 	}
 #endif // !NO_LOGGING
+
+	// Output devices are ready, start writer thread
+	CBaseLogger::Init();
 }
 
 /**
@@ -115,6 +89,8 @@ void CWindowsLogger::Init()
  */
 void CWindowsLogger::TearDown()
 {
+	// Write all messages in queue before close output devices
+	CBaseLogger::TearDown();
 	Show( false );
 
 	if ( archiveLogs )
@@ -149,7 +125,7 @@ void CWindowsLogger::ResetTextColor()
 /**
  * Serialize message
  */
-void CWindowsLogger::Serialize( const tchar* InMessage, ELogType InLogType, ELogCategory InLogCategory )
+void CWindowsLogger::Serialize( const tchar* InMessage, ELogType InLogType, ELogCategory InLogCategory, double InTime )
 {
 	// If console is opened - get current text color
 	// and change to color by event type
@@ -175,7 +151,7 @@ void CWindowsLogger::Serialize( const tchar* InMessage, ELogType InLogType, ELog
 		}
 	}
 	
-	std::wstring			message = CString::Format( TEXT( "[%07.2f][%s][%s] %s" ), appSeconds() - GStartTime, GLogTypeNames[ ( uint32 ) InLogType ], GLogCategoryNames[ ( uint32 ) InLogCategory ], InMessage );
+	std::wstring			message = CString::Format( TEXT( "[%07.2f][%s][%s] %s" ), InTime, appLogTypeToText( InLogType ), appLogCategoryToText( InLogCategory ), InMessage );
 	std::wstring			finalMessage = message + TEXT( "\n" );
 	wprintf( finalMessage.c_str() );
 
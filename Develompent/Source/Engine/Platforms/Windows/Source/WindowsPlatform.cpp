@@ -210,6 +210,25 @@ void appDumpCallStack( std::wstring& OutCallStack )
 	OutCallStack = stackWalker.GetBuffer();
 }
 
+uint32 appCaptureCallStack( uint32 InNumFramesToSkip, void** OutFrames, uint32 InMaxFrames )
+{
+	return RtlCaptureStackBackTrace( InNumFramesToSkip + 1, InMaxFrames, OutFrames, nullptr );
+}
+
+std::wstring appCodeAddressToString( void* InAddress )
+{
+	HMODULE		module = nullptr;
+	tchar		modulePath[MAX_PATH];
+	if ( !GetModuleHandleExW( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, ( LPCWSTR )InAddress, &module ) ||
+		 !GetModuleFileNameW( module, modulePath, ARRAY_COUNT( modulePath ) ) )
+	{
+		return CString::Format( TEXT( "0x%p" ), InAddress );
+	}
+
+	const tchar*	moduleName = wcsrchr( modulePath, TEXT( '\\' ) );
+	return CString::Format( TEXT( "%s+0x%llx" ), moduleName ? moduleName + 1 : modulePath, ( uint64 )( ( byte* )InAddress - ( byte* )module ) );
+}
+
 void appRequestExit( bool InForce )
 {
 	if ( InForce )
@@ -258,6 +277,53 @@ std::wstring appUserName()
 	return result;
 }
 
+uint32 appNumberOfCores()
+{
+	static uint32	numberOfCores = 0;
+	if ( numberOfCores == 0 )
+	{
+		SYSTEM_INFO		systemInfo;
+		GetSystemInfo( &systemInfo );
+		numberOfCores = Max<uint32>( systemInfo.dwNumberOfProcessors, 1 );
+	}
+	return numberOfCores;
+}
+
+void* appPageAlloc( uint64 InSize, bool InIsLargePages )
+{
+	// Large pages must be reserved and committed at once
+	return VirtualAlloc( nullptr, InSize, MEM_RESERVE | MEM_COMMIT | ( InIsLargePages ? MEM_LARGE_PAGES : 0 ), PAGE_READWRITE );
+}
+
+void appPageFree( void* InPointer, uint64 InSize )
+{
+	VirtualFree( InPointer, 0, MEM_RELEASE );
+}
+
+uint64 appGetLargePageSize()
+{
+	// Large pages are available only if user has privilege 'Lock pages in memory', it must be enabled for process token
+	static int64	largePageSize = -1;
+	if ( largePageSize < 0 )
+	{
+		largePageSize = 0;
+		HANDLE		token;
+		if ( OpenProcessToken( GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token ) )
+		{
+			TOKEN_PRIVILEGES	privileges;
+			privileges.PrivilegeCount				= 1;
+			privileges.Privileges[0].Attributes		= SE_PRIVILEGE_ENABLED;
+			if ( LookupPrivilegeValueW( nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid ) &&
+				 AdjustTokenPrivileges( token, FALSE, &privileges, 0, nullptr, nullptr ) && GetLastError() == ERROR_SUCCESS )
+			{
+				largePageSize = GetLargePageMinimum();
+			}
+			CloseHandle( token );
+		}
+	}
+	return ( uint64 )largePageSize;
+}
+
 #if WITH_EDITOR
 #include "Windows/FileDialog.h"
 
@@ -2,6 +2,7 @@
 #include "System/ThreadingBase.h"
 #include "WindowsThreading.h"
 #include "Containers/StringConv.h"
+#include "System/Stats.h"
 
 /* Global factory for creating threads */
 CThreadFactory*			GThreadFactory = new CThreadFactoryWindows();
@@ -142,6 +143,7 @@ bool CRunnableThreadWindows::Create( CRunnable* InRunnable, const tchar* InThrea
 	isAutoDeleteSelf = InIsAutoDeleteSelf;
 	isAutoDeleteRunnable = InIsAutoDeleteRunnable;
 	threadPriority = InThreadPriority;
+	threadName = InThreadName ? InThreadName : TEXT( "Unnamed LE" );
 
 	// Create a sync event to guarantee the Init() function is called first
 	threadInitSyncEvent = GSynchronizeFactory->CreateSynchEvent( true );
@@ -182,6 +184,7 @@ uint32 CRunnableThreadWindows::Run()
 {
 	check( runnable );
 	appSetThreadPriority( thread, threadPriority );
+	GStats.SetThreadName( threadName );
 
 	// Initialize the runnable object
 	bool		initReturn = runnable->Init();
@@ -426,6 +426,7 @@ void CD3D11RHI::Init( bool InIsEditor )
 	INIT_FORMAT( PF_BC5,					DXGI_FORMAT_BC5_UNORM );
 	INIT_FORMAT( PF_BC6H,					DXGI_FORMAT_BC6H_UF16 );
 	INIT_FORMAT( PF_BC7,					DXGI_FORMAT_BC7_UNORM );
+	INIT_FORMAT( PF_BC4,					DXGI_FORMAT_BC4_UNORM );
 
 	INIT_UNSUPPORTED_FORMAT( PF_Unknown );
 	isInitialize = true;
@@ -964,6 +965,8 @@ void CD3D11RHI::DrawPrimitive( class CBaseDeviceContextRHI* InDeviceContext, EPr
 	}
 
 	// Draw primitive
+	INC_COUNTER_STAT( STAT_DrawCalls, 1 );
+	INC_COUNTER_STAT( STAT_DrawPrimitives, InNumPrimitives * InNumInstances );
 	if ( InNumInstances > 1 )
 	{
 		d3d11DeviceContext->DrawInstanced( vertexCount, InNumInstances, InBaseVertexIndex, 0 );
@@ -1005,6 +1008,8 @@ void CD3D11RHI::DrawIndexedPrimitive( class CBaseDeviceContextRHI* InDeviceConte
 
 	// Draw indexed primitive	
 	uint32							indexCount = GetVertexCountForPrimitiveCount( InNumPrimitives, InPrimitiveType );
+	INC_COUNTER_STAT( STAT_DrawCalls, 1 );
+	INC_COUNTER_STAT( STAT_DrawPrimitives, InNumPrimitives * InNumInstances );
 	if ( InNumInstances > 1 )
 	{
 		d3d11DeviceContext->DrawIndexedInstanced( indexCount, InNumInstances, InStartIndex, InBaseVertexIndex, 0 );
@@ -1189,6 +1194,7 @@ void CD3D11RHI::EndDrawingViewport( class CBaseDeviceContextRHI* InDeviceContext
 #include <d3dcompiler.h>
 #include <string>
 
+#include "Containers/String.h"
 #include "Containers/StringConv.h"
 #include "Misc/CoreGlobals.h"
 #include "Misc/Misc.h"
@@ -1294,6 +1300,7 @@ bool CD3D11RHI::CompileShader( const tchar* InSourceFileName, const tchar* InFun
 	CArchive*		shaderArchive = GFileSystem->CreateFileReader( InSourceFileName );
 	if ( !shaderArchive )
 	{
+		OutOutput.errorMsg = CString::Format( TEXT( "Not found shader file '%s'" ), InSourceFileName );
 		return false;
 	}
 
@@ -1334,7 +1341,10 @@ bool CD3D11RHI::CompileShader( const tchar* InSourceFileName, const tchar* InFun
 		break;
 
 	default:
-		appErrorf( TEXT( "Unknown shader frequency %i" ), InFrequency );
+		// Shaders can be compiled on worker threads, so error is returned to caller instead of appErrorf
+		OutOutput.errorMsg = CString::Format( TEXT( "Unknown shader frequency %i" ), InFrequency );
+		delete shaderArchive;
+		delete[] buffer;
 		return false;
 	}
 
@@ -1385,8 +1395,6 @@ bool CD3D11RHI::CompileShader( const tchar* InSourceFileName, const tchar* InFun
 		{
 			OutOutput.errorMsg		= TEXT( "Compile Failed without warnings!" );	
 		}
-
-		LE_LOG( LT_Error, LC_Shader, OutOutput.errorMsg.c_str() );
 		return false;
 	}
 
@@ -1418,8 +1426,14 @@ bool CD3D11RHI::CompileShader( const tchar* InSourceFileName, const tchar* InFun
 
 			if ( cbDesc.Size > GConstantBufferSizes[ cbIndex ] )
 			{
-				appErrorf( TEXT( "Set GConstantBufferSizes[%d] to >= %d" ), cbIndex, cbDesc.Size) ;
+				OutOutput.errorMsg = CString::Format( TEXT( "Set GConstantBufferSizes[%d] to >= %d" ), cbIndex, cbDesc.Size );
+				reflector->Release();
+				shaderBlob->Release();
+				delete[] buffer;
+				delete shaderArchive;
+				return false;
 			}
+			OutOutput.parameterMap.SetConstantBufferSize( cbIndex, cbDesc.Size );
 
 			// Track all of the variables in this constant buffer
 			for ( uint32 constantIndex = 0; constantIndex < cbDesc.Variables; ++constantIndex )
@@ -1440,7 +1454,7 @@ bool CD3D11RHI::CompileShader( const tchar* InSourceFileName, const tchar* InFun
 				}
 				else
 				{
-					LE_LOG( LT_Warning, LC_Shader, TEXT( "Found Unused shader parameter: %s at offset: %i size: %i" ), ANSI_TO_TCHAR( variableDesc.Name ), variableDesc.StartOffset, variableDesc.Size );
+					OutOutput.warnings.push_back( CString::Format( TEXT( "Found Unused shader parameter: %s at offset: %i size: %i" ), ANSI_TO_TCHAR( variableDesc.Name ), variableDesc.StartOffset, variableDesc.Size ) );
 				}
 			}
 		}
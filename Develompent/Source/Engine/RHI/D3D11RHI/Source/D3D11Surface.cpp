@@ -188,10 +188,11 @@ CD3D11Texture2DRHI::CD3D11Texture2DRHI( const tchar* InDebugName, uint32 InSizeX
 		
 		for ( uint32 mipIndex = 0; mipIndex < numMips; ++mipIndex )
 		{
-			uint32		mipSizeX	= Max< uint32 >( InSizeX >> mipIndex, GPixelFormats[ InFormat ].blockSizeX );
-			uint32		pitch		= ( mipSizeX / GPixelFormats[ InFormat ].blockSizeX ) * GPixelFormats[ InFormat ].blockBytes;
-			uint32		mipSizeY	= Max< uint32 >( InSizeY >> mipIndex, GPixelFormats[ InFormat ].blockSizeY );
-			uint32		numRows		= mipSizeY / GPixelFormats[ InFormat ].blockSizeY;
+			// Mips with size not multiple of block still have whole blocks
+			uint32		mipSizeX	= Max< uint32 >( InSizeX >> mipIndex, 1 );
+			uint32		pitch		= ( ( mipSizeX + GPixelFormats[ InFormat ].blockSizeX - 1 ) / GPixelFormats[ InFormat ].blockSizeX ) * GPixelFormats[ InFormat ].blockBytes;
+			uint32		mipSizeY	= Max< uint32 >( InSizeY >> mipIndex, 1 );
+			uint32		numRows		= ( mipSizeY + GPixelFormats[ InFormat ].blockSizeY - 1 ) / GPixelFormats[ InFormat ].blockSizeY;
 
 			D3D11_SUBRESOURCE_DATA&		d3d11SubresourceData = subResourceData[ mipIndex ];
 			d3d11SubresourceData.pSysMem = data + offset;
@@ -11,6 +11,8 @@
 #include "RHI/BaseRHI.h"
 #include "RHI/BaseDeviceContextRHI.h"
 #include "Render/RenderingThread.h"
+#include "System/Stats.h"
+#include "System/BaseFileSystem.h"
 #include "ImGUI/ImGUIEngine.h"
 #include "Misc/UIGlobals.h"
 
@@ -379,9 +381,15 @@ void CImGUIEngine::InitTheme()
 	// Init dark solors	
 	ImGui::StyleColorsDark();
 
-	float	fontSize			= 15.0f;
-	ImGui::GetIO().Fonts->AddFontFromFileTTF( TCHAR_TO_ANSI( ( appBaseDir() + TEXT( "Engine/Editor/Fonts/Roboto/Roboto-Bold.ttf ") ).c_str() ), fontSize );
-	ImGui::GetIO().FontDefault	= ImGui::GetIO().Fonts->AddFontFromFileTTF( TCHAR_TO_ANSI( ( appBaseDir() + TEXT( "Engine/Editor/Fonts/Roboto/Roboto-Regular.ttf " ) ).c_str() ), fontSize );
+	// Fonts of editor may be not shipped with game, in this case ImGUI uses built-in font
+	float			fontSize		= 15.0f;
+	std::wstring	boldFontPath	= appBaseDir() + TEXT( "Engine/Editor/Fonts/Roboto/Roboto-Bold.ttf" );
+	std::wstring	regularFontPath	= appBaseDir() + TEXT( "Engine/Editor/Fonts/Roboto/Roboto-Regular.ttf" );
+	if ( GFileSystem->IsExistFile( boldFontPath ) && GFileSystem->IsExistFile( regularFontPath ) )
+	{
+		ImGui::GetIO().Fonts->AddFontFromFileTTF( TCHAR_TO_ANSI( boldFontPath.c_str() ), fontSize );
+		ImGui::GetIO().FontDefault	= ImGui::GetIO().Fonts->AddFontFromFileTTF( TCHAR_TO_ANSI( regularFontPath.c_str() ), fontSize );
+	}
 
 	// When viewports are enabled we tweak WindowRounding/WindowBg so platform windows can look identical to regular ones
 	ImGuiStyle&		style	= ImGui::GetStyle();
@@ -518,6 +526,39 @@ void CImGUIEngine::CloseWindow( ImGuiViewport* InViewport )
 	}
 }
 
+/**
+ * Draw shown stats over all windows in top left corner of main viewport
+ */
+static void DrawStatsOverlay()
+{
+	std::vector<std::wstring>		lines;
+	GStats.GetDisplayLines( lines );
+	if ( lines.empty() )
+	{
+		return;
+	}
+
+	ImDrawList*		drawList	= ImGui::GetForegroundDrawList();
+	ImVec2			position	= ImGui::GetMainViewport()->Pos;
+	float			lineHeight	= ImGui::GetTextLineHeight();
+	position.x += 8.f;
+	position.y += 24.f;
+
+	std::vector<std::string>		ansiLines( lines.size() );
+	float							maxWidth = 0.f;
+	for ( uint32 index = 0, count = ( uint32 )lines.size(); index < count; ++index )
+	{
+		ansiLines[index]	= TCHAR_TO_ANSI( lines[index].c_str() );
+		maxWidth			= Max( maxWidth, ImGui::CalcTextSize( ansiLines[index].c_str() ).x );
+	}
+
+	drawList->AddRectFilled( ImVec2( position.x - 4.f, position.y - 4.f ), ImVec2( position.x + maxWidth + 4.f, position.y + lineHeight * ansiLines.size() + 4.f ), IM_COL32( 0, 0, 0, 160 ) );
+	for ( uint32 index = 0, count = ( uint32 )ansiLines.size(); index < count; ++index )
+	{
+		drawList->AddText( ImVec2( position.x, position.y + lineHeight * index ), IM_COL32( 255, 255, 255, 255 ), ansiLines[index].c_str() );
+	}
+}
+
 /**
  * End draw commands for render ImGUI
  */
@@ -529,6 +570,9 @@ void CImGUIEngine::EndDraw()
 		layers[index]->Tick();
 	}
 
+	// Draw stats over layers
+	DrawStatsOverlay();
+
 	ImGui::Render();
 	appImGUIEndDrawing();
 
@@ -22,6 +22,10 @@
 #include "Render/Shaders/ShaderCompiler.h"
 #include "System/AudioBank.h"
 #include "System/PhysicsMaterial.h"
+#include "System/Config.h"
+#include "System/CookDatabase.h"
+#include "System/TextureCompressor.h"
+#include "System/TextureMipGenerator.h"
 
 /**
  * @ingroup WorldEd
@@ -291,6 +295,38 @@ private:
 		bool				bAlwaysCook;		/**< Is need always cook */
 	};
 
+	/**
+	 * Struct of decoded source data of texture 2D
+	 */
+	struct STexture2DSource
+	{
+		uint32					sizeX;			/**< Width of texture */
+		uint32					sizeY;			/**< Height of texture */
+		uint32					numMips;		/**< Number of mips */
+		EPixelFormat			pixelFormat;	/**< Pixel format of data */
+		std::vector< byte >		data;			/**< Pixels of all mips in pixelFormat */
+	};
+
+	/**
+	 * Struct of settings for generation of texture mips
+	 */
+	struct STextureMipsInfo
+	{
+		bool					bEnable;		/**< Is enabled generation of mips */
+		EMipFilter				filter;			/**< Filter for downsampling mips */
+	};
+
+	/**
+	 * Struct of settings for compression of textures
+	 */
+	struct STextureCompressionInfo
+	{
+		bool														bEnable;		/**< Is enabled compression of textures */
+		ETextureCompressionQuality									quality;		/**< Quality of compression */
+		ETextureUsage												defaultUsage;	/**< Usage of textures which file name not matched any suffix */
+		std::vector< std::pair< std::wstring, ETextureUsage > >		usageSuffixes;	/**< Usages of textures by suffix of file name */
+	};
+
 	/**
 	 * Struct for containing of extensions for all resource type
 	 */
@@ -371,12 +407,96 @@ private:
 	 */
 	void IndexingResources( const std::wstring& InRootDir, bool InIsRootDir = false, bool InIsAlwaysCookDir = false, const std::wstring& InPackageSufix = GGameName );
 
+	/**
+	 * Get reference to asset of resource
+	 * 
+	 * @param InResourceInfo Info about resource
+	 * @return Return reference to asset in format <PackageName>:<AssetName>
+	 */
+	FORCEINLINE static std::wstring GetAssetReference( const SResourceInfo& InResourceInfo )
+	{
+		return InResourceInfo.packageName + TEXT( ":" ) + InResourceInfo.filename;
+	}
+
+	/**
+	 * Get path to cooked package
+	 * 
+	 * @param InPackageName Package name
+	 * @return Return path to cooked package
+	 */
+	std::wstring GetCookedPackagePath( const std::wstring& InPackageName ) const;
+
+	/**
+	 * Calculate hashes of source files for all indexed resources
+	 */
+	void HashSourceFiles();
+
+	/**
+	 * Get hash of resource source file
+	 * 
+	 * @param InAssetRef Reference to asset in format <PackageName>:<AssetName>
+	 * @return Return hash of source file, if resource not indexed return 0
+	 */
+	FORCEINLINE uint64 GetSourceHash( const std::wstring& InAssetRef ) const
+	{
+		auto	itHash = sourceHashes.find( InAssetRef );
+		return itHash != sourceHashes.end() ? itHash->second : 0;
+	}
+
+	/**
+	 * Prepare incremental cook
+	 * @note Loads shader cache and packages from previous cook and removes from them assets which sources were deleted
+	 * 
+	 * @param InShadersHash Hash of shader sources
+	 */
+	void PrepareIncrementalCook( uint64 InShadersHash );
+
+	/**
+	 * Is cooked asset up to date
+	 * @note Asset is up to date when its source file, source files of all dependencies and shaders (for materials) not changed since last cook
+	 * 
+	 * @param InAssetRef Reference to asset in format <PackageName>:<AssetName>
+	 * @return Return true if cooked asset is up to date, else returning false
+	 */
+	bool IsCookedUpToDate( const std::wstring& InAssetRef );
+
+	/**
+	 * Is need cook resource in this pass
+	 * 
+	 * @param InResourceInfo Info about resource
+	 * @param InIsOnlyAlwaysCook Is need cook only resources with enabled flag bAlwaysCook
+	 * @return Return true if resource need cook, else returning false
+	 */
+	FORCEINLINE bool IsNeedCook( const SResourceInfo& InResourceInfo, bool InIsOnlyAlwaysCook )
+	{
+		std::wstring		assetRef = GetAssetReference( InResourceInfo );
+
+		// Resources which were cooked before we recook always when they changed, else maps will find outdated assets
+		if ( InIsOnlyAlwaysCook && !InResourceInfo.bAlwaysCook && !cookDatabase.FindRecord( assetRef ) )
+		{
+			return false;
+		}
+		return !IsCookedUpToDate( assetRef );
+	}
+
+	/**
+	 * Restore GUID of asset from previous cook
+	 * @note Recooked asset keeps GUID, so references to it from not recooked packages stay valid
+	 * 
+	 * @param InResourceInfo Info about resource
+	 * @param InAsset Asset
+	 */
+	void RestoreAssetGUID( const SResourceInfo& InResourceInfo, CAsset* InAsset ) const;
+
 	/**
 	 * Cook all resources
+	 * @note Resources are cooked by graph of jobs on thread pool. Decoding of source files is executed on worker threads,
+	 * creating of assets and adding them to packages on cooker thread
 	 * 
 	 * @param InIsOnlyAlwaysCook Is need cook only resources with enabled flag bAlwaysCook
+	 * @return Return true if all resources seccussed cooked, else returning false
 	 */
-	void CookAllResources( bool InIsOnlyAlwaysCook = false );
+	bool CookAllResources( bool InIsOnlyAlwaysCook = false );
 
 	/**
 	 * Cook map
@@ -395,6 +515,16 @@ private:
 	 */
 	bool CookMaterial( const SResourceInfo& InMaterialInfo, TAssetHandle<CMaterial>& OutMaterial );
 
+	/**
+	 * Cook material from already parsed source
+	 * 
+	 * @param InMaterialInfo Info about resource
+	 * @param InLMTMaterial Parsed material
+	 * @param OutMaterial Output cooked material
+	 * @return Return true if seccussed cook, else returning false
+	 */
+	bool CookMaterial( const SResourceInfo& InMaterialInfo, const CConfig& InLMTMaterial, TAssetHandle<CMaterial>& OutMaterial );
+
 	/**
 	 * Cook texture 2D
 	 *
@@ -404,6 +534,45 @@ private:
 	 */
 	bool CookTexture2D( const SResourceInfo& InTexture2DInfo, TAssetHandle<CTexture2D>& OutTexture2D );
 
+	/**
+	 * Cook texture 2D from already decoded source
+	 *
+	 * @param InTexture2DInfo Info about resource
+	 * @param InSource Decoded source of texture
+	 * @param OutTexture2D Output cooked texture
+	 * @return Return true if seccussed cook, else returning false
+	 */
+	bool CookTexture2D( const SResourceInfo& InTexture2DInfo, const STexture2DSource& InSource, TAssetHandle<CTexture2D>& OutTexture2D );
+
+	/**
+	 * Decode source file of texture 2D
+	 * @note Thread safe
+	 * 
+	 * @param InPath Path to source texture
+	 * @param OutSource Output decoded source
+	 * @return Return true if seccussed decoded, else returning false
+	 */
+	static bool LoadTexture2DSource( const std::wstring& InPath, STexture2DSource& OutSource );
+
+	/**
+	 * Build decoded source of texture 2D for cook: generate mips and compress them by usage of texture
+	 * @note Thread safe
+	 * 
+	 * @param InTexture2DInfo Info about resource
+	 * @param InOutSource Decoded source of texture with one mip. Its data replaced by data of all mips
+	 */
+	void BuildTexture2DSource( const SResourceInfo& InTexture2DInfo, STexture2DSource& InOutSource ) const;
+
+	/**
+	 * Create texture 2D from decoded source
+	 * 
+	 * @param InPath Path to source texture
+	 * @param InName Name of texture. If is empty string, name getting from path
+	 * @param InSource Decoded source of texture
+	 * @return Return pointer to created texture
+	 */
+	TSharedPtr<CTexture2D> CreateTexture2D( const std::wstring& InPath, const std::wstring& InName, const STexture2DSource& InSource );
+
 	/**
 	 * Cook audio bank
 	 * 
@@ -422,6 +591,16 @@ private:
 	 */
 	bool CookPhysMaterial( const SResourceInfo& InPhysMaterialInfo, TAssetHandle<CPhysicsMaterial>& OutPhysMaterial );
 
+	/**
+	 * Cook physics material from already parsed source
+	 *
+	 * @param InPhysMaterialInfo Info about physics material
+	 * @param InPMTMaterial Parsed physics material
+	 * @param OutPhysMaterial Output cooked physics material
+	 * @return Return true if seccussed cook, else returning false
+	 */
+	bool CookPhysMaterial( const SResourceInfo& InPhysMaterialInfo, const CConfig& InPMTMaterial, TAssetHandle<CPhysicsMaterial>& OutPhysMaterial );
+
 	/**
 	 * Insert resource to list
 	 * 
@@ -460,15 +639,24 @@ private:
 	}
 
 	/**
-	 * Save to package
+	 * Add asset to cooked package
+	 * @note Package is not written here, all cooked packages are written once by SavePackages
 	 * 
 	 * @param InResourceInfo Resource info
 	 * @param InAsset Asset for save
-	 * @return Return true if package saved seccussed, else return false
+	 * @return Return true if asset added seccussed, else return false
+	 */
+	bool AddToPackage( const SResourceInfo& InResourceInfo, const TAssetHandle<CAsset>& InAsset );
+
+	/**
+	 * Save all changed cooked packages
+	 * @return Return true if all packages saved seccussed, else return false
 	 */
-	bool SaveToPackage( const SResourceInfo& InResourceInfo, const TAssetHandle<CAsset>& InAsset );
+	bool SavePackages();
 
 	SExtensionInfo											extensionInfo;			/**< Info about extensions of output formats */
+	STextureCompressionInfo									textureCompressionInfo;	/**< Settings of texture compression */
+	STextureMipsInfo										textureMipsInfo;		/**< Settings of generation of texture mips */
 	ResourceMap_t											texturesMap;			/**< All textures */
 	ResourceMap_t											materialsMap;			/**< All materials */
 	ResourceMap_t											audiosMap;				/**< All audios */
@@ -477,6 +665,11 @@ private:
 	CShaderCache											shaderCache;			/**< Cooked shader cache */
 	EShaderPlatform											cookedShaderPlatform;	/**< Cooked shader platform */
 	EPlatformType											cookedPlatform;			/**< Cooked platform */
+	CCookDatabase											cookDatabase;			/**< Database of cooked assets */
+	std::unordered_map< std::wstring, uint64 >				sourceHashes;			/**< Hashes of source files. Key is <PackageName>:<AssetName> */
+	std::unordered_map< std::wstring, bool >				upToDateAssets;			/**< Cache of checked assets for up to date */
+	std::unordered_map< std::wstring, PackageRef_t >		changedPackages;		/**< Cooked packages which need to save. Key is path to package */
+	bool													bShaderCacheLoaded;		/**< Is shader cache loaded from previous cook */
 };
 
 #endif // !COOKPACKAGESCOMMANDLET_H
\ No newline at end of file
@@ -0,0 +1,61 @@
+/**
+ * @file
+ * @addtogroup WorldEd World editor
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef HASHBENCHMARKCOMMANDLET_H
+#define HASHBENCHMARKCOMMANDLET_H
+
+#include "Commandlets/BaseCommandlet.h"
+
+/**
+ * @ingroup WorldEd
+ * Commandlet for measure throughput and quality of appMemFastHash
+ *
+ * Compares speed of CFastHash with old byte at a time hash on different sizes of data, checks that hash by parts
+ * gives the same result as hash at once, counts collisions on sequential keys and measures avalanche of bits.
+ * Usage: -commandlet HashBenchmark [-size <MB of data for throughput test>]
+ */
+class CHashBenchmarkCommandlet : public CBaseCommandlet
+{
+	DECLARE_CLASS( CHashBenchmarkCommandlet, CBaseCommandlet )
+
+public:
+	/**
+	 * Main method of execute commandlet
+	 *
+	 * @param InCommandLine		Command line
+	 * @return Return TRUE if commandlet executed is seccussed, otherwise will return FALSE
+	 */
+	virtual bool Main( const CCommandLine& InCommandLine ) override;
+
+private:
+	/**
+	 * Measure throughput of hash functions
+	 * @param InTotalSize	Total size of data to hash for every size of key
+	 */
+	void MeasureThroughput( uint64 InTotalSize );
+
+	/**
+	 * Check that hash by parts gives the same result as hash at once
+	 * @return Return TRUE if all results are the same, otherwise returns FALSE
+	 */
+	bool CheckStreaming();
+
+	/**
+	 * Count collisions of hash on sequential keys
+	 * @return Return TRUE if number of collisions isn't much greater than expected for random hash, otherwise returns FALSE
+	 */
+	bool CheckCollisions();
+
+	/**
+	 * Measure avalanche of hash, flip of one bit in key must change half of bits in hash
+	 * @return Return TRUE if avalanche is good, otherwise returns FALSE
+	 */
+	bool CheckAvalanche();
+};
+
+#endif // !HASHBENCHMARKCOMMANDLET_H
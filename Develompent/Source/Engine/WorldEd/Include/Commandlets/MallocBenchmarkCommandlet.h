@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @addtogroup WorldEd World editor
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef MALLOCBENCHMARKCOMMANDLET_H
+#define MALLOCBENCHMARKCOMMANDLET_H
+
+#include "Commandlets/BaseCommandlet.h"
+
+/**
+ * @ingroup WorldEd
+ * Commandlet for check and measure engine allocator
+ *
+ * Checks that memory from CMallocBinned is aligned, not overlapped and keeps content after realloc, then compares
+ * speed of alloc/free pairs of CRT heap and CMallocBinned on one thread and on all threads of thread pool.
+ * Usage: -commandlet MallocBenchmark [-ops <millions of operations on every thread>]
+ */
+class CMallocBenchmarkCommandlet : public CBaseCommandlet
+{
+	DECLARE_CLASS( CMallocBenchmarkCommandlet, CBaseCommandlet )
+
+public:
+	/**
+	 * Main method of execute commandlet
+	 *
+	 * @param InCommandLine		Command line
+	 * @return Return TRUE if commandlet executed is seccussed, otherwise will return FALSE
+	 */
+	virtual bool Main( const CCommandLine& InCommandLine ) override;
+
+private:
+	/**
+	 * Check correctness of engine allocator
+	 * @return Return TRUE if all checks are passed, otherwise returns FALSE
+	 */
+	bool CheckCorrectness();
+
+	/**
+	 * Measure speed of allocators
+	 * @param InNumOps		Number of operations on every thread
+	 */
+	void MeasureSpeed( uint32 InNumOps );
+};
+
+#endif // !MALLOCBENCHMARKCOMMANDLET_H
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @addtogroup WorldEd WorldEd
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef COOKDATABASE_H
+#define COOKDATABASE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Core.h"
+#include "Misc/Guid.h"
+#include "System/Package.h"
+
+/**
+ * @ingroup WorldEd
+ * @brief Persistent database of cooked assets
+ *
+ * For every cooked asset database keeps hash of source file, GUID of asset in cooked package and
+ * references to assets from which it depends. Cooker uses it for skip assets which inputs not changed
+ * since last cook and for keep GUIDs of recooked assets, so references to them from other packages stay valid
+ */
+class CCookDatabase
+{
+public:
+	/**
+	 * @brief Record about cooked asset
+	 */
+	struct SRecord
+	{
+		/**
+		 * @brief Constructor
+		 */
+		SRecord()
+			: type( AT_Unknown )
+			, sourceHash( 0 )
+		{}
+
+		EAssetType						type;				/**< Asset type */
+		CGuid							guid;				/**< GUID of asset in cooked package */
+		uint64							sourceHash;			/**< Hash of source file */
+		std::vector<std::wstring>		dependencies;		/**< References to assets from which depends this asset (<PackageName>:<AssetName>) */
+	};
+
+	/**
+	 * @brief Typedef of map records
+	 */
+	typedef std::unordered_map<std::wstring, SRecord>		RecordMap_t;
+
+	/**
+	 * @brief Constructor
+	 */
+	CCookDatabase();
+
+	/**
+	 * @brief Load database from file
+	 * @note If database in file was created by other version of cooker or with other settings, it is not loaded
+	 *
+	 * @param InPath			Path to file
+	 * @param InCookerVersion	Version of cooker
+	 * @param InSettingsHash	Hash of cook settings (platform, cooking of editor content, etc)
+	 * @return Return TRUE if database is loaded, else return FALSE
+	 */
+	bool Load( const std::wstring& InPath, uint32 InCookerVersion, uint64 InSettingsHash );
+
+	/**
+	 * @brief Save database to file
+	 *
+	 * @param InPath	Path to file
+	 * @return Return TRUE if database is saved, else return FALSE
+	 */
+	bool Save( const std::wstring& InPath ) const;
+
+	/**
+	 * @brief Remove all records
+	 */
+	void Clear();
+
+	/**
+	 * @brief Find record about cooked asset
+	 *
+	 * @param InAssetRef	Reference to asset in format <PackageName>:<AssetName>
+	 * @return Return pointer to record, if not found return NULL
+	 */
+	FORCEINLINE const SRecord* FindRecord( const std::wstring& InAssetRef ) const
+	{
+		auto	itRecord = records.find( InAssetRef );
+		return itRecord != records.end() ? &itRecord->second : nullptr;
+	}
+
+	/**
+	 * @brief Set record about cooked asset
+	 *
+	 * @param InAssetRef	Reference to asset in format <PackageName>:<AssetName>
+	 * @param InRecord		Record
+	 */
+	FORCEINLINE void SetRecord( const std::wstring& InAssetRef, const SRecord& InRecord )
+	{
+		records[ InAssetRef ] = InRecord;
+	}
+
+	/**
+	 * @brief Remove record about cooked asset
+	 * @param InAssetRef	Reference to asset in format <PackageName>:<AssetName>
+	 */
+	FORCEINLINE void RemoveRecord( const std::wstring& InAssetRef )
+	{
+		records.erase( InAssetRef );
+	}
+
+	/**
+	 * @brief Get all records
+	 * @return Return map of all records
+	 */
+	FORCEINLINE const RecordMap_t& GetRecords() const
+	{
+		return records;
+	}
+
+	/**
+	 * @brief Set hash of shader sources which were used for cook materials
+	 * @param InShadersHash		Hash of shader sources
+	 */
+	FORCEINLINE void SetShadersHash( uint64 InShadersHash )
+	{
+		shadersHash = InShadersHash;
+	}
+
+	/**
+	 * @brief Get hash of shader sources which were used for cook materials
+	 * @return Return hash of shader sources
+	 */
+	FORCEINLINE uint64 GetShadersHash() const
+	{
+		return shadersHash;
+	}
+
+	/**
+	 * @brief Calculate hash of file content
+	 * @note Thread safe
+	 *
+	 * @param InPath	Path to file
+	 * @return Return hash of file content. If file not opened return 0
+	 */
+	static uint64 HashFile( const std::wstring& InPath );
+
+	/**
+	 * @brief Calculate hash of names and contents of all files in directory and subdirectories
+	 *
+	 * @param InPath	Path to directory
+	 * @param InHash	Start hash
+	 * @return Return hash of directory
+	 */
+	static uint64 HashDirectory( const std::wstring& InPath, uint64 InHash = 0 );
+
+private:
+	uint32				cookerVersion;		/**< Version of cooker */
+	uint64				settingsHash;		/**< Hash of cook settings */
+	uint64				shadersHash;		/**< Hash of shader sources */
+	RecordMap_t			records;			/**< Records about cooked assets */
+};
+
+#endif // !COOKDATABASE_H
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @addtogroup WorldEd WorldEd
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef COOKJOBGRAPH_H
+#define COOKJOBGRAPH_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "Core.h"
+#include "System/ThreadingBase.h"
+#include "System/ThreadPool.h"
+
+/**
+ * @ingroup WorldEd
+ * @brief Graph of cook jobs with dependencies between them
+ *
+ * Every job has two parts. Work is executed on thread pool and must not touch package manager,
+ * world and render resources. Finish is executed on cooker thread in order of dependencies,
+ * here assets are created and added to packages
+ */
+class CCookJobGraph
+{
+public:
+	/**
+	 * @brief Typedef of job function
+	 * @return Return TRUE if job is successfully done, else return FALSE
+	 */
+	typedef std::function<bool()>		JobFunction_t;
+
+	/**
+	 * @brief Constructor
+	 */
+	CCookJobGraph();
+
+	/**
+	 * @brief Add job to graph
+	 *
+	 * @param InName		Name of job for log
+	 * @param InWork		Work executed on thread pool. Can be NULL
+	 * @param InFinish		Finish executed on cooker thread after work. Can be NULL
+	 * @return Return index of job
+	 */
+	uint32 AddJob( const std::wstring& InName, const JobFunction_t& InWork, const JobFunction_t& InFinish );
+
+	/**
+	 * @brief Add dependency between jobs
+	 * @note Finish of dependency is always executed before work of job
+	 *
+	 * @param InJob				Index of job
+	 * @param InDependency		Index of job from which InJob depends
+	 */
+	void AddDependency( uint32 InJob, uint32 InDependency );
+
+	/**
+	 * @brief Execute all jobs
+	 * @note If any job failed, not started jobs are skipped
+	 *
+	 * @param OutFailedJob		Output name of failed job
+	 * @return Return TRUE if all jobs successfully done, else return FALSE
+	 */
+	bool Execute( std::wstring& OutFailedJob );
+
+	/**
+	 * @brief Get number of jobs
+	 * @return Return number of jobs
+	 */
+	FORCEINLINE uint32 GetNumJobs() const
+	{
+		return jobs.size();
+	}
+
+private:
+	/**
+	 * @brief Cook job
+	 */
+	struct SJob
+	{
+		std::wstring				name;				/**< Name of job */
+		JobFunction_t				work;				/**< Work executed on thread pool */
+		JobFunction_t				finish;				/**< Finish executed on cooker thread */
+		std::vector<uint32>			dependents;			/**< Jobs which depend from this job */
+		uint32						numDependencies;	/**< Number of not finished dependencies */
+		bool						bResult;			/**< Result of work */
+	};
+
+	/**
+	 * @brief Work of thread pool executing work of cook job
+	 */
+	class CJobWork : public CQueuedWork
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * @param InGraph	Owner graph
+		 * @param InIndex	Index of job
+		 */
+		CJobWork( CCookJobGraph* InGraph = nullptr, uint32 InIndex = 0 )
+			: graph( InGraph )
+			, index( InIndex )
+		{}
+
+		/**
+		 * @brief Do work
+		 */
+		virtual void DoThreadedWork() override;
+
+		/**
+		 * @brief Abandon work
+		 * @note Pool is not able to execute work, so we do it right here
+		 */
+		virtual void Abandon() override;
+
+	private:
+		CCookJobGraph*		graph;		/**< Owner graph */
+		uint32				index;		/**< Index of job */
+	};
+
+	/**
+	 * @brief Queue work of job to thread pool
+	 * @param InIndex	Index of job
+	 */
+	void Dispatch( uint32 InIndex );
+
+	std::vector<SJob>			jobs;				/**< Jobs */
+	std::vector<CJobWork>		works;				/**< Works of thread pool for every job */
+	std::vector<uint32>			doneJobs;			/**< Jobs which work is done, but finish is not executed yet */
+	CCriticalSection			cs;					/**< Critical section for doneJobs */
+	CEvent*						doneEvent;			/**< Event triggered when work of job is done */
+};
+
+#endif // !COOKJOBGRAPH_H
@@ -276,8 +276,8 @@ private:
 	Vector2D													axisXEnd;						/**< Axis X end in screen coord */
 	Vector2D													axisYEnd;						/**< Axis Y end in screen coord */
 	Vector2D													axisZEnd;						/**< Axis Z end in screen coord */
-	SEditorDelegates::COnEditorModeChanged::DelegateType_t*		editorModeChangedDelegate;		/**< Editor mode changed delegate */
-	COnUpdateAllGizmo::DelegateType_t*							updateAllGizmoDelegate;			/**< Update all gizmo delegate */
+	CDelegateHandle												editorModeChangedDelegate;		/**< Editor mode changed delegate */
+	CDelegateHandle												updateAllGizmoDelegate;			/**< Update all gizmo delegate */
 	static COnUpdateAllGizmo									onUpdateAllGizmo;				/**< Event when update all gizmo */
 };
 
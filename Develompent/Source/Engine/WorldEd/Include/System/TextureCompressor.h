@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @addtogroup WorldEd WorldEd
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef TEXTURECOMPRESSOR_H
+#define TEXTURECOMPRESSOR_H
+
+#include <string>
+#include <vector>
+
+#include "Core.h"
+#include "RHI/BaseSurfaceRHI.h"
+
+/**
+ * @ingroup WorldEd
+ * @brief Enumeration of texture usages. By usage cooker chooses compression format
+ */
+enum ETextureUsage
+{
+	TU_Albedo,			/**< Color texture. Compressed to BC1, with alpha to BC3, on high quality to BC7 */
+	TU_Normal,			/**< Normal map. Compressed to BC5, only X and Y are stored, Z must be reconstructed in shader */
+	TU_Mask,			/**< Grayscale mask in red channel. Compressed to BC4 */
+	TU_Uncompressed		/**< Texture not compressed (UI, pixel perfect sprites) */
+};
+
+/**
+ * @ingroup WorldEd
+ * @brief Enumeration of quality presets of texture compression
+ */
+enum ETextureCompressionQuality
+{
+	TCQ_Fast,			/**< Endpoints by bounding box of block, without refinement */
+	TCQ_Normal,			/**< Endpoints by principal axis of block with one refinement */
+	TCQ_High			/**< Endpoints by principal axis of block with several refinements, albedo compressed to BC7 */
+};
+
+/**
+ * @ingroup WorldEd
+ * @brief Convert text to ETextureUsage
+ *
+ * @param InString	String
+ * @return Return texture usage, if string is not valid returns TU_Albedo
+ */
+ETextureUsage appTextToETextureUsage( const std::wstring& InString );
+
+/**
+ * @ingroup WorldEd
+ * @brief Convert text to ETextureCompressionQuality
+ *
+ * @param InString	String
+ * @return Return quality of compression, if string is not valid returns TCQ_Normal
+ */
+ETextureCompressionQuality appTextToETextureCompressionQuality( const std::wstring& InString );
+
+/**
+ * @ingroup WorldEd
+ * @brief CPU encoder of block compressed texture formats (BC1, BC3, BC4, BC5 and BC7)
+ */
+class CTextureCompressor
+{
+public:
+	/**
+	 * @brief Get pixel format for texture
+	 *
+	 * @param InUsage		Usage of texture
+	 * @param InQuality		Quality of compression
+	 * @param InIsHasAlpha	Is texture has not opaque pixels
+	 * @return Return pixel format for compression. If texture must not be compressed returns PF_A8R8G8B8
+	 */
+	static EPixelFormat GetPixelFormat( ETextureUsage InUsage, ETextureCompressionQuality InQuality, bool InIsHasAlpha );
+
+	/**
+	 * @brief Is texture has not opaque pixels
+	 *
+	 * @param InData		Pixels in PF_A8R8G8B8 format
+	 * @param InNumPixels	Number of pixels
+	 * @return Return TRUE if at least one pixel has alpha less 255, else return FALSE
+	 */
+	static bool IsHasAlpha( const byte* InData, uint32 InNumPixels );
+
+	/**
+	 * @brief Is supported pixel format for compression
+	 *
+	 * @param InPixelFormat		Pixel format
+	 * @return Return TRUE if pixel format is supported, else return FALSE
+	 */
+	static bool IsSupportedFormat( EPixelFormat InPixelFormat );
+
+	/**
+	 * @brief Compress texture
+	 * @note Thread safe. Blocks are compressed in parallel on thread pool.
+	 * Size of texture can be not multiple of 4 (small mips), partial blocks are padded by edge pixels
+	 *
+	 * @param InData			Pixels in PF_A8R8G8B8 format
+	 * @param InSizeX			Width of texture
+	 * @param InSizeY			Height of texture
+	 * @param InPixelFormat		Pixel format of compressed data
+	 * @param InQuality			Quality of compression
+	 * @param OutData			Output compressed data
+	 * @return Return TRUE if texture compressed, else return FALSE
+	 */
+	static bool Compress( const byte* InData, uint32 InSizeX, uint32 InSizeY, EPixelFormat InPixelFormat, ETextureCompressionQuality InQuality, std::vector<byte>& OutData );
+};
+
+#endif // !TEXTURECOMPRESSOR_H
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @addtogroup WorldEd WorldEd
+ *
+ * Copyright Broken Singularity, All Rights Reserved.
+ * Authors: Yehor Pohuliaka (zombiHello)
+ */
+
+#ifndef TEXTUREMIPGENERATOR_H
+#define TEXTUREMIPGENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "Core.h"
+
+/**
+ * @ingroup WorldEd
+ * @brief Enumeration of filters for downsampling mips
+ */
+enum EMipFilter
+{
+	MF_Box,			/**< Average of 2x2 pixels. Fast, but a bit blurry and aliased */
+	MF_Kaiser		/**< Kaiser windowed sinc. Keeps details of texture sharper */
+};
+
+/**
+ * @ingroup WorldEd
+ * @brief Convert text to EMipFilter
+ *
+ * @param InString	String
+ * @return Return mip filter, if string is not valid returns MF_Kaiser
+ */
+EMipFilter appTextToEMipFilter( const std::wstring& InString );
+
+/**
+ * @ingroup WorldEd
+ * @brief Generator of mip chain for textures
+ */
+class CTextureMipGenerator
+{
+public:
+	/**
+	 * @brief Calculate number of mips in full mip chain
+	 *
+	 * @param InSizeX	Width of texture
+	 * @param InSizeY	Height of texture
+	 * @return Return number of mips down to 1x1
+	 */
+	static uint32 CalcNumMips( uint32 InSizeX, uint32 InSizeY );
+
+	/**
+	 * @brief Generate mip chain
+	 * @note Thread safe. Rows of mips are filtered in parallel on thread pool
+	 *
+	 * Every mip is filtered from previous one in linear space with premultiplied alpha,
+	 * so transparent pixels not bleed to opaque ones. Vectors of normal maps are renormalized after filtering,
+	 * because average of unit vectors is shorter than one and lighting becomes dark on far mips
+	 *
+	 * @param InData		Pixels of top mip in PF_A8R8G8B8 format
+	 * @param InSizeX		Width of texture
+	 * @param InSizeY		Height of texture
+	 * @param InNumMips		Number of mips to generate, including top mip
+	 * @param InFilter		Filter for downsampling
+	 * @param InIsSRGB		Is color stored in sRGB space. If TRUE, color is converted to linear space before filtering
+	 * @param InIsNormalMap	Is texture a normal map. If TRUE, RGB is renormalized to unit vector in every texel of mips
+	 * @param OutMips		Output mips in PF_A8R8G8B8 format. First one is copy of top mip
+	 */
+	static void Generate( const byte* InData, uint32 InSizeX, uint32 InSizeY, uint32 InNumMips, EMipFilter InFilter, bool InIsSRGB, bool InIsNormalMap, std::vector< std::vector<byte> >& OutMips );
+};
+
+#endif // !TEXTUREMIPGENERATOR_H
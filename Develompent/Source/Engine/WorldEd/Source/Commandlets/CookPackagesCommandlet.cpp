@@ -19,6 +19,8 @@
 #include "System/AudioBuffer.h"
 #include "Logger/LoggerMacros.h"
 #include "Render/Shaders/ShaderCompiler.h"
+#include "System/CookJobGraph.h"
+#include "System/ThreadPool.h"
 
 // Actors
 #include "Actors/PlayerStart.h"
@@ -36,6 +38,9 @@ IMPLEMENT_CLASS( CCookPackagesCommandlet )
 /** Default map extension */
 #define DEFAULT_MAP_EXTENSION			TEXT( "map" )
 
+/** Version of cooker. Increase it when format of cooked assets or shader cache is changed, all content will be recooked */
+#define COOKER_VERSION					5
+
 /**
  * Struct of TMX object for spawn actor in world
  */
@@ -69,6 +74,7 @@ FORCEINLINE std::wstring TMXPropertyTypeToText( tmx::Property::Type InTmxPropert
 CCookPackagesCommandlet::CCookPackagesCommandlet()
 	: cookedShaderPlatform( SP_Unknown )
 	, cookedPlatform( PLATFORM_Unknown )
+	, bShaderCacheLoaded( false )
 {}
 
 /**
@@ -417,8 +423,6 @@ void CCookPackagesCommandlet::SpawnActorsInWorld( const tmx::Map& InTMXMap, cons
 
 bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo, TAssetHandle<CMaterial>& OutMaterial )
 {
-	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking material '%s:%s'" ), InMaterialInfo.packageName.c_str(), InMaterialInfo.filename.c_str() );
-
 	// Parse material in JSON format
 	CConfig		lmtMaterial;
 	{
@@ -427,7 +431,15 @@ bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo,
 		delete arMaterial;
 	}
 
+	return CookMaterial( InMaterialInfo, lmtMaterial, OutMaterial );
+}
+
+bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo, const CConfig& InLMTMaterial, TAssetHandle<CMaterial>& OutMaterial )
+{
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking material '%s:%s'" ), InMaterialInfo.packageName.c_str(), InMaterialInfo.filename.c_str() );
+
 	// Getting general data
+	const CConfig&		lmtMaterial				= InLMTMaterial;
 	bool				bIsEditorContent		= lmtMaterial.GetValue( TEXT( "Material" ), TEXT( "IsEditorContent" ) ).GetBool();
 	if ( bIsEditorContent && !GIsCookEditorContent )
 	{
@@ -478,6 +490,7 @@ bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo,
 
 	// Getting shader types
 	std::vector< CShaderMetaType* >		shaderMetaTypes;
+	std::vector< SShaderCompileJob >	shaderCompileJobs;
 	{
 		CConfigValue	configVarShadersType = lmtMaterial.GetValue( TEXT( "Material" ), TEXT( "ShadersType" ) );
 		check( configVarShadersType.GetType() == CConfigValue::T_Array );
@@ -501,21 +514,26 @@ bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo,
 					continue;
 				}
 
-				std::wstring				errorMsg;
-				CShaderCompiler				shaderCompiler;
 				CVertexFactoryMetaType*		vfType = CVertexFactoryMetaType::SContainerVertexFactoryMetaType::Get()->FindRegisteredType( usedVertexFectories[ index ] );
-				bool						result = shaderCompiler.CompileShader( shaderMetaType, cookedShaderPlatform, shaderCache, errorMsg, vfType );
-				if ( !result )
-				{
-					appErrorf( TEXT( "Failed cached shader '%s' for vertex factory '%s'\n\n%s" ), shaderMetaTypeName.c_str(), vfType->GetName().c_str(), errorMsg.c_str() );
-					return false;
-				}
+				shaderCompileJobs.push_back( SShaderCompileJob( shaderMetaType, vfType ) );
 			}
 
 			shaderMetaTypes.push_back( shaderMetaType );
 		}
 	}
 
+	// Compile all missing shaders of material at once, they are compiled concurrently
+	if ( !shaderCompileJobs.empty() )
+	{
+		std::wstring		errorMsg;
+		CShaderCompiler		shaderCompiler;
+		if ( !shaderCompiler.CompileShaders( shaderCompileJobs, cookedShaderPlatform, shaderCache, errorMsg ) )
+		{
+			appErrorf( TEXT( "Failed cached shaders of material '%s'\n\n%s" ), InMaterialInfo.filename.c_str(), errorMsg.c_str() );
+			return false;
+		}
+	}
+
 	// Getting scalar parameters
 	std::unordered_map< std::wstring, float >		scalarParameters;
 	{
@@ -589,6 +607,7 @@ bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo,
 	materialRef->SetTwoSided( bIsTwoSided );
 	materialRef->SetWireframe( bIsWireframe );
 	materialRef->SetUsageFlags( usageFlags );
+	RestoreAssetGUID( InMaterialInfo, materialRef.Get() );
 
 	// Set scalar parameters
 	for ( auto it = scalarParameters.begin(), itEnd = scalarParameters.end(); it != itEnd; ++it )
@@ -604,8 +623,8 @@ bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo,
 
 	OutMaterial = TAssetHandle<CMaterial>( materialRef, MakeSharedPtr<SAssetReference>( AT_Material, materialRef->GetGUID() ) );
 
-	// Save to package
-	return SaveToPackage( InMaterialInfo, OutMaterial );
+	// Add to package
+	return AddToPackage( InMaterialInfo, OutMaterial );
 }
 
 /**
@@ -615,17 +634,105 @@ bool CCookPackagesCommandlet::CookMaterial( const SResourceInfo& InMaterialInfo,
  */
 
 TSharedPtr<CTexture2D> CCookPackagesCommandlet::ConvertTexture2D( const std::wstring& InPath, const std::wstring& InName /* = TEXT( "" ) */ )
+{
+	STexture2DSource		source;
+	if ( !LoadTexture2DSource( InPath, source ) )
+	{
+		return nullptr;
+	}
+
+	return CreateTexture2D( InPath, InName, source );
+}
+
+bool CCookPackagesCommandlet::LoadTexture2DSource( const std::wstring& InPath, STexture2DSource& OutSource )
 {
 	// Loading data from image
 	int				numComponents = 0;
-	uint32			sizeX = 0;
-	uint32			sizeY = 0;
-	void*			data = stbi_load( TCHAR_TO_ANSI( InPath.c_str() ), ( int* ) &sizeX, ( int* ) &sizeY, &numComponents, 4 );
+	int				sizeX = 0;
+	int				sizeY = 0;
+	void*			data = stbi_load( TCHAR_TO_ANSI( InPath.c_str() ), &sizeX, &sizeY, &numComponents, 4 );
 	if ( !data )
 	{
-		return nullptr;
+		return false;
 	}
 
+	OutSource.sizeX			= sizeX;
+	OutSource.sizeY			= sizeY;
+	OutSource.numMips		= 1;
+	OutSource.pixelFormat	= PF_A8R8G8B8;
+	OutSource.data.resize( OutSource.sizeX * OutSource.sizeY * GPixelFormats[ PF_A8R8G8B8 ].blockBytes );
+	memcpy( OutSource.data.data(), data, OutSource.data.size() );
+
+	// Clean up all data
+	stbi_image_free( data );
+	return true;
+}
+
+void CCookPackagesCommandlet::BuildTexture2DSource( const SResourceInfo& InTexture2DInfo, STexture2DSource& InOutSource ) const
+{
+	check( InOutSource.pixelFormat == PF_A8R8G8B8 && InOutSource.numMips == 1 );
+
+	// Getting usage of texture by suffix of file name
+	ETextureUsage		usage = textureCompressionInfo.defaultUsage;
+	for ( uint32 index = 0, count = textureCompressionInfo.usageSuffixes.size(); index < count; ++index )
+	{
+		const std::wstring&		suffix = textureCompressionInfo.usageSuffixes[ index ].first;
+		if ( InTexture2DInfo.filename.size() >= suffix.size() && InTexture2DInfo.filename.compare( InTexture2DInfo.filename.size() - suffix.size(), suffix.size(), suffix ) == 0 )
+		{
+			usage = textureCompressionInfo.usageSuffixes[ index ].second;
+			break;
+		}
+	}
+
+	// Generate mips. Colors of albedo and uncompressed textures are in sRGB space, normals and masks are linear
+	std::vector< std::vector< byte > >		mips;
+	uint32									numMips = textureMipsInfo.bEnable ? CTextureMipGenerator::CalcNumMips( InOutSource.sizeX, InOutSource.sizeY ) : 1;
+	CTextureMipGenerator::Generate( InOutSource.data.data(), InOutSource.sizeX, InOutSource.sizeY, numMips, textureMipsInfo.filter, usage == TU_Albedo || usage == TU_Uncompressed, usage == TU_Normal, mips );
+
+	EPixelFormat		pixelFormat = textureCompressionInfo.bEnable ? CTextureCompressor::GetPixelFormat( usage, textureCompressionInfo.quality, CTextureCompressor::IsHasAlpha( InOutSource.data.data(), InOutSource.sizeX * InOutSource.sizeY ) ) : PF_A8R8G8B8;
+	
+	// Block compression works with blocks 4x4, so size of top mip must be multiple of it
+	if ( pixelFormat != PF_A8R8G8B8 && ( InOutSource.sizeX % GPixelFormats[ pixelFormat ].blockSizeX != 0 || InOutSource.sizeY % GPixelFormats[ pixelFormat ].blockSizeY != 0 ) )
+	{
+		LE_LOG( LT_Warning, LC_Commandlet, TEXT( "Texture 2D '%s:%s' has size %ix%i which not multiple of %ix%i, it will not be compressed" ), InTexture2DInfo.packageName.c_str(), InTexture2DInfo.filename.c_str(), InOutSource.sizeX, InOutSource.sizeY, GPixelFormats[ pixelFormat ].blockSizeX, GPixelFormats[ pixelFormat ].blockSizeY );
+		pixelFormat = PF_A8R8G8B8;
+	}
+
+	// Compress all mips
+	std::vector< byte >		data;
+	if ( pixelFormat != PF_A8R8G8B8 )
+	{
+		data.reserve( CalcTextureSize( pixelFormat, InOutSource.sizeX, InOutSource.sizeY, numMips ) );
+		for ( uint32 mipIndex = 0; mipIndex < numMips; ++mipIndex )
+		{
+			std::vector< byte >		compressedMip;
+			if ( !CTextureCompressor::Compress( mips[ mipIndex ].data(), Max<uint32>( InOutSource.sizeX >> mipIndex, 1 ), Max<uint32>( InOutSource.sizeY >> mipIndex, 1 ), pixelFormat, textureCompressionInfo.quality, compressedMip ) )
+			{
+				LE_LOG( LT_Warning, LC_Commandlet, TEXT( "Failed compressing texture 2D '%s:%s' to %s, it will not be compressed" ), InTexture2DInfo.packageName.c_str(), InTexture2DInfo.filename.c_str(), GPixelFormats[ pixelFormat ].name );
+				pixelFormat = PF_A8R8G8B8;
+				data.clear();
+				break;
+			}
+			data.insert( data.end(), compressedMip.begin(), compressedMip.end() );
+		}
+	}
+
+	if ( pixelFormat == PF_A8R8G8B8 )
+	{
+		data.reserve( CalcTextureSize( pixelFormat, InOutSource.sizeX, InOutSource.sizeY, numMips ) );
+		for ( uint32 mipIndex = 0; mipIndex < numMips; ++mipIndex )
+		{
+			data.insert( data.end(), mips[ mipIndex ].begin(), mips[ mipIndex ].end() );
+		}
+	}
+
+	InOutSource.numMips		= numMips;
+	InOutSource.pixelFormat	= pixelFormat;
+	InOutSource.data.swap( data );
+}
+
+TSharedPtr<CTexture2D> CCookPackagesCommandlet::CreateTexture2D( const std::wstring& InPath, const std::wstring& InName, const STexture2DSource& InSource )
+{
 	// Getting file name from path if InName is empty
 	std::wstring		filename = InName;
 	if ( filename.empty() )
@@ -650,25 +757,31 @@ TSharedPtr<CTexture2D> CCookPackagesCommandlet::ConvertTexture2D( const std::wst
 	TSharedPtr<CTexture2D>		texture2DRef = MakeSharedPtr<CTexture2D>();
 	texture2DRef->SetAssetName( filename );
 	texture2DRef->SetAssetSourceFile( InPath );
+	texture2DRef->SetData( InSource.pixelFormat, InSource.sizeX, InSource.sizeY, InSource.data, InSource.numMips );
+	return texture2DRef;
+}
+
+bool CCookPackagesCommandlet::CookTexture2D( const SResourceInfo& InTexture2DInfo, TAssetHandle<CTexture2D>& OutTexture2D )
+{
+	STexture2DSource		source;
+	if ( !LoadTexture2DSource( InTexture2DInfo.path, source ) )
 	{
-		std::vector< byte >		tempData;
-		tempData.resize( sizeX * sizeY * GPixelFormats[ PF_A8R8G8B8 ].blockBytes );
-		memcpy( tempData.data(), data, tempData.size() );
-		texture2DRef->SetData( PF_A8R8G8B8, sizeX, sizeY, tempData );
+		LE_LOG( LT_Error, LC_Commandlet, TEXT( "Failed loading texture 2D '%s'" ), InTexture2DInfo.path.c_str() );
+		return false;
 	}
 
-	// Clean up all data
-	stbi_image_free( data );
-	return texture2DRef;
+	BuildTexture2DSource( InTexture2DInfo, source );
+	return CookTexture2D( InTexture2DInfo, source, OutTexture2D );
 }
 
-bool CCookPackagesCommandlet::CookTexture2D( const SResourceInfo& InTexture2DInfo, TAssetHandle<CTexture2D>& OutTexture2D )
+bool CCookPackagesCommandlet::CookTexture2D( const SResourceInfo& InTexture2DInfo, const STexture2DSource& InSource, TAssetHandle<CTexture2D>& OutTexture2D )
 {
 	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking texture 2D '%s:%s'" ), InTexture2DInfo.packageName.c_str(), InTexture2DInfo.filename.c_str() );
 	
-	TSharedPtr<CTexture2D>		texture2DRef = ConvertTexture2D( InTexture2DInfo.path, InTexture2DInfo.filename );
+	TSharedPtr<CTexture2D>		texture2DRef = CreateTexture2D( InTexture2DInfo.path, InTexture2DInfo.filename, InSource );
+	RestoreAssetGUID( InTexture2DInfo, texture2DRef.Get() );
 	OutTexture2D				= TAssetHandle<CTexture2D>( texture2DRef, MakeSharedPtr<SAssetReference>( AT_Texture2D, texture2DRef->GetGUID() ) );
-	return OutTexture2D.IsAssetValid() && SaveToPackage( InTexture2DInfo, OutTexture2D );
+	return OutTexture2D.IsAssetValid() && AddToPackage( InTexture2DInfo, OutTexture2D );
 }
 
 /**
@@ -677,9 +790,9 @@ bool CCookPackagesCommandlet::CookTexture2D( const SResourceInfo& InTexture2DInf
  * ---------------------
  */
 
-void CCookPackagesCommandlet::CookAllResources( bool InIsOnlyAlwaysCook /* = false */ )
+bool CCookPackagesCommandlet::CookAllResources( bool InIsOnlyAlwaysCook /* = false */ )
 {
-	// Compile all global shaders
+	// Compile all global shaders. If shader cache reused from previous cook, only missing and outdated ones are compiled
 	{
 		LE_LOG( LT_Log, LC_Commandlet, TEXT( "Compiling global shaders" ) );
 		
@@ -688,46 +801,118 @@ void CCookPackagesCommandlet::CookAllResources( bool InIsOnlyAlwaysCook /* = fal
 		if ( !result )
 		{
 			appErrorf( TEXT( "Failed compiling global shaders" ) );
-			return;
+			return false;
 		}
 	}
 
-	// Cook textures
+	CCookJobGraph								jobGraph;
+	std::unordered_map< std::wstring, uint32 >	textureJobs;		// Key is <PackageName>:<AssetName>
+
+	// Cook textures. Decoding, generation of mips and compression of images are executed on worker threads
 	for ( auto itPackage = texturesMap.begin(), itPackageEnd = texturesMap.end(); itPackage != itPackageEnd; ++itPackage )
 	{
 		for ( auto itAsset = itPackage->second.begin(), itAssetEnd = itPackage->second.end(); itAsset != itAssetEnd; ++itAsset )
 		{
-			if ( InIsOnlyAlwaysCook && !itAsset->second.bAlwaysCook )
+			if ( !IsNeedCook( itAsset->second, InIsOnlyAlwaysCook ) )
 			{
 				continue;
 			}
 
-			TAssetHandle<CTexture2D>		texture2D;
-			bool	result = CookTexture2D( itAsset->second, texture2D );
-			if ( !result )
-			{
-				appErrorf( TEXT( "Failed cooking texture 2D '%s'" ), itAsset->second.filename.c_str() );
-				return;
-			}
+			const SResourceInfo&				resourceInfo	= itAsset->second;
+			TSharedPtr<STexture2DSource>		source			= MakeSharedPtr<STexture2DSource>();
+			uint32								job				= jobGraph.AddJob( CString::Format( TEXT( "texture 2D '%s:%s'" ), resourceInfo.packageName.c_str(), resourceInfo.filename.c_str() ),
+																			   [this, source, &resourceInfo]()
+																			   {
+																				   if ( !LoadTexture2DSource( resourceInfo.path, *source ) )
+																				   {
+																					   return false;
+																				   }
+
+																				   BuildTexture2DSource( resourceInfo, *source );
+																				   return true;
+																			   },
+																			   [this, source, &resourceInfo]()
+																			   {
+																				   TAssetHandle<CTexture2D>		texture2D;
+																				   bool							bResult = CookTexture2D( resourceInfo, *source, texture2D );
+																				   source->data.clear();
+																				   source->data.shrink_to_fit();
+																				   return bResult;
+																			   } );
+			textureJobs.insert( std::make_pair( resourceInfo.packageName + TEXT( ":" ) + resourceInfo.filename, job ) );
 		}
 	}
 
-	// Cook materials
+	// Parse all materials on worker threads, we need them for getting dependencies from textures
+	std::vector< const SResourceInfo* >		materialInfos;
 	for ( auto itPackage = materialsMap.begin(), itPackageEnd = materialsMap.end(); itPackage != itPackageEnd; ++itPackage )
 	{
 		for ( auto itAsset = itPackage->second.begin(), itAssetEnd = itPackage->second.end(); itAsset != itAssetEnd; ++itAsset )
 		{
-			if ( InIsOnlyAlwaysCook && !itAsset->second.bAlwaysCook )
+			if ( IsNeedCook( itAsset->second, InIsOnlyAlwaysCook ) )
+			{
+				materialInfos.push_back( &itAsset->second );
+			}
+		}
+	}
+
+	// Workers can't stop the cook, so failed reads are only marked here and reported after all materials are parsed
+	std::vector< CConfig >		materialConfigs( materialInfos.size() );
+	std::vector< byte >			materialsLoaded( materialInfos.size(), 0 );
+	appParallelFor( materialInfos.size(), [&]( uint32 InIndex )
+	{
+		CArchive*		arMaterial = GFileSystem->CreateFileReader( materialInfos[ InIndex ]->path );
+		if ( arMaterial )
+		{
+			materialConfigs[ InIndex ].Serialize( *arMaterial );
+			materialsLoaded[ InIndex ] = 1;
+			delete arMaterial;
+		}
+	} );
+
+	// Cook materials. Shaders are compiled and materials created on cooker thread after all used textures
+	for ( uint32 index = 0, count = materialInfos.size(); index < count; ++index )
+	{
+		const SResourceInfo&	resourceInfo	= *materialInfos[ index ];
+		const CConfig&			lmtMaterial		= materialConfigs[ index ];
+		if ( !materialsLoaded[ index ] )
+		{
+			// Job of not loaded material fails, so cook is stopped with its name
+			LE_LOG( LT_Error, LC_Commandlet, TEXT( "Failed to open material '%s'" ), resourceInfo.path.c_str() );
+			jobGraph.AddJob( CString::Format( TEXT( "material '%s:%s'" ), resourceInfo.packageName.c_str(), resourceInfo.filename.c_str() ), nullptr, []() { return false; } );
+			continue;
+		}
+
+		uint32					job				= jobGraph.AddJob( CString::Format( TEXT( "material '%s:%s'" ), resourceInfo.packageName.c_str(), resourceInfo.filename.c_str() ),
+																   nullptr,
+																   [this, &resourceInfo, &lmtMaterial]()
+																   {
+																	   TAssetHandle<CMaterial>		material;
+																	   return CookMaterial( resourceInfo, lmtMaterial, material );
+																   } );
+
+		CConfigValue			configVarTextureParameters = lmtMaterial.GetValue( TEXT( "Material" ), TEXT( "TextureParameters" ) );
+		if ( configVarTextureParameters.GetType() != CConfigValue::T_Array )
+		{
+			continue;
+		}
+
+		std::vector< CConfigValue >		configObjects = configVarTextureParameters.GetArray();
+		for ( uint32 indexParameter = 0, countParameters = configObjects.size(); indexParameter < countParameters; ++indexParameter )
+		{
+			std::wstring		packageName;
+			std::wstring		assetName;
+			EAssetType			assetType;
+			if ( !ParseReferenceToAsset( configObjects[ indexParameter ].GetObject().GetValue( TEXT( "AssetReference" ) ).GetString(), packageName, assetName, assetType ) )
 			{
 				continue;
 			}
 
-			TAssetHandle<CMaterial>		material;
-			bool	result = CookMaterial( itAsset->second, material );
-			if ( !result )
+			// Textures which not cooked in this pass, material will cook self
+			auto		itTextureJob = textureJobs.find( packageName + TEXT( ":" ) + assetName );
+			if ( itTextureJob != textureJobs.end() )
 			{
-				appErrorf( TEXT( "Failed cooking material '%s'" ), itAsset->second.filename.c_str() );
-				return;
+				jobGraph.AddDependency( job, itTextureJob->second );
 			}
 		}
 	}
@@ -737,40 +922,65 @@ void CCookPackagesCommandlet::CookAllResources( bool InIsOnlyAlwaysCook /* = fal
 	{
 		for ( auto itAsset = itPackage->second.begin(), itAssetEnd = itPackage->second.end(); itAsset != itAssetEnd; ++itAsset )
 		{
-			if ( InIsOnlyAlwaysCook && !itAsset->second.bAlwaysCook )
+			if ( !IsNeedCook( itAsset->second, InIsOnlyAlwaysCook ) )
 			{
 				continue;
 			}
 
-			TAssetHandle<CAudioBank>	audioBank;
-			bool	result = CookAudioBank( itAsset->second, audioBank );
-			if ( !result )
-			{
-				appErrorf( TEXT( "Failed cooking audio bank '%s'" ), itAsset->second.filename.c_str() );
-				return;
-			}
+			const SResourceInfo&	resourceInfo = itAsset->second;
+			jobGraph.AddJob( CString::Format( TEXT( "audio bank '%s:%s'" ), resourceInfo.packageName.c_str(), resourceInfo.filename.c_str() ),
+							 nullptr,
+							 [this, &resourceInfo]()
+							 {
+								 TAssetHandle<CAudioBank>	audioBank;
+								 return CookAudioBank( resourceInfo, audioBank );
+							 } );
 		}
 	}
 
-	// Cook physics material
+	// Cook physics material. Parsing of source is executed on worker threads
 	for ( auto itPackage = physMaterialsMap.begin(), itPackageEnd = physMaterialsMap.end(); itPackage != itPackageEnd; ++itPackage )
 	{
 		for ( auto itAsset = itPackage->second.begin(), itAssetEnd = itPackage->second.end(); itAsset != itAssetEnd; ++itAsset )
 		{
-			if ( InIsOnlyAlwaysCook && !itAsset->second.bAlwaysCook )
+			if ( !IsNeedCook( itAsset->second, InIsOnlyAlwaysCook ) )
 			{
 				continue;
 			}
 
-			TAssetHandle<CPhysicsMaterial>		physMaterial;
-			bool					result = CookPhysMaterial( itAsset->second, physMaterial );
-			if ( !result )
-			{
-				appErrorf( TEXT( "Failed cooking physics material '%s'" ), itAsset->second.filename.c_str() );
-				return;
-			}
+			const SResourceInfo&	resourceInfo	= itAsset->second;
+			TSharedPtr<CConfig>		pmtMaterial		= MakeSharedPtr<CConfig>();
+			jobGraph.AddJob( CString::Format( TEXT( "physics material '%s:%s'" ), resourceInfo.packageName.c_str(), resourceInfo.filename.c_str() ),
+							 [pmtMaterial, &resourceInfo]()
+							 {
+								 CArchive*		arMaterial = GFileSystem->CreateFileReader( resourceInfo.path );
+								 if ( !arMaterial )
+								 {
+									 return false;
+								 }
+
+								 pmtMaterial->Serialize( *arMaterial );
+								 delete arMaterial;
+								 return true;
+							 },
+							 [this, pmtMaterial, &resourceInfo]()
+							 {
+								 TAssetHandle<CPhysicsMaterial>		physMaterial;
+								 return CookPhysMaterial( resourceInfo, *pmtMaterial, physMaterial );
+							 } );
 		}
 	}
+
+	// Execute all jobs
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking %i resources on %i worker threads" ), jobGraph.GetNumJobs(), GThreadPool ? GThreadPool->GetNumThreads() : 0 );
+	std::wstring		failedJob;
+	if ( !jobGraph.Execute( failedJob ) )
+	{
+		appErrorf( TEXT( "Failed cooking %s" ), failedJob.c_str() );
+		return false;
+	}
+
+	return true;
 }
 
 /**
@@ -815,8 +1025,9 @@ bool CCookPackagesCommandlet::CookAudioBank( const SResourceInfo& InAudioBankInf
 	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking audio bank '%s:%s'" ), InAudioBankInfo.packageName.c_str(), InAudioBankInfo.filename.c_str() );
 	
 	TSharedPtr<CAudioBank>		audioBankRef = ConvertAudioBank( InAudioBankInfo.path, InAudioBankInfo.filename );
+	RestoreAssetGUID( InAudioBankInfo, audioBankRef.Get() );
 	OutAudioBank				= TAssetHandle<CAudioBank>( audioBankRef, MakeSharedPtr<SAssetReference>( AT_AudioBank, audioBankRef->GetGUID() ) );
-	return OutAudioBank.IsAssetValid() && SaveToPackage( InAudioBankInfo, OutAudioBank );
+	return OutAudioBank.IsAssetValid() && AddToPackage( InAudioBankInfo, OutAudioBank );
 }
 
 /**
@@ -827,8 +1038,6 @@ bool CCookPackagesCommandlet::CookAudioBank( const SResourceInfo& InAudioBankInf
 
 bool CCookPackagesCommandlet::CookPhysMaterial( const SResourceInfo& InPhysMaterialInfo, TAssetHandle<CPhysicsMaterial>& OutPhysMaterial )
 {
-	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking physics material '%s:%s'" ), InPhysMaterialInfo.packageName.c_str(), InPhysMaterialInfo.filename.c_str() );
-	
 	// Parse physics material in JSON format
 	CConfig		pmtMaterial;
 	{
@@ -837,7 +1046,15 @@ bool CCookPackagesCommandlet::CookPhysMaterial( const SResourceInfo& InPhysMater
 		delete arMaterial;
 	}
 
+	return CookPhysMaterial( InPhysMaterialInfo, pmtMaterial, OutPhysMaterial );
+}
+
+bool CCookPackagesCommandlet::CookPhysMaterial( const SResourceInfo& InPhysMaterialInfo, const CConfig& InPMTMaterial, TAssetHandle<CPhysicsMaterial>& OutPhysMaterial )
+{
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cooking physics material '%s:%s'" ), InPhysMaterialInfo.packageName.c_str(), InPhysMaterialInfo.filename.c_str() );
+
 	// Getting general data
+	const CConfig&	pmtMaterial		= InPMTMaterial;
 	float			staticFriction	= pmtMaterial.GetValue( TEXT( "PhysicsMaterial" ), TEXT( "StaticFriction" ) ).GetNumber();
 	float			dynamicFriction	= pmtMaterial.GetValue( TEXT( "PhysicsMaterial" ), TEXT( "DynamicFriction" ) ).GetNumber();
 	float			restitution		= pmtMaterial.GetValue( TEXT( "PhysicsMaterial" ), TEXT( "Restitution" ) ).GetNumber();
@@ -852,10 +1069,11 @@ bool CCookPackagesCommandlet::CookPhysMaterial( const SResourceInfo& InPhysMater
 	physMaterialRef->SetRestitution( restitution );
 	physMaterialRef->SetDensity( density );
 	physMaterialRef->SetSurfaceType( appTextToESurfaceType( surfaceTypeName ) );
+	RestoreAssetGUID( InPhysMaterialInfo, physMaterialRef.Get() );
 
-	// Save to package
+	// Add to package
 	OutPhysMaterial = TAssetHandle<CPhysicsMaterial>( physMaterialRef, MakeSharedPtr<SAssetReference>( AT_PhysicsMaterial, physMaterialRef->GetGUID() ) );
-	return SaveToPackage( InPhysMaterialInfo, OutPhysMaterial );
+	return AddToPackage( InPhysMaterialInfo, OutPhysMaterial );
 }
 
 /**
@@ -864,22 +1082,194 @@ bool CCookPackagesCommandlet::CookPhysMaterial( const SResourceInfo& InPhysMater
  * --------------------
  */
 
-bool CCookPackagesCommandlet::SaveToPackage( const SResourceInfo& InResourceInfo, const TAssetHandle<CAsset>& InAsset )
+bool CCookPackagesCommandlet::AddToPackage( const SResourceInfo& InResourceInfo, const TAssetHandle<CAsset>& InAsset )
 {
-	std::wstring		outputPackage = CString::Format( TEXT( "%s" ) PATH_SEPARATOR TEXT( "%s.%s" ), GCookedDir.c_str(), InResourceInfo.packageName.c_str(), extensionInfo.package.c_str() );
+	// Package we only remember, it will be written once after all assets are cooked
+	std::wstring		outputPackage = GetCookedPackagePath( InResourceInfo.packageName );
 	PackageRef_t			package = GPackageManager->LoadPackage( outputPackage, true );
 	package->Add( InAsset );
+	changedPackages.insert( std::make_pair( outputPackage, package ) );
+
+	// Remember cooked asset and its dependencies in cook database
+	TSharedPtr<CAsset>				assetRef = InAsset.ToSharedPtr();
+	std::wstring					assetReference = GetAssetReference( InResourceInfo );
+	CCookDatabase::SRecord			record;
+	CAsset::SetDependentAssets_t	dependentAssets;
+	record.type			= assetRef->GetType();
+	record.guid			= assetRef->GetGUID();
+	record.sourceHash	= GetSourceHash( assetReference );
+	assetRef->GetDependentAssets( dependentAssets );
+	for ( auto itAsset = dependentAssets.begin(), itAssetEnd = dependentAssets.end(); itAsset != itAssetEnd; ++itAsset )
+	{
+		TSharedPtr<CAsset>		dependentAssetRef = itAsset->ToSharedPtr();
+		if ( dependentAssetRef && dependentAssetRef->GetPackage() )
+		{
+			record.dependencies.push_back( dependentAssetRef->GetPackage()->GetName() + TEXT( ":" ) + dependentAssetRef->GetAssetName() );
+		}
+	}
 
-	bool	result = package->Save( outputPackage );
-	if ( !result )
+	cookDatabase.SetRecord( assetReference, record );
+	upToDateAssets[ assetReference ] = true;
+	return true;
+}
+
+bool CCookPackagesCommandlet::SavePackages()
+{
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Saving %u packages" ), ( uint32 )changedPackages.size() );
+	for ( auto itPackage = changedPackages.begin(), itPackageEnd = changedPackages.end(); itPackage != itPackageEnd; ++itPackage )
 	{
-		appErrorf( TEXT( "Failed saving package '%s'" ), InResourceInfo.packageName.c_str() );
-		return false;
+		if ( !itPackage->second->Save( itPackage->first ) )
+		{
+			appErrorf( TEXT( "Failed saving package '%s'" ), itPackage->first.c_str() );
+			return false;
+		}
 	}
 
+	changedPackages.clear();
 	return true;
 }
 
+std::wstring CCookPackagesCommandlet::GetCookedPackagePath( const std::wstring& InPackageName ) const
+{
+	return CString::Format( TEXT( "%s" ) PATH_SEPARATOR TEXT( "%s.%s" ), GCookedDir.c_str(), InPackageName.c_str(), extensionInfo.package.c_str() );
+}
+
+void CCookPackagesCommandlet::HashSourceFiles()
+{
+	std::vector< const SResourceInfo* >		resourceInfos;
+	const ResourceMap_t*					resourceMaps[] = { &texturesMap, &materialsMap, &audiosMap, &physMaterialsMap };
+	for ( uint32 index = 0; index < ARRAY_COUNT( resourceMaps ); ++index )
+	{
+		for ( auto itPackage = resourceMaps[ index ]->begin(), itPackageEnd = resourceMaps[ index ]->end(); itPackage != itPackageEnd; ++itPackage )
+		{
+			for ( auto itAsset = itPackage->second.begin(), itAssetEnd = itPackage->second.end(); itAsset != itAssetEnd; ++itAsset )
+			{
+				resourceInfos.push_back( &itAsset->second );
+			}
+		}
+	}
+
+	std::vector< uint64 >		hashes( resourceInfos.size() );
+	appParallelFor( resourceInfos.size(), [&]( uint32 InIndex )
+	{
+		hashes[ InIndex ] = CCookDatabase::HashFile( resourceInfos[ InIndex ]->path );
+	} );
+
+	for ( uint32 index = 0, count = resourceInfos.size(); index < count; ++index )
+	{
+		sourceHashes[ GetAssetReference( *resourceInfos[ index ] ) ] = hashes[ index ];
+	}
+}
+
+void CCookPackagesCommandlet::PrepareIncrementalCook( uint64 InShadersHash )
+{
+	// Shader cache from previous cook we reuse. If shaders changed, only items which compile inputs changed are recompiled
+	std::wstring		shaderCachePath = GCookedDir + PATH_SEPARATOR + GShaderManager->GetShaderCacheFilename( cookedShaderPlatform );
+	if ( shaderCache.Load( shaderCachePath ) )
+	{
+		std::wstring		errorMsg;
+		CShaderCompiler		shaderCompiler;
+		if ( cookDatabase.GetShadersHash() == InShadersHash || shaderCompiler.UpdateCache( shaderCache, cookedShaderPlatform, errorMsg ) )
+		{
+			bShaderCacheLoaded = true;
+		}
+		else
+		{
+			// Shaders will be compiled again with cooking materials, so error will be reported there
+			LE_LOG( LT_Warning, LC_Commandlet, TEXT( "Failed updating shader cache from previous cook, all materials will be recooked\n\n%s" ), errorMsg.c_str() );
+			shaderCache = CShaderCache();
+		}
+	}
+
+	// Open packages from previous cook, so they will be in table of contents. Records about assets which
+	// package is missing or which source file is deleted we remove
+	std::unordered_map< std::wstring, PackageRef_t >		packages;
+	std::vector< std::wstring >								removedRecords;
+	const CCookDatabase::RecordMap_t&						records = cookDatabase.GetRecords();
+	for ( auto itRecord = records.begin(), itRecordEnd = records.end(); itRecord != itRecordEnd; ++itRecord )
+	{
+		std::size_t			posSpliter = itRecord->first.find( TEXT( ":" ) );
+		if ( posSpliter == std::wstring::npos )
+		{
+			removedRecords.push_back( itRecord->first );
+			continue;
+		}
+
+		std::wstring		packageName	= itRecord->first.substr( 0, posSpliter );
+		std::wstring		assetName	= itRecord->first.substr( posSpliter + 1 );
+
+		auto				itPackage = packages.find( packageName );
+		if ( itPackage == packages.end() )
+		{
+			std::wstring	packagePath = GetCookedPackagePath( packageName );
+			itPackage		= packages.insert( std::make_pair( packageName, GFileSystem->IsExistFile( packagePath ) ? GPackageManager->LoadPackage( packagePath ) : PackageRef_t() ) ).first;
+		}
+
+		if ( !itPackage->second.IsValid() )
+		{
+			removedRecords.push_back( itRecord->first );
+			continue;
+		}
+
+		const ResourceMap_t*	resourceMap = nullptr;
+		switch ( itRecord->second.type )
+		{
+		case AT_Texture2D:			resourceMap = &texturesMap;			break;
+		case AT_Material:			resourceMap = &materialsMap;		break;
+		case AT_AudioBank:			resourceMap = &audiosMap;			break;
+		case AT_PhysicsMaterial:	resourceMap = &physMaterialsMap;	break;
+		default:					break;
+		}
+
+		SResourceInfo		resourceInfo;
+		if ( !resourceMap || !FindResource( *resourceMap, packageName, assetName, resourceInfo ) )
+		{
+			LE_LOG( LT_Log, LC_Commandlet, TEXT( "Removing asset '%s', source file is deleted" ), itRecord->first.c_str() );
+			itPackage->second->Remove( itRecord->second.guid, true, true );
+			changedPackages.insert( std::make_pair( GetCookedPackagePath( packageName ), itPackage->second ) );
+			removedRecords.push_back( itRecord->first );
+		}
+	}
+
+	for ( uint32 index = 0, count = removedRecords.size(); index < count; ++index )
+	{
+		cookDatabase.RemoveRecord( removedRecords[ index ] );
+	}
+
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Incremental cook: %u assets from previous cook, shader cache %s" ), ( uint32 )cookDatabase.GetRecords().size(), bShaderCacheLoaded ? TEXT( "is reused" ) : TEXT( "is outdated" ) );
+}
+
+bool CCookPackagesCommandlet::IsCookedUpToDate( const std::wstring& InAssetRef )
+{
+	auto		itUpToDate = upToDateAssets.find( InAssetRef );
+	if ( itUpToDate != upToDateAssets.end() )
+	{
+		return itUpToDate->second;
+	}
+
+	// Mark asset as outdated while we check it, this breaks cycles of dependencies
+	upToDateAssets[ InAssetRef ] = false;
+
+	const CCookDatabase::SRecord*	record = cookDatabase.FindRecord( InAssetRef );
+	bool							bUpToDate = record && record->sourceHash == GetSourceHash( InAssetRef ) && ( record->type != AT_Material || bShaderCacheLoaded );
+	for ( uint32 index = 0, count = bUpToDate ? record->dependencies.size() : 0; index < count && bUpToDate; ++index )
+	{
+		bUpToDate = IsCookedUpToDate( record->dependencies[ index ] );
+	}
+
+	upToDateAssets[ InAssetRef ] = bUpToDate;
+	return bUpToDate;
+}
+
+void CCookPackagesCommandlet::RestoreAssetGUID( const SResourceInfo& InResourceInfo, CAsset* InAsset ) const
+{
+	const CCookDatabase::SRecord*	record = cookDatabase.FindRecord( GetAssetReference( InResourceInfo ) );
+	if ( record && record->type == InAsset->GetType() && record->guid.IsValid() )
+	{
+		InAsset->SetGUID( record->guid );
+	}
+}
+
 void CCookPackagesCommandlet::InsertResourceToList( ResourceMap_t& InOutResourceMap, const std::wstring& InPackageName, const std::wstring& InFilename, const SResourceInfo& InResourceInfo )
 {
 	auto		itPackage = InOutResourceMap.find( InPackageName );
@@ -1059,15 +1449,86 @@ bool CCookPackagesCommandlet::Main( const CCommandLine& InCommandLine )
 		}
 	}
 
+	// Getting settings of texture compression
+	{
+		CConfigObject		configObjTextureCompression = GConfig.GetValue( CT_Editor, TEXT( "Editor.CookPackages" ), TEXT( "TextureCompression" ) ).GetObject();
+		textureCompressionInfo.bEnable		= configObjTextureCompression.GetValue( TEXT( "Enable" ) ).GetBool();
+		textureCompressionInfo.quality		= appTextToETextureCompressionQuality( configObjTextureCompression.GetValue( TEXT( "Quality" ) ).GetString() );
+		textureCompressionInfo.defaultUsage	= appTextToETextureUsage( configObjTextureCompression.GetValue( TEXT( "DefaultUsage" ) ).GetString() );
+
+		std::vector< CConfigValue >		configVarUsageSuffixes = configObjTextureCompression.GetValue( TEXT( "UsageSuffixes" ) ).GetArray();
+		for ( uint32 index = 0, count = configVarUsageSuffixes.size(); index < count; ++index )
+		{
+			const CConfigValue&		configUsageSuffixItem = configVarUsageSuffixes[ index ];
+			check( configUsageSuffixItem.GetType() == CConfigValue::T_Object );
+			CConfigObject			objectUsageSuffix = configUsageSuffixItem.GetObject();
+
+			std::wstring		suffix	= objectUsageSuffix.GetValue( TEXT( "Suffix" ) ).GetString();
+			if ( !suffix.empty() )
+			{
+				textureCompressionInfo.usageSuffixes.push_back( std::make_pair( suffix, appTextToETextureUsage( objectUsageSuffix.GetValue( TEXT( "Usage" ) ).GetString() ) ) );
+			}
+		}
+	}
+
+	// Getting settings of texture mips
+	{
+		CConfigObject		configObjTextureMips = GConfig.GetValue( CT_Editor, TEXT( "Editor.CookPackages" ), TEXT( "TextureMips" ) ).GetObject();
+		textureMipsInfo.bEnable	= configObjTextureMips.GetValue( TEXT( "Enable" ) ).GetBool();
+		textureMipsInfo.filter	= appTextToEMipFilter( configObjTextureMips.GetValue( TEXT( "Filter" ) ).GetString() );
+	}
+
+	// Load database of previous cook. If it's outdated or full cook requested, remove cooked dir and cook all from scratch
+	std::wstring		cookDatabasePath	= appGameDir() + ( PATH_SEPARATOR TEXT( "EditorCache" ) PATH_SEPARATOR TEXT( "CookDatabase.bin" ) );
+	uint64				shadersHash			= CCookDatabase::HashDirectory( appShaderDir() );
+	uint64				settingsHash		= 0;
+	{
+		uint32			bCookEditorContent = GIsCookEditorContent ? 1 : 0;
+		settingsHash	= appMemFastHash( &cookedPlatform, sizeof( cookedPlatform ), settingsHash );
+		settingsHash	= appMemFastHash( &cookedShaderPlatform, sizeof( cookedShaderPlatform ), settingsHash );
+		settingsHash	= appMemFastHash( &bCookEditorContent, sizeof( bCookEditorContent ), settingsHash );
+		settingsHash	= appCalcHash( GCookedDir, settingsHash );
+		settingsHash	= appCalcHash( extensionInfo.package, settingsHash );
+
+		// Changing of texture compression and mips settings requires recook of all textures
+		uint32			bCompressTextures	= textureCompressionInfo.bEnable ? 1 : 0;
+		uint32			bGenerateMips		= textureMipsInfo.bEnable ? 1 : 0;
+		settingsHash	= appMemFastHash( &bGenerateMips, sizeof( bGenerateMips ), settingsHash );
+		settingsHash	= appMemFastHash( &textureMipsInfo.filter, sizeof( textureMipsInfo.filter ), settingsHash );
+		settingsHash	= appMemFastHash( &bCompressTextures, sizeof( bCompressTextures ), settingsHash );
+		settingsHash	= appMemFastHash( &textureCompressionInfo.quality, sizeof( textureCompressionInfo.quality ), settingsHash );
+		settingsHash	= appMemFastHash( &textureCompressionInfo.defaultUsage, sizeof( textureCompressionInfo.defaultUsage ), settingsHash );
+		for ( uint32 index = 0, count = textureCompressionInfo.usageSuffixes.size(); index < count; ++index )
+		{
+			settingsHash	= appCalcHash( textureCompressionInfo.usageSuffixes[ index ].first, settingsHash );
+			settingsHash	= appMemFastHash( &textureCompressionInfo.usageSuffixes[ index ].second, sizeof( ETextureUsage ), settingsHash );
+		}
+	}
+	bool				bIncrementalCook	= !InCommandLine.HasParam( TEXT( "full" ) ) && cookDatabase.Load( cookDatabasePath, COOKER_VERSION, settingsHash );
+	HashSourceFiles();
+
 	// Clear table of content and if cooked dir already created remove it
 	GTableOfContents.Clear();
-	if ( GFileSystem->IsExistFile( GCookedDir, true ) )
+	if ( bIncrementalCook )
 	{
-		GFileSystem->DeleteDirectory( GCookedDir, true );
+		PrepareIncrementalCook( shadersHash );
+	}
+	else
+	{
+		// Database we remove too, if cook will fail it must not point to packages which not exist
+		cookDatabase.Clear();
+		GFileSystem->Delete( cookDatabasePath );
+		if ( GFileSystem->IsExistFile( GCookedDir, true ) )
+		{
+			GFileSystem->DeleteDirectory( GCookedDir, true );
+		}
 	}
 
 	// Cook all resource with flag bAlwaysCook = true
-	CookAllResources( true );
+	if ( !CookAllResources( true ) )
+	{
+		return false;
+	}
 
 	// Cook maps
 	for ( uint32 index = 0, count = mapsToCook.size(); index < count; ++index )
@@ -1088,15 +1549,15 @@ bool CCookPackagesCommandlet::Main( const CCommandLine& InCommandLine )
 		}
 	}
 
-	// Serialize shader cache
+	// Write all cooked packages
+	if ( !SavePackages() )
 	{
-		CArchive*		archive = GFileSystem->CreateFileWriter( GCookedDir + PATH_SEPARATOR + GShaderManager->GetShaderCacheFilename( cookedShaderPlatform ), AW_NoFail );
-		archive->SetType( AT_ShaderCache );
-		archive->SerializeHeader();
-		shaderCache.Serialize( *archive );
-		delete archive;
+		return false;
 	}
 
+	// Serialize shader cache
+	shaderCache.Save( GCookedDir + PATH_SEPARATOR + GShaderManager->GetShaderCacheFilename( cookedShaderPlatform ) );
+
 	// Serialize table of contents
 	{
 		CArchive*		archive = GFileSystem->CreateFileWriter( GCookedDir + PATH_SEPARATOR + CTableOfContets::GetNameTOC(), AW_NoFail );
@@ -1104,6 +1565,10 @@ bool CCookPackagesCommandlet::Main( const CCommandLine& InCommandLine )
 		delete archive;
 	}
 
+	// Save cook database for next incremental cook
+	cookDatabase.SetShadersHash( shadersHash );
+	cookDatabase.Save( cookDatabasePath );
+
 	GIsCooker = false;
 	return true;
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include <vector>
+#include <random>
+#include <unordered_set>
+
+#include "Misc/Class.h"
+#include "Misc/Misc.h"
+#include "Misc/Template.h"
+#include "Containers/String.h"
+#include "Logger/LoggerMacros.h"
+#include "Commandlets/HashBenchmarkCommandlet.h"
+
+IMPLEMENT_CLASS( CHashBenchmarkCommandlet )
+
+/** Seed of random generator, results of benchmark must be reproducible */
+#define HASHBENCHMARK_RANDOM_SEED		0x5EED
+
+/** Number of keys in collision test */
+#define HASHBENCHMARK_NUM_KEYS			( 1 << 20 )
+
+/**
+ * Old byte at a time hash, used as reference for throughput
+ */
+static uint64 LegacyMemHash( const void* InData, uint64 InLength, uint64 InHash = 0 )
+{
+	const byte*		data = ( const byte* )InData;
+	for ( uint64 index = 0; index < InLength; ++index )
+	{
+		InHash = data[index] + ( InHash << 6 ) + ( InHash << 16 ) - InHash;
+	}
+	return InHash;
+}
+
+/**
+ * Count number of set bits
+ */
+static FORCEINLINE uint32 CountBits( uint64 InValue )
+{
+	uint32		count = 0;
+	for ( ; InValue; InValue &= InValue - 1 )
+	{
+		++count;
+	}
+	return count;
+}
+
+/**
+ * Measure throughput of hash functions
+ */
+void CHashBenchmarkCommandlet::MeasureThroughput( uint64 InTotalSize )
+{
+	static const uint32		keySizes[] = { 4, 8, 16, 32, 64, 256, 1024, 64 * 1024, 1024 * 1024 };
+
+	std::mt19937_64			random( HASHBENCHMARK_RANDOM_SEED );
+	std::vector<byte>		data( keySizes[ARRAY_COUNT( keySizes ) - 1] );
+	for ( uint32 index = 0, count = data.size(); index < count; ++index )
+	{
+		data[index] = ( byte )random();
+	}
+
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Throughput (%llu MB of data for every size):" ), InTotalSize / ( 1024 * 1024 ) );
+	for ( uint32 sizeIndex = 0; sizeIndex < ARRAY_COUNT( keySizes ); ++sizeIndex )
+	{
+		uint32		keySize = keySizes[sizeIndex];
+		uint64		numIterations = Max<uint64>( InTotalSize / keySize, 1 );
+
+		// Result of hash accumulated to make sure that compiler doesn't throw away calls
+		uint64		legacyResult	= 0;
+		double		startTime		= appSeconds();
+		for ( uint64 index = 0; index < numIterations; ++index )
+		{
+			legacyResult = LegacyMemHash( data.data(), keySize, legacyResult );
+		}
+		double		legacyTime		= appSeconds() - startTime;
+
+		uint64		fastResult		= 0;
+		startTime					= appSeconds();
+		for ( uint64 index = 0; index < numIterations; ++index )
+		{
+			fastResult = appMemFastHash( data.data(), keySize, fastResult );
+		}
+		double		fastTime		= appSeconds() - startTime;
+
+		double		totalMB = ( double )numIterations * keySize / ( 1024.0 * 1024.0 );
+		LE_LOG( LT_Log, LC_Commandlet, TEXT( "  %8u bytes: legacy %10.1f MB/s, fast %10.1f MB/s, speedup x%.1f (%llx %llx)" ),
+				keySize, totalMB / Max( legacyTime, 1e-9 ), totalMB / Max( fastTime, 1e-9 ), legacyTime / Max( fastTime, 1e-9 ), legacyResult, fastResult );
+	}
+}
+
+/**
+ * Check that hash by parts gives the same result as hash at once
+ */
+bool CHashBenchmarkCommandlet::CheckStreaming()
+{
+	std::mt19937_64			random( HASHBENCHMARK_RANDOM_SEED );
+	std::vector<byte>		data( 1024 );
+	for ( uint32 index = 0, count = data.size(); index < count; ++index )
+	{
+		data[index] = ( byte )random();
+	}
+
+	for ( uint32 length = 0, count = data.size(); length <= count; ++length )
+	{
+		CFastHash		fastHash( length );
+		for ( uint32 offset = 0; offset < length; )
+		{
+			uint32		partSize = Min<uint32>( ( uint32 )( random() % ( FASTHASH_BLOCK_SIZE * 2 ) ), length - offset );
+			fastHash.Update( data.data() + offset, partSize );
+			offset += partSize;
+		}
+
+		if ( fastHash.Finalize() != CFastHash::Hash( data.data(), length, length ) )
+		{
+			LE_LOG( LT_Error, LC_Commandlet, TEXT( "Hash by parts of %u bytes isn't equal to hash at once" ), length );
+			return false;
+		}
+	}
+
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Streaming: ok" ) );
+	return true;
+}
+
+/**
+ * Count collisions of hash on sequential keys
+ */
+bool CHashBenchmarkCommandlet::CheckCollisions()
+{
+	// Sequential integers and names are typical keys in engine, collisions are counted in low 32 bits
+	// because hash tables use only low bits
+	bool						bResult = true;
+	std::unordered_set<uint32>	hashes;
+	hashes.reserve( HASHBENCHMARK_NUM_KEYS * 2 );
+	for ( uint32 test = 0; test < 2; ++test )
+	{
+		hashes.clear();
+		uint32		numCollisions = 0;
+		for ( uint64 index = 0; index < HASHBENCHMARK_NUM_KEYS; ++index )
+		{
+			uint64		hash = test == 0 ? appMemFastHash( &index, sizeof( index ) ) : appCalcHash( CString::Format( TEXT( "Name_%llu" ), index ) );
+			if ( !hashes.insert( ( uint32 )hash ).second )
+			{
+				++numCollisions;
+			}
+		}
+
+		// Expected number of collisions for random 32-bit hash is N^2 / 2^33
+		double		expectedCollisions = ( double )HASHBENCHMARK_NUM_KEYS * HASHBENCHMARK_NUM_KEYS / 8589934592.0;
+		bool		bPassed = numCollisions <= expectedCollisions * 2.0 + 16.0;
+		LE_LOG( bPassed ? LT_Log : LT_Error, LC_Commandlet, TEXT( "Collisions of %s keys: %u, expected %.1f" ), test == 0 ? TEXT( "integer" ) : TEXT( "string" ), numCollisions, expectedCollisions );
+		bResult &= bPassed;
+	}
+
+	return bResult;
+}
+
+/**
+ * Measure avalanche of hash
+ */
+bool CHashBenchmarkCommandlet::CheckAvalanche()
+{
+	static const uint32		keySizes[] = { 4, 16, 64 };
+
+	std::mt19937_64			random( HASHBENCHMARK_RANDOM_SEED );
+	bool					bResult = true;
+	for ( uint32 sizeIndex = 0; sizeIndex < ARRAY_COUNT( keySizes ); ++sizeIndex )
+	{
+		uint32					keySize = keySizes[sizeIndex];
+		std::vector<byte>		key( keySize );
+		double					minRatio = 1.0;
+		double					maxRatio = 0.0;
+		for ( uint32 bit = 0; bit < keySize * 8; ++bit )
+		{
+			// Ratio of changed bits in hash after flip of one bit in key
+			uint32		numChangedBits = 0;
+			uint32		numSamples = 1000;
+			for ( uint32 sample = 0; sample < numSamples; ++sample )
+			{
+				for ( uint32 index = 0; index < keySize; ++index )
+				{
+					key[index] = ( byte )random();
+				}
+
+				uint64		hash = appMemFastHash( key.data(), keySize );
+				key[bit / 8] ^= 1 << ( bit % 8 );
+				numChangedBits += CountBits( hash ^ appMemFastHash( key.data(), keySize ) );
+			}
+
+			double		ratio = numChangedBits / ( numSamples * 64.0 );
+			minRatio	= Min( minRatio, ratio );
+			maxRatio	= Max( maxRatio, ratio );
+		}
+
+		bool		bPassed = minRatio > 0.45 && maxRatio < 0.55;
+		LE_LOG( bPassed ? LT_Log : LT_Error, LC_Commandlet, TEXT( "Avalanche of %u bytes keys: changed bits from %.3f to %.3f" ), keySize, minRatio, maxRatio );
+		bResult &= bPassed;
+	}
+
+	return bResult;
+}
+
+bool CHashBenchmarkCommandlet::Main( const CCommandLine& InCommandLine )
+{
+	uint64			totalSize	= 256;
+	std::wstring	sizeValue	= InCommandLine.GetFirstValue( TEXT( "size" ) );
+	if ( !sizeValue.empty() )
+	{
+		totalSize = Max( std::stoull( sizeValue ), 1ULL );
+	}
+
+	bool		bResult = CheckStreaming();
+	bResult &= CheckCollisions();
+	bResult &= CheckAvalanche();
+	MeasureThroughput( totalSize * 1024 * 1024 );
+	return bResult;
+}
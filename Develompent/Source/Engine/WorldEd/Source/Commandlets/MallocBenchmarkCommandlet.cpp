@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <vector>
+#include <random>
+
+#include "Misc/Class.h"
+#include "Misc/Misc.h"
+#include "Misc/Template.h"
+#include "Misc/CoreGlobals.h"
+#include "System/Malloc.h"
+#include "System/ThreadPool.h"
+#include "Logger/LoggerMacros.h"
+#include "Commandlets/MallocBenchmarkCommandlet.h"
+
+IMPLEMENT_CLASS( CMallocBenchmarkCommandlet )
+
+/** Seed of random generator, results of benchmark must be reproducible */
+#define MALLOCBENCHMARK_RANDOM_SEED		0x5EED
+
+/** Number of slots with live allocations in workload */
+#define MALLOCBENCHMARK_NUM_SLOTS		1024
+
+/**
+ * Allocator for benchmark
+ */
+struct SBenchmarkAllocator
+{
+	const tchar*	name;						/**< Name of allocator */
+	void*			( *Malloc )( size_t );		/**< Allocate memory */
+	void			( *Free )( void* );			/**< Free memory */
+};
+
+/**
+ * Operation of workload, if slot has allocation it's freed, else allocated block of size
+ */
+struct SBenchmarkOp
+{
+	uint32		slot;		/**< Index of slot */
+	uint32		size;		/**< Size of allocation */
+};
+
+/**
+ * Workload of benchmark
+ */
+struct SBenchmarkWorkload
+{
+	const tchar*	name;		/**< Name of workload */
+	uint32			minSize;	/**< Minimum size of allocation */
+	uint32			maxSize;	/**< Maximum size of allocation */
+};
+
+/**
+ * Allocate memory by CRT heap
+ */
+static void* CRTMalloc( size_t InSize )
+{
+	return malloc( InSize );
+}
+
+/**
+ * Free memory by CRT heap
+ */
+static void CRTFree( void* InPointer )
+{
+	free( InPointer );
+}
+
+/**
+ * Allocate memory by engine allocator
+ */
+static void* EngineMalloc( size_t InSize )
+{
+	return appMalloc( InSize );
+}
+
+/**
+ * Free memory by engine allocator
+ */
+static void EngineFree( void* InPointer )
+{
+	appFree( InPointer );
+}
+
+/**
+ * Build operations of workload
+ */
+static void BuildOps( const SBenchmarkWorkload& InWorkload, uint32 InNumOps, std::vector<SBenchmarkOp>& OutOps )
+{
+	std::mt19937		random( MALLOCBENCHMARK_RANDOM_SEED );
+	OutOps.resize( InNumOps );
+	for ( uint32 index = 0; index < InNumOps; ++index )
+	{
+		OutOps[index].slot = random() % MALLOCBENCHMARK_NUM_SLOTS;
+		OutOps[index].size = InWorkload.minSize + random() % ( InWorkload.maxSize - InWorkload.minSize + 1 );
+	}
+}
+
+/**
+ * Run operations of workload by allocator
+ * @return Return time in seconds
+ */
+static double RunOps( const SBenchmarkAllocator& InAllocator, const std::vector<SBenchmarkOp>& InOps )
+{
+	void*		slots[MALLOCBENCHMARK_NUM_SLOTS];
+	memset( slots, 0, sizeof( slots ) );
+
+	double		startTime = appSeconds();
+	for ( uint32 index = 0, count = InOps.size(); index < count; ++index )
+	{
+		void*&		slot = slots[InOps[index].slot];
+		if ( slot )
+		{
+			InAllocator.Free( slot );
+			slot = nullptr;
+		}
+		else
+		{
+			// Touch memory as real code does
+			slot = InAllocator.Malloc( InOps[index].size );
+			*( byte* )slot = 0;
+		}
+	}
+
+	for ( uint32 index = 0; index < MALLOCBENCHMARK_NUM_SLOTS; ++index )
+	{
+		InAllocator.Free( slots[index] );
+	}
+	return appSeconds() - startTime;
+}
+
+/**
+ * Check correctness of engine allocator
+ */
+bool CMallocBenchmarkCommandlet::CheckCorrectness()
+{
+	struct SLiveBlock
+	{
+		byte*		data;
+		uint32		size;
+	};
+
+	std::mt19937				random( MALLOCBENCHMARK_RANDOM_SEED );
+	std::vector<SLiveBlock>		liveBlocks;
+	CMallocBinned&				mallocBinned = CMallocBinned::Get();
+	for ( uint32 iteration = 0; iteration < 200000; ++iteration )
+	{
+		// Every block is filled by byte of its size, so overlapped blocks are found on check
+		if ( liveBlocks.size() < 1000 || random() % 2 )
+		{
+			uint32		size		= random() % 4 == 0 ? random() % ( 256 * 1024 ) : random() % 1024;
+			uint32		alignment	= 1 << ( 4 + random() % 4 );
+			byte*		data		= ( byte* )mallocBinned.Malloc( size, alignment );
+			if ( !data || ( ( uint64 )data & ( alignment - 1 ) ) != 0 || mallocBinned.GetAllocationSize( data ) < size )
+			{
+				LE_LOG( LT_Error, LC_Commandlet, TEXT( "Wrong allocation of %u bytes with alignment %u" ), size, alignment );
+				return false;
+			}
+
+			memset( data, ( byte )size, size );
+			liveBlocks.push_back( SLiveBlock{ data, size } );
+			continue;
+		}
+
+		uint32			blockIndex	= random() % liveBlocks.size();
+		SLiveBlock&		block		= liveBlocks[blockIndex];
+		for ( uint32 index = 0; index < block.size; ++index )
+		{
+			if ( block.data[index] != ( byte )block.size )
+			{
+				LE_LOG( LT_Error, LC_Commandlet, TEXT( "Memory of block with %u bytes is corrupted" ), block.size );
+				return false;
+			}
+		}
+
+		if ( random() % 3 == 0 )
+		{
+			uint32		newSize = 1 + random() % 4096;
+			byte*		newData = ( byte* )mallocBinned.Realloc( block.data, newSize );
+			for ( uint32 index = 0, count = Min( newSize, block.size ); index < count; ++index )
+			{
+				if ( newData[index] != ( byte )block.size )
+				{
+					LE_LOG( LT_Error, LC_Commandlet, TEXT( "Realloc from %u to %u bytes lost content" ), block.size, newSize );
+					return false;
+				}
+			}
+
+			memset( newData, ( byte )newSize, newSize );
+			block.data = newData;
+			block.size = newSize;
+		}
+		else
+		{
+			mallocBinned.Free( block.data );
+			liveBlocks[blockIndex] = liveBlocks.back();
+			liveBlocks.pop_back();
+		}
+	}
+
+	for ( uint32 index = 0, count = liveBlocks.size(); index < count; ++index )
+	{
+		mallocBinned.Free( liveBlocks[index].data );
+	}
+
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Correctness: ok" ) );
+	return true;
+}
+
+/**
+ * Measure speed of allocators
+ */
+void CMallocBenchmarkCommandlet::MeasureSpeed( uint32 InNumOps )
+{
+	static const SBenchmarkAllocator	allocators[] =
+	{
+		{ TEXT( "CRT" ),		&CRTMalloc,		&CRTFree },
+		{ TEXT( "Engine" ),		&EngineMalloc,	&EngineFree }
+	};
+
+	static const SBenchmarkWorkload		workloads[] =
+	{
+		{ TEXT( "16 bytes" ),			16,			16 },
+		{ TEXT( "64 bytes" ),			64,			64 },
+		{ TEXT( "256 bytes" ),			256,		256 },
+		{ TEXT( "8 KB" ),				8192,		8192 },
+		{ TEXT( "16-1024 bytes" ),		16,			1024 },
+		{ TEXT( "1-32 KB" ),			1024,		32 * 1024 },
+		{ TEXT( "64-512 KB" ),			64 * 1024,	512 * 1024 }
+	};
+
+	uint32		numThreads = GThreadPool ? GThreadPool->GetNumThreads() + 1 : 1;
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Speed (%u operations on every thread, %u threads):" ), InNumOps, numThreads );
+	for ( uint32 workloadIndex = 0; workloadIndex < ARRAY_COUNT( workloads ); ++workloadIndex )
+	{
+		const SBenchmarkWorkload&	workload = workloads[workloadIndex];
+		std::vector<SBenchmarkOp>	ops;
+		BuildOps( workload, workload.maxSize > MALLOC_MAX_SMALL_SIZE ? InNumOps / 16 : InNumOps, ops );
+
+		double		singleTimes[ARRAY_COUNT( allocators )];
+		double		multiTimes[ARRAY_COUNT( allocators )];
+		for ( uint32 allocatorIndex = 0; allocatorIndex < ARRAY_COUNT( allocators ); ++allocatorIndex )
+		{
+			const SBenchmarkAllocator&	allocator = allocators[allocatorIndex];
+			singleTimes[allocatorIndex] = RunOps( allocator, ops );
+
+			// Every thread runs the same operations with own blocks
+			double		startTime = appSeconds();
+			appParallelFor( numThreads, [&]( uint32 InThreadIndex )
+							{
+								RunOps( allocator, ops );
+							} );
+			multiTimes[allocatorIndex] = appSeconds() - startTime;
+		}
+
+		double		numMillionOps = ops.size() / 1000000.0;
+		LE_LOG( LT_Log, LC_Commandlet, TEXT( "  %-14s: 1 thread CRT %7.1f Mops/s, engine %7.1f Mops/s (x%.1f); %u threads CRT %7.1f Mops/s, engine %7.1f Mops/s (x%.1f)" ),
+				workload.name,
+				numMillionOps / Max( singleTimes[0], 1e-9 ), numMillionOps / Max( singleTimes[1], 1e-9 ), singleTimes[0] / Max( singleTimes[1], 1e-9 ),
+				numThreads, numMillionOps * numThreads / Max( multiTimes[0], 1e-9 ), numMillionOps * numThreads / Max( multiTimes[1], 1e-9 ), multiTimes[0] / Max( multiTimes[1], 1e-9 ) );
+	}
+
+	SMallocStats	stats = CMallocBinned::Get().GetStats();
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Engine allocator: reserved %.1f MB in %u arenas, large pages %s" ), stats.reservedSize / ( 1024.0 * 1024.0 ), stats.numArenas, stats.bLargePages ? TEXT( "on" ) : TEXT( "off" ) );
+}
+
+bool CMallocBenchmarkCommandlet::Main( const CCommandLine& InCommandLine )
+{
+	uint32			numOps		= 4;
+	std::wstring	opsValue	= InCommandLine.GetFirstValue( TEXT( "ops" ) );
+	if ( !opsValue.empty() )
+	{
+		numOps = Max<uint32>( std::stoul( opsValue ), 1 );
+	}
+
+	bool		bResult = CheckCorrectness();
+	MeasureSpeed( numOps * 1000000 );
+	return bResult;
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+
+#include "Misc/CoreGlobals.h"
+#include "Misc/Template.h"
+#include "Logger/LoggerMacros.h"
+#include "System/Archive.h"
+#include "System/BaseFileSystem.h"
+#include "System/CookDatabase.h"
+
+/**
+ * Magic number of cook database ('LCDB')
+ */
+#define COOKDB_MAGIC		0x4244434C
+
+/**
+ * Size of block for reading files at hashing
+ */
+#define COOKDB_HASH_BLOCK_SIZE		( 64 * 1024 )
+
+/**
+ * Constructor
+ */
+CCookDatabase::CCookDatabase()
+	: cookerVersion( 0 )
+	, settingsHash( 0 )
+	, shadersHash( 0 )
+{}
+
+/**
+ * Load database from file
+ */
+bool CCookDatabase::Load( const std::wstring& InPath, uint32 InCookerVersion, uint64 InSettingsHash )
+{
+	Clear();
+	cookerVersion	= InCookerVersion;
+	settingsHash	= InSettingsHash;
+
+	CArchive*		archive = GFileSystem->CreateFileReader( InPath );
+	if ( !archive )
+	{
+		return false;
+	}
+
+	// Check that database was created by this cooker with same settings
+	uint32		magic = 0;
+	uint32		fileCookerVersion = 0;
+	uint64		fileSettingsHash = 0;
+	*archive << magic;
+	*archive << fileCookerVersion;
+	*archive << fileSettingsHash;
+	if ( magic != COOKDB_MAGIC || fileCookerVersion != InCookerVersion || fileSettingsHash != InSettingsHash )
+	{
+		LE_LOG( LT_Log, LC_Commandlet, TEXT( "Cook database '%s' is outdated" ), InPath.c_str() );
+		delete archive;
+		return false;
+	}
+
+	*archive << shadersHash;
+
+	uint32		numRecords = 0;
+	*archive << numRecords;
+	for ( uint32 index = 0; index < numRecords; ++index )
+	{
+		std::wstring		assetRef;
+		SRecord				record;
+		uint32				numDependencies = 0;
+		*archive << assetRef;
+		*archive << record.type;
+		*archive << record.guid;
+		*archive << record.sourceHash;
+		*archive << numDependencies;
+
+		record.dependencies.resize( numDependencies );
+		for ( uint32 indexDependency = 0; indexDependency < numDependencies; ++indexDependency )
+		{
+			*archive << record.dependencies[ indexDependency ];
+		}
+		records.insert( std::make_pair( assetRef, record ) );
+	}
+
+	delete archive;
+	LE_LOG( LT_Log, LC_Commandlet, TEXT( "Loaded cook database with %u records" ), ( uint32 )records.size() );
+	return true;
+}
+
+/**
+ * Save database to file
+ */
+bool CCookDatabase::Save( const std::wstring& InPath ) const
+{
+	CArchive*		archive = GFileSystem->CreateFileWriter( InPath );
+	if ( !archive )
+	{
+		LE_LOG( LT_Warning, LC_Commandlet, TEXT( "Failed saving cook database '%s'" ), InPath.c_str() );
+		return false;
+	}
+
+	*archive << ( uint32 )COOKDB_MAGIC;
+	*archive << cookerVersion;
+	*archive << settingsHash;
+	*archive << shadersHash;
+	*archive << ( uint32 )records.size();
+	for ( auto itRecord = records.begin(), itRecordEnd = records.end(); itRecord != itRecordEnd; ++itRecord )
+	{
+		const SRecord&		record = itRecord->second;
+		*archive << itRecord->first;
+		*archive << record.type;
+		*archive << record.guid;
+		*archive << record.sourceHash;
+		*archive << ( uint32 )record.dependencies.size();
+		for ( uint32 index = 0, count = record.dependencies.size(); index < count; ++index )
+		{
+			*archive << record.dependencies[ index ];
+		}
+	}
+
+	delete archive;
+	return true;
+}
+
+/**
+ * Remove all records
+ */
+void CCookDatabase::Clear()
+{
+	shadersHash = 0;
+	records.clear();
+}
+
+/**
+ * Calculate hash of file content
+ */
+uint64 CCookDatabase::HashFile( const std::wstring& InPath )
+{
+	FileReadHandleRef_t		handle = GFileSystem->OpenReadHandle( InPath );
+	if ( !handle.IsValid() )
+	{
+		return 0;
+	}
+
+	uint64				size = handle->GetSize();
+	uint64				hash = appMemFastHash( &size, sizeof( uint64 ) );
+	std::vector<byte>	buffer( COOKDB_HASH_BLOCK_SIZE );
+	for ( uint64 offset = 0; offset < size; )
+	{
+		uint32		readSize = handle->ReadAt( buffer.data(), ( uint32 )Min<uint64>( buffer.size(), size - offset ), offset );
+		if ( readSize == 0 )
+		{
+			break;
+		}
+
+		hash	= appMemFastHash( buffer.data(), readSize, hash );
+		offset	+= readSize;
+	}
+
+	return hash;
+}
+
+/**
+ * Calculate hash of names and contents of all files in directory and subdirectories
+ */
+uint64 CCookDatabase::HashDirectory( const std::wstring& InPath, uint64 InHash /* = 0 */ )
+{
+	// Order of files from file system is not guaranteed, so we sort them
+	std::vector<std::wstring>		files = GFileSystem->FindFiles( InPath, true, true );
+	std::sort( files.begin(), files.end() );
+
+	for ( uint32 index = 0, count = files.size(); index < count; ++index )
+	{
+		const std::wstring&		file		= files[ index ];
+		std::wstring			fullPath	= InPath + PATH_SEPARATOR + file;
+		InHash					= appMemFastHash( file.data(), file.size() * sizeof( std::wstring::value_type ), InHash );
+
+		if ( GFileSystem->IsExistFile( fullPath, true ) )
+		{
+			InHash = HashDirectory( fullPath, InHash );
+		}
+		else
+		{
+			uint64		fileHash = HashFile( fullPath );
+			InHash		= appMemFastHash( &fileHash, sizeof( uint64 ), InHash );
+		}
+	}
+
+	return InHash;
+}
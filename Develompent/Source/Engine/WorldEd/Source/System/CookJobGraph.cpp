@@ -0,0 +1,162 @@
+#include "Misc/CoreGlobals.h"
+#include "Logger/LoggerMacros.h"
+#include "System/CookJobGraph.h"
+
+/**
+ * Do work
+ */
+void CCookJobGraph::CJobWork::DoThreadedWork()
+{
+	SJob&		job = graph->jobs[ index ];
+	job.bResult = job.work ? job.work() : true;
+
+	{
+		CScopeLock		scopeLock( graph->cs );
+		graph->doneJobs.push_back( index );
+	}
+	graph->doneEvent->Trigger();
+}
+
+/**
+ * Abandon work
+ */
+void CCookJobGraph::CJobWork::Abandon()
+{
+	DoThreadedWork();
+}
+
+/**
+ * Constructor
+ */
+CCookJobGraph::CCookJobGraph()
+	: doneEvent( nullptr )
+{}
+
+/**
+ * Add job to graph
+ */
+uint32 CCookJobGraph::AddJob( const std::wstring& InName, const JobFunction_t& InWork, const JobFunction_t& InFinish )
+{
+	jobs.push_back( SJob{ InName, InWork, InFinish, std::vector<uint32>(), 0, false } );
+	return jobs.size() - 1;
+}
+
+/**
+ * Add dependency between jobs
+ */
+void CCookJobGraph::AddDependency( uint32 InJob, uint32 InDependency )
+{
+	check( InJob < jobs.size() && InDependency < jobs.size() && InJob != InDependency );
+	jobs[ InDependency ].dependents.push_back( InJob );
+	++jobs[ InJob ].numDependencies;
+}
+
+/**
+ * Queue work of job to thread pool
+ */
+void CCookJobGraph::Dispatch( uint32 InIndex )
+{
+	// Jobs without work we not send to pool
+	if ( !jobs[ InIndex ].work )
+	{
+		works[ InIndex ].DoThreadedWork();
+		return;
+	}
+
+	if ( GThreadPool )
+	{
+		GThreadPool->AddQueuedWork( &works[ InIndex ] );
+	}
+	else
+	{
+		works[ InIndex ].DoThreadedWork();
+	}
+}
+
+/**
+ * Execute all jobs
+ */
+bool CCookJobGraph::Execute( std::wstring& OutFailedJob )
+{
+	works.clear();
+	doneJobs.clear();
+	works.reserve( jobs.size() );
+	for ( uint32 index = 0, count = jobs.size(); index < count; ++index )
+	{
+		works.push_back( CJobWork( this, index ) );
+	}
+	doneEvent = GSynchronizeFactory->CreateSynchEvent();
+
+	// Start all jobs without dependencies
+	uint32		numInFlight = 0;
+	for ( uint32 index = 0, count = jobs.size(); index < count; ++index )
+	{
+		if ( jobs[ index ].numDependencies == 0 )
+		{
+			++numInFlight;
+			Dispatch( index );
+		}
+	}
+
+	// Execute finish of jobs in order of dependencies
+	bool					bFailed = false;
+	uint32					numFinished = 0;
+	std::vector<uint32>		finishJobs;
+	while ( numInFlight > 0 )
+	{
+		{
+			CScopeLock		scopeLock( cs );
+			finishJobs.swap( doneJobs );
+		}
+
+		if ( finishJobs.empty() )
+		{
+			doneEvent->Wait();
+			continue;
+		}
+
+		for ( uint32 index = 0, count = finishJobs.size(); index < count; ++index )
+		{
+			SJob&		job = jobs[ finishJobs[ index ] ];
+			--numInFlight;
+
+			// After first error we only wait for jobs which already started
+			if ( bFailed )
+			{
+				continue;
+			}
+
+			if ( !job.bResult || ( job.finish && !job.finish() ) )
+			{
+				OutFailedJob	= job.name;
+				bFailed			= true;
+				continue;
+			}
+
+			++numFinished;
+			for ( uint32 indexDependent = 0, countDependents = job.dependents.size(); indexDependent < countDependents; ++indexDependent )
+			{
+				uint32		dependent = job.dependents[ indexDependent ];
+				if ( --jobs[ dependent ].numDependencies == 0 )
+				{
+					++numInFlight;
+					Dispatch( dependent );
+				}
+			}
+		}
+		finishJobs.clear();
+	}
+
+	GSynchronizeFactory->Destroy( doneEvent );
+	doneEvent = nullptr;
+
+	// Jobs which never started have cyclic dependencies
+	if ( !bFailed && numFinished != jobs.size() )
+	{
+		LE_LOG( LT_Error, LC_Commandlet, TEXT( "Cook jobs have cyclic dependencies, %u jobs not executed" ), ( uint32 )( jobs.size() - numFinished ) );
+		OutFailedJob	= TEXT( "Cyclic dependencies" );
+		bFailed			= true;
+	}
+
+	return !bFailed;
+}
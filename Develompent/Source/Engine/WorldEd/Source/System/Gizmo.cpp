@@ -60,21 +60,12 @@ CGizmo::CGizmo()
 	, axisXEnd( 0.f, 0.f )
 	, axisYEnd( 0.f, 0.f )
 	, axisZEnd( 0.f, 0.f )
-	, editorModeChangedDelegate( nullptr )
-	, updateAllGizmoDelegate( nullptr )
 {}
 
 CGizmo::~CGizmo()
 {
-	if ( editorModeChangedDelegate )
-	{
-		SEditorDelegates::onEditorModeChanged.Remove( editorModeChangedDelegate );
-	}
-
-	if ( updateAllGizmoDelegate )
-	{
-		onUpdateAllGizmo.Remove( updateAllGizmoDelegate );
-	}
+	SEditorDelegates::onEditorModeChanged.Remove( editorModeChangedDelegate );
+	onUpdateAllGizmo.Remove( updateAllGizmoDelegate );
 }
 
 void CGizmo::Init()
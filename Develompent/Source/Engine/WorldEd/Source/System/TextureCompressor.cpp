@@ -0,0 +1,806 @@
+#include <cmath>
+#include <cfloat>
+
+#include "Misc/Template.h"
+#include "Render/RenderUtils.h"
+#include "System/ThreadPool.h"
+#include "System/TextureCompressor.h"
+
+/** Size of block side in pixels */
+#define BLOCK_SIZE				4
+
+/** Number of pixels in block */
+#define BLOCK_NUM_PIXELS		( BLOCK_SIZE * BLOCK_SIZE )
+
+/**
+ * Pixels of one block. Every pixel has four channels in range [0, 255]
+ */
+typedef float		BlockPixels_t[ BLOCK_NUM_PIXELS ][ 4 ];
+
+/**
+ * Weights of BC1 palette colors relative to second endpoint
+ */
+static const float		GBC1Weights[ 4 ] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+
+/**
+ * Weights of BC7 palette colors with 4 bit indices (in 1/64)
+ */
+static const uint32		GBC7Weights[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/**
+ * Names of texture usages
+ */
+static const std::pair< std::wstring, ETextureUsage >		GTextureUsageNames[] =
+{
+	std::make_pair( TEXT( "Albedo" ),			TU_Albedo ),
+	std::make_pair( TEXT( "Normal" ),			TU_Normal ),
+	std::make_pair( TEXT( "Mask" ),				TU_Mask ),
+	std::make_pair( TEXT( "Uncompressed" ),		TU_Uncompressed )
+};
+
+/**
+ * Names of quality presets of texture compression
+ */
+static const std::pair< std::wstring, ETextureCompressionQuality >		GTextureCompressionQualityNames[] =
+{
+	std::make_pair( TEXT( "Fast" ),			TCQ_Fast ),
+	std::make_pair( TEXT( "Normal" ),		TCQ_Normal ),
+	std::make_pair( TEXT( "High" ),			TCQ_High )
+};
+
+/**
+ * Convert text to ETextureUsage
+ */
+ETextureUsage appTextToETextureUsage( const std::wstring& InString )
+{
+	for ( uint32 index = 0, count = ARRAY_COUNT( GTextureUsageNames ); index < count; ++index )
+	{
+		if ( GTextureUsageNames[ index ].first == InString )
+		{
+			return GTextureUsageNames[ index ].second;
+		}
+	}
+
+	return TU_Albedo;
+}
+
+/**
+ * Convert text to ETextureCompressionQuality
+ */
+ETextureCompressionQuality appTextToETextureCompressionQuality( const std::wstring& InString )
+{
+	for ( uint32 index = 0, count = ARRAY_COUNT( GTextureCompressionQualityNames ); index < count; ++index )
+	{
+		if ( GTextureCompressionQualityNames[ index ].first == InString )
+		{
+			return GTextureCompressionQualityNames[ index ].second;
+		}
+	}
+
+	return TCQ_Normal;
+}
+
+/**
+ * Get number of endpoint refinements for quality preset
+ */
+static FORCEINLINE uint32 GetNumRefinements( ETextureCompressionQuality InQuality )
+{
+	switch ( InQuality )
+	{
+	case TCQ_Fast:		return 0;
+	case TCQ_Normal:	return 1;
+	default:			return 4;
+	}
+}
+
+/**
+ * Compute start endpoints of block. Fast quality uses bounding box of block, other qualities use principal axis of block
+ */
+static void ComputeEndpoints( const BlockPixels_t& InPixels, uint32 InNumChannels, ETextureCompressionQuality InQuality, float OutEndpoint0[ 4 ], float OutEndpoint1[ 4 ] )
+{
+	float		mean[ 4 ]		= { 0.f, 0.f, 0.f, 0.f };
+	float		minColor[ 4 ]	= { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+	float		maxColor[ 4 ]	= { 0.f, 0.f, 0.f, 0.f };
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+		{
+			mean[ channel ]		+= InPixels[ index ][ channel ];
+			minColor[ channel ]	= Min( minColor[ channel ], InPixels[ index ][ channel ] );
+			maxColor[ channel ]	= Max( maxColor[ channel ], InPixels[ index ][ channel ] );
+		}
+	}
+
+	// Bounding box of block, inset a bit for reduce error of colors in middle
+	for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+	{
+		float		inset = ( maxColor[ channel ] - minColor[ channel ] ) / 16.f;
+		mean[ channel ]				/= BLOCK_NUM_PIXELS;
+		OutEndpoint0[ channel ]		= maxColor[ channel ] - inset;
+		OutEndpoint1[ channel ]		= minColor[ channel ] + inset;
+	}
+
+	if ( InQuality == TCQ_Fast )
+	{
+		return;
+	}
+
+	// Covariance matrix of block
+	float		covariance[ 4 ][ 4 ] = {};
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		for ( uint32 row = 0; row < InNumChannels; ++row )
+		{
+			for ( uint32 column = 0; column < InNumChannels; ++column )
+			{
+				covariance[ row ][ column ] += ( InPixels[ index ][ row ] - mean[ row ] ) * ( InPixels[ index ][ column ] - mean[ column ] );
+			}
+		}
+	}
+
+	// Find principal axis by power iteration, start from diagonal of bounding box
+	float		axis[ 4 ]		= { 0.f, 0.f, 0.f, 0.f };
+	for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+	{
+		axis[ channel ] = maxColor[ channel ] - minColor[ channel ];
+	}
+
+	for ( uint32 iteration = 0; iteration < 8; ++iteration )
+	{
+		float		newAxis[ 4 ]	= { 0.f, 0.f, 0.f, 0.f };
+		float		maxComponent	= 0.f;
+		for ( uint32 row = 0; row < InNumChannels; ++row )
+		{
+			for ( uint32 column = 0; column < InNumChannels; ++column )
+			{
+				newAxis[ row ] += covariance[ row ][ column ] * axis[ column ];
+			}
+			maxComponent = Max( maxComponent, ( float )fabs( newAxis[ row ] ) );
+		}
+
+		if ( maxComponent < 1e-6f )
+		{
+			break;
+		}
+
+		for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+		{
+			axis[ channel ] = newAxis[ channel ] / maxComponent;
+		}
+	}
+
+	float		axisLength = 0.f;
+	for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+	{
+		axisLength += axis[ channel ] * axis[ channel ];
+	}
+
+	// All pixels in block are the same, bounding box is enough
+	if ( axisLength < 1e-6f )
+	{
+		return;
+	}
+
+	// Project pixels to axis for getting endpoints
+	float		minProjection = FLT_MAX;
+	float		maxProjection = -FLT_MAX;
+	axisLength	= sqrt( axisLength );
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		float		projection = 0.f;
+		for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+		{
+			projection += ( InPixels[ index ][ channel ] - mean[ channel ] ) * axis[ channel ] / axisLength;
+		}
+
+		minProjection = Min( minProjection, projection );
+		maxProjection = Max( maxProjection, projection );
+	}
+
+	for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+	{
+		OutEndpoint0[ channel ] = Clamp( mean[ channel ] + axis[ channel ] / axisLength * maxProjection, 0.f, 255.f );
+		OutEndpoint1[ channel ] = Clamp( mean[ channel ] + axis[ channel ] / axisLength * minProjection, 0.f, 255.f );
+	}
+}
+
+/**
+ * Find nearest palette color for every pixel of block
+ * @return Return squared error of block
+ */
+static float FindIndices( const BlockPixels_t& InPixels, uint32 InNumChannels, const float InPalette[][ 4 ], uint32 InNumColors, uint8 OutIndices[ BLOCK_NUM_PIXELS ] )
+{
+	float		error = 0.f;
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		float		bestError = FLT_MAX;
+		for ( uint32 color = 0; color < InNumColors; ++color )
+		{
+			float		colorError = 0.f;
+			for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+			{
+				float		delta = InPixels[ index ][ channel ] - InPalette[ color ][ channel ];
+				colorError += delta * delta;
+			}
+
+			if ( colorError < bestError )
+			{
+				bestError				= colorError;
+				OutIndices[ index ]		= color;
+			}
+		}
+
+		error += bestError;
+	}
+
+	return error;
+}
+
+/**
+ * Solve endpoints by least squares for known indices
+ * @return Return FALSE if system is degenerate (all pixels use one weight)
+ */
+static bool SolveEndpoints( const BlockPixels_t& InPixels, uint32 InNumChannels, const uint8 InIndices[ BLOCK_NUM_PIXELS ], const float* InWeights, float OutEndpoint0[ 4 ], float OutEndpoint1[ 4 ] )
+{
+	float		alpha2				= 0.f;
+	float		alphaBeta			= 0.f;
+	float		beta2				= 0.f;
+	float		alphaPixel[ 4 ]		= { 0.f, 0.f, 0.f, 0.f };
+	float		betaPixel[ 4 ]		= { 0.f, 0.f, 0.f, 0.f };
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		float		beta	= InWeights[ InIndices[ index ] ];
+		float		alpha	= 1.f - beta;
+		alpha2		+= alpha * alpha;
+		alphaBeta	+= alpha * beta;
+		beta2		+= beta * beta;
+		for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+		{
+			alphaPixel[ channel ]	+= alpha * InPixels[ index ][ channel ];
+			betaPixel[ channel ]	+= beta * InPixels[ index ][ channel ];
+		}
+	}
+
+	float		determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+	if ( fabs( determinant ) < 1e-6f )
+	{
+		return false;
+	}
+
+	for ( uint32 channel = 0; channel < InNumChannels; ++channel )
+	{
+		OutEndpoint0[ channel ] = Clamp( ( alphaPixel[ channel ] * beta2 - betaPixel[ channel ] * alphaBeta ) / determinant, 0.f, 255.f );
+		OutEndpoint1[ channel ] = Clamp( ( betaPixel[ channel ] * alpha2 - alphaPixel[ channel ] * alphaBeta ) / determinant, 0.f, 255.f );
+	}
+	return true;
+}
+
+/**
+ * ---------------------
+ * BC1
+ * ---------------------
+ */
+
+/**
+ * Encoded BC1 color block
+ */
+struct SBC1Block
+{
+	uint16		color0;							/**< First endpoint in RGB565 */
+	uint16		color1;							/**< Second endpoint in RGB565 */
+	uint8		indices[ BLOCK_NUM_PIXELS ];	/**< Indices of palette colors */
+};
+
+/**
+ * Pack color to RGB565
+ */
+static FORCEINLINE uint16 PackRGB565( const float InColor[ 4 ] )
+{
+	uint32		r = Clamp<int32>( ( int32 )( InColor[ 0 ] * 31.f / 255.f + 0.5f ), 0, 31 );
+	uint32		g = Clamp<int32>( ( int32 )( InColor[ 1 ] * 63.f / 255.f + 0.5f ), 0, 63 );
+	uint32		b = Clamp<int32>( ( int32 )( InColor[ 2 ] * 31.f / 255.f + 0.5f ), 0, 31 );
+	return ( r << 11 ) | ( g << 5 ) | b;
+}
+
+/**
+ * Unpack color from RGB565
+ */
+static FORCEINLINE void UnpackRGB565( uint16 InColor, float OutColor[ 4 ] )
+{
+	uint32		r = ( InColor >> 11 ) & 31;
+	uint32		g = ( InColor >> 5 ) & 63;
+	uint32		b = InColor & 31;
+	OutColor[ 0 ] = ( float )( ( r << 3 ) | ( r >> 2 ) );
+	OutColor[ 1 ] = ( float )( ( g << 2 ) | ( g >> 4 ) );
+	OutColor[ 2 ] = ( float )( ( b << 3 ) | ( b >> 2 ) );
+	OutColor[ 3 ] = 255.f;
+}
+
+/**
+ * Quantize endpoints to BC1 block in four colors mode and find indices
+ * @return Return squared error of block
+ */
+static float QuantizeBC1( const BlockPixels_t& InPixels, const float InEndpoint0[ 4 ], const float InEndpoint1[ 4 ], SBC1Block& OutBlock )
+{
+	OutBlock.color0 = PackRGB565( InEndpoint0 );
+	OutBlock.color1 = PackRGB565( InEndpoint1 );
+
+	// Four colors mode requires color0 > color1. If they are equal, all pixels use color0
+	if ( OutBlock.color0 < OutBlock.color1 )
+	{
+		Swap( OutBlock.color0, OutBlock.color1 );
+	}
+
+	float		palette[ 4 ][ 4 ];
+	UnpackRGB565( OutBlock.color0, palette[ 0 ] );
+	UnpackRGB565( OutBlock.color1, palette[ 1 ] );
+	if ( OutBlock.color0 == OutBlock.color1 )
+	{
+		return FindIndices( InPixels, 3, palette, 1, OutBlock.indices );
+	}
+
+	for ( uint32 channel = 0; channel < 3; ++channel )
+	{
+		palette[ 2 ][ channel ] = ( 2.f * palette[ 0 ][ channel ] + palette[ 1 ][ channel ] ) / 3.f;
+		palette[ 3 ][ channel ] = ( palette[ 0 ][ channel ] + 2.f * palette[ 1 ][ channel ] ) / 3.f;
+	}
+	return FindIndices( InPixels, 3, palette, 4, OutBlock.indices );
+}
+
+/**
+ * Compress block to BC1
+ */
+static void CompressBlockBC1( const BlockPixels_t& InPixels, ETextureCompressionQuality InQuality, byte* OutBlock )
+{
+	float		endpoint0[ 4 ];
+	float		endpoint1[ 4 ];
+	SBC1Block	block;
+	ComputeEndpoints( InPixels, 3, InQuality, endpoint0, endpoint1 );
+	float		error = QuantizeBC1( InPixels, endpoint0, endpoint1, block );
+
+	// Refine endpoints while error is reduced
+	for ( uint32 iteration = 0, numIterations = GetNumRefinements( InQuality ); iteration < numIterations && block.color0 != block.color1; ++iteration )
+	{
+		SBC1Block	newBlock;
+		if ( !SolveEndpoints( InPixels, 3, block.indices, GBC1Weights, endpoint0, endpoint1 ) )
+		{
+			break;
+		}
+
+		float		newError = QuantizeBC1( InPixels, endpoint0, endpoint1, newBlock );
+		if ( newError >= error )
+		{
+			break;
+		}
+
+		error	= newError;
+		block	= newBlock;
+	}
+
+	uint32		indices = 0;
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		indices |= ( uint32 )block.indices[ index ] << ( index * 2 );
+	}
+
+	OutBlock[ 0 ] = block.color0 & 0xFF;
+	OutBlock[ 1 ] = block.color0 >> 8;
+	OutBlock[ 2 ] = block.color1 & 0xFF;
+	OutBlock[ 3 ] = block.color1 >> 8;
+	OutBlock[ 4 ] = indices & 0xFF;
+	OutBlock[ 5 ] = ( indices >> 8 ) & 0xFF;
+	OutBlock[ 6 ] = ( indices >> 16 ) & 0xFF;
+	OutBlock[ 7 ] = indices >> 24;
+}
+
+/**
+ * ---------------------
+ * BC4
+ * ---------------------
+ */
+
+/**
+ * Encoded BC4 block
+ */
+struct SBC4Block
+{
+	uint8		value0;							/**< First endpoint */
+	uint8		value1;							/**< Second endpoint */
+	uint8		indices[ BLOCK_NUM_PIXELS ];	/**< Indices of palette values */
+};
+
+/**
+ * Build BC4 palette and find indices. If value0 > value1 block is in eight values mode, else in six values mode with explicit 0 and 255
+ * @return Return squared error of block
+ */
+static float QuantizeBC4( const BlockPixels_t& InValues, SBC4Block& InOutBlock )
+{
+	float		palette[ 8 ][ 4 ];
+	float		value0 = InOutBlock.value0;
+	float		value1 = InOutBlock.value1;
+	palette[ 0 ][ 0 ] = value0;
+	palette[ 1 ][ 0 ] = value1;
+	if ( InOutBlock.value0 > InOutBlock.value1 )
+	{
+		for ( uint32 index = 2; index < 8; ++index )
+		{
+			palette[ index ][ 0 ] = ( ( 8 - index ) * value0 + ( index - 1 ) * value1 ) / 7.f;
+		}
+	}
+	else
+	{
+		for ( uint32 index = 2; index < 6; ++index )
+		{
+			palette[ index ][ 0 ] = ( ( 6 - index ) * value0 + ( index - 1 ) * value1 ) / 5.f;
+		}
+		palette[ 6 ][ 0 ] = 0.f;
+		palette[ 7 ][ 0 ] = 255.f;
+	}
+
+	return FindIndices( InValues, 1, palette, 8, InOutBlock.indices );
+}
+
+/**
+ * Compress one channel of block to BC4
+ */
+static void CompressBlockBC4( const BlockPixels_t& InPixels, uint32 InChannel, ETextureCompressionQuality InQuality, byte* OutBlock )
+{
+	// Copy channel to first one, so we can use common functions for it
+	BlockPixels_t		values;
+	float				minValue		= 255.f;
+	float				maxValue		= 0.f;
+	float				minInnerValue	= 255.f;
+	float				maxInnerValue	= 0.f;
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		float		value = InPixels[ index ][ InChannel ];
+		values[ index ][ 0 ] = value;
+		minValue	= Min( minValue, value );
+		maxValue	= Max( maxValue, value );
+		if ( value > 0.f && value < 255.f )
+		{
+			minInnerValue	= Min( minInnerValue, value );
+			maxInnerValue	= Max( maxInnerValue, value );
+		}
+	}
+
+	// Eight values mode between min and max
+	SBC4Block		block;
+	block.value0	= ( uint8 )( maxValue + 0.5f );
+	block.value1	= ( uint8 )( minValue + 0.5f );
+	float			error = QuantizeBC4( values, block );
+
+	// Refine endpoints while error is reduced
+	for ( uint32 iteration = 0, numIterations = GetNumRefinements( InQuality ); iteration < numIterations && block.value0 > block.value1; ++iteration )
+	{
+		static const float		weights[ 8 ] = { 0.f, 1.f, 1.f / 7.f, 2.f / 7.f, 3.f / 7.f, 4.f / 7.f, 5.f / 7.f, 6.f / 7.f };
+		float					endpoint0[ 4 ];
+		float					endpoint1[ 4 ];
+		if ( !SolveEndpoints( values, 1, block.indices, weights, endpoint0, endpoint1 ) )
+		{
+			break;
+		}
+
+		SBC4Block		newBlock;
+		newBlock.value0 = ( uint8 )( Max( endpoint0[ 0 ], endpoint1[ 0 ] ) + 0.5f );
+		newBlock.value1 = ( uint8 )( Min( endpoint0[ 0 ], endpoint1[ 0 ] ) + 0.5f );
+		if ( newBlock.value0 == newBlock.value1 )
+		{
+			break;
+		}
+
+		float		newError = QuantizeBC4( values, newBlock );
+		if ( newError >= error )
+		{
+			break;
+		}
+
+		error	= newError;
+		block	= newBlock;
+	}
+
+	// On high quality try six values mode, it's better for blocks with pure black and white pixels
+	if ( InQuality == TCQ_High && minInnerValue <= maxInnerValue )
+	{
+		SBC4Block		newBlock;
+		newBlock.value0 = ( uint8 )( minInnerValue + 0.5f );
+		newBlock.value1 = ( uint8 )( maxInnerValue + 0.5f );
+		if ( QuantizeBC4( values, newBlock ) < error )
+		{
+			block = newBlock;
+		}
+	}
+
+	uint64		indices = 0;
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		indices |= ( uint64 )block.indices[ index ] << ( index * 3 );
+	}
+
+	OutBlock[ 0 ] = block.value0;
+	OutBlock[ 1 ] = block.value1;
+	for ( uint32 index = 0; index < 6; ++index )
+	{
+		OutBlock[ 2 + index ] = ( indices >> ( index * 8 ) ) & 0xFF;
+	}
+}
+
+/**
+ * ---------------------
+ * BC7
+ * ---------------------
+ */
+
+/**
+ * Encoded BC7 block in mode 6 (one subset, RGBA endpoints with 7 bits per channel and unique P-bit, 4 bit indices)
+ */
+struct SBC7Block
+{
+	uint8		endpoints[ 2 ][ 4 ];			/**< Endpoints with 7 bits per channel */
+	uint8		pbits[ 2 ];						/**< P-bits of endpoints */
+	uint8		indices[ BLOCK_NUM_PIXELS ];	/**< Indices of palette colors */
+};
+
+/**
+ * Quantize endpoint to 7 bits per channel with the best P-bit
+ */
+static void QuantizeBC7Endpoint( const float InEndpoint[ 4 ], uint8 OutEndpoint[ 4 ], uint8& OutPBit, float OutColor[ 4 ] )
+{
+	float		bestError = FLT_MAX;
+	for ( uint32 pbit = 0; pbit < 2; ++pbit )
+	{
+		uint8		endpoint[ 4 ];
+		float		error = 0.f;
+		for ( uint32 channel = 0; channel < 4; ++channel )
+		{
+			endpoint[ channel ] = Clamp<int32>( ( int32 )( ( InEndpoint[ channel ] - pbit ) / 2.f + 0.5f ), 0, 127 );
+			float		delta = ( endpoint[ channel ] * 2 + pbit ) - InEndpoint[ channel ];
+			error += delta * delta;
+		}
+
+		if ( error < bestError )
+		{
+			bestError	= error;
+			OutPBit		= pbit;
+			memcpy( OutEndpoint, endpoint, sizeof( endpoint ) );
+		}
+	}
+
+	for ( uint32 channel = 0; channel < 4; ++channel )
+	{
+		OutColor[ channel ] = ( float )( OutEndpoint[ channel ] * 2 + OutPBit );
+	}
+}
+
+/**
+ * Quantize endpoints to BC7 block and find indices
+ * @return Return squared error of block
+ */
+static float QuantizeBC7( const BlockPixels_t& InPixels, const float InEndpoint0[ 4 ], const float InEndpoint1[ 4 ], SBC7Block& OutBlock )
+{
+	float		colors[ 2 ][ 4 ];
+	QuantizeBC7Endpoint( InEndpoint0, OutBlock.endpoints[ 0 ], OutBlock.pbits[ 0 ], colors[ 0 ] );
+	QuantizeBC7Endpoint( InEndpoint1, OutBlock.endpoints[ 1 ], OutBlock.pbits[ 1 ], colors[ 1 ] );
+
+	float		palette[ 16 ][ 4 ];
+	for ( uint32 index = 0; index < 16; ++index )
+	{
+		for ( uint32 channel = 0; channel < 4; ++channel )
+		{
+			palette[ index ][ channel ] = ( float )( ( ( 64 - GBC7Weights[ index ] ) * ( uint32 )colors[ 0 ][ channel ] + GBC7Weights[ index ] * ( uint32 )colors[ 1 ][ channel ] + 32 ) >> 6 );
+		}
+	}
+	return FindIndices( InPixels, 4, palette, 16, OutBlock.indices );
+}
+
+/**
+ * Write bits to block
+ */
+static FORCEINLINE void WriteBits( byte* OutBlock, uint32& InOutBitOffset, uint32 InValue, uint32 InNumBits )
+{
+	for ( uint32 bit = 0; bit < InNumBits; ++bit, ++InOutBitOffset )
+	{
+		if ( InValue & ( 1 << bit ) )
+		{
+			OutBlock[ InOutBitOffset / 8 ] |= 1 << ( InOutBitOffset % 8 );
+		}
+	}
+}
+
+/**
+ * Compress block to BC7 in mode 6
+ */
+static void CompressBlockBC7( const BlockPixels_t& InPixels, ETextureCompressionQuality InQuality, byte* OutBlock )
+{
+	static const float		weights[ 16 ] =
+	{
+		0.f / 64.f, 4.f / 64.f, 9.f / 64.f, 13.f / 64.f, 17.f / 64.f, 21.f / 64.f, 26.f / 64.f, 30.f / 64.f,
+		34.f / 64.f, 38.f / 64.f, 43.f / 64.f, 47.f / 64.f, 51.f / 64.f, 55.f / 64.f, 60.f / 64.f, 64.f / 64.f
+	};
+
+	float		endpoint0[ 4 ];
+	float		endpoint1[ 4 ];
+	SBC7Block	block;
+	ComputeEndpoints( InPixels, 4, InQuality, endpoint0, endpoint1 );
+	float		error = QuantizeBC7( InPixels, endpoint0, endpoint1, block );
+
+	// Refine endpoints while error is reduced
+	for ( uint32 iteration = 0, numIterations = GetNumRefinements( InQuality ); iteration < numIterations; ++iteration )
+	{
+		SBC7Block	newBlock;
+		if ( !SolveEndpoints( InPixels, 4, block.indices, weights, endpoint0, endpoint1 ) )
+		{
+			break;
+		}
+
+		float		newError = QuantizeBC7( InPixels, endpoint0, endpoint1, newBlock );
+		if ( newError >= error )
+		{
+			break;
+		}
+
+		error	= newError;
+		block	= newBlock;
+	}
+
+	// Most significant bit of first index is implicit zero, if it's not so swap endpoints
+	if ( block.indices[ 0 ] & 8 )
+	{
+		for ( uint32 channel = 0; channel < 4; ++channel )
+		{
+			Swap( block.endpoints[ 0 ][ channel ], block.endpoints[ 1 ][ channel ] );
+		}
+		Swap( block.pbits[ 0 ], block.pbits[ 1 ] );
+
+		for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+		{
+			block.indices[ index ] = 15 - block.indices[ index ];
+		}
+	}
+
+	uint32		bitOffset = 0;
+	memset( OutBlock, 0, 16 );
+	WriteBits( OutBlock, bitOffset, 1 << 6, 7 );
+	for ( uint32 channel = 0; channel < 4; ++channel )
+	{
+		WriteBits( OutBlock, bitOffset, block.endpoints[ 0 ][ channel ], 7 );
+		WriteBits( OutBlock, bitOffset, block.endpoints[ 1 ][ channel ], 7 );
+	}
+
+	WriteBits( OutBlock, bitOffset, block.pbits[ 0 ], 1 );
+	WriteBits( OutBlock, bitOffset, block.pbits[ 1 ], 1 );
+	for ( uint32 index = 0; index < BLOCK_NUM_PIXELS; ++index )
+	{
+		WriteBits( OutBlock, bitOffset, block.indices[ index ], index == 0 ? 3 : 4 );
+	}
+	check( bitOffset == 128 );
+}
+
+/**
+ * ---------------------
+ * Texture compressor
+ * ---------------------
+ */
+
+/**
+ * Get pixel format for texture
+ */
+EPixelFormat CTextureCompressor::GetPixelFormat( ETextureUsage InUsage, ETextureCompressionQuality InQuality, bool InIsHasAlpha )
+{
+	switch ( InUsage )
+	{
+	case TU_Albedo:
+		if ( InQuality == TCQ_High )
+		{
+			return PF_BC7;
+		}
+		return InIsHasAlpha ? PF_BC3 : PF_BC1;
+
+	case TU_Normal:		return PF_BC5;
+	case TU_Mask:		return PF_BC4;
+	default:			return PF_A8R8G8B8;
+	}
+}
+
+/**
+ * Is texture has not opaque pixels
+ */
+bool CTextureCompressor::IsHasAlpha( const byte* InData, uint32 InNumPixels )
+{
+	for ( uint32 index = 0; index < InNumPixels; ++index )
+	{
+		if ( InData[ index * 4 + 3 ] != 255 )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Is supported pixel format for compression
+ */
+bool CTextureCompressor::IsSupportedFormat( EPixelFormat InPixelFormat )
+{
+	switch ( InPixelFormat )
+	{
+	case PF_BC1:
+	case PF_BC3:
+	case PF_BC4:
+	case PF_BC5:
+	case PF_BC7:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * Compress texture
+ */
+bool CTextureCompressor::Compress( const byte* InData, uint32 InSizeX, uint32 InSizeY, EPixelFormat InPixelFormat, ETextureCompressionQuality InQuality, std::vector<byte>& OutData )
+{
+	if ( !IsSupportedFormat( InPixelFormat ) || InSizeX == 0 || InSizeY == 0 )
+	{
+		return false;
+	}
+
+	uint32		blockBytes	= GPixelFormats[ InPixelFormat ].blockBytes;
+	uint32		numBlocksX	= ( InSizeX + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+	uint32		numBlocksY	= ( InSizeY + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+	OutData.resize( numBlocksX * numBlocksY * blockBytes );
+
+	// Every row of blocks is compressed independently. Blocks out of texture (in small mips) are filled by edge pixels
+	appParallelFor( numBlocksY, [&]( uint32 InBlockY )
+					{
+						for ( uint32 blockX = 0; blockX < numBlocksX; ++blockX )
+						{
+							BlockPixels_t		pixels;
+							for ( uint32 y = 0; y < BLOCK_SIZE; ++y )
+							{
+								uint32		srcY = Min( InBlockY * BLOCK_SIZE + y, InSizeY - 1 );
+								for ( uint32 x = 0; x < BLOCK_SIZE; ++x )
+								{
+									const byte*		srcPixel = InData + ( srcY * InSizeX + Min( blockX * BLOCK_SIZE + x, InSizeX - 1 ) ) * 4;
+									for ( uint32 channel = 0; channel < 4; ++channel )
+									{
+										pixels[ y * BLOCK_SIZE + x ][ channel ] = srcPixel[ channel ];
+									}
+								}
+							}
+
+							byte*		dstBlock = OutData.data() + ( InBlockY * numBlocksX + blockX ) * blockBytes;
+							switch ( InPixelFormat )
+							{
+							case PF_BC1:
+								CompressBlockBC1( pixels, InQuality, dstBlock );
+								break;
+
+							case PF_BC3:
+								CompressBlockBC4( pixels, 3, InQuality, dstBlock );
+								CompressBlockBC1( pixels, InQuality, dstBlock + 8 );
+								break;
+
+							case PF_BC4:
+								CompressBlockBC4( pixels, 0, InQuality, dstBlock );
+								break;
+
+							case PF_BC5:
+								CompressBlockBC4( pixels, 0, InQuality, dstBlock );
+								CompressBlockBC4( pixels, 1, InQuality, dstBlock + 8 );
+								break;
+
+							case PF_BC7:
+								CompressBlockBC7( pixels, InQuality, dstBlock );
+								break;
+
+							default:
+								check( false );
+								break;
+							}
+						}
+					} );
+	return true;
+}
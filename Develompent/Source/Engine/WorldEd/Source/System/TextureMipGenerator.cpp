@@ -0,0 +1,292 @@
+#include <cmath>
+
+#include "Misc/Template.h"
+#include "System/ThreadPool.h"
+#include "System/TextureMipGenerator.h"
+
+/** Half width of Kaiser filter in pixels of destination mip */
+#define KAISER_WIDTH		3.f
+
+/** Alpha parameter of Kaiser window */
+#define KAISER_ALPHA		4.f
+
+/** PI */
+#define MIP_PI				3.14159265358979f
+
+/**
+ * Names of mip filters
+ */
+static const std::pair< std::wstring, EMipFilter >		GMipFilterNames[] =
+{
+	std::make_pair( TEXT( "Box" ),			MF_Box ),
+	std::make_pair( TEXT( "Kaiser" ),		MF_Kaiser )
+};
+
+/**
+ * Convert text to EMipFilter
+ */
+EMipFilter appTextToEMipFilter( const std::wstring& InString )
+{
+	for ( uint32 index = 0, count = ARRAY_COUNT( GMipFilterNames ); index < count; ++index )
+	{
+		if ( GMipFilterNames[ index ].first == InString )
+		{
+			return GMipFilterNames[ index ].second;
+		}
+	}
+
+	return MF_Kaiser;
+}
+
+/**
+ * Tap of filter
+ */
+struct SFilterTap
+{
+	uint32		index;		/**< Index of source pixel */
+	float		weight;		/**< Weight of source pixel */
+};
+
+/**
+ * Zero-order modified Bessel function of the first kind
+ */
+static float BesselI0( float InX )
+{
+	float		sum		= 1.f;
+	float		term	= 1.f;
+	float		x2		= InX * InX / 4.f;
+	for ( uint32 index = 1; index < 32 && term > sum * 1e-8f; ++index )
+	{
+		term	*= x2 / ( index * index );
+		sum		+= term;
+	}
+	return sum;
+}
+
+/**
+ * Evaluate filter
+ *
+ * @param InFilter	Filter
+ * @param InX		Distance from center in pixels of destination mip
+ * @return Return weight
+ */
+static float EvalFilter( EMipFilter InFilter, float InX )
+{
+	InX = fabs( InX );
+	switch ( InFilter )
+	{
+	case MF_Box:
+		return InX < 0.5f ? 1.f : 0.f;
+
+	case MF_Kaiser:
+	{
+		if ( InX >= KAISER_WIDTH )
+		{
+			return 0.f;
+		}
+
+		float		sinc	= InX < 1e-4f ? 1.f : sin( MIP_PI * InX ) / ( MIP_PI * InX );
+		float		ratio	= InX / KAISER_WIDTH;
+		return sinc * BesselI0( KAISER_ALPHA * sqrt( 1.f - ratio * ratio ) ) / BesselI0( KAISER_ALPHA );
+	}
+
+	default:
+		check( false );
+		return 0.f;
+	}
+}
+
+/**
+ * Build normalized taps of filter for every destination pixel. Pixels out of source are clamped to edge
+ */
+static void BuildFilterTaps( EMipFilter InFilter, uint32 InSrcSize, uint32 InDstSize, std::vector< std::vector<SFilterTap> >& OutTaps )
+{
+	float		scale	= ( float )InSrcSize / InDstSize;
+	float		support	= ( InFilter == MF_Box ? 0.5f : KAISER_WIDTH ) * scale;
+
+	OutTaps.resize( InDstSize );
+	for ( uint32 dstIndex = 0; dstIndex < InDstSize; ++dstIndex )
+	{
+		std::vector<SFilterTap>&	taps		= OutTaps[ dstIndex ];
+		float						center		= ( dstIndex + 0.5f ) * scale;
+		int32						firstIndex	= ( int32 )floor( center - support );
+		int32						lastIndex	= ( int32 )ceil( center + support );
+		float						totalWeight	= 0.f;
+		for ( int32 srcIndex = firstIndex; srcIndex <= lastIndex; ++srcIndex )
+		{
+			float		weight = EvalFilter( InFilter, ( srcIndex + 0.5f - center ) / scale );
+			if ( weight == 0.f )
+			{
+				continue;
+			}
+
+			SFilterTap	tap;
+			tap.index	= Clamp<int32>( srcIndex, 0, InSrcSize - 1 );
+			tap.weight	= weight;
+			taps.push_back( tap );
+			totalWeight	+= weight;
+		}
+
+		for ( uint32 index = 0, count = taps.size(); index < count; ++index )
+		{
+			taps[ index ].weight /= totalWeight;
+		}
+	}
+}
+
+/**
+ * Convert sRGB value to linear
+ */
+static FORCEINLINE float SRGBToLinear( float InValue )
+{
+	return InValue <= 0.04045f ? InValue / 12.92f : pow( ( InValue + 0.055f ) / 1.055f, 2.4f );
+}
+
+/**
+ * Convert linear value to sRGB
+ */
+static FORCEINLINE float LinearToSRGB( float InValue )
+{
+	return InValue <= 0.0031308f ? InValue * 12.92f : 1.055f * pow( InValue, 1.f / 2.4f ) - 0.055f;
+}
+
+/**
+ * Calculate number of mips in full mip chain
+ */
+uint32 CTextureMipGenerator::CalcNumMips( uint32 InSizeX, uint32 InSizeY )
+{
+	uint32		numMips = 1;
+	for ( uint32 size = Max( InSizeX, InSizeY ); size > 1; size >>= 1 )
+	{
+		++numMips;
+	}
+	return numMips;
+}
+
+/**
+ * Generate mip chain
+ */
+void CTextureMipGenerator::Generate( const byte* InData, uint32 InSizeX, uint32 InSizeY, uint32 InNumMips, EMipFilter InFilter, bool InIsSRGB, bool InIsNormalMap, std::vector< std::vector<byte> >& OutMips )
+{
+	check( InNumMips > 0 );
+	OutMips.resize( InNumMips );
+	OutMips[ 0 ].assign( InData, InData + InSizeX * InSizeY * 4 );
+	if ( InNumMips == 1 )
+	{
+		return;
+	}
+
+	// Table for convert color from bytes to linear space
+	float		toLinear[ 256 ];
+	for ( uint32 index = 0; index < 256; ++index )
+	{
+		toLinear[ index ] = InIsSRGB ? SRGBToLinear( index / 255.f ) : index / 255.f;
+	}
+
+	// Convert top mip to linear space with premultiplied alpha
+	std::vector<float>		srcPixels( InSizeX * InSizeY * 4 );
+	for ( uint32 index = 0, count = InSizeX * InSizeY; index < count; ++index )
+	{
+		const byte*		srcPixel	= InData + index * 4;
+		float*			dstPixel	= srcPixels.data() + index * 4;
+		float			alpha		= srcPixel[ 3 ] / 255.f;
+		dstPixel[ 0 ]	= toLinear[ srcPixel[ 0 ] ] * alpha;
+		dstPixel[ 1 ]	= toLinear[ srcPixel[ 1 ] ] * alpha;
+		dstPixel[ 2 ]	= toLinear[ srcPixel[ 2 ] ] * alpha;
+		dstPixel[ 3 ]	= alpha;
+	}
+
+	uint32		srcSizeX = InSizeX;
+	uint32		srcSizeY = InSizeY;
+	for ( uint32 mipIndex = 1; mipIndex < InNumMips; ++mipIndex )
+	{
+		uint32									dstSizeX = Max<uint32>( srcSizeX >> 1, 1 );
+		uint32									dstSizeY = Max<uint32>( srcSizeY >> 1, 1 );
+		std::vector< std::vector<SFilterTap> >	tapsX;
+		std::vector< std::vector<SFilterTap> >	tapsY;
+		BuildFilterTaps( InFilter, srcSizeX, dstSizeX, tapsX );
+		BuildFilterTaps( InFilter, srcSizeY, dstSizeY, tapsY );
+
+		// Filter is separable, so at first we filter rows and after columns
+		std::vector<float>		tmpPixels( dstSizeX * srcSizeY * 4 );
+		appParallelFor( srcSizeY, [&]( uint32 InY )
+						{
+							for ( uint32 x = 0; x < dstSizeX; ++x )
+							{
+								float*								dstPixel	= tmpPixels.data() + ( InY * dstSizeX + x ) * 4;
+								const std::vector<SFilterTap>&		taps		= tapsX[ x ];
+								dstPixel[ 0 ] = dstPixel[ 1 ] = dstPixel[ 2 ] = dstPixel[ 3 ] = 0.f;
+								for ( uint32 tapIndex = 0, numTaps = taps.size(); tapIndex < numTaps; ++tapIndex )
+								{
+									const float*		srcPixel = srcPixels.data() + ( InY * srcSizeX + taps[ tapIndex ].index ) * 4;
+									for ( uint32 channel = 0; channel < 4; ++channel )
+									{
+										dstPixel[ channel ] += srcPixel[ channel ] * taps[ tapIndex ].weight;
+									}
+								}
+							}
+						} );
+
+		std::vector<float>		dstPixels( dstSizeX * dstSizeY * 4 );
+		std::vector<byte>&		mip = OutMips[ mipIndex ];
+		mip.resize( dstSizeX * dstSizeY * 4 );
+		appParallelFor( dstSizeY, [&]( uint32 InY )
+						{
+							const std::vector<SFilterTap>&		taps = tapsY[ InY ];
+							for ( uint32 x = 0; x < dstSizeX; ++x )
+							{
+								float*		dstPixel = dstPixels.data() + ( InY * dstSizeX + x ) * 4;
+								dstPixel[ 0 ] = dstPixel[ 1 ] = dstPixel[ 2 ] = dstPixel[ 3 ] = 0.f;
+								for ( uint32 tapIndex = 0, numTaps = taps.size(); tapIndex < numTaps; ++tapIndex )
+								{
+									const float*		srcPixel = tmpPixels.data() + ( taps[ tapIndex ].index * dstSizeX + x ) * 4;
+									for ( uint32 channel = 0; channel < 4; ++channel )
+									{
+										dstPixel[ channel ] += srcPixel[ channel ] * taps[ tapIndex ].weight;
+									}
+								}
+
+								// Negative lobes of filter can go out of range
+								dstPixel[ 3 ] = Clamp( dstPixel[ 3 ], 0.f, 1.f );
+								for ( uint32 channel = 0; channel < 3; ++channel )
+								{
+									dstPixel[ channel ] = Clamp( dstPixel[ channel ], 0.f, dstPixel[ 3 ] );
+								}
+
+								// Filtered normal is shorter than one, so we unpack it to [-1..1], normalize and pack back.
+								// Result is written to dstPixel, so next mip is filtered from normalized vectors
+								if ( InIsNormalMap && dstPixel[ 3 ] > 0.f )
+								{
+									float		normal[ 3 ];
+									for ( uint32 channel = 0; channel < 3; ++channel )
+									{
+										normal[ channel ] = dstPixel[ channel ] / dstPixel[ 3 ] * 2.f - 1.f;
+									}
+
+									float		length = sqrt( normal[ 0 ] * normal[ 0 ] + normal[ 1 ] * normal[ 1 ] + normal[ 2 ] * normal[ 2 ] );
+									if ( length > 1e-4f )
+									{
+										for ( uint32 channel = 0; channel < 3; ++channel )
+										{
+											dstPixel[ channel ] = ( normal[ channel ] / length * 0.5f + 0.5f ) * dstPixel[ 3 ];
+										}
+									}
+								}
+
+								// Convert to bytes, color must be unpremultiplied and returned to sRGB space
+								byte*		mipPixel = mip.data() + ( InY * dstSizeX + x ) * 4;
+								for ( uint32 channel = 0; channel < 3; ++channel )
+								{
+									float		value = dstPixel[ 3 ] > 0.f ? dstPixel[ channel ] / dstPixel[ 3 ] : 0.f;
+									value		= InIsSRGB ? LinearToSRGB( value ) : value;
+									mipPixel[ channel ] = ( byte )Clamp<int32>( ( int32 )( value * 255.f + 0.5f ), 0, 255 );
+								}
+								mipPixel[ 3 ] = ( byte )Clamp<int32>( ( int32 )( dstPixel[ 3 ] * 255.f + 0.5f ), 0, 255 );
+							}
+						} );
+
+		srcPixels.swap( dstPixels );
+		srcSizeX = dstSizeX;
+		srcSizeY = dstSizeY;
+	}
+}
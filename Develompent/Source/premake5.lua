@@ -235,5 +235,7 @@ workspace( game )
         filter "configurations:not *WithEditor"
             -- If we build engine without editor, we will need exclude all of WorldEd source files
             excludes    { "Engine/WorldEd/**.*" }
-            defines     { "WITH_EDITOR=0", "WITH_IMGUI=0" }
+
+            -- WITH_IMGUI is chosen in LEBuild.h, without editor ImGui is used only for stats overlay
+            defines     { "WITH_EDITOR=0" }
         filter {}
\ No newline at end of file